@@ -2,8 +2,16 @@
 
 file(GLOB csv_files results/*.csv)
 foreach (csv_file IN LISTS csv_files)
+  # Samples files are included in the HTML of the results next to them.
+  if (csv_file MATCHES "\\.samples\\.csv$")
+    continue()
+  endif ()
   file(RELATIVE_PATH csv_file ${CMAKE_CURRENT_SOURCE_DIR} ${csv_file})
   string(REPLACE .csv .html html_file ${csv_file})
+  string(REPLACE .csv .samples.csv samples_file ${csv_file})
+  if (NOT EXISTS ${samples_file})
+    set(samples_file "")
+  endif ()
 
   file(TIMESTAMP ${csv_file} csv_time)
   file(TIMESTAMP ${html_file} html_time)
@@ -14,7 +22,8 @@ foreach (csv_file IN LISTS csv_files)
   if (PHP)
     message(STATUS "Converting ${csv_file} to ${html_file}")
     execute_process(
-      COMMAND ${PHP} results/template.php ${csv_file} OUTPUT_FILE ${html_file}
+      COMMAND ${PHP} results/template.php ${csv_file} ${samples_file}
+      OUTPUT_FILE ${html_file}
       COMMAND_ERROR_IS_FATAL ANY
     )
   else()
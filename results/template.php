@@ -37,10 +37,64 @@ THE SOFTWARE.
         onParseValue: $.csv.hooks.castToScalar
       });
 
+      // Static footprint in bytes: function -> [code, tables]
+      var footprint = {};
+      for (var i = 1; i < data.length; i++) {
+        var column = { "footprint-code": 0, "footprint-tables": 1 }[data[i][0]];
+        if (column == null)
+          continue;
+        if (footprint[data[i][1]] == null)
+          footprint[data[i][1]] = [null, null];
+        footprint[data[i][1]][column] = data[i][3];
+      }
+
+      // Times on data distributed according to a production weight
+      // histogram if any: function -> time.
+      var weighted = {};
+      for (var i = 1; i < data.length; i++) {
+        if (data[i][0] == "weighted")
+          weighted[data[i][1]] = data[i][3];
+      }
+
+      // Dispersion of the trials from the samples file if any:
+      // type -> function -> [median, standard deviation] averaged over digits.
+      var dispersion = {};
+      var samples = $.csv.toArrays($('#samplesInput').val() || "", {
+        onParseValue: $.csv.hooks.castToScalar
+      });
+      for (var i = 1; i < samples.length; i++) {
+        var type = samples[i][0], func = samples[i][1];
+        if (dispersion[type] == null)
+          dispersion[type] = {};
+        var d = dispersion[type][func] || (dispersion[type][func] = [0, 0, 0]);
+        d[0] += samples[i][3];
+        d[1] += samples[i][4];
+        d[2] += 1;
+      }
+      for (var type in dispersion) {
+        for (var func in dispersion[type]) {
+          var d = dispersion[type][func];
+          dispersion[type][func] = [d[0] / d[2], d[1] / d[2]];
+        }
+      }
+
+      // The metric to chart: time or, with ?metric=cycles, core cycles per
+      // conversion which don't depend on the clock speed. Types with a
+      // -cycles counterpart use it for the latter.
+      var metric = /[?&]metric=cycles/.test(location.search) ? "cycles" : "time";
+      var unit = metric == "cycles" ? "Cycles" : "Time (ns)";
+
+      // Methods that are not both shortest and correct, ranked separately.
+      var approximate = {};
+      for (var i = 1; i < data.length; i++) {
+        if (data[i][0] == "approximate")
+          approximate[data[i][1]] = true;
+      }
+
       // Convert data for bar chart (summing all digits)
       var timeData = {};	// type -> table
       var funcRowMap;
-      var maxDigit = 0;
+      var maxDigit = {}; // type -> max digit
 
       for (var i = 1; i < data.length; i++) {
         var type = data[i][0];
@@ -64,14 +118,16 @@ THE SOFTWARE.
         else
           table.push([func, time]);
 
-        maxDigit = Math.max(maxDigit, digit);
+        maxDigit[type] = Math.max(maxDigit[type] || 0, digit);
       }
 
       // Compute average
       for (var type in timeData) {
         var table = timeData[type];
+        if (maxDigit[type] == 0)
+          continue;
         for (var i = 1; i < table.length; i++)
-          table[i][1] /= maxDigit;
+          table[i][1] /= maxDigit[type];
       }
 
       // Convert data for drawing line chart per random digit
@@ -108,7 +164,21 @@ THE SOFTWARE.
         table[row][funcColumnMap[func]] = time;
       }
 
+      if (metric == "cycles") {
+        for (var type in timeData) {
+          var cycles = timeData[type + "-cycles"];
+          if (cycles == null)
+            continue;
+          cycles[0][1] = unit;
+          timeData[type] = cycles;
+          timeDigitData[type] = timeDigitData[type + "-cycles"];
+        }
+      }
+
       for (var type in timeData) {
+        if (type == "approximate" || /-(cycles|ghz)$/.test(type) ||
+            /^topdown-/.test(type))
+          continue;
         $("#main").append(
           $("<a>", { name: type }),
           $("<h2>", { style: "padding-top: 70px; margin-top: -70px;" }).append(type)
@@ -116,10 +186,42 @@ THE SOFTWARE.
 
         $("#section").append($("<li>").append($("<a>", { href: "#" + type }).append(type)));
 
-        drawTable(type, timeData[type]);
-        drawBarChart(type, timeData[type]);
-        if (timeDigitData[type] != null)
-          drawDigitChart(type, timeDigitData[type]);
+        if (type == "randomdigit") {
+          var exact = [timeData[type][0]], approx = [timeData[type][0]];
+          for (var i = 1; i < timeData[type].length; i++)
+            (approximate[timeData[type][i][0]] ? approx : exact).push(timeData[type][i]);
+          drawTable(type, exact, footprint, dispersion[type], weighted);
+          if (approx.length > 1) {
+            $("#main").append($("<h3>").append("Approximate methods"));
+            drawTable(type, approx, footprint, dispersion[type], weighted);
+          }
+        } else {
+          drawTable(type, timeData[type], {}, dispersion[type], {});
+        }
+        drawBarChart(type, timeData[type], unit);
+        if (type == "exponent")
+          drawExponentHeatmap(type, timeDigitData[type], unit);
+        else if (timeDigitData[type] != null)
+          drawDigitChart(type, timeDigitData[type], unit);
+      }
+
+      // The top-down breakdown of all methods in one stacked chart.
+      var categories = ["frontend-bound", "bad-speculation", "backend-bound", "retiring"];
+      var topdown = {}; // function -> fraction per category
+      for (var i = 1; i < data.length; i++) {
+        var category = categories.indexOf(data[i][0].replace(/^topdown-/, ""));
+        if (!/^topdown-/.test(data[i][0]) || category < 0)
+          continue;
+        var row = topdown[data[i][1]] || (topdown[data[i][1]] = [0, 0, 0, 0]);
+        row[category] = data[i][3];
+      }
+      if (Object.keys(topdown).length > 0) {
+        $("#main").append(
+          $("<a>", { name: "topdown" }),
+          $("<h2>", { style: "padding-top: 70px; margin-top: -70px;" }).append("topdown")
+        );
+        $("#section").append($("<li>").append($("<a>", { href: "#topdown" }).append("topdown")));
+        drawTopdownChart(topdown, categories);
       }
 
       $(".chart").each(function () {
@@ -147,7 +249,7 @@ THE SOFTWARE.
             function ($filename) {
                     return "\"" . basename($filename, ".csv") . "\"";
                   },
-            glob("*.csv")
+            preg_grep('/\.samples\.csv$/', glob("*.csv"), PREG_GREP_INVERT)
           )
         )
         ?>];
@@ -158,9 +260,49 @@ THE SOFTWARE.
       }
     }
 
-    function drawTable(type, timeData) {
+    function drawTable(type, timeData, footprint, dispersion, weighted) {
       var data = google.visualization.arrayToDataTable(timeData);
       data.addColumn('number', 'Speedup');
+      // Show the weighted time next to the average over digit counts so that
+      // methods can be ranked by it by clicking the column header.
+      if (Object.keys(weighted).length > 0) {
+        var weightedColumn = data.addColumn('number', 'Weighted (ns)');
+        for (var rowIndex = 0; rowIndex < data.getNumberOfRows(); rowIndex++) {
+          var w = weighted[data.getValue(rowIndex, 0)];
+          if (w != null)
+            data.setValue(rowIndex, weightedColumn, w);
+        }
+        new google.visualization.NumberFormat({ fractionDigits: 3 })
+          .format(data, weightedColumn);
+      }
+      // Show the static footprint next to the timings if known.
+      if (Object.keys(footprint).length > 0) {
+        var code = data.addColumn('number', 'Code (bytes)');
+        var tables = data.addColumn('number', 'Tables (bytes)');
+        for (var rowIndex = 0; rowIndex < data.getNumberOfRows(); rowIndex++) {
+          var fp = footprint[data.getValue(rowIndex, 0)];
+          if (fp == null)
+            continue;
+          data.setValue(rowIndex, code, fp[0]);
+          data.setValue(rowIndex, tables, fp[1]);
+        }
+      }
+      // Show the median and standard deviation of the trials if recorded so
+      // that differences can be told from noise.
+      if (dispersion != null) {
+        var median = data.addColumn('number', 'Median (ns)');
+        var stddev = data.addColumn('number', 'Stddev (ns)');
+        for (var rowIndex = 0; rowIndex < data.getNumberOfRows(); rowIndex++) {
+          var d = dispersion[data.getValue(rowIndex, 0)];
+          if (d == null)
+            continue;
+          data.setValue(rowIndex, median, d[0]);
+          data.setValue(rowIndex, stddev, d[1]);
+        }
+        var formatter = new google.visualization.NumberFormat({ fractionDigits: 3 });
+        formatter.format(data, median);
+        formatter.format(data, stddev);
+      }
       data.sort([{ column: 1, desc: true }]);
       var formatter1 = new google.visualization.NumberFormat({ fractionDigits: 3 });
       formatter1.format(data, 1);
@@ -196,7 +338,7 @@ THE SOFTWARE.
 
     }
 
-    function drawBarChart(type, timeData) {
+    function drawBarChart(type, timeData, unit) {
       var defaultColors = [
         "#3366cc", "#dc3912", "#ff9900", "#109618", "#990099", "#0099c6", "#dd4477",
         "#66aa00", "#b82e2e", "#316395", "#994499", "#22aa99", "#aaaa11", "#6633cc",
@@ -228,7 +370,7 @@ THE SOFTWARE.
         width: 800,
         height: 300,
         legend: { position: "none" },
-        hAxis: { title: "Time (ns)" }
+        hAxis: { title: unit }
       };
       var div = document.createElement("div");
       div.className = "chart";
@@ -239,7 +381,29 @@ THE SOFTWARE.
       chart.draw(data, options);
     }
 
-    function drawDigitChart(type, timeDigitData) {
+    function drawTopdownChart(topdown, categories) {
+      var table = [["Function"].concat(categories)];
+      for (var func in topdown)
+        table.push([func].concat(topdown[func]));
+      var data = google.visualization.arrayToDataTable(table);
+      var options = {
+        title: "Top-down breakdown of pipeline slots",
+        chartArea: { 'width': '60%', 'height': '85%' },
+        width: 800,
+        height: 30 * table.length + 100,
+        isStacked: "percent",
+        hAxis: { title: "Slots" }
+      };
+      var div = document.createElement("div");
+      div.className = "chart";
+      $(div).data("filename", "topdown");
+      $("#main").append(div);
+      var chart = new google.visualization.BarChart(div);
+
+      chart.draw(data, options);
+    }
+
+    function drawDigitChart(type, timeDigitData, unit) {
       var data = google.visualization.arrayToDataTable(timeDigitData);
 
       var options = {
@@ -256,7 +420,7 @@ THE SOFTWARE.
           minTextSpacing: 0
         },
         vAxis: {
-          title: "Time (ns) in log scale",
+          title: unit + " in log scale",
           logScale: true,
           minorGridlines: { count: 10 },
           baseline: 0
@@ -273,6 +437,42 @@ THE SOFTWARE.
       chart.draw(data, options);
     }
 
+    // Draws the times per binary exponent bucket as a heatmap with a row per
+    // method. Cells are shaded by the time relative to the fastest bucket of
+    // the method so that exponent-specific slow zones stand out. The buckets
+    // match min_bin_exp and exponent_bucket_size in benchmark.cc.
+    function drawExponentHeatmap(type, timeDigitData, unit) {
+      var minBinExp = -1074, bucketSize = 16, labelEvery = 16;
+      var table = $("<table>", { class: "heatmap" });
+      var header = $("<tr>").append($("<th>"));
+      for (var row = 1; row < timeDigitData.length; row += labelEvery) {
+        var exp = minBinExp + (timeDigitData[row][0] - 1) * bucketSize;
+        header.append($("<th>", { colspan: labelEvery }).append(exp));
+      }
+      table.append(header);
+      for (var column = 1; column < timeDigitData[0].length; column++) {
+        var min = Infinity;
+        for (var row = 1; row < timeDigitData.length; row++)
+          min = Math.min(min, timeDigitData[row][column]);
+        var tr = $("<tr>").append($("<th>").append(timeDigitData[0][column]));
+        for (var row = 1; row < timeDigitData.length; row++) {
+          var time = timeDigitData[row][column];
+          var exp = minBinExp + (timeDigitData[row][0] - 1) * bucketSize;
+          // White at the fastest bucket to red at twice its time or more.
+          var slowdown = Math.min(time / min - 1, 1);
+          tr.append($("<td>", {
+            title: "2^" + exp + " to 2^" + (exp + bucketSize - 1) + ": " +
+              time.toFixed(3),
+            style: "background-color: hsl(0, 100%, " +
+              (100 - 50 * slowdown).toFixed(0) + "%)"
+          }));
+        }
+        table.append(tr);
+      }
+      $("#main").append(
+        $("<h3>").append(unit + " by binary exponent"), table);
+    }
+
     // http://jsfiddle.net/P6XXM/
     function sanitize(svg) {
       svg = svg
@@ -334,6 +534,23 @@ THE SOFTWARE.
       padding-bottom: 20px;
     }
 
+    .heatmap {
+      font-size: 10px;
+      margin-bottom: 20px;
+    }
+
+    .heatmap th {
+      font-weight: normal;
+      padding-right: 4px;
+      white-space: nowrap;
+    }
+
+    .heatmap td {
+      width: 4px;
+      height: 14px;
+      padding: 0;
+    }
+
     .chart {
       padding-top: 20px;
       padding-bottom: 20px;
@@ -370,6 +587,13 @@ THE SOFTWARE.
               <ul class="dropdown-menu" role="menu" id="configuration">
               </ul>
             </li>
+            <li class="dropdown">
+              <a href="#" class="dropdown-toggle" data-toggle="dropdown">Metric <span class="caret"></span></a>
+              <ul class="dropdown-menu" role="menu">
+                <li><a href="?metric=time">Time (ns)</a></li>
+                <li><a href="?metric=cycles">Cycles</a></li>
+              </ul>
+            </li>
             <li class="dropdown">
               <a href="#" class="dropdown-toggle" data-toggle="dropdown">Section <span class="caret"></span></a>
               <ul class="dropdown-menu" role="menu" id="section">
@@ -388,6 +612,9 @@ THE SOFTWARE.
     <h2>Source CSV</h2>
     <textarea id="textInput" class="form-control" rows="5" readonly>
 <?php include $argv[1] ?>
+</textarea>
+    <textarea id="samplesInput" style="display: none" readonly>
+<?php if (isset($argv[2])) include $argv[2] ?>
 </textarea>
   </div>
   <div class="row" id="downloadDD" style="display: none">
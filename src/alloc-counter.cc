@@ -0,0 +1,105 @@
+// Heap allocation counting.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "alloc-counter.h"
+
+#include <errno.h>   // EINVAL, ENOMEM
+#include <stddef.h>  // size_t
+#include <stdlib.h>  // malloc
+
+#include <atomic>
+#include <new>  // std::bad_alloc
+
+namespace {
+
+// Whether counting has ever been started. Until then the allocation functions
+// only forward to the C library and don't touch thread-local state, so that
+// runs without --allocs are not affected by the interposition.
+std::atomic<bool> enabled = false;
+
+// Thread-local so that allocations of other threads are not counted.
+thread_local bool counting = false;
+thread_local alloc_counts counts;
+
+inline void count_alloc(size_t size) {
+  if (!enabled.load(std::memory_order_relaxed) || !counting) return;
+  ++counts.count;
+  counts.bytes += size;
+}
+
+}  // namespace
+
+void start_counting_allocs() {
+  enabled.store(true, std::memory_order_relaxed);
+  counts = {};
+  counting = true;
+}
+
+auto stop_counting_allocs() -> alloc_counts {
+  counting = false;
+  return counts;
+}
+
+#ifdef __GLIBC__
+
+// Interpose the C allocation functions and forward to glibc's implementation.
+// This covers allocations from C libraries as well as operator new which
+// calls malloc.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) noexcept {
+  count_alloc(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) noexcept {
+  count_alloc(n * size);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) noexcept {
+  count_alloc(size);
+  return __libc_realloc(p, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+  count_alloc(size);
+  return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+  count_alloc(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+  count_alloc(size);
+  void* p = __libc_memalign(alignment, size);
+  if (!p) return ENOMEM;
+  *result = p;
+  return 0;
+}
+}
+
+#else
+
+// Replace the global operator new. The other forms of operator new, e.g. the
+// array and nothrow ones, call this one by default.
+void* operator new(size_t size) {
+  count_alloc(size);
+  void* p = malloc(size != 0 ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+#endif
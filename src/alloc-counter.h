@@ -0,0 +1,24 @@
+// Heap allocation counting.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <stdint.h>  // uint64_t
+
+struct alloc_counts {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+// Starts counting heap allocations made by the calling thread: malloc and
+// friends with glibc, which operator new also goes through, and operator new
+// elsewhere. Frees are not counted. Until the first call the replaced
+// allocation functions only forward to the C library.
+void start_counting_allocs();
+
+// Stops counting and returns the allocations since start_counting_allocs().
+auto stop_counting_allocs() -> alloc_counts;
+
+#endif  // ALLOC_COUNTER_H_
@@ -1,8 +1,32 @@
+#include <string.h>  // memcpy, strcpy
+
 #include "asteria/ascii_numput.hpp"
 #include "benchmark.h"
 
 static register_method _("asteria", [](double value, char* buffer) {
   rocket::ascii_numput p;
   p.put_DD(value);
+  memcpy(buffer, p.data(), p.size());
+  return buffer + p.size();
+});
+
+static register_hex_method hex("asteria", [](double value, char* buffer) {
+  rocket::ascii_numput p;
+  p.put_XD(value);
   strcpy(buffer, p.data());
 });
+
+static register_itoa_method itoa(
+    "asteria",
+    [](int32_t value, char* buffer) {
+      rocket::ascii_numput p;
+      p.put_DI(value);
+      memcpy(buffer, p.data(), p.size());
+      return buffer + p.size();
+    },
+    [](int64_t value, char* buffer) {
+      rocket::ascii_numput p;
+      p.put_DI(value);
+      memcpy(buffer, p.data(), p.size());
+      return buffer + p.size();
+    });
@@ -4,42 +4,115 @@
 
 #include "benchmark.h"
 
-#include <math.h>    // isnan
+#include <math.h>    // isnan, ilogb
 #include <stdint.h>  // uint64_t
 #include <stdio.h>   // snprintf
+#include <stdlib.h>  // atoi
 #include <string.h>
 
 #include <algorithm>  // std::sort
+#include <atomic>
+#include <charconv>  // std::from_chars
 #include <chrono>
+#include <filesystem>
+#include <iterator>  // std::back_inserter
+#include <limits>  // std::numeric_limits
+#include <map>
+#include <memory>  // std::unique_ptr
+#include <mutex>
+#include <numeric>  // std::accumulate
+#include <optional>
+#include <random>  // std::mt19937
+#include <set>
 #include <string>
+#include <thread>
+#include <type_traits>  // std::is_same_v
 #include <vector>
 
+#ifndef _WIN32
+#  include <fcntl.h>         // open
+#  include <pthread.h>       // pthread_attr_setstack, pthread_setaffinity_np
+#  include <sys/mman.h>      // mmap
+#  include <sys/resource.h>  // getrusage
+#  include <unistd.h>        // fsync, ftruncate
+#endif
+
+// Random binary128 values are generated with __int128.
+#if defined(__SIZEOF_FLOAT128__) && defined(__SIZEOF_INT128__) && \
+    defined(HAVE_QUADMATH)
+#  include <quadmath.h>  // strtoflt128, quadmath_snprintf
+#  define BENCH_FLOAT128 1
+#else
+#  define BENCH_FLOAT128 0
+#endif
+
+#include "alloc-counter.h"
+#include "conversion-cache.h"
+#include "cycle-counter.h"
 #include "double-conversion/double-conversion.h"
+#include "energy-counters.h"
 #include "fmt/format.h"
+#include "fmt/ranges.h"  // fmt::join
+#include "mapped-file.h"
+#include "method-registry.h"
+#include "perf-counters.h"
+#include "plugin-loader.h"
+#include "result-cache.h"
+#include "spsc-queue.h"
+#include "symbol-sizes.h"
 
 namespace {
 
-constexpr int max_digits = std::numeric_limits<double>::max_digits10;
+template <typename Float>
+constexpr int max_digits_of = std::numeric_limits<Float>::max_digits10;
+constexpr int max_digits = max_digits_of<double>;
 constexpr int num_doubles_per_digit = 100'000;
+// Binary exponents of the exponent benchmark from the smallest subnormal to
+// the largest normal double, grouped into buckets of exponent_bucket_size.
+constexpr int min_bin_exp = -1074;
+constexpr int max_bin_exp = 1023;
+constexpr int exponent_bucket_size = 16;
+constexpr int num_exponent_buckets =
+    (max_bin_exp - min_bin_exp) / exponent_bucket_size + 1;
+// The maximum number of digit buckets of any type: 132 binary exponent
+// buckets, more than the 36 digits of binary128.
+constexpr int max_bench_digits = num_exponent_buckets;
 
-struct method {
-  std::string name;
-  dtoa_fun dtoa;
-};
+// Converts `value` and returns a pointer past the end of the output.
+auto write_value(dtoa_fun dtoa, double value, char* buffer) -> char* {
+  dtoa(value, buffer);
+  return buffer + strlen(buffer);
+}
+
+auto write_value(dtoa_end_fun dtoa, double value, char* buffer) -> char* {
+  return dtoa(value, buffer);
+}
+
+// Buffer sizes of the bounded benchmark. Shortest doubles have up to 24
+// characters so 32 is effectively unbounded.
+constexpr int bounded_sizes[] = {8, 16, 20, 22, 24, 32};
 
-std::vector<method> methods;
+// Precisions benchmarked in the precision results in increasing order.
+constexpr int precisions[] = {2, 6, 10, 17};
 
 #ifndef MACHINE
 #  define MACHINE "unknown"
 #endif
 
+// The compiler and flags of the build, part of the key of cached results.
+#ifndef BUILD_FLAGS
+#  define BUILD_FLAGS ""
+#endif
+
 auto os_name() -> const char* {
 #if defined(__linux__)
   return "linux";
 #elif defined(__APPLE__)
   return "macos";
-#elif define(_WIN32)
+#elif defined(_WIN32)
   return "windows";
+#elif defined(__wasm__)
+  return "wasm";
 #endif
   return "unknown";
 }
@@ -58,17 +131,23 @@ auto compiler_name() -> const char* {
   return "unknown";
 }
 
-struct from_chars_result {
-  double value;
+template <typename Float> struct from_chars_result {
+  Float value;
   size_t count;
 };
 
-auto from_chars(const char* buffer) -> from_chars_result {
+template <typename Float = double>
+auto from_chars(const char* buffer, int size = 1024)
+    -> from_chars_result<Float> {
   using namespace double_conversion;
   StringToDoubleConverter converter(
       StringToDoubleConverter::ALLOW_TRAILING_JUNK, 0.0, 0.0, NULL, NULL);
   int count = 0;
-  double value = converter.StringToDouble(buffer, 1024, &count);
+  Float value = 0;
+  if constexpr (std::is_same_v<Float, float>)
+    value = converter.StringToFloat(buffer, size, &count);
+  else
+    value = converter.StringToDouble(buffer, size, &count);
   return {value, size_t(count)};
 }
 
@@ -85,196 +164,6199 @@ class rng {
  public:
   explicit rng(unsigned seed = 0) : seed_(seed) {}
 
-  auto operator()() -> double {
+  auto next_uint64() -> uint64_t {
     uint64_t bits = 0;
     bits = uint64_t(next()) << 32;
     bits |= next();  // Must be a separate statement to prevent reordering.
+    return bits;
+  }
+
+  auto operator()() -> double {
+    uint64_t bits = next_uint64();
     double d = 0;
     memcpy(&d, &bits, sizeof(d));
     return d;
   }
+
+  auto next_float() -> float {
+    uint32_t bits = next();
+    float f = 0;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
 };
 
-void verify(const method& m) {
-  if (m.name == "null") return;
+// Returns a random finite value with uniformly distributed bits.
+template <typename Float> auto random_value(rng& r) -> Float {
+  Float value = 0;
+  do {
+    if constexpr (std::is_same_v<Float, float>)
+      value = r.next_float();
+    else
+      value = r();
+  } while (isnan(value) || isinf(value));
+  return value;
+}
 
-  fmt::print("Verifying {:20} ... ", m.name);
+// Returns the significant digits of a decimal number in any notation without
+// leading and trailing zeros, e.g. "1" for 0.1, 1e-01 and 1.0E-1.
+auto significant_digits(const char* s) -> std::string {
+  std::string digits;
+  for (; *s && *s != 'e' && *s != 'E'; ++s) {
+    if (*s >= '0' && *s <= '9' && (*s != '0' || !digits.empty()))
+      digits += *s;
+  }
+  while (!digits.empty() && digits.back() == '0') digits.pop_back();
+  return digits;
+}
 
-  bool first = true;
-  auto verify_value = [&](double value, dtoa_fun dtoa, const char* expected) {
-    char buffer[1024] = {};
-    dtoa(value, buffer);
+// Checks that `output` is a correct representation of `value` and returns the
+// output length. If `info` is given, the output of a shortest method must have
+// the significant digits of `expected` and round-trip failures of an
+// approximate method are only counted. Otherwise differences from `expected`
+// are reported as warnings.
+template <typename Float> class verifier {
+ private:
+  bool first_ = true;
+  const method_info* info_;
+  int num_roundtrip_failures_ = 0;
 
-    if (expected && strcmp(buffer, expected) != 0) {
-      if (first) {
-        fmt::print("\n");
-        first = false;
-      }
-      fmt::print("warning: expected {} but got {}\n", expected, buffer);
+  void print_first() {
+    if (!first_) return;
+    fmt::print("\n");
+    first_ = false;
+  }
+
+ public:
+  explicit verifier(const method_info* info = nullptr) : info_(info) {}
+
+  auto num_roundtrip_failures() const -> int {
+    return num_roundtrip_failures_;
+  }
+
+  auto verify(Float value, const char* output, const char* expected)
+      -> size_t {
+    if (expected && info_ && info_->shortest &&
+        significant_digits(output) != significant_digits(expected)) {
+      print_first();
+      fmt::print("error: not shortest {} -> '{}', expected {}\n", value,
+                 output, expected);
+    } else if (expected && strcmp(output, expected) != 0 &&
+               (!info_ || (info_->shortest &&
+                           info_->notation == output_notation::general))) {
+      print_first();
+      fmt::print("warning: expected {} but got {}\n", expected, output);
     }
 
-    size_t len = strlen(buffer);
-    auto [roundtrip, count] = from_chars(buffer);
+    size_t len = strlen(output);
+    auto [roundtrip, count] = from_chars<Float>(output);
     if (len != count) {
-      fmt::print("error: some extra character {} -> '{}'\n", value, buffer);
+      fmt::print("error: some extra character {} -> '{}'\n", value, output);
       //      throw std::exception();
     }
     if (value != roundtrip) {
-      fmt::print("error: roundtrip fail {} -> '{}' -> {}\n", value, buffer,
-                 roundtrip);
+      if (info_ && !info_->correct) {
+        ++num_roundtrip_failures_;
+      } else {
+        fmt::print("error: roundtrip fail {} -> '{}' -> {}\n", value, output,
+                   roundtrip);
+      }
       //      throw std::exception();
     }
     return len;
-  };
+  }
+};
 
-  // Verify boundary and simple cases.
-  // This gives benign errors in ostringstream and sprintf:
-  // Error: expect 0.1 but actual 0.10000000000000001
-  // Error: expect 1.2345 but actual 1.2344999999999999
-  struct test_case {
-    double value;
-    const char* expected;
-  };
-  const test_case cases[] =  //
-      {{0},
-       {0.1, "0.1"},
-       {0.12, "0.12"},
-       {0.123, "0.123"},
-       {0.1234, "0.1234"},
-       {1.2345, "1.2345"},
-       {1.0 / 3.0},
-       {2.0 / 3.0},
-       {10.0 / 3.0},
-       {20.0 / 3.0},
-       {std::numeric_limits<double>::min()},
-       {std::numeric_limits<double>::max()},
-       {std::numeric_limits<double>::denorm_min()}};
-  for (auto c : cases) verify_value(c.value, m.dtoa, c.expected);
+// Verify boundary and simple cases.
+// This gives benign errors in ostringstream and sprintf:
+// Error: expect 0.1 but actual 0.10000000000000001
+// Error: expect 1.2345 but actual 1.2344999999999999
+template <typename Float> struct test_case {
+  Float value;
+  const char* expected;
+};
+template <typename Float>
+constexpr test_case<Float> cases[] =  //
+    {{0},
+     {Float(0.1), "0.1"},
+     {Float(0.12), "0.12"},
+     {Float(0.123), "0.123"},
+     {Float(0.1234), "0.1234"},
+     {Float(1.2345), "1.2345"},
+     {Float(1.0) / Float(3.0)},
+     {Float(2.0) / Float(3.0)},
+     {Float(10.0) / Float(3.0)},
+     {Float(20.0) / Float(3.0)},
+     {std::numeric_limits<Float>::min()},
+     {std::numeric_limits<Float>::max()},
+     {std::numeric_limits<Float>::denorm_min()}};
+
+constexpr int num_random_cases = 100'000;
 
+// The maximum number of failures reported by a verification, per chunk in
+// verify_sweep.
+constexpr int max_reported_failures = 10;
+
+template <typename Float = double>
+auto get_random_cases() -> std::vector<Float> {
+  std::vector<Float> values;
+  values.reserve(num_random_cases);
   rng r;
+  for (int i = 0; i < num_random_cases; ++i)
+    values.push_back(random_value<Float>(r));
+  return values;
+}
+
+auto num_cpus() -> int {
+  return std::max(int(std::thread::hardware_concurrency()), 1);
+}
+
+void print_lengths(size_t total_len, size_t max_len) {
+  double avg_len = double(total_len) / num_random_cases;
+  fmt::print("OK. Length Avg = {:2.3f}, Max = {}\n", avg_len, max_len);
+}
+
+// Converts `value` with `m` into `buffer` followed by a NUL and returns the
+// output length.
+template <typename Method, typename Float>
+auto write_nul_terminated(const Method& m, Float value, char* buffer)
+    -> size_t {
+  m.dtoa(value, buffer);
+  return strlen(buffer);
+}
+
+auto write_nul_terminated(const method& m, double value, char* buffer)
+    -> size_t {
+  if (!m.dtoa_end) {
+    m.dtoa(value, buffer);
+    return strlen(buffer);
+  }
+  char* end = m.dtoa_end(value, buffer);
+  *end = '\0';
+  return size_t(end - buffer);
+}
+
+// Returns the properties of `m` checked by verification if it has any.
+template <typename Method>
+auto get_info(const Method&) -> const method_info* {
+  return nullptr;
+}
+
+auto get_info(const method& m) -> const method_info* { return &m.info; }
+auto get_info(const float_method& m) -> const method_info* { return &m.info; }
+
+template <typename Float, typename Method>
+void verify_method(const Method& m) {
+  verifier<Float> v(get_info(m));
+  auto verify_value = [&](Float value, const char* expected) {
+    char buffer[1024] = {};
+    write_nul_terminated(m, value, buffer);
+    return v.verify(value, buffer, expected);
+  };
+
+  for (auto c : cases<Float>) verify_value(c.value, c.expected);
+
   size_t total_len = 0;
   size_t max_len = 0;
-  constexpr int num_random_cases = 100'000;
-  for (int i = 0; i < num_random_cases; ++i) {
-    double d = 0;
-    do {
-      d = r();
-    } while (isnan(d) || isinf(d));
-    size_t len = verify_value(d, m.dtoa, nullptr);
+  for (Float d : get_random_cases<Float>()) {
+    size_t len = verify_value(d, nullptr);
     total_len += len;
     if (len > max_len) max_len = len;
   }
+  if (int n = v.num_roundtrip_failures(); n != 0)
+    fmt::print("Approximate, {} values don't round-trip. ", n);
+  print_lengths(total_len, max_len);
+}
 
-  double avg_len = double(total_len) / num_random_cases;
-  fmt::print("OK. Length Avg = {:2.3f}, Max = {}\n", avg_len, max_len);
+void verify(const method& m) {
+  if (m.name == "null") return;
+  fmt::print("Verifying {:20} ... ", m.name);
+  verify_method<double>(m);
 }
 
-auto get_random_digit_data(int digit) -> const double* {
-  static const std::vector<double> random_digit_data = []() {
-    std::vector<double> data;
-    data.reserve(num_doubles_per_digit * max_digits);
-    rng r;
-    for (int digit = 1; digit <= max_digits; ++digit) {
-      for (size_t i = 0; i < num_doubles_per_digit; ++i) {
-        double d = 0;
-        do {
-          d = r();
-        } while (isnan(d) || isinf(d));
+// Parses a hexadecimal floating-point number with an optional sign and 0x
+// prefix and returns the number of characters parsed.
+auto parse_hex(const char* s, double& value) -> size_t {
+  const char* p = s;
+  bool negative = *p == '-';
+  if (negative) ++p;
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+  auto [end, ec] =
+      std::from_chars(p, p + strlen(p), value, std::chars_format::hex);
+  if (ec != std::errc()) return 0;
+  if (negative) value = -value;
+  return size_t(end - s);
+}
 
-        // Limit the number of digits.
-        char buffer[64];
-        snprintf(buffer, sizeof(buffer), "%.*g", digit, d);
-        data.push_back(from_chars(buffer).value);
+// Checks that the hexadecimal output of `m` is exact, i.e. parses back to the
+// original value.
+void verify(const hex_method& m) {
+  fmt::print("Verifying hex {:16} ... ", m.name);
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  size_t total_len = 0, max_len = 0;
+  int num_errors = 0;
+  for (double value : values) {
+    char buffer[dtoa_buffer_size] = {};
+    m.dtoa(value, buffer);
+    size_t len = strlen(buffer);
+    total_len += len;
+    max_len = std::max(max_len, len);
+    double result = 0;
+    if (parse_hex(buffer, result) == len && result == value &&
+        signbit(result) == signbit(value)) {
+      continue;
+    }
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: {} -> '{}' -> {}\n", value, buffer, result);
+  }
+  if (num_errors == 0) print_lengths(total_len, max_len);
+}
+
+void verify(const float_method& m) {
+  fmt::print("Verifying float {:14} ... ", m.name);
+  verify_method<float>(m);
+}
+
+void verify(const batch_method& m) {
+  fmt::print("Verifying batch {:14} ... ", m.name);
+
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  std::vector<char> arena(values.size() * batch_value_size);
+  const char* end = m.dtoa(values, arena.data());
+
+  verifier<double> v(&m.info);
+  size_t total_len = 0;
+  size_t max_len = 0;
+  const char* p = arena.data();
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (p >= end) {
+      fmt::print("error: output ends after {} values\n", i);
+      return;
+    }
+    char buffer[batch_value_size] = {};
+    size_t n = static_cast<unsigned char>(*p++);
+    memcpy(buffer, p, std::min(n, sizeof(buffer) - 1));
+    p += n;
+
+    bool is_case = i < std::size(cases<double>);
+    size_t len = v.verify(values[i], buffer,
+                          is_case ? cases<double>[i].expected : nullptr);
+    if (is_case) continue;
+    total_len += len;
+    if (len > max_len) max_len = len;
+  }
+  if (p != end) fmt::print("error: {} extra bytes in output\n", end - p);
+  print_lengths(total_len, max_len);
+}
+
+// Checks the output of `m` on one thread and on more threads than CPUs, which
+// must be the same, so that the stitching of chunks is tested with threads
+// that finish out of order.
+void verify(const parallel_method& m) {
+  fmt::print("Verifying parallel {:11} ... ", m.name);
+
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  std::vector<char> arena(values.size() * batch_value_size);
+  std::string_view output(arena.data(), m.dtoa(values, arena.data(), 1));
+  const char* end = output.data() + output.size();
+  std::vector<char> parallel_arena(arena.size());
+  std::string_view parallel_output(
+      parallel_arena.data(),
+      m.dtoa(values, parallel_arena.data(), num_cpus() + 1));
+  if (output != parallel_output) {
+    fmt::print("error: output differs from the single-threaded one\n");
+    return;
+  }
+
+  verifier<double> v(&m.info);
+  size_t total_len = 0;
+  size_t max_len = 0;
+  const char* p = arena.data();
+  for (size_t i = 0; i < values.size(); ++i) {
+    auto newline = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!newline) {
+      fmt::print("error: output ends after {} values\n", i);
+      return;
+    }
+    char buffer[batch_value_size] = {};
+    memcpy(buffer, p, std::min(size_t(newline - p), sizeof(buffer) - 1));
+    p = newline + 1;
+
+    bool is_case = i < std::size(cases<double>);
+    size_t len = v.verify(values[i], buffer,
+                          is_case ? cases<double>[i].expected : nullptr);
+    if (is_case) continue;
+    total_len += len;
+    if (len > max_len) max_len = len;
+  }
+  if (p != end) fmt::print("error: {} extra bytes in output\n", end - p);
+  print_lengths(total_len, max_len);
+}
+
+// Checks that `m` parses the shortest representations of test cases and random
+// values to the original values.
+void verify(const parse_method& m) {
+  fmt::print("Verifying parse {:14} ... ", m.name);
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  int num_errors = 0;
+  for (double value : values) {
+    char buffer[64];
+    char* end = fmt::format_to(buffer, "{}", value);
+    *end = '\0';
+    double result = m.parse(buffer, end);
+    if (result == value && signbit(result) == signbit(value)) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: parse fail '{}' -> {}\n", buffer, result);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Formats `values` with `dtoa` one per line like a CSV column.
+template <typename Dtoa>
+auto format_column(Dtoa dtoa, std::span<const double> values) -> std::string {
+  std::string column;
+  char buffer[dtoa_buffer_size] = {};
+  for (double value : values) {
+    char* end = write_value(dtoa, value, buffer);
+    column.append(buffer, end);
+    column += '\n';
+  }
+  return column;
+}
+
+// Returns the number of values in `parsed` that differ from `values` in any
+// bit or are missing.
+auto count_mismatches(std::span<const double> values,
+                      std::span<const double> parsed) -> size_t {
+  size_t n = std::min(values.size(), parsed.size());
+  size_t num_mismatches = values.size() - n;
+  for (size_t i = 0; i < n; ++i)
+    num_mismatches += memcmp(&values[i], &parsed[i], sizeof(double)) != 0;
+  return num_mismatches;
+}
+
+// Checks that a column parser parses back the columns written by every correct
+// method since they differ in notation, e.g. 1e+100 or 1E100, and length.
+void verify(const column_parse_method& m) {
+  fmt::print("Verifying column parse {:7} ... ", m.name);
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  int num_errors = 0;
+  std::vector<double> parsed(values.size());
+  for (const method& dtoa_method : methods) {
+    if (!dtoa_method.info.correct) continue;
+    std::string column = dtoa_method.visit(
+        [&](auto dtoa) { return format_column(dtoa, values); });
+    size_t n = m.parse(column, parsed.data());
+    size_t num_mismatches =
+        count_mismatches(values, std::span(parsed.data(), n));
+    if (num_mismatches == 0) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: {} of {} values written by {} don't parse back\n",
+               num_mismatches, values.size(), dtoa_method.name);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Checks in parallel that `m` round-trips `count` values, where `get_value(i,
+// value)` produces the i-th value and returns false if it should be skipped.
+// Values are processed in chunks in increasing order and no new chunks are
+// started after a failure, so the first reported failure is the first one in
+// the sweep.
+template <typename Float, typename Method, typename F>
+void verify_sweep(const Method& m, uint64_t count, F get_value) {
+  using bits_type = std::conditional_t<sizeof(Float) == 4, uint32_t, uint64_t>;
+  constexpr uint64_t chunk_size = 1 << 16;
+  std::atomic<uint64_t> next_chunk = 0;
+  std::atomic<bool> failed = false;
+  std::mutex mutex;
+  std::vector<std::pair<uint64_t, std::string>> failures;
+
+  auto run = [&]() {
+    for (;;) {
+      uint64_t begin = next_chunk.fetch_add(chunk_size);
+      if (begin >= count || failed.load(std::memory_order_relaxed)) return;
+      uint64_t end = std::min(begin + chunk_size, count);
+      std::vector<std::pair<uint64_t, std::string>> chunk_failures;
+      for (uint64_t i = begin; i < end; ++i) {
+        Float value = 0;
+        if (!get_value(i, value)) continue;
+        char buffer[dtoa_buffer_size] = {};
+        size_t len = write_nul_terminated(m, value, buffer);
+        auto [roundtrip, n] = from_chars<Float>(buffer, int(len));
+        if (n == len && roundtrip == value) continue;
+        bits_type bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        chunk_failures.emplace_back(
+            i, fmt::format("{:#x} ({}) -> '{}' -> {}", bits, value, buffer,
+                           roundtrip));
+        if (chunk_failures.size() == max_reported_failures) break;
       }
+      if (chunk_failures.empty()) continue;
+      failed = true;
+      std::lock_guard<std::mutex> lock(mutex);
+      failures.insert(failures.end(), chunk_failures.begin(),
+                      chunk_failures.end());
     }
-    return data;
-  }();
-  return random_digit_data.data() + (digit - 1) * num_doubles_per_digit;
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0, n = num_cpus(); i < n; ++i) threads.emplace_back(run);
+  for (std::thread& t : threads) t.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  if (failures.empty()) {
+    fmt::print("OK. {} values in {:.1f}s\n", count, seconds);
+    return;
+  }
+  std::sort(failures.begin(), failures.end());
+  if (failures.size() > max_reported_failures)
+    failures.resize(max_reported_failures);
+  fmt::print("\n");
+  for (const auto& f : failures)
+    fmt::print("error: roundtrip fail {}\n", f.second);
 }
 
-using duration = std::chrono::steady_clock::duration;
+// Verifies `m` on `count` random finite doubles unless it is approximate.
+void verify_random(const method& m, uint64_t count) {
+  if (m.name == "null" || !m.info.correct) return;
+  fmt::print("Verifying {:20} ... ", m.name);
+  fflush(stdout);
+  verify_sweep<double>(m, count, [](uint64_t i, double& value) {
+    // splitmix64 gives independent random bits for each index.
+    uint64_t bits = i * 0x9e3779b97f4a7c15;
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111eb;
+    bits ^= bits >> 31;
+    memcpy(&value, &bits, sizeof(value));
+    return std::isfinite(value);
+  });
+}
 
-struct digit_result {
-  double duration_ns = std::numeric_limits<double>::min();
-};
+// Verifies `m` on all finite floats.
+void verify_all(const float_method& m) {
+  fmt::print("Verifying float {:14} ... ", m.name);
+  fflush(stdout);
+  verify_sweep<float>(m, uint64_t(1) << 32, [](uint64_t i, float& value) {
+    uint32_t bits = uint32_t(i);
+    memcpy(&value, &bits, sizeof(value));
+    return std::isfinite(value);
+  });
+}
 
-struct benchmark_result {
-  double min_ns = std::numeric_limits<double>::max();
-  double max_ns = std::numeric_limits<double>::min();
-  digit_result per_digit[max_digits + 1];
+// A decimal reduced to its sign, significant digits and the exponent of the
+// first digit, e.g. {false, "125", -2} for 0.0125, 1.25e-2 and 1.25E-02.
+struct normalized_decimal {
+  bool negative = false;
+  int num_digits = 0;
+  char digits[32] = {};  // Without leading and trailing zeros.
+  int exp = 0;
+
+  auto operator==(const normalized_decimal&) const -> bool = default;
 };
 
-auto bench_random_digit(dtoa_fun dtoa, const std::string& name, int num_trials)
-    -> benchmark_result {
-  int num_iterations_per_digit = num_trials;
+// Normalizes the output of a method in fixed or exponential notation.
+auto normalize_decimal(const char* s) -> normalized_decimal {
+  normalized_decimal result;
+  result.negative = *s == '-';
+  if (result.negative) ++s;
+  // The position of the decimal point and of the first nonzero digit counted
+  // in digits from the start.
+  int point = -1, first = -1, pos = 0, last_nonzero = -1;
+  for (; *s && *s != 'e' && *s != 'E'; ++s) {
+    if (*s == '.') {
+      point = pos;
+      continue;
+    }
+    if (*s < '0' || *s > '9') break;
+    if (*s != '0') {
+      if (first < 0) first = pos;
+      last_nonzero = pos;
+    }
+    if (first >= 0 && result.num_digits < int(sizeof(result.digits)))
+      result.digits[result.num_digits++] = *s;
+    ++pos;
+  }
+  if (first < 0) return {result.negative};  // Zero
+  result.num_digits = std::min(result.num_digits, last_nonzero - first + 1);
+  memset(result.digits + result.num_digits, 0,
+         sizeof(result.digits) - result.num_digits);
+  if (point < 0) point = pos;
+  result.exp = point - first - 1 + (*s ? atoi(s + 1) : 0);
+  return result;
+}
 
-  char buffer[256] = {};
-  benchmark_result result;
-  for (int digit = 1; digit <= max_digits; ++digit) {
-    const double* data = get_random_digit_data(digit);
+// Rewrites the output of a method in `[begin, end)` in the canonical notation
+// of the normalized benchmark, the shortest JSON output of JavaScript's
+// Number.prototype.toString: fixed if the decimal exponent is in [-7, 21) and
+// exponential otherwise, e.g. 0.000001, 1e-7 and 1.5e+21, and returns a
+// pointer past the end. It is a single pass like normalize_decimal but without
+// the NUL terminator and the zeroing which would dominate the timings.
+auto write_canonical(const char* begin, const char* end, char* out) -> char* {
+  const char* p = begin;
+  bool negative = p != end && *p == '-';
+  p += negative;
+  char digits[32];
+  // The position of the decimal point and of the first nonzero digit counted
+  // in digits from the start.
+  int n = 0, point = -1, first = -1, pos = 0;
+  for (; p != end && *p != 'e' && *p != 'E'; ++p) {
+    if (*p == '.') {
+      point = pos;
+      continue;
+    }
+    if (*p < '0' || *p > '9') break;
+    if (*p != '0' && first < 0) first = pos;
+    if (first >= 0 && n < int(sizeof(digits))) digits[n++] = *p;
+    ++pos;
+  }
+  while (n > 0 && digits[n - 1] == '0') --n;
+  if (n == 0) {
+    *out++ = '0';
+    return out;
+  }
+  if (point < 0) point = pos;
+  int exp = 0;
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    bool negative_exp = ++p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+')) ++p;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+      exp = exp * 10 + (*p - '0');
+    if (negative_exp) exp = -exp;
+  }
+  exp += point - first - 1;
 
-    duration run_duration = duration::max();
-    for (int trial = 0; trial < num_trials; ++trial) {
-      auto start = std::chrono::steady_clock::now();
-      for (int iter = 0; iter < num_iterations_per_digit; ++iter) {
-        for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+  if (negative) *out++ = '-';
+  if (exp >= 21 || exp < -7) {
+    *out++ = digits[0];
+    if (n > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, size_t(n - 1));
+      out += n - 1;
+    }
+    *out++ = 'e';
+    *out++ = exp < 0 ? '-' : '+';
+    unsigned abs_exp = unsigned(exp < 0 ? -exp : exp);
+    if (abs_exp >= 100) *out++ = char('0' + abs_exp / 100);
+    if (abs_exp >= 10) *out++ = char('0' + abs_exp / 10 % 10);
+    *out++ = char('0' + abs_exp % 10);
+    return out;
+  }
+  if (exp < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    memset(out, '0', size_t(-exp - 1));
+    out += -exp - 1;
+    memcpy(out, digits, size_t(n));
+    return out + n;
+  }
+  // The integer part, padded with zeros, followed by the remaining digits.
+  int int_digits = exp + 1;
+  memcpy(out, digits, size_t(std::min(n, int_digits)));
+  if (n < int_digits) memset(out + n, '0', size_t(int_digits - n));
+  out += int_digits;
+  if (n > int_digits) {
+    *out++ = '.';
+    memcpy(out, digits + int_digits, size_t(n - int_digits));
+    out += n - int_digits;
+  }
+  return out;
+}
+
+// Runs all shortest correctly rounded methods on `count` doubles in parallel
+// and reports values where the significant digits or exponents differ from
+// `methods[0]`. Half of the values are random bit patterns and half odd
+// significands times 2**-2, 2**2 or 2**3 which have many ties and values
+// near the boundaries of rounding intervals.
+void verify_differential(const std::vector<const method*>& methods,
+                         uint64_t count) {
+  constexpr uint64_t chunk_size = 1 << 16;
+  std::atomic<uint64_t> next_chunk = 0;
+  std::vector<std::atomic<uint64_t>> mismatches(methods.size());
+  std::mutex mutex;
+  std::vector<std::vector<std::string>> examples(methods.size());
+
+  auto run = [&]() {
+    std::vector<uint64_t> local_mismatches(methods.size());
+    char ref[dtoa_buffer_size] = {}, buffer[dtoa_buffer_size] = {};
+    for (;;) {
+      uint64_t begin = next_chunk.fetch_add(chunk_size);
+      if (begin >= count) break;
+      uint64_t end = std::min(begin + chunk_size, count);
+      for (uint64_t i = begin; i < end; ++i) {
+        // splitmix64 gives independent random bits for each index.
+        uint64_t bits = i * 0x9e3779b97f4a7c15;
+        bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9;
+        bits = (bits ^ (bits >> 27)) * 0x94d049bb133111eb;
+        bits ^= bits >> 31;
+        double value = 0;
+        if (i % 2 == 0) {
+          memcpy(&value, &bits, sizeof(value));
+          if (!std::isfinite(value)) continue;
+        } else {
+          constexpr int exps[] = {-2, 2, 3};
+          uint64_t sig = (bits >> 11) | (uint64_t(1) << 52) | 1;
+          value = ldexp(double(sig), exps[bits % 3]);
+        }
+        write_nul_terminated(*methods[0], value, ref);
+        normalized_decimal expected = normalize_decimal(ref);
+        for (size_t j = 1; j < methods.size(); ++j) {
+          write_nul_terminated(*methods[j], value, buffer);
+          if (normalize_decimal(buffer) == expected) continue;
+          if (local_mismatches[j]++ >= max_reported_failures) continue;
+          std::lock_guard<std::mutex> lock(mutex);
+          if (examples[j].size() < max_reported_failures) {
+            memcpy(&bits, &value, sizeof(bits));
+            examples[j].push_back(
+                fmt::format("{:#x}: {} '{}', {} '{}'", bits, methods[0]->name,
+                            ref, methods[j]->name, buffer));
+          }
+        }
       }
-      auto finish = std::chrono::steady_clock::now();
+    }
+    for (size_t j = 0; j < methods.size(); ++j)
+      mismatches[j] += local_mismatches[j];
+  };
 
-      // Pick the smallest of trial runs.
-      auto d = finish - start;
-      if (d < run_duration) run_duration = d;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0, n = num_cpus(); i < n; ++i) threads.emplace_back(run);
+  for (std::thread& t : threads) t.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  for (size_t j = 1; j < methods.size(); ++j) {
+    fmt::print("{:28} ... ", methods[j]->name);
+    if (mismatches[j] == 0) {
+      fmt::print("OK\n");
+      continue;
     }
+    fmt::print("{} values differ\n", mismatches[j].load());
+    std::sort(examples[j].begin(), examples[j].end());
+    for (const std::string& e : examples[j])
+      fmt::print("error: differs from reference {}\n", e);
+  }
+  fmt::print("{} values in {:.1f}s, {:.2e} values per hour\n", count, seconds,
+             count / seconds * 3600);
+}
 
-    double ns =
-        std::chrono::duration_cast<std::chrono::nanoseconds>(run_duration)
-            .count();
-    ns /= num_iterations_per_digit * num_doubles_per_digit;
+// Bump when the generation of random digit data changes to invalidate caches.
+constexpr int random_digit_data_version = 1;
+constexpr unsigned random_digit_seed = 0;
 
-    result.per_digit[digit].duration_ns = ns;
-    if (ns < result.min_ns) result.min_ns = ns;
-    if (ns > result.max_ns) result.max_ns = ns;
+// Returns the number of significant digits of the decimal number `s` ignoring
+// leading and trailing zeros.
+auto count_significant_digits(const char* s) -> int {
+  int num_digits = 0, num_zeros = 0;
+  for (; *s && *s != 'e' && *s != 'E'; ++s) {
+    if (*s < '0' || *s > '9') continue;
+    if (*s == '0') {
+      num_zeros += num_digits != 0;
+      continue;
+    }
+    num_digits += num_zeros + 1;
+    num_zeros = 0;
   }
-  return result;
+  return num_digits;
 }
 
-}  // namespace
+// Adds `delta` (1 or -1) to the non-negative decimal integer `digits`.
+void add_to_digits(std::string& digits, int delta) {
+  char last = delta > 0 ? '9' : '0';
+  size_t i = digits.size();
+  for (; i > 0 && digits[i - 1] == last; --i) digits[i - 1] = '9' - last + '0';
+  if (i == 0)
+    digits.insert(digits.begin(), '1');
+  else
+    digits[i - 1] += delta;
+}
 
-register_method::register_method(const char* name, dtoa_fun dtoa) {
-  methods.push_back(method{name, dtoa});
+// Returns true if a decimal with `num_digits` significant digits round-trips.
+// `format(buffer, size, precision)` writes the value like "%.*e" and
+// `round_trips(s)` checks if `s` parses back to the value. Only the nearest
+// decimal and its neighbors need to be checked since the rounding interval of
+// the value is narrower than a unit in the last decimal place.
+template <typename Format, typename RoundTrips>
+auto round_trips_with_digits(int num_digits, Format format,
+                             RoundTrips round_trips) -> bool {
+  char buffer[64];
+  format(buffer, sizeof(buffer), num_digits - 1);
+  // Split "d.ddde[+-]xx" into the significand digits and the exponent.
+  std::string digits;
+  const char* p = buffer;
+  for (; *p != 'e'; ++p) {
+    if (*p != '.') digits += *p;
+  }
+  int exp = atoi(p + 1) - (num_digits - 1);
+  for (int delta : {0, -1, 1}) {
+    std::string candidate = digits;
+    if (delta != 0) add_to_digits(candidate, delta);
+    if (round_trips(fmt::format("{}e{}", candidate, exp).c_str())) return true;
+  }
+  return false;
 }
 
-auto main(int argc, char** argv) -> int {
-  std::string commit_hash;
-  if (argc > 1) commit_hash = std::string("_") + argv[1];
-  int num_trials = 10;
-  if (argc > 2) num_trials = std::stoi(argv[2]);
+// Returns true if `num_digits` is the shortest number of digits that round-trip
+// which is the case if no decimal with one digit fewer does: a shorter one can
+// be padded with zeros.
+template <typename Format, typename RoundTrips>
+auto is_shortest(int num_digits, Format format, RoundTrips round_trips)
+    -> bool {
+  return num_digits <= 1 ||
+         !round_trips_with_digits(num_digits - 1, format, round_trips);
+}
 
-  std::sort(
-      methods.begin(), methods.end(),
-      [](const method& lhs, const method& rhs) { return lhs.name < rhs.name; });
+// Loads `size` values of the dataset `name` into `values` from a cache in
+// results/cache, generating them with `generate()` and writing them first if
+// the cache doesn't exist. The cache is keyed by the dataset name and version,
+// type, seed and number of values per digit. The values are copied out of the
+// file mapping because timed loops read them in every trial and the kernel may
+// drop and refault pages of a file. Returns `values.data()`.
+template <typename T, typename Generate>
+auto load_cached_data(std::vector<T>& values, const char* name, int version,
+                      size_t size, Generate generate) -> const T* {
+  namespace fs = std::filesystem;
+  std::string path = fmt::format(
+      "results/cache/{}-v{}-{}-s{}-n{}.bin", name, version,
+      std::is_same_v<T, float>    ? "f32"
+      : std::is_same_v<T, double> ? "f64"
+                                  : "u8",
+      random_digit_seed, num_doubles_per_digit);
+  mapped_file file;
+  if (file.open(path.c_str()) && file.size() == size * sizeof(T)) {
+    auto data = static_cast<const T*>(file.data());
+    values.assign(data, data + size);
+    return values.data();
+  }
 
-  for (const method& m : methods) verify(m);
+  values = generate();
+  std::error_code ec;
+  fs::create_directories(fs::path(path).parent_path(), ec);
+  // Write to a temporary file first so that a concurrent run never sees a
+  // partially written cache.
+  std::string temp_path = fmt::format(
+      "{}.{}", path,
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  FILE* f = fopen(temp_path.c_str(), "wb");
+  if (!f) return values.data();
+  bool ok = fwrite(values.data(), sizeof(T), size, f) == size;
+  ok = fclose(f) == 0 && ok;
+  if (ok) fs::rename(temp_path, path, ec);
+  if (!ok || ec) fs::remove(temp_path, ec);
+  return values.data();
+}
 
-  std::string filename = fmt::format("results/{}_{}_{}{}.csv", MACHINE,
-                                     os_name(), compiler_name(), commit_hash);
-  FILE* f = fopen(filename.c_str(), "w");
-  if (!f) {
-    fmt::print(stderr, "Failed to open {}: {}", filename.c_str(),
-               strerror(errno));
-    exit(1);
+auto float16_name(float16_format format) -> const char* {
+  return format == float16_format::binary16 ? "float16" : "bfloat16";
+}
+
+auto float16_sig_bits(float16_format format) -> int {
+  return format == float16_format::binary16 ? 10 : 7;
+}
+
+// The maximum number of significant digits needed to round-trip.
+auto float16_max_digits(float16_format format) -> int {
+  return format == float16_format::binary16 ? 5 : 4;
+}
+
+// Converts a 16-bit value given by its bit pattern to a double exactly.
+auto float16_to_double(float16_format format, uint16_t bits) -> double {
+  int sig_bits = float16_sig_bits(format);
+  int exp_mask = (1 << (15 - sig_bits)) - 1, exp_bias = exp_mask >> 1;
+  int bin_exp = (bits >> sig_bits) & exp_mask;
+  int bin_sig = bits & ((1 << sig_bits) - 1);
+  double value = 0;
+  if (bin_exp == exp_mask)
+    value = bin_sig != 0 ? NAN : INFINITY;
+  else if (bin_exp == 0)
+    value = ldexp(bin_sig, 1 - exp_bias - sig_bits);
+  else
+    value = ldexp(bin_sig | (1 << sig_bits), bin_exp - exp_bias - sig_bits);
+  return bits >> 15 ? -value : value;
+}
+
+// Rounds `value` to the nearest 16-bit value with ties to even.
+auto double_to_float16(float16_format format, double value) -> uint16_t {
+  int sig_bits = float16_sig_bits(format);
+  int exp_mask = (1 << (15 - sig_bits)) - 1, exp_bias = exp_mask >> 1;
+  uint32_t sign = std::signbit(value) ? 0x8000 : 0;
+  uint32_t inf_bits = uint32_t(exp_mask) << sig_bits;
+  if (isnan(value)) return uint16_t(sign | inf_bits | (1 << (sig_bits - 1)));
+  if (isinf(value)) return uint16_t(sign | inf_bits);
+  if (value == 0) return uint16_t(sign);
+  // Scale to an integer significand with the exponent of the value or of the
+  // smallest normal whichever is larger so that rounding handles subnormals
+  // and carries into the exponent.
+  int min_exp = 1 - exp_bias, bin_exp = 0;
+  frexp(value, &bin_exp);
+  bin_exp = std::max(bin_exp - 1, min_exp);
+  uint32_t sig =
+      uint32_t(nearbyint(ldexp(std::abs(value), sig_bits - bin_exp)));
+  uint32_t bits = (uint32_t(bin_exp - min_exp) << sig_bits) + sig;
+  return uint16_t(sign | std::min(bits, inf_bits));
+}
+
+// Returns the shortest number of significant digits that round-trip the
+// non-negative 16-bit value `bits`.
+auto float16_shortest_digits(float16_format format, uint16_t bits) -> int {
+  double value = float16_to_double(format, bits);
+  auto format_value = [&](char* buffer, size_t size, int precision) {
+    snprintf(buffer, size, "%.*e", precision, value);
+  };
+  auto round_trips = [&](const char* s) {
+    return double_to_float16(format, from_chars(s).value) == bits;
+  };
+  int num_digits = 1;
+  while (!round_trips_with_digits(num_digits, format_value, round_trips))
+    ++num_digits;
+  return num_digits;
+}
+
+constexpr uint32_t num_float16_magnitudes = 0x8000;
+
+// Returns the shortest numbers of significant digits of the non-negative
+// 16-bit values indexed by their bits, 0 for zero and non-finite values.
+// Computing them with printf takes a while, so they are cached in
+// results/cache like the random digit data.
+auto get_float16_shortest_digits(float16_format format) -> const uint8_t* {
+  static std::vector<uint8_t> values[2];
+  static const uint8_t* digits[2] = {};
+  int index = int(format);
+  if (!digits[index]) {
+    std::string name = fmt::format("{}-digits", float16_name(format));
+    digits[index] = load_cached_data<uint8_t>(
+        values[index], name.c_str(), 1, num_float16_magnitudes, [=]() {
+          std::vector<uint8_t> result(num_float16_magnitudes);
+          for (uint32_t i = 1; i < num_float16_magnitudes; ++i) {
+            auto bits = uint16_t(i);
+            if (!std::isfinite(float16_to_double(format, bits))) continue;
+            result[i] = uint8_t(float16_shortest_digits(format, bits));
+          }
+          return result;
+        });
   }
+  return digits[index];
+}
 
-  fmt::print(f, "Type,Function,Digit,Time(ns)\n");
-  for (const method& m : methods) {
-    fmt::print("Benchmarking randomdigit {:20} ... ", m.name);
-    fflush(stdout);
-    benchmark_result result = bench_random_digit(m.dtoa, m.name, num_trials);
-    for (int digit = 1; digit <= max_digits; ++digit) {
-      fmt::print(f, "randomdigit,{},{},{:f}\n", m.name, digit,
-                 result.per_digit[digit].duration_ns);
+// Verifies `m` on all finite 16-bit values: the output must round-trip and
+// have the shortest number of digits.
+void verify(const float16_method& m) {
+  fmt::print("Verifying {:8} {:14} ... ", float16_name(m.format), m.name);
+  fflush(stdout);
+  const uint8_t* shortest_digits = get_float16_shortest_digits(m.format);
+  auto start = std::chrono::steady_clock::now();
+  int num_values = 0, num_errors = 0;
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    uint16_t bits = uint16_t(i);
+    double value = float16_to_double(m.format, bits);
+    if (!std::isfinite(value)) continue;
+    ++num_values;
+    char buffer[64] = {};
+    m.dtoa(bits, buffer);
+    size_t len = strlen(buffer);
+    auto [roundtrip, count] = from_chars(buffer, int(len));
+    uint16_t abs_bits = bits & 0x7fff;
+    bool ok =
+        count == len && double_to_float16(m.format, roundtrip) == bits &&
+        (abs_bits == 0 ||
+         count_significant_digits(buffer) == shortest_digits[abs_bits]);
+    if (ok) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: {:#06x} ({}) -> '{}'\n", bits, value, buffer);
+  }
+  double us = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  if (num_errors == 0)
+    fmt::print("OK. {} values in {:.0f}us\n", num_values, us);
+}
+
+// Returns `num_doubles_per_digit` random 16-bit values whose shortest
+// representations have `digit` significant digits, sampled uniformly from all
+// such values.
+auto get_float16_digit_data(float16_format format, int digit)
+    -> const uint16_t* {
+  static std::vector<uint16_t> data[2];
+  std::vector<uint16_t>& result = data[int(format)];
+  if (result.empty()) {
+    int num_digits = float16_max_digits(format);
+    const uint8_t* shortest_digits = get_float16_shortest_digits(format);
+    std::vector<std::vector<uint16_t>> values_by_digits(num_digits + 1);
+    for (uint32_t i = 1; i < num_float16_magnitudes; ++i) {
+      if (shortest_digits[i] != 0)
+        values_by_digits[shortest_digits[i]].push_back(uint16_t(i));
+    }
+    rng r(random_digit_seed);
+    for (int d = 1; d <= num_digits; ++d) {
+      const std::vector<uint16_t>& values = values_by_digits[d];
+      for (int i = 0; i < num_doubles_per_digit; ++i) {
+        uint64_t random = r.next_uint64();
+        uint16_t sign = uint16_t((random >> 63) << 15);
+        result.push_back(sign | values[(random >> 1) % values.size()]);
+      }
+    }
+  }
+  return result.data() + (digit - 1) * num_doubles_per_digit;
+}
+
+#if LDBL_MANT_DIG == 64
+constexpr int max_long_double_digits = 21;
+// long double methods are slower so fewer values are used.
+constexpr int num_long_double_per_digit = 1000;
+constexpr int num_long_double_cases = 10'000;
+
+// Returns a random finite x87 80-bit value with uniformly distributed bits
+// except for the explicit integer bit which is set for normal values.
+auto random_long_double(rng& r) -> long double {
+  for (;;) {
+    uint64_t sig = r.next_uint64();
+    uint16_t sign_exp = uint16_t(r.next_uint64());
+    if ((sign_exp & 0x7fff) == 0x7fff) continue;  // infinity or NaN
+    if ((sign_exp & 0x7fff) != 0)
+      sig |= uint64_t(1) << 63;
+    else
+      sig &= ~(uint64_t(1) << 63);
+    char bytes[sizeof(long double)] = {};
+    memcpy(bytes, &sig, sizeof(sig));
+    memcpy(bytes + sizeof(sig), &sign_exp, sizeof(sign_exp));
+    long double value = 0;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+}
+
+// Verifies that `m` round-trips for boundary cases and random values. strtold
+// is used rather than a binary128 parser since rounding the result of the
+// latter to long double could round twice.
+void verify(const long_double_method& m) {
+  fmt::print("Verifying longdouble {:9} ... ", m.name);
+  fflush(stdout);
+  std::vector<long double> values = {0,       0.1L,     1 / 3.0L,
+                                     LDBL_MIN, LDBL_MAX, LDBL_TRUE_MIN};
+  rng r;
+  for (int i = 0; i < num_long_double_cases; ++i)
+    values.push_back(random_long_double(r));
+
+  size_t total_len = 0, max_len = 0;
+  int num_errors = 0;
+  for (long double value : values) {
+    char buffer[128] = {};
+    m.dtoa(value, buffer);
+    size_t len = strlen(buffer);
+    total_len += len;
+    max_len = std::max(max_len, len);
+    char* end = nullptr;
+    if (strtold(buffer, &end) == value && end == buffer + len) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures) {
+      char expected[64];
+      snprintf(expected, sizeof(expected), "%.21Lg", value);
+      fmt::print("error: {} -> '{}'\n", expected, buffer);
+    }
+  }
+  if (num_errors != 0) return;
+  fmt::print("OK. Length Avg = {:2.3f}, Max = {}\n",
+             double(total_len) / values.size(), max_len);
+}
+
+// Returns `num_long_double_per_digit` random long double values with `digit`
+// significant decimal digits.
+auto get_long_double_digit_data(int digit) -> const long double* {
+  static const std::vector<long double> data = []() {
+    std::vector<long double> result;
+    rng r(random_digit_seed);
+    for (int d = 1; d <= max_long_double_digits; ++d) {
+      for (int i = 0; i < num_long_double_per_digit; ++i) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*Le", d - 1, random_long_double(r));
+        result.push_back(strtold(buffer, nullptr));
+      }
+    }
+    return result;
+  }();
+  return data.data() + (digit - 1) * num_long_double_per_digit;
+}
+#endif  // LDBL_MANT_DIG == 64
+
+#if BENCH_FLOAT128
+constexpr int max_float128_digits = 36;
+// binary128 methods are much slower so fewer values are used.
+constexpr int num_float128_per_digit = 100;
+constexpr int num_float128_cases = 10'000;
+
+// Returns a random finite binary128 value with uniformly distributed bits.
+auto random_float128(rng& r) -> __float128 {
+  for (;;) {
+    unsigned __int128 bits = r.next_uint64();
+    bits = bits << 64 | r.next_uint64();
+    if ((~bits >> 112 & 0x7fff) == 0) continue;  // infinity or NaN
+    __float128 value = 0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+}
+
+// Verifies that `m` round-trips and gives the shortest output for boundary
+// cases and random values.
+void verify(const float128_method& m) {
+  fmt::print("Verifying float128 {:11} ... ", m.name);
+  fflush(stdout);
+  std::vector<__float128> values = {0, 0.1Q, 1 / 3.0Q, FLT128_MIN, FLT128_MAX,
+                                    FLT128_DENORM_MIN};
+  rng r;
+  for (int i = 0; i < num_float128_cases; ++i)
+    values.push_back(random_float128(r));
+
+  size_t total_len = 0, max_len = 0;
+  int num_errors = 0;
+  for (__float128 value : values) {
+    char buffer[128] = {};
+    m.dtoa(value, buffer);
+    size_t len = strlen(buffer);
+    total_len += len;
+    max_len = std::max(max_len, len);
+    char* end = nullptr;
+    __float128 abs_value = fabsq(value);
+    auto format_value = [&](char* buf, size_t size, int precision) {
+      quadmath_snprintf(buf, size, "%.*Qe", precision, abs_value);
+    };
+    auto round_trips = [&](const char* s) {
+      return strtoflt128(s, nullptr) == abs_value;
+    };
+    bool ok = strtoflt128(buffer, &end) == value && end == buffer + len &&
+              is_shortest(count_significant_digits(buffer), format_value,
+                          round_trips);
+    if (ok) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures) {
+      char expected[64];
+      quadmath_snprintf(expected, sizeof(expected), "%.36Qg", value);
+      fmt::print("error: {} -> '{}'\n", expected, buffer);
+    }
+  }
+  if (num_errors != 0) return;
+  fmt::print("OK. Length Avg = {:2.3f}, Max = {}\n",
+             double(total_len) / values.size(), max_len);
+}
+
+// Returns `num_float128_per_digit` random binary128 values with `digit`
+// significant decimal digits.
+auto get_float128_digit_data(int digit) -> const __float128* {
+  static const std::vector<__float128> data = []() {
+    std::vector<__float128> result;
+    rng r(random_digit_seed);
+    for (int d = 1; d <= max_float128_digits; ++d) {
+      for (int i = 0; i < num_float128_per_digit; ++i) {
+        char buffer[64];
+        quadmath_snprintf(buffer, sizeof(buffer), "%.*Qe", d - 1,
+                          random_float128(r));
+        result.push_back(strtoflt128(buffer, nullptr));
+      }
+    }
+    return result;
+  }();
+  return data.data() + (digit - 1) * num_float128_per_digit;
+}
+#endif  // BENCH_FLOAT128
+
+// Generates `num_doubles_per_digit` random values for each digit count from 1
+// to max_digits_of<Float>. Random bits are drawn sequentially to keep the data
+// reproducible while the expensive rounding is done on all cores.
+template <typename Float>
+auto generate_random_digit_data() -> std::vector<Float> {
+  constexpr int num_digits = max_digits_of<Float>;
+  std::vector<Float> data;
+  data.reserve(num_doubles_per_digit * num_digits);
+  rng r(random_digit_seed);
+  for (size_t i = 0; i < num_doubles_per_digit * num_digits; ++i)
+    data.push_back(random_value<Float>(r));
+
+  auto round = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      // Limit the number of digits.
+      int digit = int(i / num_doubles_per_digit) + 1;
+      char buffer[64];
+      snprintf(buffer, sizeof(buffer), "%.*g", digit, double(data[i]));
+      data[i] = from_chars<Float>(buffer).value;
+    }
+  };
+  std::vector<std::thread> threads;
+  size_t num_threads = size_t(num_cpus());
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back(round, data.size() * t / num_threads,
+                         data.size() * (t + 1) / num_threads);
+  }
+  for (std::thread& t : threads) t.join();
+  return data;
+}
+
+// Checks that `m` writes the digits of 17-digit significands without trailing
+// zeros.
+void verify(const digits_method& m) {
+  fmt::print("Verifying digits {:13} ... ", m.name);
+  rng r;
+  int num_errors = 0;
+  uint64_t pow10 = 1;
+  for (int i = 0; i < num_random_cases; ++i) {
+    uint64_t bits = 0;
+    double d = r();
+    memcpy(&bits, &d, sizeof(d));
+    // Zero out a varying number of trailing digits.
+    pow10 = i % max_digits == 0 ? 1 : pow10 * 10;
+    uint64_t sig = (uint64_t(1e16) + bits % uint64_t(9e16)) / pow10 * pow10;
+    std::string expected = fmt::format("{}", sig);
+    expected.erase(expected.find_last_not_of('0') + 1);
+
+    char buffer[256] = {};
+    m.write_digits(sig, buffer);
+    if (buffer == expected) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: expected {} but got {}\n", expected, buffer);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// The number of decimal digits of the largest value of `Int`.
+template <typename Int>
+constexpr int max_integer_digits = std::numeric_limits<Int>::digits10 + 1;
+
+// Returns `num_doubles_per_digit` random nonnegative integers of type `Int`
+// with `digit` decimal digits.
+template <typename Int>
+auto get_random_integers(int digit) -> const std::vector<Int>& {
+  static const std::vector<std::vector<Int>> integers = []() {
+    std::vector<std::vector<Int>> result(max_integer_digits<Int> + 1);
+    rng r;
+    uint64_t pow10 = 1;
+    for (int digit = 1; digit <= max_integer_digits<Int>; ++digit) {
+      uint64_t min = digit == 1 ? 0 : pow10;
+      pow10 *= 10;
+      uint64_t max =
+          std::min(pow10 - 1, uint64_t(std::numeric_limits<Int>::max()));
+      for (int i = 0; i < num_doubles_per_digit; ++i)
+        result[digit].push_back(Int(min + r.next_uint64() % (max - min + 1)));
+    }
+    return result;
+  }();
+  return integers[digit];
+}
+
+// Checks the output of `itoa` against std::to_chars for random values of
+// every digit count with both signs and the limits of `Int`. Returns the
+// number of errors.
+template <typename Int, typename Itoa>
+auto verify_itoa(Itoa itoa) -> int {
+  std::vector<Int> values = {0, -1, std::numeric_limits<Int>::min(),
+                             std::numeric_limits<Int>::max()};
+  for (int digit = 1; digit <= max_integer_digits<Int>; ++digit) {
+    const std::vector<Int>& integers = get_random_integers<Int>(digit);
+    for (int i = 0; i < 1000; ++i) {
+      values.push_back(integers[i]);
+      values.push_back(Int(-integers[i]));
+    }
+  }
+  int num_errors = 0;
+  for (Int value : values) {
+    char expected[32], buffer[32] = {};
+    std::string_view expected_str(
+        expected, std::to_chars(expected, expected + sizeof(expected), value)
+                          .ptr -
+                      expected);
+    std::string_view actual(buffer, itoa(value, buffer) - buffer);
+    if (actual == expected_str) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: expected {} but got {}\n", expected_str, actual);
+  }
+  return num_errors;
+}
+
+void verify(const itoa_method& m) {
+  fmt::print("Verifying itoa {:15} ... ", m.name);
+  if (verify_itoa<int32_t>(m.itoa32) + verify_itoa<int64_t>(m.itoa64) == 0)
+    fmt::print("OK\n");
+}
+
+// Returns the shortest decimal representation of the absolute value of a
+// finite nonzero `value` without trailing zeros.
+template <typename Float> auto to_decimal_fp(Float value) -> decimal_fp {
+  char buffer[64];
+  *fmt::format_to(buffer, "{}", std::abs(value)) = '\0';
+  decimal_fp dec = {0, 0};
+  bool fraction = false;
+  for (const char* p = buffer; *p; ++p) {
+    if (*p == '.') {
+      fraction = true;
+    } else if (*p == 'e') {
+      dec.exp += atoi(p + 1);
+      break;
+    } else {
+      dec.sig = dec.sig * 10 + uint64_t(*p - '0');
+      dec.exp -= fraction;
+    }
+  }
+  for (; dec.sig != 0 && dec.sig % 10 == 0; dec.sig /= 10) ++dec.exp;
+  return dec;
+}
+
+// Checks that `m` produces the shortest decimal representation.
+template <typename Float, typename Method>
+void verify_decimal(const Method& m) {
+  int num_errors = 0;
+  for (Float value : get_random_cases<Float>()) {
+    if (value == 0 || !std::isfinite(value)) continue;
+    decimal_fp expected = to_decimal_fp(value);
+    decimal_fp dec = m.to_decimal(value);
+    while (dec.sig != 0 && dec.sig % 10 == 0) {
+      dec.sig /= 10;
+      ++dec.exp;
+    }
+    if (dec.sig == expected.sig && dec.exp == expected.exp) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: {} -> {}e{}, expected {}e{}\n", value, dec.sig, dec.exp,
+               expected.sig, expected.exp);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+void verify(const decimal_method& m) {
+  fmt::print("Verifying decimal {:12} ... ", m.name);
+  verify_decimal<double>(m);
+}
+
+void verify(const float_decimal_method& m) {
+  fmt::print("Verifying float decimal {:6} ... ", m.name);
+  verify_decimal<float>(m);
+}
+
+// Checks that the output of `m` round-trips.
+void verify(const format_method& m) {
+  fmt::print("Verifying format {:13} ... ", m.name);
+  int num_errors = 0;
+  for (double value : get_random_cases()) {
+    if (value == 0 || !std::isfinite(value)) continue;
+    char buffer[256] = {};
+    m.format(to_decimal_fp(value), buffer);
+    auto [roundtrip, count] = from_chars(buffer);
+    if (roundtrip == std::abs(value) && buffer[count] == '\0') continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: {} -> '{}'\n", value, buffer);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// The maximum number of digits of a decimal64 coefficient.
+constexpr int max_decimal64_digits = 16;
+
+// Encodes sig * 10**exp with `sig` < 10**16 and `exp` in [-398, 369] as a
+// decimal64 in the BID encoding.
+auto to_decimal64(bool negative, uint64_t sig, int exp) -> uint64_t {
+  uint64_t bits = uint64_t(negative) << 63;
+  uint64_t biased_exp = uint64_t(exp + 398);
+  if (sig < (uint64_t(1) << 53)) return bits | biased_exp << 53 | sig;
+  // Large coefficients start with 0b100 which is implied by the 11 prefix.
+  return bits | uint64_t(3) << 61 | biased_exp << 51 |
+         (sig & ((uint64_t(1) << 51) - 1));
+}
+
+// Checks that `m` writes the random cases with up to 16 digits and special
+// encodings with their decimal values.
+void verify(const decimal64_method& m) {
+  fmt::print("Verifying decimal64 {:10} ... ", m.name);
+  int num_errors = 0;
+  // Compare as long double which has the range of decimal64 on x86.
+  auto check = [&](uint64_t bits, const char* expected) {
+    char buffer[256] = {};
+    m.format(bits, buffer);
+    long double value = strtold(buffer, nullptr);
+    long double expected_value = strtold(expected, nullptr);
+    if (std::isnan(value) ? std::isnan(expected_value)
+                          : value == expected_value &&
+                                std::signbit(value) ==
+                                    std::signbit(expected_value)) {
+      return;
+    }
+    if (num_errors++ == 0) fmt::print("\n");
+    fmt::print("error: {:016x} -> '{}', expected {}\n", bits, buffer,
+               expected);
+  };
+  for (double value : get_random_cases()) {
+    if (value == 0 || !std::isfinite(value)) continue;
+    decimal_fp dec = to_decimal_fp(value);
+    if (dec.sig >= uint64_t(1e16)) continue;
+    bool negative = std::signbit(value);
+    std::string expected =
+        fmt::format("{}{}e{}", negative ? "-" : "", dec.sig, dec.exp);
+    check(to_decimal64(negative, dec.sig, dec.exp), expected.c_str());
+  }
+  struct test_case {
+    uint64_t bits;
+    const char* expected;
+  };
+  const test_case special_cases[] = {
+      {to_decimal64(false, 0, 0), "0"},
+      {to_decimal64(true, 0, -398), "-0"},
+      {to_decimal64(false, 1, -398), "1e-398"},
+      {to_decimal64(false, 12500, -2), "125"},
+      {to_decimal64(true, 9999999999999999, 369), "-9999999999999999e369"},
+      {to_decimal64(false, uint64_t(1) << 53, 0), "9007199254740992"},
+      // A noncanonical coefficient above 10**16 - 1 which is zero.
+      {uint64_t(3) << 61 | uint64_t(398) << 51 | ((uint64_t(1) << 51) - 1),
+       "0"},
+      {0x7800000000000000, "inf"},
+      {0xf800000000000000, "-inf"},
+      {0x7c00000000000000, "nan"},
+  };
+  for (const test_case& c : special_cases) check(c.bits, c.expected);
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Returns `num_doubles_per_digit` random values of both signs with uniformly
+// distributed significands and magnitudes in [1e-3, 1e9), a range where
+// fixed-precision output stays short like in reports.
+auto get_precision_data() -> const std::vector<double>& {
+  static const std::vector<double> data = []() {
+    std::vector<double> result;
+    rng r(random_digit_seed);
+    for (int i = 0; i < num_doubles_per_digit; ++i) {
+      double sig = 1 + double(r.next_uint64() >> 11) * 0x1p-53 * 9;
+      int exp = int(r.next_uint64() % 12) - 3;
+      double value = sig * pow(10, exp);
+      result.push_back(r.next_uint64() & 1 ? -value : value);
+    }
+    return result;
+  }();
+  return data;
+}
+
+// Removes the exponent sign and leading zeros from the exponent of printf
+// output so that e.g. "1.5e+05" and "1.5e5" compare equal.
+auto normalize_exponent(const char* s) -> std::string {
+  std::string result = s;
+  size_t e = result.find('e');
+  if (e == std::string::npos) return result;
+  size_t start = e + 1;
+  if (start < result.size() && result[start] == '+') result.erase(start, 1);
+  if (start < result.size() && result[start] == '-') ++start;
+  while (start + 1 < result.size() && result[start] == '0')
+    result.erase(start, 1);
+  return result;
+}
+
+// Checks that `m` produces the same output as printf modulo the exponent
+// format. Differences are reported as warnings since some methods don't round
+// correctly.
+void verify(const precision_method& m) {
+  fmt::print("Verifying precision {:10} ... ", m.name);
+  const char* spec = "%.*f";
+  if (m.format == fixed_precision_format::exponent) spec = "%.*e";
+  if (m.format == fixed_precision_format::general) spec = "%.*g";
+  int num_warnings = 0;
+  for (int precision : precisions) {
+    if (precision > m.max_precision) break;
+    for (double value : get_precision_data()) {
+      char expected[dtoa_buffer_size];
+      snprintf(expected, sizeof(expected), spec, precision, value);
+      char buffer[dtoa_buffer_size] = {};
+      m.format_fun(value, precision, buffer);
+      if (normalize_exponent(buffer) == normalize_exponent(expected)) continue;
+      if (num_warnings++ == 0) fmt::print("\n");
+      if (num_warnings <= max_reported_failures)
+        fmt::print("warning: expected {} but got {}\n", expected, buffer);
+    }
+  }
+  if (num_warnings == 0)
+    fmt::print("OK\n");
+  else
+    fmt::print("warning: {} outputs differ from printf\n", num_warnings);
+}
+
+// Checks that bounded writes at each size of the sweep are prefixes of the
+// full output which parses back to the original value, that the full size is
+// returned and that nothing is written past the end.
+void verify(const bounded_method& m) {
+  fmt::print("Verifying bounded {:12} ... ", m.name);
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  constexpr char canary = '\x55';
+  int num_errors = 0;
+  for (double value : values) {
+    char full[dtoa_buffer_size] = {};
+    size_t size = m.write(value, full, sizeof(full) - 1);
+    bool ok = strtod(full, nullptr) == value;
+    for (size_t n : bounded_sizes) {
+      char buffer[dtoa_buffer_size];
+      memset(buffer, canary, sizeof(buffer));
+      ok &= m.write(value, buffer, n) == size;
+      size_t prefix_size = std::min(n, size);
+      ok &= memcmp(buffer, full, prefix_size - 1) == 0;
+      char last = buffer[prefix_size - 1];
+      ok &= last == full[prefix_size - 1] || (n <= size && last == '\0');
+      ok &= std::all_of(buffer + n, buffer + sizeof(buffer),
+                        [](char c) { return c == canary; });
+    }
+    if (ok) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: {} -> '{}'\n", value, full);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Checks that the UTF-16 output of a wide method is ASCII and parses back to
+// the original value.
+void verify(const wide_method& m) {
+  fmt::print("Verifying wide {:15} ... ", m.name);
+  std::vector<double> values;
+  for (auto c : cases<double>) values.push_back(c.value);
+  std::vector<double> random_cases = get_random_cases();
+  values.insert(values.end(), random_cases.begin(), random_cases.end());
+
+  int num_errors = 0;
+  for (double value : values) {
+    char16_t wide[dtoa_buffer_size] = {};
+    char16_t* end = m.dtoa(value, wide);
+    char narrow[dtoa_buffer_size] = {};
+    bool ok = end > wide && end - wide < dtoa_buffer_size;
+    for (char16_t* p = wide; ok && p != end; ++p) {
+      ok = *p < 0x80;
+      narrow[p - wide] = char(*p);
+    }
+    if (ok && strtod(narrow, nullptr) == value) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: {} -> '{}'\n", value, narrow);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Returns `num_doubles_per_digit` random values with `digit` significant
+// decimal digits.
+template <typename Float = double>
+auto get_random_digit_data(int digit) -> const Float* {
+  static std::vector<Float> values;
+  static const Float* random_digit_data = load_cached_data<Float>(
+      values, "random-digit", random_digit_data_version,
+      num_doubles_per_digit * max_digits_of<Float>,
+      generate_random_digit_data<Float>);
+  return random_digit_data + (digit - 1) * num_doubles_per_digit;
+}
+
+// Synthetic datasets of values common in real data, benchmarked as separate
+// types. Each has `num_doubles_per_digit` values.
+struct dataset {
+  const char* name;
+  int version;  // Bump when the generation changes to invalidate caches.
+  auto (*generate)() -> std::vector<double>;
+};
+
+// Calls `f(r)` `num_doubles_per_digit` times and returns the results.
+template <typename F> auto generate_values(F f) -> std::vector<double> {
+  std::vector<double> result;
+  result.reserve(num_doubles_per_digit);
+  rng r(random_digit_seed);
+  for (int i = 0; i < num_doubles_per_digit; ++i) result.push_back(f(r));
+  return result;
+}
+
+// Returns a random number in [0, 1).
+auto random_unit(rng& r) -> double {
+  return double(r.next_uint64() >> 11) * 0x1p-53;
+}
+
+constexpr dataset datasets[] = {
+    // Integers below 2**53 with uniformly distributed bit lengths, e.g.
+    // counters.
+    {"integers", 1,
+     []() {
+       return generate_values([](rng& r) {
+         uint64_t bits = r.next_uint64();
+         return double((bits >> 11) >> (bits % 53));
+       });
+     }},
+    // Prices with two decimals in [0.01, 1e6] with log-uniform magnitudes.
+    {"prices", 1,
+     []() {
+       return generate_values([](rng& r) {
+         double cents = floor(pow(10, random_unit(r) * 8));
+         return cents / 100;
+       });
+     }},
+    // Random significands with binary exponents uniform in [-64, 64), i.e.
+    // magnitudes from 5e-20 to 2e19 where most measurements lie, unlike the
+    // full range of random bits.
+    {"uniform-exponent", 1,
+     []() {
+       return generate_values([](rng& r) {
+         double sig = 1 + random_unit(r);
+         return ldexp(sig, int(r.next_uint64() % 128) - 64);
+       });
+     }},
+    {"subnormal", 1,
+     []() {
+       return generate_values([](rng& r) {
+         uint64_t bits = r.next_uint64() & ((uint64_t(1) << 52) - 1);
+         double value = 0;
+         memcpy(&value, &bits, sizeof(value));
+         return value;
+       });
+     }},
+    // Powers of 10 from 1e-307 to 1e308 rounded to nearest.
+    {"powers-of-ten", 1,
+     []() {
+       return generate_values([](rng& r) {
+         char buffer[16];
+         snprintf(buffer, sizeof(buffer), "1e%d",
+                  int(r.next_uint64() % 616) - 307);
+         return strtod(buffer, nullptr);
+       });
+     }},
+    // Inputs known to hit the rare branches of the algorithms, e.g. zmij's
+    // fallback to Schubfach, Ryu's trailing zero removal, Dragonbox's
+    // is_product_integer checks and Grisu's rejections, to measure the worst
+    // case throughput. A quarter each of
+    // * powers of 2 with asymmetric rounding intervals,
+    // * subnormals with the smallest significands,
+    // * neighbors of decimals with 1-3 digits whose shortest representations
+    //   are long and close to a boundary of the rounding interval,
+    // * odd significands times 2**-2 with exact decimal expansions of 18
+    //   digits ending in 5, i.e. ties when rounded to 17 digits, and times
+    //   2**2 or 2**3, integers whose rounding intervals often end near a
+    //   multiple of 10.
+    {"boundary", 1,
+     []() {
+       return generate_values([](rng& r) {
+         // The low bits of rng are weak so select by the high ones.
+         switch (r.next_uint64() >> 62) {
+           case 0:
+             return ldexp(1, int(random_unit(r) * 2098) - 1074);
+           case 1:
+             return ldexp(int(random_unit(r) * 1024) + 1, -1074);
+           case 2: {
+             char buffer[24];  // Fits two ints and the e.
+             snprintf(buffer, sizeof(buffer), "%de%d",
+                      int(random_unit(r) * 999) + 1,
+                      int(random_unit(r) * 601) - 300);
+             double value = strtod(buffer, nullptr);
+             return nextafter(value, random_unit(r) < 0.5 ? 0 : HUGE_VAL);
+           }
+           default: {
+             uint64_t sig = (r.next_uint64() >> 12) | (uint64_t(1) << 52) | 1;
+             int exp = random_unit(r) < 0.5 ? -2 : 2 + int(random_unit(r) * 2);
+             return ldexp(double(sig), exp);
+           }
+         }
+       });
+     }},
+};
+
+constexpr int num_datasets = int(std::size(datasets));
+
+// Returns the values of the dataset with index `index`.
+auto get_dataset(int index) -> std::span<const double> {
+  static std::vector<double> values[num_datasets];
+  static const double* data[num_datasets] = {};
+  const dataset& d = datasets[index];
+  if (!data[index]) {
+    data[index] = load_cached_data<double>(values[index], d.name, d.version,
+                                           num_doubles_per_digit, d.generate);
+  }
+  return {data[index], num_doubles_per_digit};
+}
+
+constexpr int num_doubles_per_exponent_bucket = 10'000;
+
+// Returns `num_doubles_per_exponent_bucket` random values with binary
+// exponents in the exponent bucket `bucket` in [1, num_exponent_buckets],
+// i.e. in [2**e, 2**(e + exponent_bucket_size)) where
+// e = min_bin_exp + (bucket - 1) * exponent_bucket_size. Subnormals are
+// bucketed by the position of their leading bit.
+auto get_exponent_data(int bucket) -> const double* {
+  static std::vector<double> values;
+  static const double* data = load_cached_data<double>(
+      values, "binary-exponent", 1,
+      num_exponent_buckets * num_doubles_per_exponent_bucket, []() {
+        std::vector<double> result;
+        result.reserve(num_exponent_buckets * num_doubles_per_exponent_bucket);
+        rng r(random_digit_seed);
+        for (int b = 0; b < num_exponent_buckets; ++b) {
+          int first_exp = min_bin_exp + b * exponent_bucket_size;
+          int num_exps =
+              std::min(exponent_bucket_size, max_bin_exp - first_exp + 1);
+          for (int i = 0; i < num_doubles_per_exponent_bucket; ++i) {
+            // The low bits of rng are weak so select by the high ones.
+            int exp = first_exp + int((r.next_uint64() >> 32) % num_exps);
+            result.push_back(ldexp(1 + random_unit(r), exp));
+          }
+        }
+        return result;
+      });
+  return data + (bucket - 1) * num_doubles_per_exponent_bucket;
+}
+
+// Orders of the random digit data in the order benchmark. Table-driven methods
+// index tables of powers of 10 by exponent, so sorted data, e.g. time series,
+// hits the same or nearby entries while shuffled data scatters across them.
+enum class data_order { shuffled, exponent, value, nearly_sorted, count };
+
+const char* data_order_names[] = {"shuffled", "exponent-sorted",
+                                  "value-sorted", "nearly-sorted"};
+
+// The maximum distance an element of the nearly sorted data is moved from its
+// sorted position.
+constexpr int nearly_sorted_window = 16;
+
+// Returns the random digit values with `digit` significant digits in `order`.
+// All orders are copies of the same values so that they only differ in order.
+auto get_ordered_data(data_order order, int digit) -> const double* {
+  static std::vector<double> data[size_t(data_order::count)];
+  std::vector<double>& ordered = data[size_t(order)];
+  if (ordered.empty()) {
+    ordered.reserve(num_doubles_per_digit * max_digits);
+    rng r(random_digit_seed);
+    for (int d = 1; d <= max_digits; ++d) {
+      const double* values = get_random_digit_data<double>(d);
+      auto first = ordered.end();
+      ordered.insert(first, values, values + num_doubles_per_digit);
+      first = ordered.end() - num_doubles_per_digit;
+      switch (order) {
+      case data_order::shuffled:
+        std::shuffle(first, ordered.end(), std::mt19937(random_digit_seed));
+        break;
+      case data_order::exponent:
+        // Keep the random order of values with the same binary exponent.
+        std::stable_sort(first, ordered.end(), [](double lhs, double rhs) {
+          return ilogb(lhs) < ilogb(rhs);
+        });
+        break;
+      case data_order::value:
+      case data_order::nearly_sorted:
+        std::sort(first, ordered.end());
+        if (order == data_order::value) break;
+        // Swap each value with one of the next nearly_sorted_window ones.
+        for (auto it = first; it != ordered.end(); ++it) {
+          uint64_t max_distance = uint64_t(std::min<ptrdiff_t>(
+              nearly_sorted_window, ordered.end() - it - 1));
+          // The low bits of rng are weak so select by the high ones.
+          uint64_t distance = (r.next_uint64() >> 32) % (max_distance + 1);
+          std::iter_swap(it, it + ptrdiff_t(distance));
+        }
+        break;
+      case data_order::count:
+        break;
+      }
+    }
+  }
+  return ordered.data() + (digit - 1) * num_doubles_per_digit;
+}
+
+// Returns true if all `values` are in the range of `m`.
+auto in_range(const range_method& m, std::span<const double> values) -> bool {
+  return std::all_of(values.begin(), values.end(),
+                     [&](double v) { return v >= m.min && v <= m.max; });
+}
+
+// Checks that `m` gives shortest round-tripping output on the datasets in its
+// range.
+void verify(const range_method& m) {
+  fmt::print("Verifying range {:14} ... ", m.name);
+  // Range methods write the scientific notation like zmij.
+  method_info info = {.notation = output_notation::scientific};
+  verifier<double> v(&info);
+  int num_datasets_in_range = 0;
+  size_t total_len = 0, max_len = 0;
+  for (int i = 0; i < num_datasets; ++i) {
+    std::span<const double> data = get_dataset(i);
+    if (!in_range(m, data)) continue;
+    ++num_datasets_in_range;
+    for (double value : data) {
+      char buffer[dtoa_buffer_size] = {};
+      *m.dtoa(value, buffer) = '\0';
+      char expected[dtoa_buffer_size] = {};
+      fmt::format_to(expected, "{}", value);
+      size_t len = v.verify(value, buffer, expected);
+      total_len += len;
+      max_len = std::max(max_len, len);
+    }
+  }
+  if (num_datasets_in_range == 0) {
+    fmt::print("warning: no dataset in [{}, {}]\n", m.min, m.max);
+    return;
+  }
+  size_t num_values = size_t(num_datasets_in_range) * num_doubles_per_digit;
+  fmt::print("OK. {} datasets, Length Avg = {:2.3f}, Max = {}\n",
+             num_datasets_in_range, double(total_len) / num_values, max_len);
+}
+
+// Returns the shortest representations of the random digit data for `digit`,
+// each stored as a one-byte length followed by the characters and a NUL.
+auto get_random_digit_strings(int digit) -> const std::vector<char>& {
+  static const std::vector<std::vector<char>> random_digit_strings = []() {
+    std::vector<std::vector<char>> result(max_digits + 1);
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      std::vector<char>& strings = result[digit];
+      const double* data = get_random_digit_data<double>(digit);
+      for (int i = 0; i < num_doubles_per_digit; ++i) {
+        char buffer[64];
+        char* end = fmt::format_to(buffer, "{}", data[i]);
+        strings.push_back(char(end - buffer));
+        strings.insert(strings.end(), buffer, end);
+        strings.push_back('\0');
+      }
+    }
+    return result;
+  }();
+  return random_digit_strings[digit];
+}
+
+// Returns the shortest decimal representations of the random digit data for
+// `digit`.
+auto get_random_digit_decimals(int digit) -> const std::vector<decimal_fp>& {
+  static const std::vector<std::vector<decimal_fp>> decimals = []() {
+    std::vector<std::vector<decimal_fp>> result(max_digits + 1);
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      for (int i = 0; i < num_doubles_per_digit; ++i)
+        result[digit].push_back(to_decimal_fp(data[i]));
+    }
+    return result;
+  }();
+  return decimals[digit];
+}
+
+// Returns the shortest decimal significands of the random digit data for
+// `digit`, padded with trailing zeros to 17 digits.
+auto get_random_digit_significands(int digit) -> const std::vector<uint64_t>& {
+  static const std::vector<std::vector<uint64_t>> significands = []() {
+    std::vector<std::vector<uint64_t>> result(max_digits + 1);
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      for (decimal_fp dec : get_random_digit_decimals(digit)) {
+        while (dec.sig < uint64_t(1e16)) dec.sig *= 10;
+        result[digit].push_back(dec.sig);
+      }
+    }
+    return result;
+  }();
+  return significands[digit];
+}
+
+// The number of distinct values that repeat in the memoization benchmark,
+// e.g. 0, 1, 100 and the last values of gauges.
+constexpr int num_repeated_values = 64;
+
+// The number of entries of the memoization caches, 32 KB like a typical L1
+// data cache.
+constexpr size_t memoize_cache_size = 1024;
+
+// Returns `num_doubles_per_digit` values of which `rate` percent are drawn
+// from a small set of repeated values and the rest from the random digit data
+// where repeats are rare.
+auto get_repeat_data(int rate) -> std::vector<double> {
+  std::vector<double> repeated = {0, 1, 100};
+  for (int i = int(repeated.size()); i < num_repeated_values; ++i)
+    repeated.push_back(get_random_digit_data<double>(i % max_digits + 1)[i]);
+  std::vector<double> result;
+  result.reserve(num_doubles_per_digit);
+  rng r(random_digit_seed);
+  for (int i = 0; i < num_doubles_per_digit; ++i) {
+    uint64_t random = r.next_uint64();
+    if (int(random % 100) < rate) {
+      result.push_back(repeated[(random >> 32) % num_repeated_values]);
+    } else {
+      // Skip the repeated values.
+      result.push_back(get_random_digit_data<double>(
+          i % max_digits + 1)[num_repeated_values + i / max_digits]);
+    }
+  }
+  return result;
+}
+
+// Kinds of special values mixed into the random digit data in the mixed
+// benchmark.
+enum special_kind {
+  special_zero,
+  special_integer,
+  special_subnormal,
+  num_special_kinds
+};
+
+constexpr const char* special_kind_names[] = {"zero", "integer", "subnormal"};
+
+// Returns `num_doubles_per_digit` values drawn from all digit buckets in
+// random order with `weights[kind]` percent of special values of each kind.
+// Mixing defeats the branch prediction of digit count and exponent dependent
+// branches that each bucket on its own trains.
+auto get_mixed_data(const double (&weights)[num_special_kinds])
+    -> std::vector<double> {
+  std::vector<double> result;
+  result.reserve(num_doubles_per_digit);
+  rng r(random_digit_seed);
+  for (int i = 0; i < num_doubles_per_digit; ++i) {
+    double percent = double(r.next_uint64() >> 11) * 0x1p-53 * 100;
+    uint64_t random = r.next_uint64();
+    int kind = 0;
+    for (; kind < num_special_kinds; ++kind) {
+      if (percent < weights[kind]) break;
+      percent -= weights[kind];
+    }
+    double sign = random >> 63 ? -1 : 1;
+    double value = 0;
+    switch (kind) {
+      case special_zero:
+        value = sign * 0.0;
+        break;
+      case special_integer:
+        // Integers below 2**53 with uniformly distributed bit lengths.
+        value = sign * double((random << 1) >> (11 + random % 53));
+        break;
+      case special_subnormal: {
+        uint64_t bits = (random >> 1) & ((uint64_t(1) << 52) - 1);
+        memcpy(&value, &bits, sizeof(value));
+        value *= sign;
+        break;
+      }
+      default:
+        value = get_random_digit_data(int(random % max_digits) + 1)
+            [(random >> 32) % num_doubles_per_digit];
+    }
+    result.push_back(value);
+  }
+  return result;
+}
+
+using duration = std::chrono::steady_clock::duration;
+
+// Hardware counters measured around timed loops if enabled with --perf.
+perf_counters* counters = nullptr;
+
+struct digit_result {
+  double duration_ns = std::numeric_limits<double>::min();
+  // Hardware counter values per conversion.
+  double perf[num_perf_events] = {};
+  // The estimated core frequency before the trials or, when interleaved,
+  // during the fastest one.
+  double ghz = 0;
+  // The time per conversion in every trial, written to the samples file.
+  std::vector<double> trial_ns;
+};
+
+struct benchmark_result {
+  double min_ns = std::numeric_limits<double>::max();
+  double max_ns = std::numeric_limits<double>::min();
+  int num_digits = max_digits;
+  digit_result per_digit[max_bench_digits + 1];
+};
+
+// Estimates the core frequency in GHz from the time of a chain of dependent
+// additions, one per cycle on common cores. The absolute value is approximate
+// but changes between trials show throttling and turbo decay.
+auto estimate_ghz() -> double {
+  constexpr int num_additions = 100'000;
+  uint64_t x = 0;
+  uint64_t start = read_cycle_counter();
+  for (int i = 0; i < num_additions; ++i) {
+    x += uint64_t(i);
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+r"(x));  // Prevent folding and vectorization.
+#endif
+  }
+  uint64_t ticks = read_cycle_counter() - start;
+  volatile uint64_t sink = x;
+  (void)sink;
+  return num_additions * ticks_per_ns() / double(ticks);
+}
+
+// Runs `convert(digit)`, which converts all `num_values` values in a digit
+// bucket, for every bucket and records the smallest time per value among
+// `num_trials` trials. If `convert` returns cycle counter ticks, they are used
+// instead of the time of the whole call, e.g. to exclude untimed work.
+template <typename F>
+auto bench_digits(int num_trials, int num_digits, F convert,
+                  int num_values = num_doubles_per_digit) -> benchmark_result {
+  int num_iterations_per_digit = num_trials;
+
+  benchmark_result result;
+  result.num_digits = num_digits;
+  for (int digit = 1; digit <= num_digits; ++digit) {
+    result.per_digit[digit].ghz = estimate_ghz();
+
+    // Time with the cycle counter which has lower overhead and better
+    // resolution than steady_clock where available.
+    uint64_t run_ticks = std::numeric_limits<uint64_t>::max();
+    perf_counts run_counts;
+    std::vector<uint64_t> trial_ticks;
+    for (int trial = 0; trial < num_trials; ++trial) {
+      if (counters) counters->start();
+      uint64_t ticks = 0;
+      if constexpr (std::is_same_v<decltype(convert(digit)), uint64_t>) {
+        for (int iter = 0; iter < num_iterations_per_digit; ++iter)
+          ticks += convert(digit);
+      } else {
+        uint64_t start = read_cycle_counter();
+        for (int iter = 0; iter < num_iterations_per_digit; ++iter)
+          convert(digit);
+        ticks = read_cycle_counter() - start;
+      }
+      perf_counts counts = counters ? counters->stop() : perf_counts();
+      trial_ticks.push_back(ticks);
+
+      // Pick the smallest of trial runs.
+      if (ticks < run_ticks) {
+        run_ticks = ticks;
+        run_counts = counts;
+      }
+    }
+
+    double num_conversions = double(num_iterations_per_digit) * num_values;
+    double ns = double(run_ticks) / ticks_per_ns() / num_conversions;
+
+    result.per_digit[digit].duration_ns = ns;
+    for (uint64_t ticks : trial_ticks) {
+      result.per_digit[digit].trial_ns.push_back(double(ticks) /
+                                                 ticks_per_ns() /
+                                                 num_conversions);
+    }
+    for (int e = 0; e < num_perf_events; ++e)
+      result.per_digit[digit].perf[e] = run_counts.values[e] / num_conversions;
+    if (ns < result.min_ns) result.min_ns = ns;
+    if (ns > result.max_ns) result.max_ns = ns;
+  }
+  return result;
+}
+
+// Subtracts the per-digit harness overhead, i.e. the loop and indirect call
+// cost measured by running the null method through the same loop.
+auto subtract_overhead(const benchmark_result& result,
+                       const benchmark_result& overhead) -> benchmark_result {
+  benchmark_result corrected;
+  corrected.num_digits = result.num_digits;
+  for (int digit = 1; digit <= result.num_digits; ++digit) {
+    const digit_result& raw = result.per_digit[digit];
+    const digit_result& base = overhead.per_digit[digit];
+    digit_result& r = corrected.per_digit[digit];
+    r.duration_ns = std::max(raw.duration_ns - base.duration_ns, 0.0);
+    for (int e = 0; e < num_perf_events; ++e)
+      r.perf[e] = std::max(raw.perf[e] - base.perf[e], 0.0);
+    corrected.min_ns = std::min(corrected.min_ns, r.duration_ns);
+    corrected.max_ns = std::max(corrected.max_ns, r.duration_ns);
+  }
+  return corrected;
+}
+
+template <typename Dtoa>
+auto bench_random_digit(Dtoa dtoa, const std::string& name, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+  });
+}
+
+// Converts the values of each binary exponent bucket.
+template <typename Dtoa>
+auto bench_exponent(Dtoa dtoa, int num_trials) -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_exponent_data(1);  // Generate outside of the timed loop.
+  return bench_digits(
+      num_trials, num_exponent_buckets,
+      [&](int bucket) {
+        const double* data = get_exponent_data(bucket);
+        for (int i = 0; i < num_doubles_per_exponent_bucket; ++i)
+          dtoa(data[i], buffer);
+      },
+      num_doubles_per_exponent_bucket);
+}
+
+// Runs the random digit benchmark on the values of each digit count in `order`.
+template <typename Dtoa>
+auto bench_ordered(Dtoa dtoa, data_order order, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_ordered_data(order, 1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_ordered_data(order, digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+  });
+}
+
+// Runs the random digit benchmark with the conversion inlined into `loop`
+// which is called once per digit bucket.
+auto bench_random_digit_inline(inline_loop_fun loop, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    loop(get_random_digit_data<double>(digit), num_doubles_per_digit, buffer);
+  });
+}
+
+// Runs the random digit benchmark of all `methods` with the trials of every
+// method and digit count interleaved in a random order. Thermal throttling and
+// turbo decay then affect all methods alike instead of the ones run last. The
+// trials are the same as in bench_digits and the core frequency is estimated
+// before each one.
+auto bench_random_digit_interleaved(const std::vector<method>& methods,
+                                    int num_trials)
+    -> std::vector<benchmark_result> {
+  struct trial {
+    size_t method_index;
+    int digit;
+  };
+  std::vector<trial> trials;
+  for (size_t i = 0; i < methods.size(); ++i) {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      for (int t = 0; t < num_trials; ++t) trials.push_back({i, digit});
+    }
+  }
+  // A fixed seed makes the order reproducible.
+  std::shuffle(trials.begin(), trials.end(), std::mt19937(random_digit_seed));
+
+  for (int digit = 1; digit <= max_digits; ++digit)
+    get_random_digit_data<double>(digit);
+
+  std::vector<benchmark_result> results(methods.size());
+  std::vector<std::vector<uint64_t>> min_ticks(
+      methods.size(), std::vector<uint64_t>(max_digits + 1, UINT64_MAX));
+  char buffer[dtoa_buffer_size] = {};
+  double min_ghz = std::numeric_limits<double>::max(), max_ghz = 0;
+  for (size_t i = 0; i < trials.size(); ++i) {
+    if (i % (trials.size() / 100 + 1) == 0) {
+      fmt::print("\rBenchmarking randomdigit interleaved ... {:3}%",
+                 i * 100 / trials.size());
+      fflush(stdout);
+    }
+    const trial& t = trials[i];
+    double ghz = estimate_ghz();
+    min_ghz = std::min(min_ghz, ghz);
+    max_ghz = std::max(max_ghz, ghz);
+    const double* data = get_random_digit_data(t.digit);
+    if (counters) counters->start();
+    uint64_t ticks = methods[t.method_index].visit([&](auto dtoa) {
+      uint64_t start = read_cycle_counter();
+      for (int iter = 0; iter < num_trials; ++iter) {
+        for (int j = 0; j < num_doubles_per_digit; ++j) dtoa(data[j], buffer);
+      }
+      return read_cycle_counter() - start;
+    });
+    perf_counts counts = counters ? counters->stop() : perf_counts();
+    if (ticks >= min_ticks[t.method_index][t.digit]) continue;
+    min_ticks[t.method_index][t.digit] = ticks;
+    double num_conversions = double(num_trials) * num_doubles_per_digit;
+    digit_result& r = results[t.method_index].per_digit[t.digit];
+    r.duration_ns = double(ticks) / ticks_per_ns() / num_conversions;
+    for (int e = 0; e < num_perf_events; ++e)
+      r.perf[e] = counts.values[e] / num_conversions;
+    r.ghz = ghz;
+  }
+  for (benchmark_result& result : results) {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      double ns = result.per_digit[digit].duration_ns;
+      result.min_ns = std::min(result.min_ns, ns);
+      result.max_ns = std::max(result.max_ns, ns);
+    }
+  }
+  fmt::print("\rBenchmarking randomdigit interleaved ... {} trials, "
+             "{:.2f}-{:.2f} GHz\n",
+             trials.size(), min_ghz, max_ghz);
+  return results;
+}
+
+// Converts each digit bucket with every input depending on the previous
+// output so that conversions cannot overlap and the time per value is the
+// latency of a conversion rather than the throughput. The dependency goes
+// through the end of the output and its last byte, which is written last and
+// always ASCII so the input index doesn't change, but the compiler and CPU
+// cannot know that. The first byte wouldn't do because it is often a sign
+// stored before the rest of the conversion.
+template <typename Dtoa>
+auto bench_chain(Dtoa dtoa, int num_trials) -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    size_t dep = 0;
+    for (int i = 0; i < num_doubles_per_digit; ++i) {
+      char* end = write_value(dtoa, data[i + dep], buffer);
+      dep = static_cast<unsigned char>(end[-1]) >> 7;
+    }
+  });
+}
+
+// The number of values per digit count whose canonical output is compared to
+// that of the reference method in the normalized benchmark.
+constexpr int num_normalize_checked = 1000;
+
+// Converts every random digit value with `dtoa` and rewrites the output in
+// the canonical notation of write_canonical so that methods with different
+// output formats do the same work. Returns the number of values, among the
+// first `num_checked` per digit count, whose canonical output differs from
+// that of `reference` in `num_mismatches`.
+template <typename Dtoa, typename Reference>
+auto bench_normalized(Dtoa dtoa, Reference reference, int num_checked,
+                      int num_trials, int& num_mismatches)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {}, out[dtoa_buffer_size] = {};
+  auto convert = [&](auto method, double value, char* canonical) {
+    return write_canonical(buffer, write_value(method, value, buffer),
+                           canonical);
+  };
+  num_mismatches = 0;
+  char expected[dtoa_buffer_size] = {};
+  for (int digit = 1; digit <= max_digits; ++digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    for (int i = 0; i < num_checked; ++i) {
+      std::string_view s(out, convert(dtoa, data[i], out));
+      if (s != std::string_view(expected,
+                                convert(reference, data[i], expected)))
+        ++num_mismatches;
+    }
+  }
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) convert(dtoa, data[i], out);
+  });
+}
+
+// Converts `data`, e.g. the mixed data or a synthetic dataset, as a single
+// bucket.
+template <typename Dtoa>
+auto bench_values(Dtoa dtoa, std::span<const double> data, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  return bench_digits(
+      num_trials, 1,
+      [&](int) {
+        for (double value : data) dtoa(value, buffer);
+      },
+      int(data.size()));
+}
+
+auto bench_float(ftoa_fun ftoa, int num_trials) -> benchmark_result {
+  char buffer[256] = {};
+  get_random_digit_data<float>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits_of<float>, [&](int digit) {
+    const float* data = get_random_digit_data<float>(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) ftoa(data[i], buffer);
+  });
+}
+
+// Random digit values of both precisions with the precision of each value
+// given by a pattern of 'f' and 'd' repeated over the data, e.g. telemetry
+// records with float and double fields.
+struct precision_mix {
+  std::vector<double> doubles;
+  std::vector<float> floats;
+  std::vector<uint8_t> is_float;
+};
+
+auto get_precision_mix(const std::string& pattern) -> precision_mix {
+  precision_mix mix;
+  for (int i = 0; i < num_doubles_per_digit; ++i) {
+    mix.doubles.push_back(get_random_digit_data<double>(
+        i % max_digits + 1)[i / max_digits]);
+    mix.floats.push_back(get_random_digit_data<float>(
+        i % max_digits_of<float> + 1)[i / max_digits_of<float>]);
+    mix.is_float.push_back(pattern[size_t(i) % pattern.size()] == 'f');
+  }
+  return mix;
+}
+
+// Converts values of the mix with `ftoa` or `dtoa` depending on precision.
+template <typename Dtoa>
+auto bench_precision_mix(Dtoa dtoa, ftoa_fun ftoa, const precision_mix& mix,
+                         int num_trials) -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  size_t n = mix.is_float.size();
+  return bench_digits(
+      num_trials, 1,
+      [&](int) {
+        for (size_t i = 0; i < n; ++i) {
+          if (mix.is_float[i])
+            ftoa(mix.floats[i], buffer);
+          else
+            dtoa(mix.doubles[i], buffer);
+        }
+      },
+      int(n));
+}
+
+auto bench_float16(const float16_method& m, int num_trials)
+    -> benchmark_result {
+  char buffer[256] = {};
+  get_float16_digit_data(m.format, 1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, float16_max_digits(m.format), [&](int digit) {
+    const uint16_t* data = get_float16_digit_data(m.format, digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) m.dtoa(data[i], buffer);
+  });
+}
+
+#if LDBL_MANT_DIG == 64
+auto bench_long_double(ldtoa_fun dtoa, int num_trials) -> benchmark_result {
+  char buffer[256] = {};
+  get_long_double_digit_data(1);  // Generate outside of the timed loop.
+  return bench_digits(
+      num_trials, max_long_double_digits,
+      [&](int digit) {
+        const long double* data = get_long_double_digit_data(digit);
+        for (int i = 0; i < num_long_double_per_digit; ++i)
+          dtoa(data[i], buffer);
+      },
+      num_long_double_per_digit);
+}
+#endif
+
+#if BENCH_FLOAT128
+auto bench_float128(f128toa_fun dtoa, int num_trials) -> benchmark_result {
+  char buffer[256] = {};
+  get_float128_digit_data(1);  // Generate outside of the timed loop.
+  return bench_digits(
+      num_trials, max_float128_digits,
+      [&](int digit) {
+        const __float128* data = get_float128_digit_data(digit);
+        for (int i = 0; i < num_float128_per_digit; ++i) dtoa(data[i], buffer);
+      },
+      num_float128_per_digit);
+}
+#endif
+
+// Converts each digit bucket with a single call into one preallocated arena.
+auto bench_batch(batch_dtoa_fun dtoa, int num_trials) -> benchmark_result {
+  std::vector<char> arena(num_doubles_per_digit * batch_value_size);
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    dtoa({data, num_doubles_per_digit}, arena.data());
+  });
+}
+
+// Returns the top-down breakdown of converting the random digit data
+// `num_trials` times with `dtoa`.
+template <typename Dtoa>
+auto bench_topdown(topdown_counters& topdown, Dtoa dtoa, int num_trials)
+    -> topdown_fractions {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  auto convert_all = [&]() {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+    }
+  };
+  convert_all();  // Warm up.
+  topdown.start();
+  for (int trial = 0; trial < num_trials; ++trial) convert_all();
+  return topdown.stop();
+}
+
+// The minimum time of an energy measurement. The counters are updated about
+// every millisecond and measure the whole package, so short runs are noisy.
+constexpr auto min_energy_time = std::chrono::seconds(1);
+
+struct energy_result {
+  double ns = 0;  // Time per conversion.
+  double nj[num_energy_domains] = {};  // Energy per conversion.
+};
+
+// Measures the energy per conversion of `convert_all`, which converts all
+// random digit values once, by calling it repeatedly for at least
+// `min_energy_time` between reads of `energy`.
+template <typename F>
+auto measure_energy(energy_counters& energy, F convert_all) -> energy_result {
+  convert_all();  // Warm up.
+  using clock = std::chrono::steady_clock;
+  uint64_t num_conversions = 0;
+  energy.start();
+  auto start = clock::now();
+  auto elapsed = clock::duration();
+  do {
+    convert_all();
+    num_conversions += uint64_t(max_digits) * num_doubles_per_digit;
+    elapsed = clock::now() - start;
+  } while (elapsed < min_energy_time);
+  energy_counts counts = energy.stop();
+  energy_result result;
+  result.ns = std::chrono::duration<double, std::nano>(elapsed).count() /
+              double(num_conversions);
+  for (int d = 0; d < num_energy_domains; ++d)
+    result.nj[d] = counts.joules[d] * 1e9 / double(num_conversions);
+  return result;
+}
+
+template <typename Dtoa>
+auto bench_energy(energy_counters& energy, Dtoa dtoa) -> energy_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return measure_energy(energy, [&]() {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+    }
+  });
+}
+
+auto bench_energy(energy_counters& energy, batch_dtoa_fun dtoa)
+    -> energy_result {
+  std::vector<char> arena(num_doubles_per_digit * batch_value_size);
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return measure_energy(energy, [&]() {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      dtoa({data, num_doubles_per_digit}, arena.data());
+    }
+  });
+}
+
+// Writes the digits of the decimal significands of each digit bucket.
+auto bench_digits_method(digits_fun write_digits, int num_trials)
+    -> benchmark_result {
+  char buffer[256] = {};
+  get_random_digit_significands(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const uint64_t* sigs = get_random_digit_significands(digit).data();
+    for (int i = 0; i < num_doubles_per_digit; ++i)
+      write_digits(sigs[i], buffer);
+  });
+}
+
+// Formats the random integers of each digit count.
+template <typename Int, typename Itoa>
+auto bench_itoa(Itoa itoa, int num_trials) -> benchmark_result {
+  char buffer[32] = {};
+  get_random_integers<Int>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_integer_digits<Int>, [&](int digit) {
+    for (Int value : get_random_integers<Int>(digit)) itoa(value, buffer);
+  });
+}
+
+// Converts each digit bucket to decimal without formatting.
+template <typename Float = double, typename ToDecimal>
+auto bench_decimal(ToDecimal to_decimal, int num_trials) -> benchmark_result {
+  volatile uint64_t sink = 0;
+  get_random_digit_data<Float>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits_of<Float>, [&](int digit) {
+    const Float* data = get_random_digit_data<Float>(digit);
+    uint64_t sum = 0;
+    for (int i = 0; i < num_doubles_per_digit; ++i)
+      sum += to_decimal(data[i]).sig;
+    sink = sum;
+  });
+}
+
+// Formats the precomputed decimal representations of each digit bucket.
+auto bench_format(format_fun format, int num_trials) -> benchmark_result {
+  char buffer[256] = {};
+  get_random_digit_decimals(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const decimal_fp* decs = get_random_digit_decimals(digit).data();
+    for (int i = 0; i < num_doubles_per_digit; ++i) format(decs[i], buffer);
+  });
+}
+
+// Formats the precision data with the given precision.
+auto bench_precision(precision_fun format_fun, int precision, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  const std::vector<double>& data = get_precision_data();
+  return bench_digits(num_trials, 1, [&](int) {
+    for (double value : data) format_fun(value, precision, buffer);
+  });
+}
+
+// Writes `data` to a buffer of size `n`.
+auto bench_bounded(bounded_fun write, std::span<const double> data, size_t n,
+                   int num_trials) -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  return bench_digits(
+      num_trials, 1,
+      [&](int) {
+        for (double value : data) write(value, buffer, n);
+      },
+      int(data.size()));
+}
+
+// Returns the random digit values with `digit` <= 16 significant digits
+// encoded as decimal64.
+auto get_decimal64_data(int digit) -> const uint64_t* {
+  static const std::vector<uint64_t> data = []() {
+    std::vector<uint64_t> result;
+    result.reserve(num_doubles_per_digit * max_decimal64_digits);
+    for (int d = 1; d <= max_decimal64_digits; ++d) {
+      const double* values = get_random_digit_data<double>(d);
+      for (int i = 0; i < num_doubles_per_digit; ++i) {
+        decimal_fp dec = to_decimal_fp(values[i]);
+        result.push_back(
+            to_decimal64(std::signbit(values[i]), dec.sig, dec.exp));
+      }
+    }
+    return result;
+  }();
+  return data.data() + (digit - 1) * num_doubles_per_digit;
+}
+
+// Formats the random digit values with up to 16 digits stored as decimal64.
+auto bench_decimal64(decimal64_fun format, int num_trials)
+    -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_decimal64_data(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_decimal64_digits, [&](int digit) {
+    const uint64_t* data = get_decimal64_data(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) format(data[i], buffer);
+  });
+}
+
+// Runs the random digit benchmark on the values with up to 16 digits, i.e.
+// the ones of bench_decimal64 stored as doubles.
+template <typename Dtoa>
+auto bench_decimal64_double(Dtoa dtoa, int num_trials) -> benchmark_result {
+  char buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_decimal64_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+  });
+}
+
+// Converts the random digit data to UTF-16.
+auto bench_wide(wide_dtoa_fun dtoa, int num_trials) -> benchmark_result {
+  char16_t buffer[dtoa_buffer_size] = {};
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+  });
+}
+
+// Parses the shortest representations of each digit bucket.
+auto bench_parse(parse_fun parse, int num_trials) -> benchmark_result {
+  get_random_digit_strings(1);  // Generate outside of the timed loop.
+  return bench_digits(num_trials, max_digits, [&](int digit) {
+    const char* p = get_random_digit_strings(digit).data();
+    for (int i = 0; i < num_doubles_per_digit; ++i) {
+      size_t n = static_cast<unsigned char>(*p++);
+      parse(p, p + n);
+      p += n + 1;
+    }
+  });
+}
+
+// The number of values of each digit bucket used in the round-trip benchmark
+// which pairs every method with every parser.
+constexpr int num_roundtrip_per_digit = 10'000;
+
+// Returns the first num_roundtrip_per_digit values of each digit bucket.
+auto get_roundtrip_values() -> const std::vector<double>& {
+  static std::vector<double> values = [] {
+    std::vector<double> result;
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      result.insert(result.end(), data, data + num_roundtrip_per_digit);
+    }
+    return result;
+  }();
+  return values;
+}
+
+struct roundtrip_result {
+  double ns = std::numeric_limits<double>::max();  // per round trip
+  // The sum of the times per value of formatting and parsing separately.
+  double separate_ns = 0;
+  size_t num_mismatches = 0;  // values that don't parse back bit-exactly
+  std::string first_mismatch;  // the output of the first such value
+};
+
+// Formats each value with `dtoa` and parses it back with `parse` in the same
+// loop and compares with formatting all values and then parsing them.
+template <typename Dtoa>
+auto bench_roundtrip(Dtoa dtoa, parse_fun parse, int num_trials)
+    -> roundtrip_result {
+  const std::vector<double>& values = get_roundtrip_values();
+  auto time = [&](auto run) {
+    duration run_duration = duration::max();
+    for (int trial = 0; trial < num_trials; ++trial) {
+      auto start = std::chrono::steady_clock::now();
+      run();
+      auto d = std::chrono::steady_clock::now() - start;
+      if (d < run_duration) run_duration = d;
+    }
+    return std::chrono::duration<double, std::nano>(run_duration).count() /
+           values.size();
+  };
+
+  roundtrip_result result;
+  char buffer[dtoa_buffer_size] = {};
+  result.ns = time([&] {
+    size_t num_mismatches = 0;
+    for (double value : values) {
+      char* end = write_value(dtoa, value, buffer);
+      *end = '\0';  // Some parsers require a NUL.
+      double parsed = parse(buffer, end);
+      num_mismatches += memcmp(&parsed, &value, sizeof(value)) != 0;
+    }
+    result.num_mismatches = num_mismatches;
+  });
+  for (double value : values) {
+    if (result.num_mismatches == 0) break;
+    char* end = write_value(dtoa, value, buffer);
+    *end = '\0';
+    double parsed = parse(buffer, end);
+    if (memcmp(&parsed, &value, sizeof(value)) == 0) continue;
+    result.first_mismatch = buffer;
+    break;
+  }
+
+  // Formatting is timed into the same buffer as the round trip so that both
+  // write to hot memory. The parsed strings are stored back to back, each
+  // followed by a NUL, and read sequentially which the prefetcher hides.
+  double format_ns = time([&] {
+    for (double value : values) *write_value(dtoa, value, buffer) = '\0';
+  });
+  std::vector<char> strings;
+  strings.reserve(values.size() * 32);
+  std::vector<size_t> ends(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    char* end = write_value(dtoa, values[i], buffer);
+    strings.insert(strings.end(), buffer, end);
+    ends[i] = strings.size();
+    strings.push_back('\0');
+  }
+  volatile double sink = 0;
+  double parse_ns = time([&] {
+    double sum = 0;
+    size_t begin = 0;
+    for (size_t end : ends) {
+      sum += parse(strings.data() + begin, strings.data() + end);
+      begin = end + 1;
+    }
+    sink = sum;
+  });
+  result.separate_ns = format_ns + parse_ns;
+  return result;
+}
+
+// Parses the lines of `input` one at a time with `parse`.
+auto parse_lines(parse_fun parse, std::string_view input, double* out)
+    -> size_t {
+  double* start = out;
+  const char* p = input.data();
+  const char* last = p + input.size();
+  while (p != last) {
+    auto end = static_cast<const char*>(memchr(p, '\n', size_t(last - p)));
+    if (!end) break;
+    *out++ = parse(p, end);
+    p = end + 1;
+  }
+  return size_t(out - start);
+}
+
+struct column_parse_result {
+  double ns = std::numeric_limits<double>::max();  // per value
+  size_t num_mismatches = 0;  // values that don't parse back bit-exactly
+};
+
+// Parses `column`, the round-trip values formatted by a method, with `parse`
+// where `parse(column, out)` is called like a column_parse_fun.
+template <typename Parse>
+auto bench_column_parse(Parse parse, std::string_view column, int num_trials)
+    -> column_parse_result {
+  const std::vector<double>& values = get_roundtrip_values();
+  std::vector<double> parsed(values.size());
+  column_parse_result result;
+  duration min_duration = duration::max();
+  size_t n = 0;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    n = parse(column, parsed.data());
+    auto d = std::chrono::steady_clock::now() - start;
+    if (d < min_duration) min_duration = d;
+  }
+  result.ns = std::chrono::duration<double, std::nano>(min_duration).count() /
+              values.size();
+  result.num_mismatches = count_mismatches(values, std::span(parsed.data(), n));
+  return result;
+}
+
+// Kinds of parse inputs that miss the fast paths of parsers. They are used as
+// the digit buckets of the parsehard type.
+enum hard_parse_kind {
+  hard_parse_long = 1,  // 700 significant digits
+  hard_parse_halfway,   // exact and near halfway points between doubles
+  hard_parse_extreme,   // subnormals and values near or out of range
+  num_hard_parse_kinds = hard_parse_extreme
+};
+
+constexpr const char* hard_parse_kind_names[] = {"", "long", "halfway",
+                                                 "extreme"};
+
+constexpr int num_hard_parse_strings = 1000;
+constexpr int num_long_parse_digits = 700;
+
+// Returns the significant digits of the exact value of sig * 2**exp without
+// trailing zeros and sets `exp10` so that the value is digits * 10**exp10.
+auto exact_decimal(uint64_t sig, int exp, int& exp10) -> std::string {
+  constexpr uint32_t base = 1'000'000'000;
+  std::vector<uint32_t> limbs;  // Least significant first.
+  for (; sig != 0; sig /= base) limbs.push_back(uint32_t(sig % base));
+  // Multipliers are less than base so the carry fits in a limb.
+  auto multiply = [&](uint32_t m) {
+    uint64_t carry = 0;
+    for (uint32_t& limb : limbs) {
+      uint64_t product = uint64_t(limb) * m + carry;
+      limb = uint32_t(product % base);
+      carry = product / base;
+    }
+    if (carry != 0) limbs.push_back(uint32_t(carry));
+  };
+  // sig * 2**exp = sig * 5**-exp * 10**exp for negative exp.
+  exp10 = std::min(exp, 0);
+  for (; exp < 0; exp += 12) {
+    uint32_t pow5 = 1;
+    for (int i = std::min(-exp, 12); i > 0; --i) pow5 *= 5;
+    multiply(pow5);
+  }
+  for (; exp > 0; exp -= 29) multiply(uint32_t(1) << std::min(exp, 29));
+
+  std::string digits = fmt::format("{}", limbs.back());
+  for (size_t i = limbs.size() - 1; i-- > 0;)
+    digits += fmt::format("{:09}", limbs[i]);
+  size_t size = digits.find_last_not_of('0') + 1;
+  exp10 += int(digits.size() - size);
+  digits.resize(size);
+  return digits;
+}
+
+// Formats digits * 10**exp10 in exponential notation.
+auto to_exponential(const std::string& digits, int exp10) -> std::string {
+  return fmt::format("{}.{}e{}", digits[0], digits.substr(1),
+                     exp10 + int(digits.size()) - 1);
+}
+
+// Returns random positive decimal strings of `kind` that are hard to parse.
+// The strings are NUL-terminated.
+auto get_hard_parse_strings(int kind) -> const std::vector<std::string>& {
+  static const std::vector<std::vector<std::string>> strings = []() {
+    std::vector<std::vector<std::string>> result(num_hard_parse_kinds + 1);
+    rng r(random_digit_seed);
+    auto random_positive = [&]() { return fabs(random_value<double>(r)); };
+    // Returns the significand and exponent of `value` as an integer times a
+    // power of 2.
+    auto decompose = [](double value, uint64_t& sig, int& exp) {
+      uint64_t bits = 0;
+      memcpy(&bits, &value, sizeof(bits));
+      sig = bits & ((uint64_t(1) << 52) - 1);
+      exp = int(bits >> 52);
+      if (exp != 0) sig |= uint64_t(1) << 52;
+      exp = std::max(exp, 1) - 1075;
+    };
+    for (int i = 0; i < num_hard_parse_strings; ++i) {
+      uint64_t sig = 0;
+      int exp = 0, exp10 = 0;
+
+      // The exact value of a random double padded or truncated to 700 digits.
+      decompose(random_positive(), sig, exp);
+      std::string digits = exact_decimal(sig, exp, exp10);
+      exp10 -= num_long_parse_digits - int(digits.size());
+      digits.resize(num_long_parse_digits, '0');
+      result[hard_parse_long].push_back(to_exponential(digits, exp10));
+
+      // The halfway point between a random double and the next one: exact
+      // (rounded to even), just above it and truncated to 19 digits, i.e.
+      // just below it.
+      decompose(random_positive(), sig, exp);
+      digits = exact_decimal(sig * 2 + 1, exp - 1, exp10);
+      switch (i % 3) {
+        case 1:
+          exp10 -= 21;
+          digits += std::string(20, '0') + "1";
+          break;
+        case 2:
+          if (digits.size() > 19) {
+            exp10 += int(digits.size()) - 19;
+            digits.resize(19);
+          }
+          break;
+      }
+      result[hard_parse_halfway].push_back(to_exponential(digits, exp10));
+
+      // Subnormals, values near the largest double, and 17-digit values that
+      // underflow or overflow.
+      std::string s;
+      uint64_t bits = r.next_uint64();
+      double value = 0;
+      switch (i % 4) {
+        case 0:
+          bits &= (uint64_t(1) << 52) - 1;
+          break;
+        case 1:
+          bits = (bits & ((uint64_t(1) << 52) - 1)) | (uint64_t(2046) << 52);
+          break;
+      }
+      memcpy(&value, &bits, sizeof(value));
+      if (i % 4 < 2) {
+        s = fmt::format("{}", value);
+      } else {
+        int e = int(r.next_uint64() % 23);
+        s = fmt::format("{}.{:016}e{}", 1 + r.next_uint64() % 9,
+                        r.next_uint64() % 10'000'000'000'000'000,
+                        i % 4 == 2 ? -324 - e : 308 + e);
+      }
+      result[hard_parse_extreme].push_back(s);
+    }
+    return result;
+  }();
+  return strings[kind];
+}
+
+// Checks that `m` parses the hard inputs like strtod. Mismatches are reported
+// as warnings since some parsers don't support long inputs or out of range
+// values by design.
+void verify_hard(const parse_method& m) {
+  fmt::print("Verifying parsehard {:10} ... ", m.name);
+  std::string mismatches;
+  for (int kind = 1; kind <= num_hard_parse_kinds; ++kind) {
+    int num_mismatches = 0;
+    for (const std::string& s : get_hard_parse_strings(kind)) {
+      double expected = strtod(s.c_str(), nullptr);
+      double result = m.parse(s.data(), s.data() + s.size());
+      if (memcmp(&result, &expected, sizeof(result)) != 0) ++num_mismatches;
+    }
+    if (num_mismatches == 0) continue;
+    mismatches += fmt::format(" {} {}/{}", hard_parse_kind_names[kind],
+                              num_mismatches, num_hard_parse_strings);
+  }
+  if (mismatches.empty())
+    fmt::print("OK\n");
+  else
+    fmt::print("warning: mismatches with strtod:{}\n", mismatches);
+}
+
+// Parses the hard inputs of each kind.
+auto bench_parse_hard(parse_fun parse, int num_trials) -> benchmark_result {
+  get_hard_parse_strings(1);  // Generate outside of the timed loop.
+  return bench_digits(
+      num_trials, num_hard_parse_kinds,
+      [&](int kind) {
+        for (const std::string& s : get_hard_parse_strings(kind))
+          parse(s.data(), s.data() + s.size());
+      },
+      num_hard_parse_strings);
+}
+
+// Returns the worst-case latency in nanoseconds of parsing a hard input of
+// each kind. Each input is timed separately and the fastest of `num_trials`
+// runs is taken to filter out interrupts.
+auto bench_parse_hard_max(parse_fun parse, int num_trials)
+    -> std::vector<double> {
+  std::vector<double> result(num_hard_parse_kinds + 1);
+  for (int kind = 1; kind <= num_hard_parse_kinds; ++kind) {
+    uint64_t max_ticks = 0;
+    for (const std::string& s : get_hard_parse_strings(kind)) {
+      uint64_t min_ticks = std::numeric_limits<uint64_t>::max();
+      for (int trial = 0; trial < num_trials; ++trial) {
+        uint64_t start = read_cycle_counter();
+        parse(s.data(), s.data() + s.size());
+        min_ticks = std::min(min_ticks, read_cycle_counter() - start);
+      }
+      max_ticks = std::max(max_ticks, min_ticks);
+    }
+    result[kind] = double(max_ticks) / ticks_per_ns();
+  }
+  return result;
+}
+
+// The number of consecutive calls timed as one latency sample. Timing single
+// calls would mostly measure the cycle counter itself.
+constexpr int latency_group_size = 8;
+
+constexpr double latency_percentiles[] = {50, 90, 99, 99.9};
+constexpr int num_latency_percentiles = std::size(latency_percentiles);
+
+struct latency_result {
+  // Per-call latency in nanoseconds indexed by digit and percentile.
+  double ns[max_digits + 1][num_latency_percentiles] = {};
+};
+
+// Times groups of `latency_group_size` calls with the cycle counter and
+// computes percentiles of the per-call latency for each digit bucket.
+template <typename Dtoa>
+auto bench_latency(Dtoa dtoa, int num_trials) -> latency_result {
+  constexpr int num_groups = num_doubles_per_digit / latency_group_size;
+  double ns_per_tick = 1 / ticks_per_ns();
+
+  char buffer[dtoa_buffer_size] = {};
+  latency_result result;
+  std::vector<uint64_t> samples;
+  samples.reserve(size_t(num_groups) * num_trials);
+  for (int digit = 1; digit <= max_digits; ++digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    samples.clear();
+    for (int trial = 0; trial < num_trials; ++trial) {
+      for (int g = 0; g < num_groups; ++g) {
+        const double* group = data + g * latency_group_size;
+        uint64_t start = read_cycle_counter();
+        for (int i = 0; i < latency_group_size; ++i) dtoa(group[i], buffer);
+        samples.push_back(read_cycle_counter() - start);
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+    for (int p = 0; p < num_latency_percentiles; ++p) {
+      double rank = latency_percentiles[p] / 100 * (samples.size() - 1);
+      size_t index = size_t(rank);
+      result.ns[digit][p] =
+          double(samples[index]) * ns_per_tick / latency_group_size;
+    }
+  }
+  return result;
+}
+
+// The number of values per digit bucket converted in the cold-cache benchmark.
+// Each conversion is preceded by an eviction so fewer values are used.
+constexpr int num_cold_per_digit = 1000;
+
+// The size of the scratch buffer streamed through between conversions in the
+// cold-cache benchmark. It is larger than the last-level cache of common CPUs
+// so that every touched line is a miss that evicts another one.
+constexpr size_t cold_scratch_size = size_t(256) << 20;
+
+// Returns the scratch buffer of cold_scratch_size bytes shared by the
+// cold-cache benchmark and the SMT antagonist.
+auto get_cold_scratch() -> const char* {
+  static std::vector<char> scratch(cold_scratch_size, 1);
+  return scratch.data();
+}
+
+constexpr size_t cache_line_size = 64;
+
+// The time between a table prefetch and the conversion in the cold-cache
+// benchmark, about the latency of a DRAM access, e.g. the time to parse the
+// rest of a request after the prefetch is issued on its arrival.
+constexpr double cold_prefetch_lead_ns = 200;
+
+// Times each conversion of the first `num_cold_per_digit` values of every
+// digit bucket separately. If `evict_size` is nonzero, the next `evict_size`
+// bytes of a large scratch buffer are read between conversions, like
+// unrelated work between conversions in a service, evicting the method's
+// tables and code from the caches over time. The eviction is not timed. Reads
+// are used rather than writes because the cycle counter waits for earlier
+// loads but not for buffered stores which would delay the conversion. If
+// `prefetch` is not null, it is called after the eviction and followed by a
+// wait of `cold_prefetch_lead_ns`, neither of which is timed.
+template <typename Dtoa>
+auto bench_cold(Dtoa dtoa, size_t evict_size, int num_trials,
+                table_prefetcher prefetch = nullptr) -> benchmark_result {
+  const char* scratch = get_cold_scratch();
+  size_t offset = 0;
+  volatile char sink = 0;
+  char buffer[dtoa_buffer_size] = {};
+  auto lead_ticks = uint64_t(cold_prefetch_lead_ns * ticks_per_ns());
+  get_random_digit_data<double>(1);  // Generate outside of the timed loop.
+  return bench_digits(
+      num_trials, max_digits,
+      [&](int digit) {
+        const double* data = get_random_digit_data<double>(digit);
+        uint64_t ticks = 0;
+        for (int i = 0; i < num_cold_per_digit; ++i) {
+          char sum = 0;
+          for (size_t n = 0; n < evict_size; n += cache_line_size) {
+            sum += scratch[offset];
+            offset += cache_line_size;
+            if (offset == cold_scratch_size) offset = 0;
+          }
+          sink = sum;
+          if (prefetch) {
+            prefetch();
+            uint64_t issued = read_cycle_counter();
+            while (read_cycle_counter() - issued < lead_ticks) {
+            }
+          }
+          uint64_t start = read_cycle_counter();
+          dtoa(data[i], buffer);
+          ticks += read_cycle_counter() - start;
+        }
+        return ticks;
+      },
+      num_cold_per_digit);
+}
+
+// The number of values per digit bucket converted at every output offset.
+constexpr int num_offset_values_per_digit = 256;
+
+constexpr int num_offset_rounds = 3;
+
+constexpr size_t page_size = 4096;
+
+// Returns output offsets from the start of a page: every offset in a cache
+// line followed by two at which a typical output crosses into the next page.
+auto get_output_offsets() -> std::vector<size_t> {
+  std::vector<size_t> offsets;
+  for (size_t offset = 0; offset < cache_line_size; ++offset)
+    offsets.push_back(offset);
+  offsets.push_back(page_size - 16);
+  offsets.push_back(page_size - 8);
+  return offsets;
+}
+
+// Times conversions of random digit values, mixed across digit counts, written
+// at each of `offsets` from a page-aligned buffer, and returns the time per
+// conversion at every offset. Stores that straddle cache lines or pages are
+// split and may be slower, depending on the method's store widths.
+template <typename Dtoa>
+auto bench_offsets(Dtoa dtoa, const std::vector<size_t>& offsets,
+                   int num_trials) -> std::vector<double> {
+  static std::vector<double> data = []() {
+    std::vector<double> result;
+    for (int i = 0; i < num_offset_values_per_digit; ++i) {
+      for (int digit = 1; digit <= max_digits; ++digit)
+        result.push_back(get_random_digit_data<double>(digit)[i]);
+    }
+    return result;
+  }();
+  alignas(page_size) static char buffer[page_size * 2];
+  // Sweep the offsets several times and keep the fastest time at each, so
+  // that whichever offset is timed first isn't penalized by warm-up.
+  std::vector<double> ns(offsets.size(),
+                         std::numeric_limits<double>::max());
+  for (int round = 0; round < num_offset_rounds; ++round) {
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      char* out = buffer + offsets[i];
+      benchmark_result result = bench_digits(
+          num_trials, 1,
+          [&](int) {
+            for (double value : data) dtoa(value, out);
+          },
+          int(data.size()));
+      ns[i] = std::min(ns[i], result.per_digit[1].duration_ns);
+    }
+  }
+  return ns;
+}
+
+// The distance in values at which inputs are prefetched in the streaming
+// benchmark, about 8 cache lines ahead which covers the memory latency at the
+// rate of typical conversions.
+constexpr size_t stream_prefetch_distance = 64;
+
+// The number of values per call of batch methods in the streaming benchmark.
+constexpr size_t stream_batch_size = 4096;
+
+inline void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p);
+#else
+  (void)p;
+#endif
+}
+
+// Returns `size` bytes of the random digit data repeated to fill them for the
+// streaming benchmark.
+auto get_stream_data(size_t size) -> std::vector<double> {
+  std::span<const double> tile(get_random_digit_data(1),
+                               num_doubles_per_digit * max_digits);
+  std::vector<double> values(size / sizeof(double));
+  for (size_t i = 0; i < values.size(); i += tile.size()) {
+    size_t n = std::min(tile.size(), values.size() - i);
+    std::copy_n(tile.begin(), n, values.begin() + i);
+  }
+  return values;
+}
+
+// Converts `values` writing the outputs one after another into `out` which is
+// reused from the start when full. With `prefetch_input` the inputs are
+// prefetched in software ahead of the hardware prefetcher.
+template <typename Dtoa>
+void stream_values(Dtoa dtoa, std::span<const double> values,
+                   std::span<char> out, bool prefetch_input) {
+  char* p = out.data();
+  char* end = out.data() + out.size() - dtoa_buffer_size;
+  for (size_t i = 0; i < values.size(); ++i) {
+    // Prefetching past the end is harmless and avoids a branch.
+    if (prefetch_input) prefetch(values.data() + i + stream_prefetch_distance);
+    p = write_value(dtoa, values[i], p);
+    if (p > end) p = out.data();
+  }
+}
+
+void stream_values(batch_dtoa_fun dtoa, std::span<const double> values,
+                   std::span<char> out, bool prefetch_input) {
+  char* p = out.data();
+  char* end = out.data() + out.size() - stream_batch_size * batch_value_size;
+  for (size_t i = 0; i < values.size(); i += stream_batch_size) {
+    size_t n = std::min(stream_batch_size, values.size() - i);
+    if (prefetch_input) {
+      // Prefetch the next batch while converting this one.
+      const char* next = reinterpret_cast<const char*>(values.data() + i + n);
+      for (size_t j = 0; j < n * sizeof(double); j += cache_line_size)
+        prefetch(next + j);
+    }
+    p = dtoa(values.subspan(i, n), p);
+    if (p > end) p = out.data();
+  }
+}
+
+struct stream_result {
+  double ns = 0;           // per value without prefetching
+  double prefetch_ns = 0;  // per value with software prefetching
+  double hot_ns = 0;       // per value with the data in cache
+};
+
+// Converts `values`, which are much larger than the caches, into an output
+// buffer of the same size, so that both the input and the output are memory
+// bound, and compares the time per value to converting a cache-resident sample
+// with the same mix of digit counts.
+template <typename Dtoa>
+auto bench_stream(Dtoa dtoa, std::span<const double> values, int num_trials)
+    -> stream_result {
+  // The output buffer fits at least two batches.
+  constexpr size_t min_out_size = stream_batch_size * batch_value_size * 2;
+  static std::vector<char> out;
+  out.resize(std::max(values.size() * sizeof(double), min_out_size));
+  auto time = [&](std::span<const double> data, bool prefetch_input,
+                  int trials) {
+    std::span<char> data_out = std::span(out).first(
+        std::max(data.size() * sizeof(double), min_out_size));
+    duration run_duration = duration::max();
+    for (int trial = 0; trial < trials; ++trial) {
+      auto start = std::chrono::steady_clock::now();
+      stream_values(dtoa, data, data_out, prefetch_input);
+      auto d = std::chrono::steady_clock::now() - start;
+      if (d < run_duration) run_duration = d;
+    }
+    return std::chrono::duration<double, std::nano>(run_duration).count() /
+           data.size();
+  };
+  std::vector<double> sample(num_doubles_per_digit);
+  size_t stride = values.size() / sample.size();
+  for (size_t i = 0; i < sample.size(); ++i) sample[i] = values[i * stride];
+  stream_result result;
+  result.hot_ns = time(sample, false, num_trials);
+  // Each trial streams the whole dataset, so a few are enough.
+  int stream_trials = std::min(num_trials, 3);
+  result.ns = time(values, false, stream_trials);
+  result.prefetch_ns = time(values, true, stream_trials);
+  return result;
+}
+
+// Pins the calling thread to the logical CPU `cpu` where supported.
+void pin_thread(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % CPU_SETSIZE, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  // macOS doesn't support hard affinity, so threads are left unpinned.
+  (void)cpu;
+#endif
+}
+
+struct thread_result {
+  double per_thread_ns = std::numeric_limits<double>::max();
+  double aggregate_ns = std::numeric_limits<double>::max();
+};
+
+// Runs `dtoa` on `num_threads` pinned threads, each converting its own slice of
+// every digit bucket. Each thread repeats its slice `num_threads` times so that
+// the work per thread is the same as in the single-threaded case.
+template <typename Dtoa>
+auto bench_threads(Dtoa dtoa, int num_threads, int num_trials)
+    -> thread_result {
+  int cpus = num_cpus();
+  int slice_size = num_doubles_per_digit / num_threads;
+  double values_per_thread = double(slice_size) * max_digits * num_threads;
+  get_random_digit_data(1);  // Initialize the data before starting threads.
+
+  thread_result result;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    std::vector<duration> thread_durations(num_threads);
+    std::atomic<int> num_ready = 0;
+    std::atomic<bool> start_flag = false;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        pin_thread(t % cpus);
+        char buffer[dtoa_buffer_size] = {};
+        ++num_ready;
+        while (!start_flag.load(std::memory_order_acquire)) {
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int iter = 0; iter < num_threads; ++iter) {
+          for (int digit = 1; digit <= max_digits; ++digit) {
+            const double* data =
+                get_random_digit_data(digit) + t * slice_size;
+            for (int i = 0; i < slice_size; ++i) dtoa(data[i], buffer);
+          }
+        }
+        thread_durations[t] = std::chrono::steady_clock::now() - start;
+      });
+    }
+    while (num_ready < num_threads) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    start_flag.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    auto wall_duration = std::chrono::steady_clock::now() - start;
+
+    duration total_duration = {};
+    for (duration d : thread_durations) total_duration += d;
+    double per_thread_ns =
+        std::chrono::duration<double, std::nano>(total_duration).count() /
+        (values_per_thread * num_threads);
+    double aggregate_ns =
+        std::chrono::duration<double, std::nano>(wall_duration).count() /
+        (values_per_thread * num_threads);
+    result.per_thread_ns = std::min(result.per_thread_ns, per_thread_ns);
+    result.aggregate_ns = std::min(result.aggregate_ns, aggregate_ns);
+  }
+  return result;
+}
+
+// The size in bytes of the values converted by parallel methods, large enough
+// for the threads to amortize their startup.
+constexpr size_t parallel_data_size = size_t(32) << 20;
+
+// Converts a large array with a single call of `dtoa` on `num_threads` threads
+// and returns the wall time per value. Unlike bench_threads this includes
+// splitting the work and assembling the output.
+auto bench_parallel(parallel_dtoa_fun dtoa, int num_threads, int num_trials)
+    -> double {
+  std::vector<double> values = get_stream_data(parallel_data_size);
+  std::vector<char> out(values.size() * batch_value_size);
+  dtoa(values, out.data(), num_threads);  // Warm up and touch the pages.
+  double ns = std::numeric_limits<double>::max();
+  // Each trial converts the whole array, so a few are enough.
+  for (int trial = 0; trial < std::min(num_trials, 3); ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    dtoa(values, out.data(), num_threads);
+    auto wall_duration = std::chrono::steady_clock::now() - start;
+    double wall_ns =
+        std::chrono::duration<double, std::nano>(wall_duration).count();
+    ns = std::min(ns, wall_ns / double(values.size()));
+  }
+  return ns;
+}
+
+// Parses a CPU list like "0-3,8-11" from sysfs.
+auto parse_cpu_list(const char* s) -> std::vector<int> {
+  std::vector<int> cpus;
+  while (*s >= '0' && *s <= '9') {
+    char* end = nullptr;
+    int first = int(strtol(s, &end, 10)), last = first;
+    if (*end == '-') last = int(strtol(end + 1, &end, 10));
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    s = *end == ',' ? end + 1 : end;
+  }
+  return cpus;
+}
+
+// Returns the logical CPUs of each NUMA node with CPUs, or an empty vector if
+// the topology is unknown.
+auto get_numa_nodes() -> std::vector<std::vector<int>> {
+  std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+  // Node numbers are usually but not necessarily contiguous.
+  std::vector<int> ids;
+  std::error_code ec;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.starts_with("node") && name.size() > 4 &&
+        name.find_first_not_of("0123456789", 4) == std::string::npos) {
+      ids.push_back(std::stoi(name.substr(4)));
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  for (int id : ids) {
+    std::string path =
+        fmt::format("/sys/devices/system/node/node{}/cpulist", id);
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) continue;
+    char line[4096] = {};
+    if (fgets(line, sizeof(line), f)) {
+      std::vector<int> cpus = parse_cpu_list(line);
+      if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    fclose(f);
+  }
+#endif
+  return nodes;
+}
+
+// The size of the data in the NUMA benchmark. It is larger than the last-level
+// cache of common CPUs so that the data is read from the memory of its node.
+constexpr size_t numa_data_size = size_t(256) << 20;
+
+// Returns a copy of `values` in pages allocated on the node of `cpu`. The
+// pages are placed by the default first-touch policy of the kernel.
+auto place_on_cpu(std::span<const double> values, int cpu)
+    -> std::unique_ptr<double[]> {
+  // Not value-initialized so that the pages are first touched by the copy.
+  std::unique_ptr<double[]> data(new double[values.size()]);
+  std::thread([&] {
+    pin_thread(cpu);
+    std::copy(values.begin(), values.end(), data.get());
+  }).join();
+  return data;
+}
+
+// Converts `values` on threads pinned to each of `cpus`, each thread taking
+// its own slice, and returns the wall time per value.
+template <typename Dtoa>
+auto bench_numa(Dtoa dtoa, const std::vector<int>& cpus,
+                std::span<const double> values, int num_trials) -> double {
+  int num_threads = int(cpus.size());
+  size_t slice_size = values.size() / num_threads;
+  double ns = std::numeric_limits<double>::max();
+  // Each trial reads the whole data, so a few are enough.
+  for (int trial = 0; trial < std::min(num_trials, 3); ++trial) {
+    std::atomic<int> num_ready = 0;
+    std::atomic<bool> start_flag = false;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        pin_thread(cpus[t]);
+        char buffer[dtoa_buffer_size] = {};
+        ++num_ready;
+        while (!start_flag.load(std::memory_order_acquire)) {
+        }
+        for (double value : values.subspan(t * slice_size, slice_size))
+          dtoa(value, buffer);
+      });
+    }
+    while (num_ready < num_threads) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    start_flag.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    auto wall_duration = std::chrono::steady_clock::now() - start;
+    double wall_ns =
+        std::chrono::duration<double, std::nano>(wall_duration).count();
+    ns = std::min(ns, wall_ns / double(slice_size * num_threads));
+  }
+  return ns;
+}
+
+// Returns two logical CPUs that are SMT siblings, i.e. hardware threads of the
+// same physical core, or an empty vector if there are none.
+auto get_smt_siblings() -> std::vector<int> {
+#ifdef __linux__
+  for (int cpu = 0; cpu < num_cpus(); ++cpu) {
+    std::string path = fmt::format(
+        "/sys/devices/system/cpu/cpu{}/topology/thread_siblings_list", cpu);
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) continue;
+    char line[256] = {};
+    std::vector<int> siblings;
+    if (fgets(line, sizeof(line), f)) siblings = parse_cpu_list(line);
+    fclose(f);
+    if (siblings.size() >= 2) return {siblings[0], siblings[1]};
+  }
+#endif
+  return {};
+}
+
+// Runs `run(stop)` on `cpus[1]` until `stop` is set while `dtoa` converts all
+// random digit data on `cpus[0]` and returns the time per value of the latter.
+// `run` is the workload that competes for the core, e.g. another method.
+template <typename Dtoa, typename F>
+auto bench_smt(Dtoa dtoa, const std::vector<int>& cpus, F run, int num_trials)
+    -> double {
+  std::span<const double> values(get_random_digit_data(1),
+                                 num_doubles_per_digit * max_digits);
+  double ns = std::numeric_limits<double>::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    std::atomic<bool> stop = false, started = false;
+    std::thread sibling([&] {
+      pin_thread(cpus[1]);
+      started = true;
+      run(stop);
+    });
+    while (!started) std::this_thread::yield();
+    std::thread([&] {
+      pin_thread(cpus[0]);
+      char buffer[dtoa_buffer_size] = {};
+      auto start = std::chrono::steady_clock::now();
+      for (double value : values) dtoa(value, buffer);
+      auto d = std::chrono::steady_clock::now() - start;
+      ns = std::min(ns, std::chrono::duration<double, std::nano>(d).count() /
+                            values.size());
+    }).join();
+    stop = true;
+    sibling.join();
+  }
+  return ns;
+}
+
+// Returns a sibling workload that converts the random digit data with `dtoa`.
+template <typename Dtoa>
+auto smt_converter(Dtoa dtoa) {
+  return [dtoa](const std::atomic<bool>& stop) {
+    const double* values = get_random_digit_data(1);
+    char buffer[dtoa_buffer_size] = {};
+    for (size_t i = 0; !stop.load(std::memory_order_relaxed); ++i)
+      dtoa(values[i % (num_doubles_per_digit * max_digits)], buffer);
+  };
+}
+
+// A memory-bound sibling workload that reads a buffer larger than the caches
+// one cache line at a time.
+void smt_antagonist(const std::atomic<bool>& stop) {
+  const char* scratch = get_cold_scratch();
+  volatile char sink = 0;
+  char sum = 0;
+  for (size_t offset = 0; !stop.load(std::memory_order_relaxed);) {
+    sum += scratch[offset];
+    offset += cache_line_size;
+    if (offset == cold_scratch_size) offset = 0;
+  }
+  sink = sum;
+}
+
+// A batch of values passed between the stages of the pipeline benchmark.
+struct pipeline_batch {
+  std::vector<double> values;
+  std::vector<char> text;  // The formatted values separated by newlines.
+  size_t text_size = 0;
+  uint64_t produce_ticks = 0;  // The cycle counter when the batch was filled.
+};
+
+// The number of batches in flight between the pipeline stages.
+constexpr size_t pipeline_queue_size = 8;
+
+using pipeline_queue = spsc_queue<pipeline_batch*, pipeline_queue_size>;
+
+struct pipeline_result {
+  double ns = 0;         // per value from the first batch to the last flush
+  double format_ns = 0;  // per value spent converting in the formatter
+  double latency_p50_ns = 0;  // from filling a batch to flushing it
+  double latency_p99_ns = 0;
+};
+
+// Runs a pipeline of three threads connected by SPSC queues: a producer that
+// fills batches of `batch_size` values from the random digit data, a formatter
+// that converts them with `dtoa` and a writer that copies the text to an
+// output buffer. Empty batches go back from the writer to the producer.
+template <typename Dtoa>
+auto bench_pipeline(Dtoa dtoa, size_t batch_size, int num_trials)
+    -> pipeline_result {
+  std::span<const double> values(get_random_digit_data(1),
+                                 num_doubles_per_digit * max_digits);
+  size_t num_batches = values.size() / batch_size;
+  std::vector<pipeline_batch> batches(pipeline_queue_size);
+  for (pipeline_batch& b : batches) {
+    b.values.resize(batch_size);
+    b.text.resize(batch_size * dtoa_buffer_size);
+  }
+  std::vector<char> output(1 << 20);
+  volatile char sink = 0;
+
+  pipeline_result result;
+  result.ns = std::numeric_limits<double>::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    pipeline_queue free_queue, format_queue, write_queue;
+    for (pipeline_batch& b : batches) free_queue.try_push(&b);
+    std::vector<uint64_t> latencies(num_batches);
+    uint64_t format_ticks = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+      for (size_t i = 0; i < num_batches; ++i) {
+        pipeline_batch* b = nullptr;
+        while (!free_queue.try_pop(b)) std::this_thread::yield();
+        std::copy_n(values.begin() + i * batch_size, batch_size,
+                    b->values.begin());
+        b->produce_ticks = read_cycle_counter();
+        while (!format_queue.try_push(b)) std::this_thread::yield();
+      }
+    });
+    std::thread formatter([&] {
+      for (size_t i = 0; i < num_batches; ++i) {
+        pipeline_batch* b = nullptr;
+        while (!format_queue.try_pop(b)) std::this_thread::yield();
+        uint64_t format_start = read_cycle_counter();
+        char* out = b->text.data();
+        for (double value : b->values) {
+          out = write_value(dtoa, value, out);
+          *out++ = '\n';
+        }
+        b->text_size = size_t(out - b->text.data());
+        format_ticks += read_cycle_counter() - format_start;
+        while (!write_queue.try_push(b)) std::this_thread::yield();
+      }
+    });
+    size_t offset = 0;
+    for (size_t i = 0; i < num_batches; ++i) {
+      pipeline_batch* b = nullptr;
+      while (!write_queue.try_pop(b)) std::this_thread::yield();
+      for (size_t pos = 0; pos < b->text_size;) {
+        size_t n = std::min(b->text_size - pos, output.size() - offset);
+        memcpy(output.data() + offset, b->text.data() + pos, n);
+        pos += n;
+        offset = (offset + n) % output.size();
+      }
+      latencies[i] = read_cycle_counter() - b->produce_ticks;
+      while (!free_queue.try_push(b)) std::this_thread::yield();
+    }
+    auto d = std::chrono::steady_clock::now() - start;
+    producer.join();
+    formatter.join();
+    sink = output[offset];
+
+    double num_values = double(num_batches * batch_size);
+    double ns = std::chrono::duration<double, std::nano>(d).count() /
+                num_values;
+    if (ns >= result.ns) continue;
+    std::sort(latencies.begin(), latencies.end());
+    result.ns = ns;
+    result.format_ns = double(format_ticks) / ticks_per_ns() / num_values;
+    result.latency_p50_ns =
+        double(latencies[latencies.size() / 2]) / ticks_per_ns();
+    result.latency_p99_ns =
+        double(latencies[latencies.size() * 99 / 100]) / ticks_per_ns();
+  }
+  return result;
+}
+
+// Returns the number of heap allocations and bytes allocated per conversion
+// of the random digit values of each digit count. This is done in a separate
+// untimed pass to not affect the timings.
+template <typename Dtoa>
+auto count_allocs(Dtoa dtoa) -> std::vector<alloc_counts> {
+  std::vector<alloc_counts> result(max_digits + 1);
+  char buffer[dtoa_buffer_size] = {};
+  for (int digit = 1; digit <= max_digits; ++digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    start_counting_allocs();
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+    result[digit] = stop_counting_allocs();
+  }
+  return result;
+}
+
+// Returns the percentage of the random digit values of each digit count for
+// which `dtoa` fell back to a slower path according to `count`.
+template <typename Dtoa>
+auto get_fallback_rates(Dtoa dtoa, fallback_counter count)
+    -> std::vector<double> {
+  std::vector<double> rates(max_digits + 1);
+  char buffer[dtoa_buffer_size] = {};
+  for (int digit = 1; digit <= max_digits; ++digit) {
+    const double* data = get_random_digit_data<double>(digit);
+    count();  // Reset the counter.
+    for (int i = 0; i < num_doubles_per_digit; ++i) dtoa(data[i], buffer);
+    rates[digit] = 100.0 * double(count()) / num_doubles_per_digit;
+  }
+  return rates;
+}
+
+// The size of the stack on which stack usage is measured, far more than any
+// method uses.
+constexpr size_t stack_probe_size = size_t(1) << 20;
+
+// The number of values of each digit count and dataset converted in the stack
+// measurement.
+constexpr int num_stack_values = 1'000;
+
+// Returns the values of the stack measurement: the random cases and values of
+// every digit count and dataset, including the boundary cases that take the
+// rare paths with the largest intermediates.
+auto get_stack_values() -> const std::vector<double>& {
+  static std::vector<double> values = [] {
+    std::vector<double> result = get_random_cases();
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      result.insert(result.end(), data, data + num_stack_values);
+    }
+    for (int i = 0; i < num_datasets; ++i) {
+      std::span<const double> data = get_dataset(i).first(num_stack_values);
+      result.insert(result.end(), data.begin(), data.end());
+    }
+    return result;
+  }();
+  return values;
+}
+
+// Returns the peak stack usage in bytes of converting the stack values with
+// `dtoa` on a thread whose stack is painted with a pattern beforehand. The
+// stack grows down, so the usage is everything above the lowest byte that
+// lost the pattern, including the thread startup and the thread control block
+// that some C libraries put on top of the stack. Returns 0 on systems where
+// the stack of a thread cannot be provided.
+template <typename Dtoa>
+auto measure_stack_usage(Dtoa dtoa) -> size_t {
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+  constexpr unsigned char paint = 0xa5;
+  auto stack = static_cast<unsigned char*>(
+      aligned_alloc(page_size, stack_probe_size));
+  if (!stack) return 0;
+  memset(stack, paint, stack_probe_size);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack, stack_probe_size);
+  pthread_t thread;
+  auto run = [](void* arg) -> void* {
+    Dtoa dtoa = *static_cast<Dtoa*>(arg);
+    char buffer[dtoa_buffer_size] = {};
+    for (double value : get_stack_values()) dtoa(value, buffer);
+    return nullptr;
+  };
+  get_stack_values();  // Generate the values outside of the thread.
+  bool started = pthread_create(&thread, &attr, run, &dtoa) == 0;
+  if (started) pthread_join(thread, nullptr);
+  pthread_attr_destroy(&attr);
+  size_t untouched = 0;
+  while (untouched < stack_probe_size && stack[untouched] == paint)
+    ++untouched;
+  free(stack);
+  return started ? stack_probe_size - untouched : 0;
+#else
+  (void)dtoa;
+  return 0;
+#endif
+}
+
+// Returns the stack usage of `dtoa` above that of the measurement itself, i.e.
+// of a conversion function that only writes a terminating null.
+template <typename Dtoa>
+auto measure_method_stack(Dtoa dtoa) -> size_t {
+  static size_t baseline = measure_stack_usage(
+      +[](double, char* buffer) { *buffer = '\0'; });
+  size_t usage = measure_stack_usage(dtoa);
+  return usage > baseline ? usage - baseline : 0;
+}
+
+// Converts `values` with the instrumented method `m` and prints the
+// percentage of conversions that took each code path.
+void print_path_counts(const path_method& m, const char* dataset,
+                       std::span<const double> values) {
+  fmt::print("Paths {:18} {:20} ...", dataset, m.name);
+  char buffer[dtoa_buffer_size] = {};
+  m.count();  // Reset the counters.
+  for (double value : values) m.dtoa(value, buffer);
+  for (const path_count& c : m.count()) {
+    fmt::print(" {} {:.3f}%", c.path,
+               100.0 * double(c.count) / double(values.size()));
+  }
+  fmt::print("\n");
+}
+
+struct ranked_method {
+  std::string name;
+  double ns;  // Or another cost per conversion, e.g. energy.
+};
+
+// Returns the average time per conversion over digit counts.
+auto average_ns(const benchmark_result& result) -> double {
+  double sum = 0;
+  for (int digit = 1; digit <= result.num_digits; ++digit)
+    sum += result.per_digit[digit].duration_ns;
+  return sum / result.num_digits;
+}
+
+// Prints methods from the fastest to the slowest with the speedup relative to
+// the slowest one.
+void print_ranking(const char* title, std::vector<ranked_method> ranking,
+                   const char* unit = "ns") {
+  if (ranking.empty()) return;
+  std::sort(ranking.begin(), ranking.end(),
+            [](const ranked_method& lhs, const ranked_method& rhs) {
+              return lhs.ns < rhs.ns;
+            });
+  fmt::print("Ranking of {} methods:\n", title);
+  for (size_t i = 0; i < ranking.size(); ++i) {
+    fmt::print("{:4}. {:28} {:9.3f}{} {:8.2f}x\n", i + 1, ranking[i].name,
+               ranking[i].ns, unit, ranking.back().ns / ranking[i].ns);
+  }
+}
+
+// Prints the random digit times of methods with a footprint next to their
+// total size from the smallest to the largest, marking methods that are faster
+// than all smaller ones, i.e. on the speed versus size frontier.
+void print_size_frontier(const symbol_sizes& symbols,
+                         const std::vector<ranked_method>& times) {
+  struct sized_method {
+    std::string name;
+    double ns;
+    size_t size;
+  };
+  std::vector<sized_method> sized;
+  for (const footprint_method& m : footprint_methods) {
+    auto t = std::find_if(
+        times.begin(), times.end(),
+        [&](const ranked_method& r) { return r.name == m.name; });
+    footprint fp = symbols.measure(m.symbols);
+    size_t size = fp.code_size + fp.table_size;
+    if (t != times.end() && size != 0) sized.push_back({m.name, t->ns, size});
+  }
+  if (sized.empty()) return;
+  std::sort(sized.begin(), sized.end(),
+            [](const sized_method& lhs, const sized_method& rhs) {
+              return lhs.size != rhs.size ? lhs.size < rhs.size
+                                          : lhs.ns < rhs.ns;
+            });
+  fmt::print("Speed versus size (* on the frontier):\n");
+  double best_ns = std::numeric_limits<double>::max();
+  for (const sized_method& m : sized) {
+    bool on_frontier = m.ns < best_ns;
+    best_ns = std::min(best_ns, m.ns);
+    fmt::print("{:>34} {:9.3f}ns {:7} bytes {}\n", m.name, m.ns, m.size,
+               on_frontier ? "*" : "");
+  }
+}
+
+// Returns the core cycles per conversion from the cycles counter if recorded
+// and from the time and the estimated core frequency otherwise. Unlike the
+// time it doesn't depend on the clock speed, e.g. turbo, so it is comparable
+// across machines.
+auto cycles_per_conversion(const digit_result& r) -> double {
+  if (counters && counters->available(perf_cycles)) return r.perf[perf_cycles];
+  return r.duration_ns * r.ghz;
+}
+
+// The file with the samples of every trial, median and standard deviation of
+// results timed with bench_digits, or null if not written.
+FILE* samples_file = nullptr;
+
+// Writes the counter columns of `r`, if counters are enabled, to `f`.
+void write_counters(FILE* f, const digit_result& r) {
+  for (int e = 0; counters && e < num_perf_events; ++e) {
+    if (counters->available(perf_event(e)))
+      fmt::print(f, ",{:f}", r.perf[e]);
+    else
+      fmt::print(f, ",");
+  }
+}
+
+// Writes the trial samples of `r` as a row of the samples file.
+void write_samples(const char* type, const std::string& name, int digit,
+                   const digit_result& r) {
+  if (!samples_file || r.trial_ns.empty()) return;
+  std::vector<double> sorted = r.trial_ns;
+  std::sort(sorted.begin(), sorted.end());
+  size_t n = sorted.size();
+  double median = n % 2 != 0 ? sorted[n / 2]
+                             : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+  double sum_squares = 0;
+  for (double x : sorted) sum_squares += (x - mean) * (x - mean);
+  double stddev = n > 1 ? std::sqrt(sum_squares / double(n - 1)) : 0;
+  fmt::print(samples_file, "{},{},{},{:f},{:f},{:f}", type, name, digit,
+             median, stddev, fmt::join(r.trial_ns, " "));
+  write_counters(samples_file, r);
+  fmt::print(samples_file, "\n");
+}
+
+void write_result(FILE* f, const char* type, const std::string& name,
+                  const benchmark_result& result) {
+  double perf_sum[num_perf_events] = {};
+  for (int digit = 1; digit <= result.num_digits; ++digit) {
+    const digit_result& r = result.per_digit[digit];
+    fmt::print(f, "{},{},{},{:f}", type, name, digit, r.duration_ns);
+    write_counters(f, r);
+    for (int e = 0; e < num_perf_events; ++e) perf_sum[e] += r.perf[e];
+    fmt::print(f, "\n");
+    write_samples(type, name, digit, r);
+  }
+  fmt::print("[{:8.3f}ns, {:8.3f}ns]", result.min_ns, result.max_ns);
+  for (int e = 0; counters && e < num_perf_events; ++e) {
+    if (counters->available(perf_event(e)))
+      fmt::print(" {} {:.2f}", perf_event_names[e],
+                 perf_sum[e] / result.num_digits);
+  }
+  fmt::print("\n");
+}
+
+// Writes percentiles as latency-p<percentile> types.
+void write_latency_result(FILE* f, const std::string& name,
+                          const latency_result& result) {
+  double max_ns[num_latency_percentiles] = {};
+  for (int p = 0; p < num_latency_percentiles; ++p) {
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      double ns = result.ns[digit][p];
+      fmt::print(f, "latency-p{},{},{},{:f}\n", latency_percentiles[p], name,
+                 digit, ns);
+      max_ns[p] = std::max(max_ns[p], ns);
+    }
+  }
+  // Print the worst percentiles across digits.
+  fmt::print("[p50 {:7.3f}ns, p99 {:7.3f}ns, p99.9 {:7.3f}ns]\n", max_ns[0],
+             max_ns[2], max_ns[3]);
+}
+
+// Extracts all numeric tokens, i.e. tokens delimited by whitespace or CSV/JSON
+// punctuation that parse as doubles in their entirety, from text.
+auto parse_numbers(const char* begin, const char* end) -> std::vector<double> {
+  auto is_delimiter = [](char c) {
+    return c == ',' || c == ';' || c == ':' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '"' || c == ' ' || c == '\t' ||
+           c == '\r' || c == '\n';
+  };
+  std::vector<double> values;
+  for (const char* p = begin; p != end;) {
+    if (is_delimiter(*p)) {
+      ++p;
+      continue;
+    }
+    const char* token_end = p;
+    while (token_end != end && !is_delimiter(*token_end)) ++token_end;
+    auto [value, count] = from_chars(p, int(token_end - p));
+    if (count == size_t(token_end - p)) values.push_back(value);
+    p = token_end;
+  }
+  return values;
+}
+
+// Maps a corpus of doubles. Binary files contain raw doubles in native byte
+// order. CSV, JSON and text files are parsed once into a binary cache next to
+// the source file which is reused while it is newer than the source. Methods
+// don't have to handle NaN and infinity, so if the corpus has any, its finite
+// values are copied into `finite` and returned instead.
+auto map_corpus(mapped_file& file, std::vector<double>& finite,
+                const std::string& path) -> std::span<const double> {
+  namespace fs = std::filesystem;
+  std::string ext = fs::path(path).extension().string();
+  std::string binary_path = path;
+  if (ext == ".csv" || ext == ".json" || ext == ".txt") {
+    binary_path = path + ".bin";
+    std::error_code ec;
+    if (!fs::exists(binary_path, ec) ||
+        fs::last_write_time(binary_path, ec) < fs::last_write_time(path, ec)) {
+      if (!file.open(path.c_str())) {
+        fmt::print(stderr, "Failed to open {}: {}\n", path, strerror(errno));
+        exit(1);
+      }
+      const char* text = static_cast<const char*>(file.data());
+      std::vector<double> values = parse_numbers(text, text + file.size());
+      file.close();
+      FILE* f = fopen(binary_path.c_str(), "wb");
+      if (!f || fwrite(values.data(), sizeof(double), values.size(), f) !=
+                    values.size()) {
+        fmt::print(stderr, "Failed to write {}: {}\n", binary_path,
+                   strerror(errno));
+        exit(1);
+      }
+      fclose(f);
+    }
+  }
+  if (!file.open(binary_path.c_str())) {
+    fmt::print(stderr, "Failed to open {}: {}\n", binary_path,
+               strerror(errno));
+    exit(1);
+  }
+  std::span<const double> values(static_cast<const double*>(file.data()),
+                                 file.size() / sizeof(double));
+  if (size_t size = file.size() % sizeof(double); size != 0) {
+    fmt::print(stderr, "warning: ignoring {} trailing bytes in {}\n", size,
+               binary_path);
+  }
+  auto is_finite = [](double value) { return std::isfinite(value); };
+  if (!std::all_of(values.begin(), values.end(), is_finite)) {
+    std::copy_if(values.begin(), values.end(), std::back_inserter(finite),
+                 is_finite);
+    fmt::print(stderr, "warning: ignoring {} non-finite values in {}\n",
+               values.size() - finite.size(), path);
+    values = finite;
+  }
+  if (values.empty()) {
+    fmt::print(stderr, "No values in {}\n", path);
+    exit(1);
+  }
+  return values;
+}
+
+struct corpus_result {
+  double ns = std::numeric_limits<double>::max();
+  double bytes_per_second = 0;
+};
+
+// Converts the whole corpus in each trial reading values directly from the
+// mapping.
+template <typename Dtoa>
+auto bench_corpus(Dtoa dtoa, std::span<const double> corpus, int num_trials)
+    -> corpus_result {
+  char buffer[dtoa_buffer_size] = {};
+  size_t num_bytes = 0;
+  for (double value : corpus)
+    num_bytes += size_t(write_value(dtoa, value, buffer) - buffer);
+
+  duration run_duration = duration::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    for (double value : corpus) dtoa(value, buffer);
+    auto d = std::chrono::steady_clock::now() - start;
+    if (d < run_duration) run_duration = d;
+  }
+  double ns = std::chrono::duration<double, std::nano>(run_duration).count();
+  return {ns / corpus.size(), num_bytes / ns * 1e9};
+}
+
+// A cell of a weight histogram over the number of significant digits and the
+// decimal exponent of the shortest representation, e.g. 1.25e3 has 3 digits
+// and exponent 3.
+struct weighted_cell {
+  int digits;
+  int exp;
+  double weight;
+};
+
+// Returns the number of significant digits and the decimal exponent of the
+// shortest representation of a finite `value`.
+auto get_digits_and_exp(double value) -> std::pair<int, int> {
+  char buffer[32];
+  char* end = std::to_chars(buffer, buffer + sizeof(buffer) - 1, value,
+                            std::chars_format::scientific)
+                  .ptr;
+  *end = '\0';
+  const char* e = std::find(buffer, end, 'e');
+  int digits = 0;
+  for (const char* p = buffer; p != e; ++p) digits += *p >= '0' && *p <= '9';
+  return {digits, atoi(e + 1)};
+}
+
+// Writes the histogram of the digit counts and decimal exponents of the
+// finite values of a corpus to `path` in the format read by read_weights.
+void write_histogram(const std::string& corpus_path, const std::string& path) {
+  mapped_file file;
+  std::vector<double> finite;
+  std::span<const double> corpus = map_corpus(file, finite, corpus_path);
+  std::map<std::pair<int, int>, size_t> counts;
+  for (double value : corpus) ++counts[get_digits_and_exp(value)];
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) {
+    fmt::print(stderr, "Failed to open {}: {}\n", path, strerror(errno));
+    exit(1);
+  }
+  fmt::print(f, "Digits,Exponent,Weight\n");
+  for (const auto& [cell, count] : counts)
+    fmt::print(f, "{},{},{}\n", cell.first, cell.second, count);
+  fclose(f);
+  fmt::print("Wrote the histogram of {} values in {} cells to {}\n",
+             corpus.size(), counts.size(), path);
+}
+
+// Reads a weight histogram with lines `digits,exponent,weight`. Weights are
+// relative, e.g. counts, and lines that don't start with a number such as the
+// header are skipped.
+auto read_weights(const std::string& path) -> std::vector<weighted_cell> {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) {
+    fmt::print(stderr, "Failed to open {}: {}\n", path, strerror(errno));
+    exit(1);
+  }
+  std::vector<weighted_cell> cells;
+  char line[256] = {};
+  while (fgets(line, sizeof(line), f)) {
+    weighted_cell c = {};
+    if (sscanf(line, "%d,%d,%lf", &c.digits, &c.exp, &c.weight) != 3) continue;
+    if (c.digits < 1 || c.digits > max_digits || c.exp < -324 || c.exp > 308 ||
+        !(c.weight >= 0)) {
+      fmt::print(stderr, "Invalid weight in {}: {}", path, line);
+      exit(1);
+    }
+    if (c.weight > 0) cells.push_back(c);
+  }
+  fclose(f);
+  if (cells.empty()) {
+    fmt::print(stderr, "No weights in {}\n", path);
+    exit(1);
+  }
+  return cells;
+}
+
+// Generates `n` values distributed according to the weight histogram
+// `cells` with random significands of the cell's digit count.
+auto generate_weighted_data(const std::vector<weighted_cell>& cells, size_t n)
+    -> std::vector<double> {
+  std::vector<double> cumulative;
+  double total = 0;
+  for (const weighted_cell& c : cells) cumulative.push_back(total += c.weight);
+  std::vector<double> data;
+  data.reserve(n);
+  rng r(random_digit_seed);
+  // Values that overflow at the top of the exponent range are redrawn.
+  for (size_t i = 0; i < n * 10 && data.size() < n; ++i) {
+    double u = double(r.next_uint64() >> 11) * 0x1p-53 * total;
+    size_t index = size_t(
+        std::upper_bound(cumulative.begin(), cumulative.end(), u) -
+        cumulative.begin());
+    const weighted_cell& c = cells[std::min(index, cells.size() - 1)];
+    uint64_t min_sig = 1;
+    for (int d = 1; d < c.digits; ++d) min_sig *= 10;
+    uint64_t sig = min_sig + r.next_uint64() % (min_sig * 9);
+    if (c.digits > 1 && sig % 10 == 0) ++sig;  // Keep the digit count.
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%llue%d", (unsigned long long)sig,
+             c.exp - c.digits + 1);
+    double value = from_chars<double>(buffer).value;
+    if (std::isfinite(value)) data.push_back(value);
+  }
+  return data;
+}
+
+// The initial capacity of the JSON output buffer.
+constexpr size_t min_json_capacity = 4096;
+
+// Serializes `values` as a JSON array into a buffer that starts empty and
+// doubles in size when there is less than dtoa_buffer_size left. Each value
+// is appended at the end of the previous one.
+template <typename Dtoa>
+auto write_json(Dtoa dtoa, std::span<const double> values)
+    -> std::vector<char> {
+  std::vector<char> out;
+  size_t size = 0;
+  auto reserve = [&]() {
+    if (out.size() - size >= dtoa_buffer_size + 2) return;
+    out.resize(std::max(out.size() * 2, min_json_capacity));
+  };
+  reserve();
+  out[size++] = '[';
+  for (size_t i = 0; i < values.size(); ++i) {
+    reserve();
+    if (i != 0) out[size++] = ',';
+    char* p = out.data() + size;
+    size += size_t(write_value(dtoa, values[i], p) - p);
+  }
+  out[size++] = ']';
+  out.resize(size);
+  return out;
+}
+
+struct json_result {
+  double ns = std::numeric_limits<double>::max();  // per value
+  double bytes_per_second = 0;
+};
+
+// Serializes `values` as a JSON array in each trial including the buffer
+// growth.
+template <typename Dtoa>
+auto bench_json(Dtoa dtoa, std::span<const double> values, int num_trials)
+    -> json_result {
+  size_t num_bytes = write_json(dtoa, values).size();
+  duration run_duration = duration::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    write_json(dtoa, values);
+    auto d = std::chrono::steady_clock::now() - start;
+    if (d < run_duration) run_duration = d;
+  }
+  double ns = std::chrono::duration<double, std::nano>(run_duration).count();
+  return {ns / values.size(), num_bytes / ns * 1e9};
+}
+
+struct columnar_result {
+  double ns;  // per value
+  double bytes_per_second;
+};
+
+// Converts all random digit data, about 1.7 million values, as one column.
+auto bench_columnar(columnar_fun convert, int num_trials) -> columnar_result {
+  std::span<const double> column(get_random_digit_data(1),
+                                 num_doubles_per_digit * max_digits);
+  std::vector<char> out(column.size() * columnar_value_size);
+  size_t num_bytes = convert(column, out.data());  // Also touches the pages.
+
+  duration run_duration = duration::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    convert(column, out.data());
+    auto d = std::chrono::steady_clock::now() - start;
+    if (d < run_duration) run_duration = d;
+  }
+  double ns = std::chrono::duration<double, std::nano>(run_duration).count();
+  return {ns / column.size(), num_bytes / ns * 1e9};
+}
+
+// Returns the values of the prices dataset on which fixed column methods are
+// verified and benchmarked.
+auto get_fixed_column_data() -> std::span<const double> {
+  for (int i = 0; i < num_datasets; ++i) {
+    if (strcmp(datasets[i].name, "prices") == 0) return get_dataset(i);
+  }
+  return {};
+}
+
+// Checks that the lines written by a fixed column method parse back to the
+// values.
+void verify(const fixed_column_method& m) {
+  fmt::print("Verifying fixed-column {:7} ... ", m.name);
+  std::span<const double> values = get_fixed_column_data();
+  std::vector<char> out(values.size() * fixed_column_value_size + 1);
+  char* end = m.write(values, out.data());
+  *end = '\0';
+  int num_errors = 0;
+  const char* p = out.data();
+  for (double value : values) {
+    const char* line_end = strchr(p, '\n');
+    if (!line_end) {
+      fmt::print("error: output ends before {}\n", value);
+      return;
+    }
+    std::string line(p, line_end);
+    p = line_end + 1;
+    if (strtod(line.c_str(), nullptr) == value) continue;
+    if (num_errors++ == 0) fmt::print("\n");
+    if (num_errors <= max_reported_failures)
+      fmt::print("error: {} -> '{}'\n", value, line);
+  }
+  if (num_errors == 0) fmt::print("OK\n");
+}
+
+// Writes the prices dataset as one text column.
+auto bench_fixed_column(fixed_column_fun write, int num_trials)
+    -> columnar_result {
+  std::span<const double> column = get_fixed_column_data();
+  std::vector<char> out(column.size() * fixed_column_value_size);
+  size_t num_bytes = size_t(write(column, out.data()) - out.data());
+
+  duration run_duration = duration::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    write(column, out.data());
+    auto d = std::chrono::steady_clock::now() - start;
+    if (d < run_duration) run_duration = d;
+  }
+  double ns = std::chrono::duration<double, std::nano>(run_duration).count();
+  return {ns / column.size(), num_bytes / ns * 1e9};
+}
+
+// Output paths of the CSV benchmark.
+enum class csv_output {
+  mmap,   // A shared mapping of the file synced with msync.
+  fwrite  // Unbuffered writes of 1 MB chunks followed by fsync.
+};
+
+// Writes `values` as rows of `num_columns` comma-separated values starting at
+// `out`. Column c of row r is values[c * num_rows + r] so that columns come
+// from different digit buckets. `out` must have dtoa_buffer_size bytes of
+// slack past the end of the output.
+template <typename Dtoa>
+auto write_csv_row(Dtoa dtoa, std::span<const double> values, size_t row,
+                   int num_columns, char* out) -> char* {
+  size_t num_rows = values.size() / num_columns;
+  for (int c = 0; c < num_columns; ++c) {
+    out = write_value(dtoa, values[c * num_rows + row], out);
+    *out++ = c + 1 < num_columns ? ',' : '\n';
+  }
+  return out;
+}
+
+// Writes the CSV of `values` to the file at `path` and returns its size. The
+// page faults of the output and the writeback to the storage are included.
+template <typename Dtoa>
+auto write_csv_file(Dtoa dtoa, std::span<const double> values, int num_columns,
+                    const char* path, csv_output output, size_t max_size)
+    -> size_t {
+  size_t num_rows = values.size() / num_columns;
+  size_t size = 0;
+#ifndef _WIN32
+  if (output == csv_output::mmap) {
+    int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, off_t(max_size)) != 0) {
+      fmt::print(stderr, "Cannot create {}\n", path);
+      exit(1);
+    }
+    void* data =
+        mmap(nullptr, max_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      fmt::print(stderr, "Cannot map {}\n", path);
+      exit(1);
+    }
+    char* begin = static_cast<char*>(data);
+    char* out = begin;
+    for (size_t r = 0; r < num_rows; ++r)
+      out = write_csv_row(dtoa, values, r, num_columns, out);
+    size = size_t(out - begin);
+    msync(data, max_size, MS_SYNC);
+    munmap(data, max_size);
+    if (ftruncate(fd, off_t(size)) != 0) size = 0;
+    ::close(fd);
+    return size;
+  }
+#endif
+  (void)max_size;
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    fmt::print(stderr, "Cannot create {}\n", path);
+    exit(1);
+  }
+  setvbuf(f, nullptr, _IONBF, 0);  // Write the chunks directly.
+  constexpr size_t chunk_size = 1 << 20;
+  std::vector<char> chunk(chunk_size + num_columns * dtoa_buffer_size);
+  char* out = chunk.data();
+  for (size_t r = 0; r < num_rows; ++r) {
+    out = write_csv_row(dtoa, values, r, num_columns, out);
+    if (size_t(out - chunk.data()) < chunk_size) continue;
+    size += fwrite(chunk.data(), 1, out - chunk.data(), f);
+    out = chunk.data();
+  }
+  size += fwrite(chunk.data(), 1, out - chunk.data(), f);
+#ifndef _WIN32
+  fsync(fileno(f));
+#endif
+  fclose(f);
+  return size;
+}
+
+// Writes all random digit data, about 1.7 million values, as a CSV file with
+// `num_columns` columns in each trial.
+template <typename Dtoa>
+auto bench_csv(Dtoa dtoa, int num_columns, csv_output output, int num_trials)
+    -> json_result {
+  std::span<const double> values(get_random_digit_data(1),
+                                 num_doubles_per_digit * max_digits);
+  values = values.first(values.size() / num_columns * num_columns);
+  const char* path = "results/csv.tmp";
+
+  // Find the output size with an untimed conversion into memory.
+  size_t num_bytes = 0;
+  char row[dtoa_buffer_size * 64];
+  for (size_t r = 0; r < values.size() / num_columns; ++r) {
+    num_bytes +=
+        size_t(write_csv_row(dtoa, values, r, num_columns, row) - row);
+  }
+  size_t max_size = num_bytes + dtoa_buffer_size;
+
+  duration run_duration = duration::max();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    auto start = std::chrono::steady_clock::now();
+    size_t size =
+        write_csv_file(dtoa, values, num_columns, path, output, max_size);
+    auto d = std::chrono::steady_clock::now() - start;
+    if (size != num_bytes) {
+      fmt::print(stderr, "Cannot write {}\n", path);
+      exit(1);
+    }
+    if (d < run_duration) run_duration = d;
+  }
+  std::filesystem::remove(path);
+  double ns = std::chrono::duration<double, std::nano>(run_duration).count();
+  return {ns / values.size(), num_bytes / ns * 1e9};
+}
+
+// The value converted in the first-call benchmark. It has 17 digits and a
+// large exponent so that methods use their tables.
+constexpr double first_call_value = 1.2345678901234567e-89;
+
+struct first_call_result {
+  double ns = 0;
+  double page_faults = 0;
+  double rss_bytes = 0;  // the growth of the resident set size
+};
+
+#ifndef _WIN32
+// Returns the resident set size of this process, or its peak where the
+// current size is not available.
+auto resident_bytes() -> long {
+#  ifdef __linux__
+  long pages = 0;
+  if (FILE* f = fopen("/proc/self/statm", "r")) {
+    if (fscanf(f, "%*s %ld", &pages) != 1) pages = 0;
+    fclose(f);
+    return pages * sysconf(_SC_PAGESIZE);
+  }
+#  endif
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+#  ifdef __APPLE__
+  return usage.ru_maxrss;
+#  else
+  return usage.ru_maxrss * 1024;  // ru_maxrss is in kilobytes.
+#  endif
+}
+#endif
+
+// Converts `first_call_value` once with `m` in this process, which should be
+// freshly started, and prints the time, page faults and resident set growth.
+void run_first_call(const method& m) {
+#ifndef _WIN32
+  rusage before = {}, after = {};
+  // Warm up the measurement itself so that only the conversion faults in
+  // pages.
+  resident_bytes();
+  (void)std::chrono::steady_clock::now();
+  long rss_before = resident_bytes();
+  getrusage(RUSAGE_SELF, &before);
+  char buffer[dtoa_buffer_size];
+  auto start = std::chrono::steady_clock::now();
+  m.visit([&](auto dtoa) { dtoa(first_call_value, buffer); });
+  auto d = std::chrono::steady_clock::now() - start;
+  getrusage(RUSAGE_SELF, &after);
+  long faults = (after.ru_minflt - before.ru_minflt) +
+                (after.ru_majflt - before.ru_majflt);
+  long rss = resident_bytes() - rss_before;
+  fmt::print("first-call {} {} {}\n",
+             std::chrono::duration<double, std::nano>(d).count(), faults, rss);
+#else
+  (void)m;
+#endif
+}
+
+// Runs `command` with `--first-call-child=name` in `num_trials` new processes
+// and returns the median of each measurement.
+auto bench_first_call(const std::string& command, const std::string& name,
+                      int num_trials) -> first_call_result {
+  std::vector<first_call_result> results;
+#ifndef _WIN32
+  std::string child = command + " '--first-call-child=" + name + "'";
+  for (int trial = 0; trial < num_trials; ++trial) {
+    FILE* pipe = popen(child.c_str(), "r");
+    if (!pipe) break;
+    char line[256];
+    first_call_result r;
+    bool found = false;
+    while (fgets(line, sizeof(line), pipe)) {
+      found = sscanf(line, "first-call %lf %lf %lf", &r.ns, &r.page_faults,
+                     &r.rss_bytes) == 3 ||
+              found;
+    }
+    pclose(pipe);
+    if (found) results.push_back(r);
+  }
+#else
+  (void)command, (void)name, (void)num_trials;
+#endif
+  if (results.empty()) return {};
+  auto median = [&](double first_call_result::*field) {
+    std::vector<double> values;
+    for (const first_call_result& r : results) values.push_back(r.*field);
+    std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                     values.end());
+    return values[values.size() / 2];
+  };
+  return {median(&first_call_result::ns),
+          median(&first_call_result::page_faults),
+          median(&first_call_result::rss_bytes)};
+}
+
+// The number of bootstrap resamples in the comparison with a baseline.
+constexpr int num_bootstrap_samples = 10'000;
+
+// Reads the randomdigit times per method and digit count from the results
+// file `filename`, or returns an empty map if it cannot be read.
+auto read_baseline(const std::string& filename)
+    -> std::map<std::string, std::vector<double>> {
+  std::map<std::string, std::vector<double>> result;
+  FILE* f = fopen(filename.c_str(), "r");
+  if (!f) return result;
+  char line[4096] = {};
+  while (fgets(line, sizeof(line), f)) {
+    // Type,Function,Digit,Time(ns)[,counters...]
+    std::string_view s = line;
+    size_t type_end = s.find(',');
+    if (s.substr(0, type_end) != "randomdigit") continue;
+    size_t name_end = s.find(',', type_end + 1);
+    size_t digit_end = s.find(',', name_end + 1);
+    if (digit_end == std::string_view::npos) continue;
+    std::string name(s.substr(type_end + 1, name_end - type_end - 1));
+    int digit = atoi(line + name_end + 1);
+    std::vector<double>& times = result[name];
+    if (digit < 1 || digit > max_bench_digits) continue;
+    if (times.size() <= size_t(digit)) times.resize(size_t(digit) + 1);
+    times[size_t(digit)] = atof(line + digit_end + 1);
+  }
+  fclose(f);
+  return result;
+}
+
+// Reads the randomdigit trial times per method and digit count from the
+// samples file written next to the results file `filename`, or returns an
+// empty map if there is none, e.g. for results written before the samples.
+auto read_baseline_samples(const std::string& filename)
+    -> std::map<std::string, std::vector<std::vector<double>>> {
+  std::map<std::string, std::vector<std::vector<double>>> result;
+  if (!filename.ends_with(".csv")) return result;
+  std::string samples_filename =
+      filename.substr(0, filename.size() - 4) + ".samples.csv";
+  FILE* f = fopen(samples_filename.c_str(), "r");
+  if (!f) return result;
+  std::vector<char> line(1 << 16);
+  while (fgets(line.data(), int(line.size()), f)) {
+    // Type,Function,Digit,Median(ns),Stddev(ns),Samples(ns)[,counters...]
+    std::string_view s = line.data();
+    size_t type_end = s.find(',');
+    if (s.substr(0, type_end) != "randomdigit") continue;
+    size_t name_end = s.find(',', type_end + 1);
+    size_t digit_end = s.find(',', name_end + 1);
+    size_t median_end = s.find(',', digit_end + 1);
+    size_t stddev_end = s.find(',', median_end + 1);
+    if (stddev_end == std::string_view::npos) continue;
+    std::string name(s.substr(type_end + 1, name_end - type_end - 1));
+    int digit = atoi(line.data() + name_end + 1);
+    if (digit < 1 || digit > max_bench_digits) continue;
+    std::vector<std::vector<double>>& samples = result[name];
+    if (samples.size() <= size_t(digit)) samples.resize(size_t(digit) + 1);
+    const char* p = line.data() + stddev_end + 1;
+    for (;;) {
+      char* end = nullptr;
+      double ns = strtod(p, &end);
+      if (end == p) break;
+      samples[size_t(digit)].push_back(ns);
+      p = end;
+    }
+  }
+  fclose(f);
+  return result;
+}
+
+// The ratio of the current to the baseline time of a method, the geometric
+// mean over digit counts, with a 95% bootstrap confidence interval.
+struct comparison {
+  double ratio;
+  double lower;
+  double upper;
+};
+
+// Returns the median of `values` reordering them.
+auto median_of(std::vector<double>& values) -> double {
+  auto mid = values.begin() + values.size() / 2;
+  std::nth_element(values.begin(), mid, values.end());
+  return *mid;
+}
+
+// Compares the trial times of `current` with the `baseline` trial times per
+// digit count. The ratio is the geometric mean over digit counts of the
+// ratios of the medians. The trials of both runs are resampled with
+// replacement per digit count to estimate its distribution, so that noisy
+// trials widen the interval.
+auto compare_samples(const benchmark_result& current,
+                     const std::vector<std::vector<double>>& baseline)
+    -> comparison {
+  std::vector<std::pair<const std::vector<double>*, const std::vector<double>*>>
+      digits;
+  for (int digit = 1; digit <= current.num_digits; ++digit) {
+    const std::vector<double>& trials = current.per_digit[digit].trial_ns;
+    if (size_t(digit) >= baseline.size() || baseline[size_t(digit)].empty() ||
+        trials.empty()) {
+      continue;
+    }
+    digits.push_back({&trials, &baseline[size_t(digit)]});
+  }
+  if (digits.empty()) return {1, 1, 1};
+  std::mt19937 rng(random_digit_seed);
+  std::vector<double> cur, base;
+  auto mean_log_ratio = [&](bool resample) {
+    auto fill = [&](std::vector<double>& out, const std::vector<double>& in) {
+      out = in;
+      if (!resample) return;
+      std::uniform_int_distribution<size_t> pick(0, in.size() - 1);
+      for (double& x : out) x = in[pick(rng)];
+    };
+    double sum = 0;
+    for (auto [current_trials, baseline_trials] : digits) {
+      fill(cur, *current_trials);
+      fill(base, *baseline_trials);
+      sum += std::log(median_of(cur) / median_of(base));
+    }
+    return sum / double(digits.size());
+  };
+  std::vector<double> means(num_bootstrap_samples);
+  for (double& m : means) m = mean_log_ratio(true);
+  std::sort(means.begin(), means.end());
+  return {std::exp(mean_log_ratio(false)),
+          std::exp(means[size_t(num_bootstrap_samples * 0.025)]),
+          std::exp(means[size_t(num_bootstrap_samples * 0.975)])};
+}
+
+// Compares per-digit times `current` and `baseline` paired by digit count
+// for baselines without samples. The digit counts are resampled with
+// replacement to estimate the distribution of the mean log ratio. This only
+// reflects how the ratio varies across digit counts, not the noise of the
+// measurements, so a uniform shift such as a change of clock speed looks
+// significant.
+auto compare_times(const benchmark_result& current,
+                   const std::vector<double>& baseline) -> comparison {
+  std::vector<double> log_ratios;
+  for (int digit = 1; digit <= current.num_digits; ++digit) {
+    if (size_t(digit) >= baseline.size() || baseline[size_t(digit)] <= 0)
+      continue;
+    log_ratios.push_back(std::log(current.per_digit[digit].duration_ns /
+                                  baseline[size_t(digit)]));
+  }
+  if (log_ratios.empty()) return {1, 1, 1};
+  auto mean = [](const std::vector<double>& v) {
+    return std::accumulate(v.begin(), v.end(), 0.0) / double(v.size());
+  };
+  std::mt19937 rng(random_digit_seed);
+  std::uniform_int_distribution<size_t> pick(0, log_ratios.size() - 1);
+  std::vector<double> means(num_bootstrap_samples);
+  std::vector<double> sample(log_ratios.size());
+  for (double& m : means) {
+    for (double& x : sample) x = log_ratios[pick(rng)];
+    m = mean(sample);
+  }
+  std::sort(means.begin(), means.end());
+  return {std::exp(mean(log_ratios)),
+          std::exp(means[size_t(num_bootstrap_samples * 0.025)]),
+          std::exp(means[size_t(num_bootstrap_samples * 0.975)])};
+}
+
+// Reruns the random digit benchmark of `names`, or of all methods in the
+// baseline if empty, and compares them with the baseline results file.
+// Returns 1 if a method is significantly slower, i.e. the lower bound of the
+// confidence interval of its ratio to the baseline is above 1 + `threshold`.
+auto compare_with_baseline(const std::string& filename,
+                           const std::vector<std::string>& names,
+                           double threshold, int num_trials) -> int {
+  std::map<std::string, std::vector<double>> baseline = read_baseline(filename);
+  if (baseline.empty()) {
+    fmt::print(stderr, "No randomdigit results in {}\n", filename);
+    return 1;
+  }
+  std::map<std::string, std::vector<std::vector<double>>> baseline_samples =
+      read_baseline_samples(filename);
+  fmt::print("Comparing with {}\n", filename);
+  int num_regressions = 0;
+  for (const method& m : methods) {
+    if (!names.empty() &&
+        std::find(names.begin(), names.end(), m.name) == names.end()) {
+      continue;
+    }
+    auto base = baseline.find(m.name);
+    if (base == baseline.end()) continue;
+    fmt::print("Benchmarking randomdigit {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result result = m.visit([&](auto dtoa) {
+      return bench_random_digit(dtoa, m.name, num_trials);
+    });
+    auto samples = baseline_samples.find(m.name);
+    bool has_samples = samples != baseline_samples.end();
+    comparison c = has_samples ? compare_samples(result, samples->second)
+                               : compare_times(result, base->second);
+    bool regressed = c.lower > 1 + threshold;
+    bool improved = c.upper < 1 - threshold;
+    fmt::print("{:6.3f}x [{:.3f}, {:.3f}] {}{}\n", c.ratio, c.lower, c.upper,
+               regressed  ? "SLOWER"
+               : improved ? "faster"
+                          : "same",
+               has_samples ? "" : " (fallback: no baseline samples)");
+    num_regressions += regressed;
+  }
+  if (num_regressions == 0) return 0;
+  fmt::print("{} methods are significantly slower than the baseline\n",
+             num_regressions);
+  return 1;
+}
+
+// Reads the random digit results of builds with `num_layouts` randomized code
+// layouts from `<prefix>-layout-<seed>.csv` and writes the average time of
+// each method per layout with their mean and standard deviation to
+// `<prefix>-layouts.csv`. Prints the spread across layouts which bounds the
+// differences in time that code placement alone can cause.
+auto report_layouts(const std::string& prefix, int num_layouts) -> int {
+  // The average times of methods over digit counts, one per layout.
+  std::map<std::string, std::vector<double>> times;
+  for (int seed = 1; seed <= num_layouts; ++seed) {
+    std::string filename = fmt::format("{}-layout-{}.csv", prefix, seed);
+    std::map<std::string, std::vector<double>> results =
+        read_baseline(filename);
+    if (results.empty()) {
+      fmt::print(stderr, "No randomdigit results in {}\n", filename);
+      return 1;
+    }
+    for (const auto& [name, per_digit] : results) {
+      double sum = 0;
+      int count = 0;
+      for (double t : per_digit) {
+        if (t <= 0) continue;
+        sum += t;
+        ++count;
+      }
+      if (count == 0) continue;
+      std::vector<double>& t = times[name];
+      t.resize(size_t(num_layouts));
+      t[size_t(seed - 1)] = sum / count;
+    }
+  }
+
+  std::string filename = prefix + "-layouts.csv";
+  FILE* f = fopen(filename.c_str(), "w");
+  if (!f) {
+    fmt::print(stderr, "Failed to open {}: {}", filename, strerror(errno));
+    return 1;
+  }
+  fmt::print(f, "Type,Function,Digit,Time(ns)\n");
+  struct layout_stats {
+    std::string name;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+  };
+  std::vector<layout_stats> stats;
+  for (const auto& [name, t] : times) {
+    // Methods missing from some layouts, e.g. plugins, are left out.
+    if (std::find(t.begin(), t.end(), 0.0) != t.end()) continue;
+    double n = double(t.size());
+    double mean = std::accumulate(t.begin(), t.end(), 0.0) / n;
+    double sum_squares = 0;
+    for (double x : t) sum_squares += (x - mean) * (x - mean);
+    double stddev = t.size() > 1 ? std::sqrt(sum_squares / (n - 1)) : 0;
+    for (size_t i = 0; i < t.size(); ++i)
+      fmt::print(f, "layout,{},{},{:f}\n", name, i + 1, t[i]);
+    fmt::print(f, "layout-mean,{},0,{:f}\n", name, mean);
+    fmt::print(f, "layout-stddev,{},0,{:f}\n", name, stddev);
+    auto [min, max] = std::minmax_element(t.begin(), t.end());
+    stats.push_back({name, mean, stddev, *min, *max});
+  }
+  fclose(f);
+
+  std::sort(stats.begin(), stats.end(),
+            [](const layout_stats& lhs, const layout_stats& rhs) {
+              return lhs.mean < rhs.mean;
+            });
+  fmt::print("Random digit times across {} layouts:\n", num_layouts);
+  fmt::print("{:28} {:>11} {:>11} {:>11} {:>11} {:>8}\n", "method", "mean",
+             "stddev", "min", "max", "spread");
+  for (const layout_stats& s : stats) {
+    fmt::print("{:28} {:9.3f}ns {:9.3f}ns {:9.3f}ns {:9.3f}ns {:7.2f}%\n",
+               s.name, s.mean, s.stddev, s.min, s.max,
+               100 * (s.max - s.min) / s.mean);
+  }
+  return 0;
+}
+
+// Tracks that run after the random digit benchmark when selected with
+// --tracks. They are off by default to keep the default run short.
+constexpr const char* track_names[] = {
+    "chain",     "mixed",     "exponent",     "datasets",      "json",
+    "batch",     "hex",       "float",        "float16",       "longdouble",
+    "float128",  "columnar",  "fixed-column", "parse",         "parsehard",
+    "digits",    "itoa",      "decimal",      "float-decimal", "format",
+    "decimal64", "precision", "bounded",      "wide"};
+
+struct options {
+  std::string commit_hash;
+  int num_trials = 10;
+  // The tracks from track_names to run.
+  std::set<std::string> tracks;
+  // The maximum number of threads in the threaded benchmark, 0 to disable it.
+  int max_threads = 0;
+  // Whether to measure the per-call latency distribution.
+  bool latency = false;
+  // Whether to record hardware performance counters.
+  bool perf = false;
+  // Whether to count heap allocations per conversion.
+  bool allocs = false;
+  // Whether to measure the peak stack usage of methods.
+  bool stack = false;
+  // Whether to interleave the random digit trials of all methods.
+  bool interleave = false;
+  // The number of columns in the CSV benchmark, 0 to disable it.
+  int csv_columns = 0;
+  // The size of the data in the streaming benchmark, 0 to disable it.
+  size_t stream_size = 0;
+  // Whether to compare node-local and remote data on NUMA systems.
+  bool numa = false;
+  // The method run on the SMT sibling in the smt-partner results, empty to
+  // disable the SMT benchmark.
+  std::string smt_partner;
+  // The number of values per batch in the pipeline benchmark, 0 to disable it.
+  int pipeline_batch_size = 0;
+  // Whether to benchmark round trips through every pair of method and parser.
+  bool roundtrip = false;
+  // Whether to benchmark parsing columns written by every method.
+  bool column_parse = false;
+  // Whether to benchmark sorted and shuffled orders of the random digit data.
+  bool orderings = false;
+  // Whether to sweep the offset of the output buffer.
+  bool offsets = false;
+  // Whether to measure the energy per conversion.
+  bool energy = false;
+  // Whether to measure the top-down breakdown of pipeline slots.
+  bool topdown = false;
+  // Whether to benchmark methods with the output rewritten in one notation.
+  bool normalize = false;
+  // The number of bytes of scratch memory read between conversions in the
+  // cold-cache benchmark, 0 to disable it.
+  size_t cold_evict_size = 0;
+  // Percentages of zeros, integers and subnormals in the mixed benchmark.
+  double mixed_weights[num_special_kinds] = {1, 10, 1};
+  // A file of doubles to benchmark in addition to the random digit data.
+  std::string corpus;
+  // The number of random doubles to verify in parallel, 0 to disable.
+  uint64_t verify_count = 0;
+  // The number of doubles to compare across methods, 0 to disable.
+  uint64_t diff_count = 0;
+  // Whether to verify float methods on all finite floats.
+  bool verify_floats = false;
+  // Plugins or directories of plugins to load.
+  std::vector<std::string> plugins;
+  // A results file to compare the random digit times with instead of running
+  // the benchmarks, empty to disable.
+  std::string baseline;
+  // The methods to compare with the baseline, empty for all.
+  std::vector<std::string> compare_methods;
+  // The ratio to the baseline above which a significant slowdown fails.
+  double threshold = 0.02;
+  // Whether to measure the first call of each method in a new process.
+  bool first_call = false;
+  // The method to call once in a child process of the first-call benchmark.
+  std::string first_call_child;
+  // A weight histogram over digit counts and decimal exponents to compute a
+  // weighted score with, empty to disable.
+  std::string weights;
+  // A file to write the histogram of the corpus to instead of benchmarking.
+  std::string histogram;
+  // A pattern of 'f' and 'd' for the precisions of values in the mixed float
+  // and double benchmark, empty to disable it.
+  std::string float_mix;
+  // Whether to only run the random digit benchmark without writing results,
+  // e.g. to train a profile-guided build.
+  bool train = false;
+  // Whether to only run and write the random digit benchmark, e.g. in each
+  // build of run-benchmark-layouts.
+  bool random_digit_only = false;
+  // The number of randomized code layouts whose results to report instead of
+  // running the benchmarks, 0 to disable.
+  int num_layouts = 0;
+  // Repeat rates in percent of the memoization benchmark, empty to disable
+  // it.
+  std::vector<int> memoize_rates;
+  // Whether to reuse the cached results of methods whose sources, build and
+  // options haven't changed instead of running them.
+  bool incremental = false;
+  // Methods to run in an incremental run even if they have cached results.
+  std::vector<std::string> force_methods;
+  // The options that affect results, i.e. all but the incremental ones,
+  // which are part of the key of cached results.
+  std::string result_args;
+
+  auto has_track(const std::string& name) const -> bool {
+    return tracks.count(name) != 0;
+  }
+};
+
+// Returns `value` of the command-line argument `arg` parsed as a number or
+// exits with a usage error if it is not one.
+template <typename T>
+auto parse_number(const std::string& arg, const std::string& value) -> T {
+  T result = 0;
+  const char* end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, result);
+  if (ec != std::errc() || ptr != end || value.empty()) {
+    fmt::print(stderr, "Invalid number in {}\n", arg);
+    exit(1);
+  }
+  return result;
+}
+
+// Parses command-line arguments:
+//   dtoa-benchmark [commit-hash [num-trials]] [--threads[=N]] [--numa]
+//                  [--smt[=PARTNER]] [--pipeline[=BATCH]] [--roundtrip]
+//                  [--column-parse] [--orderings] [--offsets] [--normalize]
+//                  [--energy] [--topdown] [--float-mix[=PATTERN]]
+//                  [--memoize[=PERCENT,...]] [--latency] [--perf] [--allocs]
+//                  [--stack] [--interleave] [--csv[=COLUMNS]] [--stream[=MB]]
+//                  [--cold[=KB]] [--mixed=KIND:PERCENT,...] [--corpus=FILE]
+//                  [--histogram=FILE] [--weights=FILE] [--verify=N]
+//                  [--verify-floats] [--diff=N] [--first-call]
+//                  [--baseline=FILE] [--compare=METHOD,...]
+//                  [--threshold=PERCENT] [--train] [--plugin=PATH...]
+//                  [--incremental] [--force=METHOD,...] [--random-digit-only]
+//                  [--layouts=N] [--tracks=TRACK,...|all]
+auto parse_options(int argc, char** argv) -> options {
+  options opts;
+  int pos = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (!arg.starts_with("--")) {
+      if (pos == 0) opts.commit_hash = "_" + arg;
+      if (pos == 1) opts.num_trials = parse_number<int>(arg, arg);
+      ++pos;
+      continue;
+    }
+    size_t eq = arg.find('=');
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = eq != std::string::npos ? arg.substr(eq + 1) : "";
+    if (name != "incremental" && name != "force")
+      opts.result_args += arg + ' ';
+    if (name == "threads") {
+      opts.max_threads =
+          value.empty() ? num_cpus() : parse_number<int>(arg, value);
+    } else if (name == "numa") {
+      opts.numa = true;
+    } else if (name == "roundtrip") {
+      opts.roundtrip = true;
+    } else if (name == "column-parse") {
+      opts.column_parse = true;
+    } else if (name == "pipeline") {
+      opts.pipeline_batch_size =
+          std::clamp(value.empty() ? 256 : parse_number<int>(arg, value), 1,
+                     num_doubles_per_digit);
+    } else if (name == "smt") {
+      opts.smt_partner = value.empty() ? "zmij" : value;
+    } else if (name == "baseline") {
+      opts.baseline = value;
+    } else if (name == "compare") {
+      for (size_t pos = 0; pos < value.size();) {
+        size_t end = std::min(value.find(',', pos), value.size());
+        opts.compare_methods.push_back(value.substr(pos, end - pos));
+        pos = end + 1;
+      }
+    } else if (name == "threshold") {
+      opts.threshold = parse_number<double>(arg, value) / 100;
+    } else if (name == "orderings") {
+      opts.orderings = true;
+    } else if (name == "offsets") {
+      opts.offsets = true;
+    } else if (name == "energy") {
+      opts.energy = true;
+    } else if (name == "topdown") {
+      opts.topdown = true;
+    } else if (name == "normalize") {
+      opts.normalize = true;
+    } else if (name == "latency") {
+      opts.latency = true;
+    } else if (name == "perf") {
+      opts.perf = true;
+    } else if (name == "allocs") {
+      opts.allocs = true;
+    } else if (name == "stack") {
+      opts.stack = true;
+    } else if (name == "interleave") {
+      opts.interleave = true;
+    } else if (name == "csv") {
+      // Rows are converted into a stack buffer, hence the limit.
+      opts.csv_columns = value.empty()
+                             ? 8
+                             : std::clamp(parse_number<int>(arg, value), 1, 64);
+    } else if (name == "stream") {
+      opts.stream_size =
+          size_t(value.empty() ? 256 : parse_number<int>(arg, value)) << 20;
+    } else if (name == "cold") {
+      // The default is the size of a typical L2 cache.
+      size_t kb = value.empty() ? 1024 : parse_number<size_t>(arg, value);
+      if (kb == 0 || kb > cold_scratch_size >> 10) {
+        fmt::print(stderr,
+                   "Invalid cold eviction size, expected 1 to {} KB: {}\n",
+                   cold_scratch_size >> 10, arg);
+        exit(1);
+      }
+      opts.cold_evict_size = kb << 10;
+    } else if (name == "mixed") {
+      // Comma-separated kind:percent pairs, e.g. zero:5,integer:60.
+      for (size_t pos = 0; pos < value.size();) {
+        size_t end = std::min(value.find(',', pos), value.size());
+        std::string item = value.substr(pos, end - pos);
+        size_t colon = item.find(':');
+        auto kind = std::find(std::begin(special_kind_names),
+                              std::end(special_kind_names),
+                              item.substr(0, colon));
+        if (colon == std::string::npos ||
+            kind == std::end(special_kind_names)) {
+          fmt::print(stderr, "Invalid mixed weight: {}\n", item);
+          exit(1);
+        }
+        opts.mixed_weights[kind - std::begin(special_kind_names)] =
+            parse_number<double>(arg, item.substr(colon + 1));
+        pos = end + 1;
+      }
+    } else if (name == "corpus") {
+      opts.corpus = value;
+    } else if (name == "float-mix") {
+      opts.float_mix = value.empty() ? "fd" : value;
+      if (opts.float_mix.find_first_not_of("fd") != std::string::npos) {
+        fmt::print(stderr, "Invalid float mix pattern: {}\n", value);
+        exit(1);
+      }
+    } else if (name == "histogram") {
+      opts.histogram = value;
+    } else if (name == "weights") {
+      opts.weights = value;
+    } else if (name == "verify") {
+      // Parse as double to allow counts like 1e9.
+      opts.verify_count = uint64_t(parse_number<double>(arg, value));
+    } else if (name == "diff") {
+      opts.diff_count = uint64_t(parse_number<double>(arg, value));
+    } else if (name == "verify-floats") {
+      opts.verify_floats = true;
+    } else if (name == "first-call") {
+      opts.first_call = true;
+    } else if (name == "first-call-child") {
+      opts.first_call_child = value;
+    } else if (name == "train") {
+      opts.train = true;
+    } else if (name == "random-digit-only") {
+      opts.random_digit_only = true;
+    } else if (name == "layouts") {
+      opts.num_layouts = parse_number<int>(arg, value);
+    } else if (name == "memoize") {
+      std::string rates = value.empty() ? "0,25,50,75,90,99" : value;
+      for (size_t pos = 0; pos < rates.size();) {
+        size_t end = std::min(rates.find(',', pos), rates.size());
+        int rate = parse_number<int>(arg, rates.substr(pos, end - pos));
+        if (rate < 0 || rate > 100) {
+          fmt::print(stderr, "Invalid repeat rate: {}\n", rate);
+          exit(1);
+        }
+        opts.memoize_rates.push_back(rate);
+        pos = end + 1;
+      }
+      std::sort(opts.memoize_rates.begin(), opts.memoize_rates.end());
+    } else if (name == "plugin") {
+      opts.plugins.push_back(value);
+    } else if (name == "incremental") {
+      opts.incremental = true;
+    } else if (name == "tracks") {
+      for (size_t pos = 0; pos < value.size();) {
+        size_t end = std::min(value.find(',', pos), value.size());
+        std::string track = value.substr(pos, end - pos);
+        if (track == "all") {
+          opts.tracks.insert(std::begin(track_names), std::end(track_names));
+        } else if (std::find(std::begin(track_names), std::end(track_names),
+                             track) != std::end(track_names)) {
+          opts.tracks.insert(track);
+        } else {
+          fmt::print(stderr, "Unknown track: {}\n", track);
+          exit(1);
+        }
+        pos = end + 1;
+      }
+    } else if (name == "force") {
+      for (size_t pos = 0; pos < value.size();) {
+        size_t end = std::min(value.find(',', pos), value.size());
+        opts.force_methods.push_back(value.substr(pos, end - pos));
+        pos = end + 1;
+      }
+    } else {
+      fmt::print(stderr, "Unknown option: {}\n", arg);
+      exit(1);
+    }
+  }
+  return opts;
+}
+
+// Cached results of an incremental run.
+struct incremental_run {
+  result_cache cache{"results/cache/methods"};
+  // The keys of the methods that are run to store their results with.
+  std::map<std::string, uint64_t> keys;
+  // The result and sample rows of the methods that are skipped.
+  std::string rows;
+  std::string samples;
+};
+
+// Removes the methods `names` from every kind of method.
+void remove_methods(const std::set<std::string>& names) {
+  auto remove = [&](auto& v) {
+    std::erase_if(v, [&](const auto& m) { return names.count(m.name) != 0; });
+  };
+  remove(methods);
+  remove(range_methods);
+  remove(fallback_methods);
+  remove(path_methods);
+  remove(footprint_methods);
+  remove(inline_methods);
+  remove(prefetch_methods);
+  remove(batch_methods);
+  remove(parallel_methods);
+  remove(hex_methods);
+  remove(float_methods);
+  remove(float16_methods);
+#if LDBL_MANT_DIG == 64
+  remove(long_double_methods);
+#endif
+#ifdef __SIZEOF_FLOAT128__
+  remove(float128_methods);
+#endif
+  remove(columnar_methods);
+  remove(fixed_column_methods);
+  remove(parse_methods);
+  remove(column_parse_methods);
+  remove(digits_methods);
+  remove(itoa_methods);
+  remove(decimal_methods);
+  remove(float_decimal_methods);
+  remove(format_methods);
+  remove(decimal64_methods);
+  remove(precision_methods);
+  remove(bounded_methods);
+  remove(wide_methods);
+}
+
+// Loads the cached results of methods whose key, a hash of their sources, the
+// harness, the build, the machine and the options, matches an earlier run and
+// removes them so that only changed methods are run. The null method and the
+// SMT partner always run because other results are computed from them.
+auto start_incremental_run(const options& opts, const char* executable)
+    -> incremental_run {
+  incremental_run run;
+  std::filesystem::path root = std::filesystem::path(__FILE__).parent_path();
+  source_hasher hasher(root.string(),
+                       {root.string(), (root / "fmt/include").string()});
+  uint64_t base_key = hash_bytes(fmt::format(
+      "{}\n{}\n{}\n{}\n{}\n{}\n{}", MACHINE, os_name(), compiler_name(),
+      BUILD_FLAGS, std::filesystem::path(executable).filename().string(),
+      opts.num_trials, opts.result_args));
+  base_key = hasher.hash(hasher.find_sources(__FILE__), base_key);
+
+  std::map<std::string, std::vector<std::string>> sources;
+  for (const method_source& s : method_sources) {
+    std::vector<std::string>& files = sources[s.name];
+    std::vector<std::string> more = hasher.find_sources(s.file);
+    files.insert(files.end(), more.begin(), more.end());
+  }
+  std::set<std::string> skipped;
+  for (auto& [name, files] : sources) {
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    uint64_t key = hasher.hash(files, base_key);
+    bool force = name == "null" || name == opts.smt_partner ||
+                 std::find(opts.force_methods.begin(), opts.force_methods.end(),
+                           name) != opts.force_methods.end();
+    std::string rows, samples;
+    if (!force && run.cache.load(name, key, rows, samples)) {
+      run.rows += rows;
+      run.samples += samples;
+      skipped.insert(name);
+    } else {
+      run.keys[name] = key;
+    }
+  }
+  remove_methods(skipped);
+  fmt::print("Reusing cached results of {} methods, running {}\n",
+             skipped.size(), run.keys.size());
+  return run;
+}
+
+// Stores the results of the methods that were run and appends the cached
+// results of the skipped ones. Rows that aren't keyed by the name of a single
+// method, e.g. of round trips through a pair of methods, are only written for
+// the methods that were run.
+void finish_incremental_run(const incremental_run& run, FILE* f,
+                            const std::string& filename) {
+  std::string samples_filename =
+      filename.substr(0, filename.size() - 4) + ".samples.csv";
+  fflush(f);
+  fflush(samples_file);
+  rows_by_function rows = read_rows(filename.c_str());
+  rows_by_function samples = read_rows(samples_filename.c_str());
+  for (const auto& [name, key] : run.keys) {
+    auto it = rows.find(name);
+    if (it == rows.end()) continue;
+    if (!run.cache.store(name, key, it->second, samples[name]))
+      fmt::print(stderr, "warning: failed to cache the results of {}\n", name);
+  }
+  fmt::print(f, "{}", run.rows);
+  fmt::print(samples_file, "{}", run.samples);
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  options opts = parse_options(argc, argv);
+  int num_trials = opts.num_trials;
+
+  plugin_registry registry = {
+      plugin_interface_version,
+      [](const char* name, dtoa_fun dtoa, const method_info& info) {
+        methods.push_back(method{name, dtoa, nullptr, info});
+      },
+      [](const char* name, dtoa_end_fun dtoa, const method_info& info) {
+        methods.push_back(method{name, nullptr, dtoa, info});
+      }};
+  for (const std::string& path : opts.plugins) {
+    if (!load_plugins(path, registry)) return 1;
+  }
+
+  auto by_name = [](const auto& lhs, const auto& rhs) {
+    return lhs.name < rhs.name;
+  };
+  std::sort(methods.begin(), methods.end(), by_name);
+  std::sort(batch_methods.begin(), batch_methods.end(), by_name);
+  std::sort(parallel_methods.begin(), parallel_methods.end(), by_name);
+  std::sort(float_methods.begin(), float_methods.end(), by_name);
+  std::sort(hex_methods.begin(), hex_methods.end(), by_name);
+  std::sort(float16_methods.begin(), float16_methods.end(), by_name);
+#if LDBL_MANT_DIG == 64
+  std::sort(long_double_methods.begin(), long_double_methods.end(), by_name);
+#endif
+#if BENCH_FLOAT128
+  std::sort(float128_methods.begin(), float128_methods.end(), by_name);
+#endif
+  std::sort(parse_methods.begin(), parse_methods.end(), by_name);
+  std::sort(column_parse_methods.begin(), column_parse_methods.end(), by_name);
+  std::sort(columnar_methods.begin(), columnar_methods.end(), by_name);
+  std::sort(fixed_column_methods.begin(), fixed_column_methods.end(), by_name);
+  std::sort(digits_methods.begin(), digits_methods.end(), by_name);
+  std::sort(itoa_methods.begin(), itoa_methods.end(), by_name);
+  std::sort(decimal_methods.begin(), decimal_methods.end(), by_name);
+  std::sort(float_decimal_methods.begin(), float_decimal_methods.end(),
+            by_name);
+  std::sort(format_methods.begin(), format_methods.end(), by_name);
+  std::sort(decimal64_methods.begin(), decimal64_methods.end(), by_name);
+  std::sort(precision_methods.begin(), precision_methods.end(), by_name);
+  std::sort(bounded_methods.begin(), bounded_methods.end(), by_name);
+  std::sort(wide_methods.begin(), wide_methods.end(), by_name);
+  std::sort(range_methods.begin(), range_methods.end(), by_name);
+
+  if (!opts.first_call_child.empty()) {
+    for (const method& m : methods) {
+      if (m.name == opts.first_call_child) run_first_call(m);
+    }
+    return 0;
+  }
+
+  if (!opts.histogram.empty()) {
+    if (opts.corpus.empty()) {
+      fmt::print(stderr, "--histogram requires --corpus\n");
+      return 1;
+    }
+    write_histogram(opts.corpus, opts.histogram);
+    return 0;
+  }
+
+  if (opts.train) {
+    for (const method& m : methods) {
+      fmt::print("Training {} ...\n", m.name);
+      fflush(stdout);
+      m.visit([&](auto dtoa) { bench_random_digit(dtoa, m.name, num_trials); });
+    }
+    return 0;
+  }
+
+  if (opts.num_layouts != 0) {
+    return report_layouts(
+        fmt::format("results/{}_{}_{}{}", MACHINE, os_name(),
+                    compiler_name(), opts.commit_hash),
+        opts.num_layouts);
+  }
+
+  incremental_run run;
+  if (opts.incremental && opts.baseline.empty())
+    run = start_incremental_run(opts, argv[0]);
+
+  for (const method& m : methods) verify(m);
+  for (const batch_method& m : batch_methods) verify(m);
+  for (const parallel_method& m : parallel_methods) verify(m);
+  for (const float_method& m : float_methods) verify(m);
+  for (const hex_method& m : hex_methods) verify(m);
+  for (const float16_method& m : float16_methods) verify(m);
+#if LDBL_MANT_DIG == 64
+  for (const long_double_method& m : long_double_methods) verify(m);
+#endif
+#if BENCH_FLOAT128
+  for (const float128_method& m : float128_methods) verify(m);
+#endif
+  for (const parse_method& m : parse_methods) verify(m);
+  for (const parse_method& m : parse_methods) verify_hard(m);
+  for (const column_parse_method& m : column_parse_methods) verify(m);
+  for (const digits_method& m : digits_methods) verify(m);
+  for (const itoa_method& m : itoa_methods) verify(m);
+  for (const decimal_method& m : decimal_methods) verify(m);
+  for (const float_decimal_method& m : float_decimal_methods) verify(m);
+  for (const format_method& m : format_methods) verify(m);
+  for (const decimal64_method& m : decimal64_methods) verify(m);
+  for (const precision_method& m : precision_methods) verify(m);
+  for (const bounded_method& m : bounded_methods) verify(m);
+  for (const wide_method& m : wide_methods) verify(m);
+  for (const range_method& m : range_methods) verify(m);
+  for (const fixed_column_method& m : fixed_column_methods) verify(m);
+  if (opts.verify_count != 0) {
+    fmt::print("Verifying {} random doubles on {} threads\n",
+               opts.verify_count, num_cpus());
+    for (const method& m : methods) verify_random(m, opts.verify_count);
+  }
+  if (opts.diff_count != 0) {
+    // The standard library's method is the reference where available. Plain
+    // to_chars prints integers exactly in fixed notation, i.e. not always with
+    // the shortest digits, so the scientific one is used.
+    std::vector<const method*> exact;
+    for (const method& m : methods) {
+      if (m.is_exact() && m.name != "null") exact.push_back(&m);
+    }
+    auto ref = std::find_if(exact.begin(), exact.end(), [](const method* m) {
+      return m->name == "to_chars-scientific";
+    });
+    if (ref != exact.end()) std::rotate(exact.begin(), ref, ref + 1);
+    if (exact.size() >= 2) {
+      fmt::print("Comparing {} doubles across {} methods with reference {} "
+                 "on {} threads\n",
+                 opts.diff_count, exact.size(), exact[0]->name, num_cpus());
+      verify_differential(exact, opts.diff_count);
+    }
+  }
+  if (opts.verify_floats) {
+    fmt::print("Verifying all floats on {} threads\n", num_cpus());
+    for (const float_method& m : float_methods) verify_all(m);
+  }
+
+  if (!opts.baseline.empty()) {
+    return compare_with_baseline(opts.baseline, opts.compare_methods,
+                                 opts.threshold, num_trials);
+  }
+
+  std::string filename =
+      fmt::format("results/{}_{}_{}{}.csv", MACHINE, os_name(),
+                  compiler_name(), opts.commit_hash);
+  FILE* f = fopen(filename.c_str(), "w");
+  if (!f) {
+    fmt::print(stderr, "Failed to open {}: {}", filename.c_str(),
+               strerror(errno));
+    exit(1);
+  }
+
+  // Opening counters has side effects, e.g. forcing all counters on macOS.
+  std::optional<perf_counters> perf;
+  if (opts.perf) {
+    perf.emplace();
+    if (perf->available())
+      counters = &*perf;
+    else
+      fmt::print(stderr, "warning: hardware counters are not available\n");
+  }
+
+  // Counter columns are only filled in for types timed with bench_digits, e.g.
+  // randomdigit, mixed and batch.
+  fmt::print(f, "Type,Function,Digit,Time(ns)");
+  for (int e = 0; counters && e < num_perf_events; ++e)
+    fmt::print(f, ",{}", perf_event_names[e]);
+  fmt::print(f, "\n");
+
+  // The samples file has the same rows as the results for types written with
+  // write_result, with the trial times separated by spaces.
+  std::string samples_filename =
+      filename.substr(0, filename.size() - 4) + ".samples.csv";
+  samples_file = fopen(samples_filename.c_str(), "w");
+  if (!samples_file) {
+    fmt::print(stderr, "Failed to open {}: {}", samples_filename,
+               strerror(errno));
+    exit(1);
+  }
+  fmt::print(samples_file,
+             "Type,Function,Digit,Median(ns),Stddev(ns),Samples(ns)");
+  for (int e = 0; counters && e < num_perf_events; ++e)
+    fmt::print(samples_file, ",{}", perf_event_names[e]);
+  fmt::print(samples_file, "\n");
+
+  // The null method measures the overhead of the timing loop which is
+  // subtracted in the randomdigit-corrected results.
+  auto null_method =
+      std::find_if(methods.begin(), methods.end(),
+                   [](const method& m) { return m.name == "null"; });
+  std::vector<benchmark_result> interleaved;
+  if (opts.interleave)
+    interleaved = bench_random_digit_interleaved(methods, num_trials);
+  auto bench_method = [&](const method& m) {
+    if (opts.interleave) return interleaved[size_t(&m - methods.data())];
+    return m.visit([&](auto dtoa) {
+      return bench_random_digit(dtoa, m.name, num_trials);
+    });
+  };
+  benchmark_result overhead;
+  if (null_method != methods.end()) {
+    fmt::print("Calibrating overhead     {:20} ... ", null_method->name);
+    fflush(stdout);
+    overhead = bench_method(*null_method);
+    fmt::print("[{:8.3f}ns, {:8.3f}ns]\n", overhead.min_ns, overhead.max_ns);
+  }
+  // Average times of shortest correct and approximate methods.
+  std::vector<ranked_method> exact_ranking, approximate_ranking;
+  // Average indirect and inline times of methods with an inline variant.
+  struct inline_time {
+    std::string name;
+    double indirect_ns;
+    double inline_ns;
+  };
+  std::vector<inline_time> inline_times;
+  for (const method& m : methods) {
+    fmt::print("Benchmarking randomdigit {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result result = bench_method(m);
+    write_result(f, "randomdigit", m.name, result);
+    auto im = std::find_if(
+        inline_methods.begin(), inline_methods.end(),
+        [&](const inline_method& i) { return i.name == m.name; });
+    if (im != inline_methods.end()) {
+      fmt::print("{:>45} ... ", "inline");
+      fflush(stdout);
+      benchmark_result inlined =
+          bench_random_digit_inline(im->loop, num_trials);
+      write_result(f, "randomdigit-inline", m.name, inlined);
+      inline_times.push_back(
+          {m.name, average_ns(result), average_ns(inlined)});
+    }
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const digit_result& r = result.per_digit[digit];
+      fmt::print(f, "randomdigit-cycles,{},{},{:f}\n", m.name, digit,
+                 cycles_per_conversion(r));
+      fmt::print(f, "randomdigit-ghz,{},{},{:f}\n", m.name, digit, r.ghz);
+    }
+    if (m.info.table_size != 0)
+      fmt::print(f, "tablesize,{},0,{}\n", m.name, m.info.table_size);
+    if (null_method == methods.end() || &m == &*null_method) continue;
+    if (!m.is_exact()) fmt::print(f, "approximate,{},0,1\n", m.name);
+    (m.is_exact() ? exact_ranking : approximate_ranking)
+        .push_back({m.name, average_ns(result)});
+    fmt::print("{:>45} ... ", "corrected");
+    write_result(f, "randomdigit-corrected", m.name,
+                 subtract_overhead(result, overhead));
+  }
+  print_ranking("shortest and correct", exact_ranking);
+  print_ranking("approximate", approximate_ranking);
+  if (!inline_times.empty()) {
+    fmt::print("Inlined vs indirect calls:\n");
+    for (const inline_time& t : inline_times) {
+      fmt::print("{:>34} {:9.3f}ns {:9.3f}ns {:8.2f}x\n", t.name,
+                 t.indirect_ns, t.inline_ns, t.indirect_ns / t.inline_ns);
+    }
+  }
+  if (opts.random_digit_only) {
+    if (opts.incremental) finish_incremental_run(run, f, filename);
+    fclose(f);
+    fclose(samples_file);
+    return 0;
+  }
+  for (const method& m : methods) {
+    if (!opts.has_track("chain")) break;
+    fmt::print("Benchmarking chain       {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "chain", m.name, m.visit([&](auto dtoa) {
+                   return bench_chain(dtoa, num_trials);
+                 }));
+  }
+  std::vector<double> mixed_data = get_mixed_data(opts.mixed_weights);
+  for (const method& m : methods) {
+    if (!opts.has_track("mixed")) break;
+    fmt::print("Benchmarking mixed       {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "mixed", m.name, m.visit([&](auto dtoa) {
+                   return bench_values(dtoa, mixed_data, num_trials);
+                 }));
+  }
+  // In the exponent results the digit column holds the bucket index.
+  for (const method& m : methods) {
+    if (!opts.has_track("exponent")) break;
+    fmt::print("Benchmarking exponent    {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "exponent", m.name, m.visit([&](auto dtoa) {
+                   return bench_exponent(dtoa, num_trials);
+                 }));
+  }
+  // The order results are random digit results with the values of each digit
+  // count sorted or shuffled, e.g. order-value-sorted.
+  for (const method& m : methods) {
+    if (!opts.orderings) break;
+    double shuffled_ns = 0;
+    for (int i = 0; i < int(data_order::count); ++i) {
+      fmt::print("Benchmarking {:16} {:20} ... ", data_order_names[i], m.name);
+      fflush(stdout);
+      benchmark_result result = m.visit([&](auto dtoa) {
+        return bench_ordered(dtoa, data_order(i), num_trials);
+      });
+      write_result(f, fmt::format("order-{}", data_order_names[i]).c_str(),
+                   m.name, result);
+      if (data_order(i) == data_order::shuffled)
+        shuffled_ns = average_ns(result);
+      else
+        fmt::print("{:>45} ... {:.2f}x\n", "speedup over shuffled",
+                   shuffled_ns / average_ns(result));
+    }
+  }
+  for (int i = 0; i < num_datasets; ++i) {
+    if (!opts.has_track("datasets")) break;
+    std::span<const double> data = get_dataset(i);
+    for (const method& m : methods) {
+      fmt::print("Benchmarking {:16} {:20} ... ", datasets[i].name, m.name);
+      fflush(stdout);
+      write_result(f, datasets[i].name, m.name, m.visit([&](auto dtoa) {
+                     return bench_values(dtoa, data, num_trials);
+                   }));
+    }
+    for (const range_method& m : range_methods) {
+      if (!in_range(m, data)) continue;
+      fmt::print("Benchmarking {:16} {:20} ... ", datasets[i].name, m.name);
+      fflush(stdout);
+      write_result(f, datasets[i].name, m.name,
+                   bench_values(m.dtoa, data, num_trials));
+    }
+  }
+  if (!opts.memoize_rates.empty()) {
+    // In the memoize results the digit column holds the repeat rate.
+    static thread_local conversion_cache<memoize_cache_size> local_cache;
+    auto shared_cache =
+        std::make_unique<shared_conversion_cache<memoize_cache_size>>();
+    std::vector<std::vector<double>> data;
+    for (int rate : opts.memoize_rates) data.push_back(get_repeat_data(rate));
+    std::map<std::string, std::vector<double>> uncached_ns, cached_ns;
+    for (const method& m : methods) {
+      for (size_t i = 0; i < data.size(); ++i) {
+        int rate = opts.memoize_rates[i];
+        fmt::print("Benchmarking memoize     {:20} {:3}% ... ", m.name, rate);
+        fflush(stdout);
+        double ns[3] = {};
+        m.visit([&](auto dtoa) {
+          auto write = [&](double value, char* buffer) {
+            return write_value(dtoa, value, buffer);
+          };
+          ns[0] = bench_values(write, data[i], num_trials).min_ns;
+          local_cache.clear();
+          auto write_local = [&](double value, char* buffer) {
+            return local_cache.write(value, buffer, write);
+          };
+          ns[1] = bench_values(write_local, data[i], num_trials).min_ns;
+          shared_cache->clear();
+          auto write_shared = [&](double value, char* buffer) {
+            return shared_cache->write(value, buffer, write);
+          };
+          ns[2] = bench_values(write_shared, data[i], num_trials).min_ns;
+        });
+        fmt::print(f, "memoize,{},{},{:f}\n", m.name, rate, ns[0]);
+        fmt::print(f, "memoize-thread-local,{},{},{:f}\n", m.name, rate,
+                   ns[1]);
+        fmt::print(f, "memoize-shared,{},{},{:f}\n", m.name, rate, ns[2]);
+        fmt::print("[{:8.3f}ns, {:8.3f}ns thread-local, {:8.3f}ns shared]\n",
+                   ns[0], ns[1], ns[2]);
+        uncached_ns[m.name].push_back(ns[0]);
+        cached_ns[m.name].push_back(ns[1]);
+      }
+    }
+    // The lowest repeat rate at which a method with a thread-local cache
+    // beats recomputing with zmij.
+    auto zmij_ns = uncached_ns.find("zmij");
+    if (zmij_ns != uncached_ns.end()) {
+      fmt::print("Lowest repeat rate at which caching beats zmij:\n");
+      for (const auto& [name, ns] : cached_ns) {
+        size_t i = 0;
+        while (i < ns.size() && ns[i] >= zmij_ns->second[i]) ++i;
+        if (i < ns.size())
+          fmt::print("  {:20} {}%\n", name, opts.memoize_rates[i]);
+        else
+          fmt::print("  {:20} never\n", name);
+      }
+    }
+  }
+  for (const fallback_method& fm : fallback_methods) {
+    auto m = std::find_if(methods.begin(), methods.end(),
+                          [&](const method& m) { return m.name == fm.name; });
+    if (m == methods.end()) continue;
+    fmt::print("Measuring fallback rate  {:20} ... ", fm.name);
+    fflush(stdout);
+    std::vector<double> rates = m->visit(
+        [&](auto dtoa) { return get_fallback_rates(dtoa, fm.count); });
+    for (int digit = 1; digit <= max_digits; ++digit)
+      fmt::print(f, "fallback,{},{},{:f}\n", fm.name, digit, rates[digit]);
+    fmt::print("[{:7.3f}%, {:7.3f}%]\n",
+               *std::min_element(rates.begin() + 1, rates.end()),
+               *std::max_element(rates.begin() + 1, rates.end()));
+  }
+  for (const path_method& m : path_methods) {
+    std::vector<double> random_digit_data;
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      const double* data = get_random_digit_data<double>(digit);
+      random_digit_data.insert(random_digit_data.end(), data,
+                               data + num_doubles_per_digit);
+    }
+    print_path_counts(m, "randomdigit", random_digit_data);
+    print_path_counts(m, "mixed", mixed_data);
+    for (int i = 0; i < num_datasets; ++i)
+      print_path_counts(m, datasets[i].name, get_dataset(i));
+  }
+  // Symbol sizes are written at build time next to the executable.
+  symbol_sizes symbols;
+#ifdef SYMBOL_FILE
+  if (!footprint_methods.empty() && !symbols.load(SYMBOL_FILE))
+    fmt::print(stderr, "warning: cannot read symbol sizes from {}\n",
+               SYMBOL_FILE);
+#endif
+  for (const footprint_method& m : footprint_methods) {
+    footprint fp = symbols.measure(m.symbols);
+    if (fp.code_size == 0 && fp.table_size == 0) continue;
+    fmt::print("Footprint                {:20} ... ", m.name);
+    fmt::print(f, "footprint-code,{},0,{}\n", m.name, fp.code_size);
+    fmt::print(f, "footprint-tables,{},0,{}\n", m.name, fp.table_size);
+    fmt::print("[{:7} bytes of code, {:7} bytes of tables]\n", fp.code_size,
+               fp.table_size);
+  }
+  print_size_frontier(symbols, exact_ranking);
+  for (const method& m : methods) {
+    if (!opts.has_track("json")) break;
+    fmt::print("Benchmarking json        {:20} ... ", m.name);
+    fflush(stdout);
+    double min_ns = std::numeric_limits<double>::max(), max_ns = 0;
+    double min_mbps = std::numeric_limits<double>::max(), max_mbps = 0;
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      std::span<const double> values(get_random_digit_data(digit),
+                                     num_doubles_per_digit);
+      json_result result = m.visit(
+          [&](auto dtoa) { return bench_json(dtoa, values, num_trials); });
+      double mbps = result.bytes_per_second / 1e6;
+      fmt::print(f, "json,{},{},{:f}\n", m.name, digit, result.ns);
+      fmt::print(f, "json-mbps,{},{},{:f}\n", m.name, digit, mbps);
+      min_ns = std::min(min_ns, result.ns);
+      max_ns = std::max(max_ns, result.ns);
+      min_mbps = std::min(min_mbps, mbps);
+      max_mbps = std::max(max_mbps, mbps);
+    }
+    fmt::print("[{:8.3f}ns, {:8.3f}ns] [{:7.1f}MB/s, {:7.1f}MB/s]\n", min_ns,
+               max_ns, min_mbps, max_mbps);
+  }
+  for (const batch_method& m : batch_methods) {
+    if (!opts.has_track("batch")) break;
+    fmt::print("Benchmarking batch       {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "batch", m.name, bench_batch(m.dtoa, num_trials));
+  }
+  // The energy results are the package energy per conversion in nJ and
+  // energy-core that of the cores only, with the same types for batch methods
+  // prefixed with energy-batch.
+  energy_counters energy;
+  if (opts.energy && !energy.available()) {
+    fmt::print(stderr, "warning: energy counters are not available\n");
+  } else if (opts.energy) {
+    std::vector<ranked_method> energy_ranking;
+    auto bench_method_energy = [&](const char* type, const std::string& name,
+                                   auto dtoa) {
+      fmt::print("Benchmarking {:11} {:20} ... ", type, name);
+      fflush(stdout);
+      energy_result result = bench_energy(energy, dtoa);
+      fmt::print("{:8.3f}ns", result.ns);
+      for (int d = 0; d < num_energy_domains; ++d) {
+        if (!energy.available(energy_domain(d))) continue;
+        fmt::print(f, "{}{},{},0,{:f}\n", type, d == 0 ? "" : "-core", name,
+                   result.nj[d]);
+        fmt::print(" {:8.3f}nJ {}", result.nj[d], energy_domain_names[d]);
+      }
+      fmt::print("\n");
+      return result.nj[energy_package];
+    };
+    for (const method& m : methods) {
+      m.visit([&](auto dtoa) {
+        double nj = bench_method_energy("energy", m.name, dtoa);
+        if (m.name != "null") energy_ranking.push_back({m.name, nj});
+      });
+    }
+    for (const batch_method& m : batch_methods) {
+      energy_ranking.push_back(
+          {m.name + " (batch)",
+           bench_method_energy("energy-batch", m.name, m.dtoa)});
+    }
+    print_ranking("energy-efficient", energy_ranking, "nJ");
+  }
+  // The topdown-* results are the fractions of pipeline slots per category
+  // while converting the random digit data.
+  topdown_counters topdown;
+  if (opts.topdown && !topdown.available()) {
+    fmt::print(stderr, "warning: top-down events are not available\n");
+  } else if (opts.topdown) {
+    for (const method& m : methods) {
+      fmt::print("Benchmarking topdown     {:20} ...", m.name);
+      fflush(stdout);
+      topdown_fractions result = m.visit([&](auto dtoa) {
+        return bench_topdown(topdown, dtoa, num_trials);
+      });
+      for (int c = 0; c < num_topdown_categories; ++c) {
+        fmt::print(f, "topdown-{},{},0,{:f}\n", topdown_category_names[c],
+                   m.name, result.values[c]);
+        fmt::print(" {} {:4.1f}%", topdown_category_names[c],
+                   result.values[c] * 100);
+      }
+      fmt::print("\n");
+    }
+  }
+  for (const hex_method& m : hex_methods) {
+    if (!opts.has_track("hex")) break;
+    fmt::print("Benchmarking hex         {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "hex", m.name,
+                 bench_random_digit(m.dtoa, m.name, num_trials));
+  }
+  for (const float_method& m : float_methods) {
+    if (!opts.has_track("float")) break;
+    fmt::print("Benchmarking float       {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "float", m.name, bench_float(m.dtoa, num_trials));
+  }
+  if (!opts.float_mix.empty()) {
+    // Both precisions are converted in the same loop as the mix so that only
+    // switching between them differs.
+    precision_mix mix = get_precision_mix(opts.float_mix);
+    precision_mix only_doubles = get_precision_mix("d");
+    precision_mix only_floats = get_precision_mix("f");
+    double float_fraction =
+        double(std::count(mix.is_float.begin(), mix.is_float.end(), 1)) /
+        double(mix.is_float.size());
+    for (const float_method& fm : float_methods) {
+      auto m = std::find_if(
+          methods.begin(), methods.end(),
+          [&](const method& other) { return other.name == fm.name; });
+      if (m == methods.end()) continue;
+      auto bench = [&](const char* type, const precision_mix& data) {
+        fmt::print("Benchmarking {:16} {:20} ... ", type, fm.name);
+        fflush(stdout);
+        benchmark_result result = m->visit([&](auto dtoa) {
+          return bench_precision_mix(dtoa, fm.dtoa, data, num_trials);
+        });
+        write_result(f, type, fm.name, result);
+        return average_ns(result);
+      };
+      double mixed_ns = bench("float-mix", mix);
+      double double_ns = bench("float-mix-double", only_doubles);
+      double float_ns = bench("float-mix-float", only_floats);
+      // The cost of switching is the excess over the pure runs weighted by
+      // the fraction of each precision.
+      double expected_ns =
+          float_fraction * float_ns + (1 - float_fraction) * double_ns;
+      fmt::print(f, "float-mix-penalty,{},0,{:f}\n", fm.name,
+                 mixed_ns - expected_ns);
+      fmt::print("{:>50} ... [{:8.3f}ns, {:+.1f}%]\n", "penalty",
+                 mixed_ns - expected_ns,
+                 (mixed_ns / expected_ns - 1) * 100);
+    }
+  }
+  for (const float16_method& m : float16_methods) {
+    if (!opts.has_track("float16")) break;
+    fmt::print("Benchmarking {:11} {:20} ... ", float16_name(m.format),
+               m.name);
+    fflush(stdout);
+    write_result(f, float16_name(m.format), m.name,
+                 bench_float16(m, num_trials));
+  }
+#if LDBL_MANT_DIG == 64
+  for (const long_double_method& m : long_double_methods) {
+    if (!opts.has_track("longdouble")) break;
+    fmt::print("Benchmarking longdouble  {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "longdouble", m.name,
+                 bench_long_double(m.dtoa, num_trials));
+  }
+#endif
+#if BENCH_FLOAT128
+  for (const float128_method& m : float128_methods) {
+    if (!opts.has_track("float128")) break;
+    fmt::print("Benchmarking float128    {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "float128", m.name, bench_float128(m.dtoa, num_trials));
+  }
+#endif
+  for (const columnar_method& m : columnar_methods) {
+    if (!opts.has_track("columnar")) break;
+    fmt::print("Benchmarking columnar    {:20} ... ", m.name);
+    fflush(stdout);
+    columnar_result result = bench_columnar(m.convert, num_trials);
+    fmt::print(f, "columnar,{},0,{:f}\n", m.name, result.ns);
+    fmt::print("[{:8.3f}ns, {:8.3f}MB/s written]\n", result.ns,
+               result.bytes_per_second / 1e6);
+  }
+  for (const fixed_column_method& m : fixed_column_methods) {
+    if (!opts.has_track("fixed-column")) break;
+    fmt::print("Benchmarking fixed-column {:19} ... ", m.name);
+    fflush(stdout);
+    columnar_result result = bench_fixed_column(m.write, num_trials);
+    fmt::print(f, "fixed-column,{},0,{:f}\n", m.name, result.ns);
+    fmt::print("[{:8.3f}ns, {:8.3f}MB/s written]\n", result.ns,
+               result.bytes_per_second / 1e6);
+  }
+  for (const parse_method& m : parse_methods) {
+    if (!opts.has_track("parse")) break;
+    fmt::print("Benchmarking parse       {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "parse", m.name, bench_parse(m.parse, num_trials));
+  }
+  for (const parse_method& m : parse_methods) {
+    if (!opts.has_track("parsehard")) break;
+    fmt::print("Benchmarking parsehard   {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "parsehard", m.name, bench_parse_hard(m.parse, num_trials));
+    std::vector<double> max_ns = bench_parse_hard_max(m.parse, num_trials);
+    fmt::print("  worst-case:");
+    for (int kind = 1; kind <= num_hard_parse_kinds; ++kind) {
+      fmt::print(f, "parsehard-max,{},{},{:f}\n", m.name, kind, max_ns[kind]);
+      fmt::print(" {} {:.3f}ns", hard_parse_kind_names[kind], max_ns[kind]);
+    }
+    fmt::print("\n");
+  }
+  // The normalized results are the time per call including rewriting the
+  // output in the canonical notation and normalized-ratio the ratio of the
+  // average to that of the native output timed in the same run.
+  auto canonical_reference =
+      std::find_if(methods.begin(), methods.end(), [](const method& m) {
+        return m.name == "to_chars-scientific";
+      });
+  std::vector<ranked_method> normalized_ranking;
+  for (const method& m : methods) {
+    if (!opts.normalize || canonical_reference == methods.end()) break;
+    if (m.name == "null") continue;
+    fmt::print("Benchmarking normalized  {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result native = m.visit([&](auto dtoa) {
+      return bench_random_digit(dtoa, m.name, num_trials);
+    });
+    int num_mismatches = 0;
+    benchmark_result normalized = m.visit([&](auto dtoa) {
+      return canonical_reference->visit([&](auto reference) {
+        return bench_normalized(dtoa, reference, num_normalize_checked,
+                                num_trials, num_mismatches);
+      });
+    });
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      fmt::print(f, "normalized,{},{},{:f}\n", m.name, digit,
+                 normalized.per_digit[digit].duration_ns);
+    }
+    double ratio = average_ns(normalized) / average_ns(native);
+    fmt::print(f, "normalized-ratio,{},0,{:f}\n", m.name, ratio);
+    fmt::print("[{:8.3f}ns, {:8.3f}ns] {:.2f}x native", normalized.min_ns,
+               normalized.max_ns, ratio);
+    if (num_mismatches != 0)
+      fmt::print(" {} outputs differ from the canonical", num_mismatches);
+    fmt::print("\n");
+    if (m.is_exact())
+      normalized_ranking.push_back({m.name, average_ns(normalized)});
+  }
+  print_ranking("normalized shortest and correct", normalized_ranking);
+  // In the roundtrip results the name is method+parser and roundtrip-ratio is
+  // the ratio of the time of a round trip to the sum of formatting and parsing
+  // separately. Methods that don't round-trip are skipped.
+  for (const method& m : methods) {
+    if (!opts.roundtrip) break;
+    if (!m.info.correct) continue;
+    for (const parse_method& p : parse_methods) {
+      std::string name = m.name + "+" + p.name;
+      fmt::print("Benchmarking roundtrip   {:28} ... ", name);
+      fflush(stdout);
+      roundtrip_result result = m.visit([&](auto dtoa) {
+        return bench_roundtrip(dtoa, p.parse, num_trials);
+      });
+      fmt::print(f, "roundtrip,{},0,{:f}\n", name, result.ns);
+      fmt::print(f, "roundtrip-ratio,{},0,{:f}\n", name,
+                 result.ns / result.separate_ns);
+      fmt::print("[{:8.3f}ns, {:.2f}x separate]", result.ns,
+                 result.ns / result.separate_ns);
+      if (result.num_mismatches != 0)
+        fmt::print(" {} values don't round-trip, e.g. {}",
+                   result.num_mismatches, result.first_mismatch);
+      fmt::print("\n");
+    }
+  }
+  // In the column-parse results the name is method+parser where the method
+  // writes the column since its notation and output length affect parsing.
+  // column-parse-bytes is the average line length of the method's column.
+  // Parse methods parse one line at a time.
+  for (const method& m : methods) {
+    if (!opts.column_parse) break;
+    if (!m.info.correct) continue;
+    std::string column = m.visit([&](auto dtoa) {
+      return format_column(dtoa, get_roundtrip_values());
+    });
+    fmt::print(f, "column-parse-bytes,{},0,{:f}\n", m.name,
+               double(column.size()) / get_roundtrip_values().size());
+    auto bench = [&](const std::string& parser, auto parse) {
+      std::string name = m.name + "+" + parser;
+      fmt::print("Benchmarking column      {:28} ... ", name);
+      fflush(stdout);
+      column_parse_result result =
+          bench_column_parse(parse, column, num_trials);
+      fmt::print(f, "column-parse,{},0,{:f}\n", name, result.ns);
+      fmt::print("[{:8.3f}ns]", result.ns);
+      if (result.num_mismatches != 0)
+        fmt::print(" {} values don't parse back", result.num_mismatches);
+      fmt::print("\n");
+    };
+    for (const column_parse_method& p : column_parse_methods)
+      bench(p.name, p.parse);
+    for (const parse_method& p : parse_methods) {
+      bench(p.name, [&](std::string_view input, double* out) {
+        return parse_lines(p.parse, input, out);
+      });
+    }
+  }
+  for (const digits_method& m : digits_methods) {
+    if (!opts.has_track("digits")) break;
+    fmt::print("Benchmarking digits      {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "digits", m.name,
+                 bench_digits_method(m.write_digits, num_trials));
+  }
+  for (const itoa_method& m : itoa_methods) {
+    if (!opts.has_track("itoa")) break;
+    fmt::print("Benchmarking itoa32      {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "itoa32", m.name,
+                 bench_itoa<int32_t>(m.itoa32, num_trials));
+    fmt::print("Benchmarking itoa64      {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "itoa64", m.name,
+                 bench_itoa<int64_t>(m.itoa64, num_trials));
+  }
+  for (const decimal_method& m : decimal_methods) {
+    if (!opts.has_track("decimal")) break;
+    fmt::print("Benchmarking decimal     {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "decimal", m.name, bench_decimal(m.to_decimal, num_trials));
+  }
+  for (const float_decimal_method& m : float_decimal_methods) {
+    if (!opts.has_track("float-decimal")) break;
+    fmt::print("Benchmarking float-decimal {:18} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "float-decimal", m.name,
+                 bench_decimal<float>(m.to_decimal, num_trials));
+  }
+  for (const format_method& m : format_methods) {
+    if (!opts.has_track("format")) break;
+    fmt::print("Benchmarking format      {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "format", m.name, bench_format(m.format, num_trials));
+  }
+  // The decimal64 results are the time of formatting values stored as
+  // decimal64 and decimal64-double that of the method of the same name
+  // formatting the same values stored as doubles.
+  for (const decimal64_method& m : decimal64_methods) {
+    if (!opts.has_track("decimal64")) break;
+    fmt::print("Benchmarking decimal64   {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result result = bench_decimal64(m.format, num_trials);
+    write_result(f, "decimal64", m.name, result);
+    auto double_method =
+        std::find_if(methods.begin(), methods.end(),
+                     [&](const method& dm) { return dm.name == m.name; });
+    if (double_method == methods.end()) continue;
+    fmt::print("{:>45} ... ", "double");
+    fflush(stdout);
+    benchmark_result double_result = double_method->visit([&](auto dtoa) {
+      return bench_decimal64_double(dtoa, num_trials);
+    });
+    write_result(f, "decimal64-double", m.name, double_result);
+    fmt::print("{:>45} ... {:.2f}x\n", "speedup over double",
+               average_ns(double_result) / average_ns(result));
+  }
+  // In the precision results the digit column holds the precision.
+  for (const precision_method& m : precision_methods) {
+    if (!opts.has_track("precision")) break;
+    for (int precision : precisions) {
+      if (precision > m.max_precision) break;
+      fmt::print("Benchmarking precision   {:20} .{:<3} ... ", m.name,
+                 precision);
+      fflush(stdout);
+      benchmark_result result =
+          bench_precision(m.format_fun, precision, num_trials);
+      fmt::print(f, "precision,{},{},{:f}\n", m.name, precision,
+                 result.min_ns);
+      fmt::print("[{:8.3f}ns]\n", result.min_ns);
+    }
+  }
+  // In the bounded results the digit column holds the buffer size.
+  for (const bounded_method& m : bounded_methods) {
+    if (!opts.has_track("bounded")) break;
+    for (int n : bounded_sizes) {
+      fmt::print("Benchmarking bounded     {:20} n={:<2} ... ", m.name, n);
+      fflush(stdout);
+      benchmark_result result =
+          bench_bounded(m.write, mixed_data, size_t(n), num_trials);
+      fmt::print(f, "bounded,{},{},{:f}\n", m.name, n, result.min_ns);
+      fmt::print("[{:8.3f}ns]\n", result.min_ns);
+    }
+  }
+  for (const wide_method& m : wide_methods) {
+    if (!opts.has_track("wide")) break;
+    fmt::print("Benchmarking wide        {:20} ... ", m.name);
+    fflush(stdout);
+    write_result(f, "wide", m.name, bench_wide(m.dtoa, num_trials));
+  }
+  // In the threads and threads-aggregate results the digit column holds the
+  // number of threads.
+  for (const method& m : methods) {
+    if (!m.info.thread_safe) continue;
+    for (int n = 1; n <= opts.max_threads; ++n) {
+      fmt::print("Benchmarking threads     {:20} x{:<3} ... ", m.name, n);
+      fflush(stdout);
+      thread_result result = m.visit(
+          [&](auto dtoa) { return bench_threads(dtoa, n, num_trials); });
+      fmt::print(f, "threads,{},{},{:f}\n", m.name, n, result.per_thread_ns);
+      fmt::print(f, "threads-aggregate,{},{},{:f}\n", m.name, n,
+                 result.aggregate_ns);
+      fmt::print("[{:8.3f}ns per thread, {:8.3f}M values/s]\n",
+                 result.per_thread_ns, 1e3 / result.aggregate_ns);
+    }
+  }
+  // Parallel methods are compared with threads-aggregate for the same number
+  // of threads, which has no cost of splitting or assembling the output.
+  for (const parallel_method& m : parallel_methods) {
+    for (int n = 1; n <= opts.max_threads; ++n) {
+      fmt::print("Benchmarking parallel    {:20} x{:<3} ... ", m.name, n);
+      fflush(stdout);
+      double ns = bench_parallel(m.dtoa, n, num_trials);
+      fmt::print(f, "parallel,{},{},{:f}\n", m.name, n, ns);
+      fmt::print("[{:8.3f}ns, {:8.3f}M values/s]\n", ns, 1e3 / ns);
+    }
+  }
+  // In the numa-local and numa-remote results the digit column holds the node
+  // whose CPUs run the threads. The data is on the same node or the next one.
+  // Static tables stay where the kernel placed them, typically on the node
+  // that loaded the executable, so differences between the numa-local results
+  // of nodes show the cost of remote tables.
+  if (opts.numa) {
+    std::vector<std::vector<int>> nodes = get_numa_nodes();
+    if (nodes.size() < 2) {
+      fmt::print("NUMA: {} node(s) found, skipping\n", nodes.size());
+      nodes.clear();
+    }
+    std::vector<double> values = get_stream_data(numa_data_size);
+    std::vector<std::unique_ptr<double[]>> node_data;
+    for (const std::vector<int>& cpus : nodes)
+      node_data.push_back(place_on_cpu(values, cpus.front()));
+    for (const method& m : methods) {
+      if (!m.info.thread_safe) continue;
+      for (size_t n = 0; n < nodes.size(); ++n) {
+        fmt::print("Benchmarking numa        {:20} n{:<3} ... ", m.name, n);
+        fflush(stdout);
+        size_t remote = (n + 1) % nodes.size();
+        auto [local_ns, remote_ns] = m.visit([&](auto dtoa) {
+          auto bench = [&](size_t node) {
+            std::span<const double> data(node_data[node].get(), values.size());
+            return bench_numa(dtoa, nodes[n], data, num_trials);
+          };
+          return std::pair(bench(n), bench(remote));
+        });
+        fmt::print(f, "numa-local,{},{},{:f}\n", m.name, n, local_ns);
+        fmt::print(f, "numa-remote,{},{},{:f}\n", m.name, n, remote_ns);
+        fmt::print("[{:8.3f}ns local, {:8.3f}ns remote] {:.2f}x\n", local_ns,
+                   remote_ns, remote_ns / local_ns);
+      }
+    }
+  }
+  // The smt results are the time per value with the sibling hardware thread
+  // idle and the slowdowns are relative to it with the sibling running the
+  // same method, a memory-bound antagonist or the partner method.
+  if (!opts.smt_partner.empty()) {
+    std::vector<int> siblings = get_smt_siblings();
+    auto partner = std::find_if(methods.begin(), methods.end(),
+                                [&](const method& m) {
+                                  return m.name == opts.smt_partner;
+                                });
+    if (siblings.empty()) {
+      fmt::print("SMT: no sibling hardware threads found, skipping\n");
+    } else if (partner == methods.end()) {
+      fmt::print(stderr, "Unknown SMT partner {}\n", opts.smt_partner);
+      return 1;
+    } else {
+      fmt::print("SMT: CPUs {} and {}, partner {}\n", siblings[0],
+                 siblings[1], partner->name);
+    }
+    for (const method& m : methods) {
+      if (siblings.empty() || partner == methods.end()) break;
+      if (!m.info.thread_safe) continue;
+      fmt::print("Benchmarking smt         {:20} ... ", m.name);
+      fflush(stdout);
+      auto idle = [](const std::atomic<bool>&) {};
+      double alone = 0, same = 0, antagonist = 0, with_partner = 0;
+      m.visit([&](auto dtoa) {
+        alone = bench_smt(dtoa, siblings, idle, num_trials);
+        same = bench_smt(dtoa, siblings, smt_converter(dtoa), num_trials);
+        antagonist = bench_smt(dtoa, siblings, smt_antagonist, num_trials);
+        with_partner = partner->visit([&](auto partner_dtoa) {
+          return bench_smt(dtoa, siblings, smt_converter(partner_dtoa),
+                           num_trials);
+        });
+      });
+      fmt::print(f, "smt,{},0,{:f}\n", m.name, alone);
+      fmt::print(f, "smt-same-slowdown,{},0,{:f}\n", m.name, same / alone);
+      fmt::print(f, "smt-antagonist-slowdown,{},0,{:f}\n", m.name,
+                 antagonist / alone);
+      fmt::print(f, "smt-partner-slowdown,{},0,{:f}\n", m.name,
+                 with_partner / alone);
+      fmt::print("[{:8.3f}ns] {:.2f}x same, {:.2f}x antagonist, {:.2f}x "
+                 "partner\n",
+                 alone, same / alone, antagonist / alone, with_partner / alone);
+    }
+  }
+  // The pipeline results are the end-to-end time per value, pipeline-format
+  // the part of it spent converting and the latency types the time from
+  // filling a batch to flushing it. If pipeline is close to pipeline-format,
+  // the conversion is the bottleneck rather than the queues.
+  for (const method& m : methods) {
+    if (opts.pipeline_batch_size == 0) break;
+    if (!m.info.thread_safe) continue;
+    fmt::print("Benchmarking pipeline    {:20} ... ", m.name);
+    fflush(stdout);
+    pipeline_result result = m.visit([&](auto dtoa) {
+      return bench_pipeline(dtoa, opts.pipeline_batch_size, num_trials);
+    });
+    int batch = opts.pipeline_batch_size;
+    fmt::print(f, "pipeline,{},{},{:f}\n", m.name, batch, result.ns);
+    fmt::print(f, "pipeline-format,{},{},{:f}\n", m.name, batch,
+               result.format_ns);
+    fmt::print(f, "pipeline-latency-p50,{},{},{:f}\n", m.name, batch,
+               result.latency_p50_ns);
+    fmt::print(f, "pipeline-latency-p99,{},{},{:f}\n", m.name, batch,
+               result.latency_p99_ns);
+    fmt::print("[{:8.3f}ns, {:8.3f}ns formatting] latency p50 {:.0f}ns, "
+               "p99 {:.0f}ns\n",
+               result.ns, result.format_ns, result.latency_p50_ns,
+               result.latency_p99_ns);
+  }
+  // The first-call results are the median time, page faults and resident
+  // set growth of the first conversion in a new process.
+  if (opts.first_call) {
+    std::string command = argv[0];
+#ifdef __linux__
+    std::error_code ec;
+    std::filesystem::path exe =
+        std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (!ec) command = exe.string();
+#endif
+    command = "'" + command + "'";
+    for (const std::string& path : opts.plugins)
+      command += " '--plugin=" + path + "'";
+    for (const method& m : methods) {
+      fmt::print("Benchmarking first-call  {:20} ... ", m.name);
+      fflush(stdout);
+      first_call_result result = bench_first_call(command, m.name, num_trials);
+      fmt::print(f, "first-call,{},0,{:f}\n", m.name, result.ns);
+      fmt::print(f, "first-call-faults,{},0,{:f}\n", m.name,
+                 result.page_faults);
+      fmt::print(f, "first-call-rss,{},0,{:f}\n", m.name, result.rss_bytes);
+      fmt::print("[{:10.3f}ns, {:4.0f} page faults, {:7.0f} KB]\n", result.ns,
+                 result.page_faults, result.rss_bytes / 1024);
+    }
+  }
+  if (opts.allocs) {
+    for (const method& m : methods) {
+      fmt::print("Counting allocations     {:20} ... ", m.name);
+      fflush(stdout);
+      double max_count = 0, max_bytes = 0;
+      std::vector<alloc_counts> counts =
+          m.visit([](auto dtoa) { return count_allocs(dtoa); });
+      for (int digit = 1; digit <= max_digits; ++digit) {
+        double count = double(counts[digit].count) / num_doubles_per_digit;
+        double bytes = double(counts[digit].bytes) / num_doubles_per_digit;
+        fmt::print(f, "allocs,{},{},{:f}\n", m.name, digit, count);
+        fmt::print(f, "allocbytes,{},{},{:f}\n", m.name, digit, bytes);
+        max_count = std::max(max_count, count);
+        max_bytes = std::max(max_bytes, bytes);
+      }
+      fmt::print("[{:6.3f} allocs, {:8.3f} bytes per conversion]\n", max_count,
+                 max_bytes);
+      if (max_count != 0 && !m.info.allocates)
+        fmt::print("warning: {} is not registered as allocating\n", m.name);
+    }
+  }
+  // The stack results are the peak stack usage in bytes over random cases,
+  // digit counts and datasets, listed next to the random digit times.
+  if (opts.stack) {
+    struct stack_usage {
+      std::string name;
+      size_t bytes;
+      double ns;
+    };
+    std::vector<stack_usage> usages;
+    for (const method& m : methods) {
+      fmt::print("Measuring stack          {:20} ... ", m.name);
+      fflush(stdout);
+      size_t bytes =
+          m.visit([](auto dtoa) { return measure_method_stack(dtoa); });
+      fmt::print(f, "stack,{},0,{}\n", m.name, bytes);
+      fmt::print("[{:7} bytes]\n", bytes);
+      for (const auto* ranking : {&exact_ranking, &approximate_ranking}) {
+        for (const ranked_method& r : *ranking) {
+          if (r.name == m.name) usages.push_back({m.name, bytes, r.ns});
+        }
+      }
+    }
+    std::sort(usages.begin(), usages.end(),
+              [](const stack_usage& lhs, const stack_usage& rhs) {
+                return lhs.bytes < rhs.bytes;
+              });
+    if (!usages.empty()) fmt::print("Stack usage of methods:\n");
+    for (const stack_usage& u : usages)
+      fmt::print("{:>34} {:7} bytes {:9.3f}ns\n", u.name, u.bytes, u.ns);
+  }
+  // The CSV results include the I/O, so the ranking shows how much the choice
+  // of method matters once the output is written to storage.
+  for (csv_output output : {csv_output::mmap, csv_output::fwrite}) {
+    if (opts.csv_columns == 0) break;
+    const char* type = output == csv_output::mmap ? "csv-mmap" : "csv-fwrite";
+    std::vector<ranked_method> ranking;
+    for (const method& m : methods) {
+      fmt::print("Benchmarking {:11} {:20} ... ", type, m.name);
+      fflush(stdout);
+      json_result result = m.visit([&](auto dtoa) {
+        return bench_csv(dtoa, opts.csv_columns, output, num_trials);
+      });
+      fmt::print(f, "{},{},0,{:f}\n", type, m.name, result.ns);
+      fmt::print(f, "{}-mbps,{},0,{:f}\n", type, m.name,
+                 result.bytes_per_second / 1e6);
+      fmt::print("[{:8.3f}ns, {:8.3f}MB/s]\n", result.ns,
+                 result.bytes_per_second / 1e6);
+      if (m.is_exact()) ranking.push_back({m.name, result.ns});
+    }
+    print_ranking(type, ranking);
+  }
+  // The stream results are the time per value with the input and output in
+  // memory rather than cache and stream-slowdown the ratio to the same loop
+  // over a cache-resident part of the data.
+  if (opts.stream_size != 0) {
+    std::vector<double> stream_data = get_stream_data(opts.stream_size);
+    fmt::print("Stream data: {} MB, {} values\n", opts.stream_size >> 20,
+               stream_data.size());
+    // Batch methods share names with scalar ones and are recorded as
+    // stream-batch.
+    auto bench_stream_method = [&](const char* type, const std::string& name,
+                                   auto dtoa) {
+      fmt::print("Benchmarking {:11} {:20} ... ", type, name);
+      fflush(stdout);
+      stream_result result = bench_stream(dtoa, stream_data, num_trials);
+      fmt::print(f, "{},{},0,{:f}\n", type, name, result.ns);
+      fmt::print(f, "{}-prefetch,{},0,{:f}\n", type, name, result.prefetch_ns);
+      fmt::print(f, "{}-slowdown,{},0,{:f}\n", type, name,
+                 result.ns / result.hot_ns);
+      fmt::print("[{:8.3f}ns, {:8.3f}ns prefetched] {:.2f}x slower than hot\n",
+                 result.ns, result.prefetch_ns, result.ns / result.hot_ns);
+    };
+    for (const method& m : methods)
+      m.visit([&](auto dtoa) { bench_stream_method("stream", m.name, dtoa); });
+    for (const batch_method& m : batch_methods)
+      bench_stream_method("stream-batch", m.name, m.dtoa);
+  }
+  // The offset results are the time per call with the output at the offset in
+  // the digit column, offset-penalty the ratio of the slowest offset in a
+  // cache line to the fastest and offset-page-crossing the ratio of the
+  // slowest page-crossing offset to offset 0.
+  std::vector<size_t> output_offsets = get_output_offsets();
+  for (const method& m : methods) {
+    if (!opts.offsets) break;
+    fmt::print("Benchmarking offsets     {:20} ... ", m.name);
+    fflush(stdout);
+    std::vector<double> ns = m.visit([&](auto dtoa) {
+      return bench_offsets(dtoa, output_offsets, num_trials);
+    });
+    for (size_t i = 0; i < ns.size(); ++i)
+      fmt::print(f, "offset,{},{},{:f}\n", m.name, output_offsets[i], ns[i]);
+    auto line_end = ns.begin() + cache_line_size;
+    auto [min, max] = std::minmax_element(ns.begin(), line_end);
+    double penalty = *max / *min;
+    double page_crossing = *std::max_element(line_end, ns.end()) / ns[0];
+    fmt::print(f, "offset-penalty,{},0,{:f}\n", m.name, penalty);
+    fmt::print(f, "offset-page-crossing,{},0,{:f}\n", m.name, page_crossing);
+    fmt::print("[{:8.3f}ns, {:8.3f}ns] {:.2f}x at offset {}, {:.2f}x across "
+               "pages\n",
+               *min, *max, penalty, max - ns.begin(), page_crossing);
+  }
+  // The cold results are the time per call with evictions between calls and
+  // cold-slowdown the ratio to the same per-call timing without evictions.
+  for (const method& m : methods) {
+    if (opts.cold_evict_size == 0) break;
+    fmt::print("Benchmarking cold        {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result hot = m.visit(
+        [&](auto dtoa) { return bench_cold(dtoa, 0, num_trials); });
+    benchmark_result cold = m.visit([&](auto dtoa) {
+      return bench_cold(dtoa, opts.cold_evict_size, num_trials);
+    });
+    double max_slowdown = 0;
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      double slowdown = cold.per_digit[digit].duration_ns /
+                        hot.per_digit[digit].duration_ns;
+      fmt::print(f, "cold,{},{},{:f}\n", m.name, digit,
+                 cold.per_digit[digit].duration_ns);
+      fmt::print(f, "cold-slowdown,{},{},{:f}\n", m.name, digit, slowdown);
+      max_slowdown = std::max(max_slowdown, slowdown);
+    }
+    fmt::print("[{:8.3f}ns, {:8.3f}ns] up to {:.2f}x slower than hot\n",
+               cold.min_ns, cold.max_ns, max_slowdown);
+    // The cold-prefetch results are the time per call when the method's
+    // tables are prefetched after the eviction and cold-prefetch-saved the
+    // time saved compared to no prefetch.
+    auto pm = std::find_if(
+        prefetch_methods.begin(), prefetch_methods.end(),
+        [&](const prefetch_method& p) { return p.name == m.name; });
+    if (pm == prefetch_methods.end()) continue;
+    fmt::print("Benchmarking prefetch    {:20} ... ", m.name);
+    fflush(stdout);
+    benchmark_result warm = m.visit([&](auto dtoa) {
+      return bench_cold(dtoa, opts.cold_evict_size, num_trials, pm->prefetch);
+    });
+    double saved_sum = 0;
+    for (int digit = 1; digit <= max_digits; ++digit) {
+      double saved = cold.per_digit[digit].duration_ns -
+                     warm.per_digit[digit].duration_ns;
+      fmt::print(f, "cold-prefetch,{},{},{:f}\n", m.name, digit,
+                 warm.per_digit[digit].duration_ns);
+      fmt::print(f, "cold-prefetch-saved,{},{},{:f}\n", m.name, digit, saved);
+      saved_sum += saved;
+    }
+    fmt::print("[{:8.3f}ns, {:8.3f}ns] {:.3f}ns saved on average\n",
+               warm.min_ns, warm.max_ns, saved_sum / max_digits);
+  }
+  if (opts.latency) {
+    for (const method& m : methods) {
+      fmt::print("Benchmarking latency     {:20} ... ", m.name);
+      fflush(stdout);
+      write_latency_result(f, m.name, m.visit([&](auto dtoa) {
+                             return bench_latency(dtoa, num_trials);
+                           }));
+    }
+  }
+  if (!opts.weights.empty()) {
+    std::vector<double> data = generate_weighted_data(
+        read_weights(opts.weights), num_doubles_per_digit);
+    std::vector<ranked_method> weighted_ranking;
+    for (const method& m : methods) {
+      fmt::print("Benchmarking weighted    {:20} ... ", m.name);
+      fflush(stdout);
+      corpus_result result = m.visit(
+          [&](auto dtoa) { return bench_corpus(dtoa, data, num_trials); });
+      fmt::print(f, "weighted,{},0,{:f}\n", m.name, result.ns);
+      fmt::print("[{:8.3f}ns]\n", result.ns);
+      if (m.is_exact() && m.name != "null")
+        weighted_ranking.push_back({m.name, result.ns});
+    }
+    print_ranking("weighted shortest and correct", weighted_ranking);
+  }
+  if (!opts.corpus.empty()) {
+    mapped_file file;
+    std::vector<double> finite;
+    std::span<const double> corpus = map_corpus(file, finite, opts.corpus);
+    fmt::print("Corpus {}: {} values\n", opts.corpus, corpus.size());
+    for (const method& m : methods) {
+      fmt::print("Benchmarking corpus      {:20} ... ", m.name);
+      fflush(stdout);
+      corpus_result result = m.visit(
+          [&](auto dtoa) { return bench_corpus(dtoa, corpus, num_trials); });
+      fmt::print(f, "corpus,{},0,{:f}\n", m.name, result.ns);
+      fmt::print("[{:8.3f}ns, {:8.3f}MB/s]\n", result.ns,
+                 result.bytes_per_second / 1e6);
+    }
+    for (const path_method& m : path_methods)
+      print_path_counts(m, "corpus", corpus);
+    for (const method& m : methods) {
+      fmt::print("Benchmarking json corpus {:20} ... ", m.name);
+      fflush(stdout);
+      json_result result = m.visit(
+          [&](auto dtoa) { return bench_json(dtoa, corpus, num_trials); });
+      fmt::print(f, "json-corpus,{},0,{:f}\n", m.name, result.ns);
+      fmt::print(f, "json-corpus-mbps,{},0,{:f}\n", m.name,
+                 result.bytes_per_second / 1e6);
+      fmt::print("[{:8.3f}ns, {:8.3f}MB/s]\n", result.ns,
+                 result.bytes_per_second / 1e6);
     }
-    fmt::print("[{:8.3f}ns, {:8.3f}ns]\n", result.min_ns, result.max_ns);
   }
+  if (opts.incremental) finish_incremental_run(run, f, filename);
   fclose(f);
+  fclose(samples_file);
 }
@@ -5,10 +5,435 @@
 #ifndef BENCHMARK_H_
 #define BENCHMARK_H_
 
+#include <float.h>   // LDBL_MANT_DIG
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+
+#include <initializer_list>
+#include <source_location>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The size of the buffer passed to conversion methods. It fits any double in
+// fixed notation, e.g. 327 characters for -2.2250738585072014e-308.
+constexpr int dtoa_buffer_size = 512;
+
+// Writes `value` followed by a NUL to `buffer`.
 using dtoa_fun = void (*)(double, char*);
 
+// Writes `value` to `buffer` without a terminating NUL and returns a pointer
+// past the end of the output. Preferred for methods that know the output
+// length since neither the method nor the caller has to find the end.
+using dtoa_end_fun = char* (*)(double, char*);
+
+// The notation of the output of a method.
+enum class output_notation {
+  general,     // Fixed or exponential depending on the exponent, e.g. 0.1.
+  scientific,  // Always with an exponent, e.g. 1E-1 or 1e-01.
+  fixed,       // Never with an exponent.
+};
+
+// Properties of a method checked by verification and used to group results.
+// The defaults describe a shortest, correctly rounded method like to_chars.
+struct method_info {
+  // Whether the output has the fewest significant digits that round-trip,
+  // e.g. 0.1 rather than 0.10000000000000001.
+  bool shortest = true;
+  // Whether the output parses back to the same value.
+  bool correct = true;
+  output_notation notation = output_notation::general;
+  bool allocates = false;
+  bool thread_safe = true;
+  // The size in bytes of the method's lookup tables if known. It is written to
+  // the results so that footprint can be weighed against speed.
+  size_t table_size = 0;
+};
+
+// Methods that are not both shortest and correct are verified and ranked
+// separately as approximate.
 struct register_method {
-  register_method(const char* name, dtoa_fun dtoa);
+  register_method(
+      const char* name, dtoa_fun dtoa, method_info info = {},
+      std::source_location location = std::source_location::current());
+  register_method(
+      const char* name, dtoa_end_fun dtoa, method_info info = {},
+      std::source_location location = std::source_location::current());
+};
+
+// A method specialized for values in [min, max], e.g. for a schema that
+// guarantees a value range, which may give wrong results or crash outside of
+// it. Range methods are verified and benchmarked only on the datasets whose
+// values are all in the range and reported next to the general methods.
+struct register_range_method {
+  register_range_method(
+      const char* name, dtoa_end_fun dtoa, double min, double max,
+      std::source_location location = std::source_location::current());
+};
+
+// Converts `count` values into `buffer` with the conversion inlined into the
+// loop rather than called through a pointer as in the other benchmarks.
+using inline_loop_fun = void (*)(const double* values, size_t count,
+                                 char* buffer);
+
+// Reports the time of the method `name` with the conversion inlined next to
+// the indirect one. Use DTOA_BENCHMARK_INLINE to instantiate the loop.
+struct register_inline_method {
+  register_inline_method(
+      const char* name, inline_loop_fun loop,
+      std::source_location location = std::source_location::current());
+};
+
+// Keeps the compiler from eliding the writes to `buffer` of all but the last
+// inlined conversion.
+inline void clobber_buffer(char* buffer) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(buffer) : "memory");
+#else
+  (void)buffer;
+#endif
+}
+
+// Registers the inline variant of the method `name` whose conversion is the
+// callable `...`, e.g. a lambda with the same signature as the method, as the
+// static variable `var`.
+#define DTOA_BENCHMARK_INLINE(var, name, ...)                              \
+  static register_inline_method var(                                       \
+      name, [](const double* values, size_t count, char* buffer) {         \
+        auto convert = __VA_ARGS__;                                        \
+        for (size_t i = 0; i < count; ++i) {                               \
+          convert(values[i], buffer);                                      \
+          clobber_buffer(buffer);                                          \
+        }                                                                  \
+      })
+
+// Returns the number of times a method fell back to a slower path, e.g. an
+// exact algorithm when a fast one cannot prove its result correct, since the
+// last call.
+using fallback_counter = uint64_t (*)();
+
+// Reports the fallback rate of the method `name` per digit count.
+struct register_fallback_counter {
+  register_fallback_counter(
+      const char* name, fallback_counter count,
+      std::source_location location = std::source_location::current());
+};
+
+// The number of conversions that took a code path of a method.
+struct path_count {
+  const char* path;
+  uint64_t count;
+};
+
+// Returns the number of conversions per code path since the last call.
+using path_counter = std::span<const path_count> (*)();
+
+// Reports how often conversions take each code path, e.g. a fast path and the
+// fallbacks it can break to, on every dataset. `dtoa` is an instrumented build
+// of the method `name` and is not timed.
+struct register_path_counter {
+  register_path_counter(
+      const char* name, dtoa_fun dtoa, path_counter count,
+      std::source_location location = std::source_location::current());
+};
+
+// Reports the static footprint of the method `name`: the total size of code
+// and of tables of the symbols whose names contain any of `symbols` as a whole
+// identifier, e.g. the library's conversion functions and lookup tables. Code
+// inlined into the registered function is not included.
+struct register_footprint {
+  register_footprint(
+      const char* name, std::initializer_list<const char*> symbols,
+      std::source_location location = std::source_location::current());
+};
+
+// Prefetches the tables of a method into the caches ahead of a conversion.
+using table_prefetcher = void (*)();
+
+// Reports how much of the cold-cache latency of the method `name` is saved by
+// calling `prefetch` ahead of each conversion.
+struct register_prefetch {
+  register_prefetch(
+      const char* name, table_prefetcher prefetch,
+      std::source_location location = std::source_location::current());
+};
+
+// Hex methods write `value` as a hexadecimal floating-point number, e.g.
+// 0x1.8p+0 like printf's %a, followed by a NUL. The 0x prefix and the binary
+// exponent are optional.
+struct register_hex_method {
+  register_hex_method(
+      const char* name, dtoa_fun dtoa,
+      std::source_location location = std::source_location::current());
+};
+
+using ftoa_fun = void (*)(float, char*);
+
+struct register_float_method {
+  register_float_method(
+      const char* name, ftoa_fun ftoa, method_info info = {},
+      std::source_location location = std::source_location::current());
+};
+
+// 16-bit binary floating-point formats.
+enum class float16_format { binary16, bfloat16 };
+
+// Converts a 16-bit value given by its bit pattern.
+using f16toa_fun = void (*)(uint16_t bits, char* buffer);
+
+struct register_float16_method {
+  register_float16_method(
+      const char* name, float16_format format, f16toa_fun f16toa,
+      std::source_location location = std::source_location::current());
+};
+
+#if LDBL_MANT_DIG == 64
+using ldtoa_fun = void (*)(long double, char*);
+
+// long double methods are only benchmarked if it is the x87 80-bit format.
+struct register_long_double_method {
+  register_long_double_method(
+      const char* name, ldtoa_fun ldtoa,
+      std::source_location location = std::source_location::current());
+};
+#endif
+
+#ifdef __SIZEOF_FLOAT128__
+using f128toa_fun = void (*)(__float128, char*);
+
+// binary128 methods are only benchmarked if libquadmath is available.
+struct register_float128_method {
+  register_float128_method(
+      const char* name, f128toa_fun f128toa,
+      std::source_location location = std::source_location::current());
+};
+#endif
+
+// Parses a decimal floating-point number in [begin, end). The character at
+// `end` is guaranteed to be a NUL for parsers that require one.
+using parse_fun = double (*)(const char* begin, const char* end);
+
+struct register_parse_method {
+  register_parse_method(
+      const char* name, parse_fun parse,
+      std::source_location location = std::source_location::current());
+};
+
+// Parses `input`, numbers each followed by a newline like a CSV column, into
+// `out` and returns the number of values parsed. `out` should have room for a
+// value per line. Every parse method is also benchmarked on columns, parsing
+// one line at a time.
+using column_parse_fun = size_t (*)(std::string_view input, double* out);
+
+struct register_column_parse_method {
+  register_column_parse_method(
+      const char* name, column_parse_fun parse,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes the digits of a 17-digit decimal significand, e.g. the output of a
+// binary-to-decimal conversion, without trailing zeros followed by a NUL to
+// `buffer`. Used to measure digit emission separately from the conversion.
+using digits_fun = void (*)(uint64_t sig, char* buffer);
+
+struct register_digits_method {
+  register_digits_method(
+      const char* name, digits_fun write_digits,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes an integer without a terminating NUL to `buffer` and returns a
+// pointer past the end.
+using itoa32_fun = char* (*)(int32_t value, char* buffer);
+using itoa64_fun = char* (*)(int64_t value, char* buffer);
+
+// Integer methods format 32- and 64-bit integers with the same digit count
+// buckets as the floating-point ones, e.g. for serializers that emit both.
+struct register_itoa_method {
+  register_itoa_method(
+      const char* name, itoa32_fun itoa32, itoa64_fun itoa64,
+      std::source_location location = std::source_location::current());
+};
+
+// A decimal floating-point number sig * 10**exp.
+struct decimal_fp {
+  uint64_t sig;
+  int exp;
+};
+
+// Converts the absolute value of a finite nonzero double into its shortest
+// correctly rounded decimal representation without writing any characters.
+// The significand may have trailing zeros.
+using decimal_fun = decimal_fp (*)(double value);
+
+struct register_decimal_method {
+  register_decimal_method(
+      const char* name, decimal_fun to_decimal,
+      std::source_location location = std::source_location::current());
+};
+
+// Converts a float like decimal_fun, with up to 9 significant digits.
+using float_decimal_fun = decimal_fp (*)(float value);
+
+struct register_float_decimal_method {
+  register_float_decimal_method(
+      const char* name, float_decimal_fun to_decimal,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes a positive decimal of up to 17 digits without trailing zeros, e.g.
+// the output of a binary-to-decimal conversion, in the method's usual format
+// followed by a NUL to `buffer`. Used to measure formatting separately from
+// the conversion.
+using format_fun = void (*)(decimal_fp dec, char* buffer);
+
+struct register_format_method {
+  register_format_method(
+      const char* name, format_fun format,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes an IEEE 754 decimal64 value in the binary integer decimal (BID)
+// encoding, given by its bit pattern, followed by a NUL to `buffer`. Decimal
+// formatting needs no binary-to-decimal conversion, only digit emission.
+using decimal64_fun = void (*)(uint64_t bits, char* buffer);
+
+// decimal64 methods are compared with the method of the same name formatting
+// the same values stored as doubles.
+struct register_decimal64_method {
+  register_decimal64_method(
+      const char* name, decimal64_fun format,
+      std::source_location location = std::source_location::current());
+};
+
+// Fixed-precision output formats.
+enum class fixed_precision_format {
+  fixed,     // printf's %.*f
+  exponent,  // printf's %.*e
+  general,   // printf's %.*g
+};
+
+// Writes `value` with `precision` digits after the decimal point, or
+// significant digits for the general format, in the method's format followed
+// by a NUL to `buffer`.
+using precision_fun = void (*)(double value, int precision, char* buffer);
+
+// `max_precision` is the largest precision the method supports. Larger
+// precisions of the sweep are skipped.
+struct register_precision_method {
+  register_precision_method(
+      const char* name, fixed_precision_format format, precision_fun format_fun,
+      int max_precision = 17,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes the shortest representation of `value` to a buffer of size `n`,
+// e.g. the tail of a network buffer, and returns the size of the full output.
+// Output that doesn't fit is truncated to `n` bytes, or `n - 1` bytes and a
+// NUL like snprintf. Nothing is written past `n` bytes.
+using bounded_fun = size_t (*)(double value, char* buffer, size_t n);
+
+struct register_bounded_method {
+  register_bounded_method(
+      const char* name, bounded_fun write,
+      std::source_location location = std::source_location::current());
+};
+
+// Writes `value` to `buffer` as UTF-16 code units, e.g. for Windows APIs or
+// Java and JavaScript strings, without a terminating null and returns a
+// pointer past the end of the output.
+using wide_dtoa_fun = char16_t* (*)(double value, char16_t* buffer);
+
+struct register_wide_method {
+  register_wide_method(
+      const char* name, wide_dtoa_fun dtoa,
+      std::source_location location = std::source_location::current());
+};
+
+// Copies the ASCII output of a narrow method to `out` as UTF-16 code units,
+// i.e. the widening that wide methods avoid, and returns a pointer past the
+// end.
+inline auto widen(const char* begin, const char* end, char16_t* out)
+    -> char16_t* {
+  for (; begin != end; ++begin) *out++ = char16_t(*begin);
+  return out;
+}
+
+// The maximum number of bytes a batch method may write per value including
+// the one-byte length prefix.
+constexpr int batch_value_size = 32;
+
+// Converts `values` into `out` as a sequence of length-prefixed strings, i.e.
+// a one-byte length followed by that many characters without a terminating
+// NUL, and returns a pointer past the last string. `out` should point to a
+// buffer of size `values.size() * batch_value_size` or larger.
+using batch_dtoa_fun = char* (*)(std::span<const double> values, char* out);
+
+struct register_batch_method {
+  register_batch_method(
+      const char* name, batch_dtoa_fun dtoa, method_info info = {},
+      std::source_location location = std::source_location::current());
+};
+
+// Converts `values` on `num_threads` threads into contiguous output at `out`,
+// each value followed by a newline, and returns a pointer past the end. `out`
+// should point to a buffer of size `values.size() * batch_value_size` or
+// larger.
+using parallel_dtoa_fun = char* (*)(std::span<const double> values, char* out,
+                                    int num_threads);
+
+struct register_parallel_method {
+  register_parallel_method(
+      const char* name, parallel_dtoa_fun dtoa, method_info info = {},
+      std::source_location location = std::source_location::current());
 };
 
+// The maximum number of bytes a columnar method may write per value.
+constexpr int columnar_value_size = 16;
+
+// Converts `values` into their shortest decimal significands and exponents in
+// a method-specific layout, e.g. an array of structs or separate arrays, and
+// returns the number of bytes written. `out` should point to a buffer of size
+// `values.size() * columnar_value_size` or larger, aligned like malloc.
+using columnar_fun = size_t (*)(std::span<const double> values, char* out);
+
+struct register_columnar_method {
+  register_columnar_method(
+      const char* name, columnar_fun convert,
+      std::source_location location = std::source_location::current());
+};
+
+// The maximum number of bytes a fixed column method may write per value.
+constexpr int fixed_column_value_size = 32;
+
+// Writes `values` that share a decimal exponent, e.g. prices, as text in the
+// fixed notation, each followed by a newline like a CSV column, and returns a
+// pointer past the end. `out` should point to a buffer of size
+// `values.size() * fixed_column_value_size` or larger.
+using fixed_column_fun = char* (*)(std::span<const double> values, char* out);
+
+struct register_fixed_column_method {
+  register_fixed_column_method(
+      const char* name, fixed_column_fun write,
+      std::source_location location = std::source_location::current());
+};
+
+// The registered methods of one name, e.g. "zmij", for tools that reuse them
+// such as dtoa-convert. A function is null if there is no method of its kind
+// with the name. At most one of dtoa and dtoa_end is set.
+struct named_methods {
+  dtoa_fun dtoa = nullptr;
+  dtoa_end_fun dtoa_end = nullptr;
+  batch_dtoa_fun batch = nullptr;
+  parallel_dtoa_fun parallel = nullptr;
+  ftoa_fun ftoa = nullptr;
+};
+
+// Returns the registered methods named `name`.
+auto find_methods(std::string_view name) -> named_methods;
+
+// Returns the names of the registered double and float methods.
+auto method_names() -> std::vector<std::string>;
+
 #endif  // BENCHMARK_H_
@@ -0,0 +1,140 @@
+// Direct-mapped caches of formatted doubles.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef CONVERSION_CACHE_H_
+#define CONVERSION_CACHE_H_
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+#include <string.h>  // memcpy
+
+#include <atomic>
+
+// The number of output bytes stored per entry. Longer outputs aren't cached.
+constexpr size_t cached_output_size = 23;
+
+// Returns the bit pattern of `value` which is the cache key, so that e.g. 0
+// and -0 are distinct.
+inline auto get_cache_key(double value) -> uint64_t {
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(value));
+  return bits;
+}
+
+// Returns the index of `key` in a cache of `Size` entries. Multiplicative
+// hashing spreads keys that only differ in the upper bits like small integers.
+template <size_t Size> auto get_cache_index(uint64_t key) -> size_t {
+  static_assert(Size > 1 && (Size & (Size - 1)) == 0,
+                "size must be a power of two");
+  constexpr int num_index_bits = [] {
+    int n = 0;
+    while ((size_t(1) << n) < Size) ++n;
+    return n;
+  }();
+  return size_t((key * 0x9e3779b97f4a7c15) >> (64 - num_index_bits));
+}
+
+// A cache of `Size` entries for use by a single thread, e.g. as a
+// thread_local, without any atomics. `write(value, buffer)` converts a value on
+// a miss and returns a pointer past the end of the output. On a hit
+// cached_output_size bytes are copied to `buffer` which must have room for
+// them.
+template <size_t Size>
+class conversion_cache {
+ private:
+  struct entry {
+    uint64_t key;
+    uint8_t size;  // The output size or 0 if the entry is empty.
+    char chars[cached_output_size];
+  };
+
+  entry entries_[Size] = {};
+
+ public:
+  void clear() { memset(entries_, 0, sizeof(entries_)); }
+
+  template <typename Write>
+  auto write(double value, char* buffer, Write write) -> char* {
+    uint64_t key = get_cache_key(value);
+    entry& e = entries_[get_cache_index<Size>(key)];
+    if (e.key == key && e.size != 0) {
+      memcpy(buffer, e.chars, sizeof(e.chars));
+      return buffer + e.size;
+    }
+    char* end = write(value, buffer);
+    size_t size = size_t(end - buffer);
+    // Only outputs shorter than an entry are cached so that the terminating
+    // NUL of methods that write one is copied with them.
+    if (size >= sizeof(e.chars)) return end;
+    e.key = key;
+    e.size = uint8_t(size);
+    memcpy(e.chars, buffer, sizeof(e.chars));
+    return end;
+  }
+};
+
+// A cache of `Size` entries shared between threads. Each entry is protected
+// by a sequence lock. Readers treat a concurrent update as a miss instead of
+// retrying and writers skip an entry that another thread is writing.
+template <size_t Size>
+class shared_conversion_cache {
+ private:
+  static constexpr size_t num_words = (cached_output_size + 1 + 7) / 8;
+
+  struct entry {
+    std::atomic<uint64_t> version;  // Odd while the entry is being written.
+    std::atomic<uint64_t> key;
+    // The output size in the first byte followed by the output.
+    std::atomic<uint64_t> words[num_words];
+  };
+
+  entry entries_[Size] = {};
+
+ public:
+  void clear() {
+    for (entry& e : entries_) {
+      e.version.store(0, std::memory_order_relaxed);
+      e.key.store(0, std::memory_order_relaxed);
+      for (auto& w : e.words) w.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  template <typename Write>
+  auto write(double value, char* buffer, Write write) -> char* {
+    uint64_t key = get_cache_key(value);
+    entry& e = entries_[get_cache_index<Size>(key)];
+    uint64_t version = e.version.load(std::memory_order_acquire);
+    if ((version & 1) == 0 && e.key.load(std::memory_order_relaxed) == key) {
+      uint64_t words[num_words];
+      for (size_t i = 0; i < num_words; ++i)
+        words[i] = e.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const char* chars = reinterpret_cast<const char*>(words);
+      auto size = static_cast<unsigned char>(chars[0]);
+      if (e.version.load(std::memory_order_relaxed) == version && size != 0) {
+        memcpy(buffer, chars + 1, cached_output_size);
+        return buffer + size;
+      }
+    }
+    char* end = write(value, buffer);
+    size_t size = size_t(end - buffer);
+    if (size >= cached_output_size || (version & 1) != 0 ||
+        !e.version.compare_exchange_strong(version, version + 1,
+                                           std::memory_order_relaxed)) {
+      return end;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t words[num_words];
+    char* chars = reinterpret_cast<char*>(words);
+    chars[0] = char(size);
+    memcpy(chars + 1, buffer, cached_output_size);
+    e.key.store(key, std::memory_order_relaxed);
+    for (size_t i = 0; i < num_words; ++i)
+      e.words[i].store(words[i], std::memory_order_relaxed);
+    e.version.store(version + 2, std::memory_order_release);
+    return end;
+  }
+};
+
+#endif  // CONVERSION_CACHE_H_
@@ -0,0 +1,61 @@
+// A low-overhead serializing cycle counter.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include <stdint.h>  // uint64_t
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>  // __rdtscp, _mm_lfence
+#  define HAS_CYCLE_COUNTER 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#  include <intrin.h>  // __rdtscp, _mm_lfence
+#  define HAS_CYCLE_COUNTER 1
+#elif defined(__aarch64__)
+#  define HAS_CYCLE_COUNTER 1
+#else
+#  define HAS_CYCLE_COUNTER 0
+#endif
+
+// Returns the current value of the time-stamp counter (x86) or the virtual
+// counter (AArch64) without letting earlier or later instructions be reordered
+// across the read. Falls back to std::chrono::steady_clock elsewhere. The tick
+// rate is fixed but implementation-defined, see ticks_per_ns().
+inline auto read_cycle_counter() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  unsigned aux = 0;
+  uint64_t ticks = __rdtscp(&aux);  // Waits for earlier instructions.
+  _mm_lfence();                     // Prevents later ones from starting.
+  return ticks;
+#elif defined(__aarch64__)
+  uint64_t ticks = 0;
+  asm volatile("isb; mrs %0, cntvct_el0; isb" : "=r"(ticks) : : "memory");
+  return ticks;
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Returns the number of cycle counter ticks per nanosecond, measured once
+// against std::chrono::steady_clock.
+inline auto ticks_per_ns() -> double {
+  static const double result = []() {
+    using clock = std::chrono::steady_clock;
+    auto start_time = clock::now();
+    uint64_t start_ticks = read_cycle_counter();
+    while (clock::now() - start_time < std::chrono::milliseconds(20)) {
+    }
+    uint64_t ticks = read_cycle_counter() - start_ticks;
+    auto ns = std::chrono::duration<double, std::nano>(clock::now() -
+                                                       start_time);
+    return double(ticks) / ns.count();
+  }();
+  return result;
+}
+
+#endif  // CYCLE_COUNTER_H_
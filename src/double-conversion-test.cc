@@ -1,9 +1,96 @@
 #include "double-conversion/double-conversion.h"
 
 #include "benchmark.h"
+#include "double-conversion/bignum-dtoa.h"
 
 static register_method _("double-conversion", [](double value, char* buffer) {
   using namespace double_conversion;
   StringBuilder sb(buffer, 26);
   DoubleToStringConverter::EcmaScriptConverter().ToShortest(value, &sb);
+  return buffer + sb.position();
 });
+
+static register_footprint footprint(
+    "double-conversion",
+    {"double_conversion::DoubleToStringConverter::ToShortestIeeeNumber",
+     "double_conversion::DoubleToStringConverter::CreateDecimalRepresentation",
+     "double_conversion::DoubleToStringConverter::"
+     "CreateExponentialRepresentation",
+     "double_conversion::DoubleToStringConverter::HandleSpecialValues",
+     "double_conversion::FastDtoa", "double_conversion::BignumDtoa",
+     "double_conversion::Bignum", "double_conversion::PowersOfTenCache",
+     "double_conversion::kCachedPowers"});
+
+// Same as EcmaScriptConverter but with custom flags, e.g. "1.0" rather than "1"
+// and %g-like exponent thresholds.
+static register_method converter(
+    "double-conversion-converter", [](double value, char* buffer) {
+      using namespace double_conversion;
+      static thread_local const DoubleToStringConverter converter(
+          DoubleToStringConverter::EMIT_TRAILING_DECIMAL_POINT |
+              DoubleToStringConverter::EMIT_TRAILING_ZERO_AFTER_POINT |
+              DoubleToStringConverter::UNIQUE_ZERO,
+          "inf", "nan", 'e', -4, 17, 6, 0);
+      StringBuilder sb(buffer, 26);
+      converter.ToShortest(value, &sb);
+      return buffer + sb.position();
+    });
+
+// Converts the digits produced by double-conversion into a decimal_fp.
+static auto to_decimal_fp(const char* digits, int length, int point)
+    -> decimal_fp {
+  uint64_t sig = 0;
+  for (int i = 0; i < length; ++i) sig = sig * 10 + (digits[i] - '0');
+  return {sig, point - length};
+}
+
+// Raw digits without a StringBuilder or the formatting of ToShortest.
+static register_decimal_method decimal(
+    "double-conversion", [](double value) -> decimal_fp {
+      using namespace double_conversion;
+      char digits[DoubleToStringConverter::kBase10MaximalLength + 1];
+      bool sign = false;
+      int length = 0, point = 0;
+      DoubleToStringConverter::DoubleToAscii(
+          value, DoubleToStringConverter::SHORTEST, 0, digits, sizeof(digits),
+          &sign, &length, &point);
+      return to_decimal_fp(digits, length, point);
+    });
+
+// The bignum fallback that DoubleToAscii uses when the fast Grisu3 path fails.
+static register_decimal_method bignum(
+    "double-conversion-bignum", [](double value) -> decimal_fp {
+      using namespace double_conversion;
+      char digits[DoubleToStringConverter::kBase10MaximalLength + 1];
+      int length = 0, point = 0;
+      BignumDtoa(value, BIGNUM_DTOA_SHORTEST, 0,
+                 Vector<char>(digits, sizeof(digits)), &length, &point);
+      return to_decimal_fp(digits, length, point);
+    });
+
+static register_parse_method parse(
+    "double-conversion", [](const char* begin, const char* end) {
+      using namespace double_conversion;
+      static const StringToDoubleConverter converter(
+          StringToDoubleConverter::NO_FLAGS, 0.0, 0.0, "inf", "nan");
+      int count = 0;
+      return converter.StringToDouble(begin, int(end - begin), &count);
+    });
+
+static register_precision_method fixed(
+    "double-conversion-%f", fixed_precision_format::fixed,
+    [](double value, int precision, char* buffer) {
+      using namespace double_conversion;
+      StringBuilder sb(buffer, 512);
+      DoubleToStringConverter::EcmaScriptConverter().ToFixed(value, precision,
+                                                             &sb);
+    });
+
+static register_precision_method exponent(
+    "double-conversion-%e", fixed_precision_format::exponent,
+    [](double value, int precision, char* buffer) {
+      using namespace double_conversion;
+      StringBuilder sb(buffer, 512);
+      DoubleToStringConverter::EcmaScriptConverter().ToExponential(
+          value, precision, &sb);
+    });
@@ -1,6 +1,151 @@
 #include "benchmark.h"
 #include "dragonbox/dragonbox_to_chars.h"
 
-static register_method _("dragonbox", [](double value, char* buffer) {
-  jkj::dragonbox::to_chars(value, buffer, jkj::dragonbox::policy::cache::full);
+namespace policy = jkj::dragonbox::policy;
+
+constexpr size_t full_cache_size = sizeof(
+    jkj::dragonbox::cache_holder<jkj::dragonbox::ieee754_binary64>::cache);
+constexpr size_t compact_cache_size =
+    sizeof(jkj::dragonbox::compressed_cache_holder<
+           jkj::dragonbox::ieee754_binary64>::cache) +
+    sizeof(jkj::dragonbox::compressed_cache_holder<
+           jkj::dragonbox::ieee754_binary64>::pow5_table);
+
+// Dragonbox's to_chars always writes an exponent, e.g. 1E-1.
+constexpr method_info full_cache_info = {
+    .notation = output_notation::scientific, .table_size = full_cache_size};
+constexpr method_info compact_cache_info = {
+    .notation = output_notation::scientific, .table_size = compact_cache_size};
+
+template <typename... Policies>
+auto to_chars_with(double value, char* buffer) -> char* {
+  return jkj::dragonbox::to_chars_n(value, buffer, Policies()...);
+}
+
+static register_method _("dragonbox", to_chars_with<policy::cache::full_t>,
+                         full_cache_info);
+
+// Inlines the header-only to_decimal. The digit generation is out of line.
+DTOA_BENCHMARK_INLINE(inline_to_chars, "dragonbox",
+                      to_chars_with<policy::cache::full_t>);
+
+// Policy variants. The table size only counts the cache of powers of 10.
+static register_method compact("dragonbox-compact",
+                               to_chars_with<policy::cache::compact_t>,
+                               compact_cache_info);
+
+static register_method compact_digits(
+    "dragonbox-compact-digits",
+    to_chars_with<policy::cache::full_t, policy::digit_generation::compact_t>,
+    full_cache_info);
+
+static register_method compact_all(
+    "dragonbox-compact-all",
+    to_chars_with<policy::cache::compact_t,
+                  policy::digit_generation::compact_t>,
+    compact_cache_info);
+
+// Assumes round-to-nearest-even input without checking the boundaries at
+// runtime.
+static register_method static_boundary(
+    "dragonbox-static-boundary",
+    to_chars_with<
+        policy::cache::full_t,
+        policy::decimal_to_binary_rounding::nearest_to_even_static_boundary_t>,
+    full_cache_info);
+
+// The out-of-line digit generation and the cache are shared by the policy
+// variants.
+static register_footprint footprint(
+    "dragonbox",
+    {"to_chars_with<jkj::dragonbox::policy::cache::full_t>",
+     "jkj::dragonbox::detail::to_chars<jkj::dragonbox::ieee754_binary64",
+     "jkj::dragonbox::cache_holder<jkj::dragonbox::ieee754_binary64, void>",
+     "jkj::dragonbox::detail::radix_100_table",
+     "jkj::dragonbox::detail::radix_100_head_table"});
+
+static register_footprint compact_footprint(
+    "dragonbox-compact",
+    {"to_chars_with<jkj::dragonbox::policy::cache::compact_t>",
+     "jkj::dragonbox::detail::to_chars<jkj::dragonbox::ieee754_binary64",
+     "jkj::dragonbox::compressed_cache_holder<"
+     "jkj::dragonbox::ieee754_binary64, void>",
+     "jkj::dragonbox::detail::radix_100_table",
+     "jkj::dragonbox::detail::radix_100_head_table"});
+
+// Dragonbox has no prefetch API so the cache of powers of 10 is prefetched by
+// address. The digit tables are internal to dragonbox_to_chars.cpp.
+template <typename T>
+void prefetch_table(const T& table) {
+  for (size_t i = 0; i < sizeof(table); i += 64)
+    __builtin_prefetch(reinterpret_cast<const char*>(&table) + i);
+}
+
+static register_prefetch prefetch("dragonbox", []() {
+  prefetch_table(
+      jkj::dragonbox::cache_holder<jkj::dragonbox::ieee754_binary64>::cache);
+});
+
+static register_prefetch prefetch_compact("dragonbox-compact", []() {
+  using holder = jkj::dragonbox::compressed_cache_holder<
+      jkj::dragonbox::ieee754_binary64>;
+  prefetch_table(holder::cache);
+  prefetch_table(holder::pow5_table);
 });
+
+// Binary-to-decimal rounding only affects which of two equally short
+// candidates is picked so the output may differ from the closest one.
+static register_method do_not_care(
+    "dragonbox-do-not-care",
+    to_chars_with<policy::cache::full_t,
+                  policy::binary_to_decimal_rounding::do_not_care_t>,
+    full_cache_info);
+
+static register_method away_from_zero(
+    "dragonbox-away-from-zero",
+    to_chars_with<policy::cache::full_t,
+                  policy::binary_to_decimal_rounding::away_from_zero_t>,
+    full_cache_info);
+
+static register_batch_method batch(
+    "dragonbox", [](std::span<const double> values, char* out) {
+      for (double value : values) {
+        char* end = jkj::dragonbox::to_chars_n(
+            value, out + 1, policy::cache::full);
+        *out = char(end - out - 1);
+        out = end;
+      }
+      return out;
+    },
+    {.notation = output_notation::scientific});
+
+static register_float_method float32(
+    "dragonbox",
+    [](float value, char* buffer) {
+      jkj::dragonbox::to_chars(value, buffer, policy::cache::full);
+    },
+    {.notation = output_notation::scientific});
+
+template <typename... Policies>
+auto to_decimal_with(double value) -> decimal_fp {
+  auto dec =
+      jkj::dragonbox::to_decimal(value, policy::sign::ignore, Policies()...);
+  return {dec.significand, dec.exponent};
+}
+
+static register_decimal_method decimal(
+    "dragonbox", to_decimal_with<policy::cache::full_t>);
+
+static register_decimal_method decimal_compact(
+    "dragonbox-compact", to_decimal_with<policy::cache::compact_t>);
+
+// Leaves trailing zeros in the significand instead of removing them.
+static register_decimal_method decimal_keep_zeros(
+    "dragonbox-keep-zeros",
+    to_decimal_with<policy::cache::full_t, policy::trailing_zero::ignore_t>);
+
+static register_format_method format(
+    "dragonbox", [](decimal_fp dec, char* buffer) {
+      *jkj::dragonbox::detail::to_chars<jkj::dragonbox::ieee754_binary64>(
+          dec.sig, dec.exp, buffer) = '\0';
+    });
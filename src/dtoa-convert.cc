@@ -0,0 +1,356 @@
+// A converter of raw binary doubles or floats to text with the methods of the
+// benchmark to measure end-to-end throughput including output.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include <errno.h>
+#include <fcntl.h>     // open
+#include <limits.h>    // IOV_MAX
+#include <stdlib.h>    // exit
+#include <string.h>    // strlen
+#include <sys/uio.h>   // writev
+#include <unistd.h>    // close
+
+#include <algorithm>  // std::min
+#include <atomic>
+#include <charconv>  // std::from_chars
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "fmt/format.h"
+#include "mapped-file.h"
+
+namespace {
+
+// The number of values converted by a thread as a unit. The text of a chunk,
+// up to 2MB, is written with the others of the same round in one writev.
+constexpr size_t chunk_size = 65536;
+
+// The number of chunks per thread in a round of conversion and output.
+constexpr size_t chunks_per_thread = 4;
+
+#ifndef IOV_MAX
+constexpr int IOV_MAX = 1024;
+#endif
+
+struct options {
+  std::string method = "zmij";
+  std::string input;
+  std::string output;  // Empty for stdout.
+  bool floats = false;
+  char separator = '\n';
+  unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  bool list = false;
+};
+
+// Parses command-line arguments:
+//   dtoa-convert [--method=NAME] [--float] [--separator=SEP] [--threads=N]
+//                [--list] INPUT [OUTPUT]
+auto parse_options(int argc, char** argv) -> options {
+  options opts;
+  int pos = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (!arg.starts_with("--")) {
+      if (pos == 0) opts.input = arg;
+      if (pos == 1) opts.output = arg;
+      ++pos;
+      continue;
+    }
+    size_t eq = arg.find('=');
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = eq != std::string::npos ? arg.substr(eq + 1) : "";
+    if (name == "method") {
+      opts.method = value;
+    } else if (name == "float") {
+      opts.floats = true;
+    } else if (name == "separator") {
+      // "\n" and "\t" are accepted as escapes since they are hard to pass.
+      opts.separator = value == "\\n"   ? '\n'
+                       : value == "\\t" ? '\t'
+                       : value.empty()  ? '\n'
+                                        : value[0];
+    } else if (name == "threads") {
+      unsigned num_threads = 0;
+      const char* end = value.data() + value.size();
+      auto [ptr, ec] = std::from_chars(value.data(), end, num_threads);
+      if (ec != std::errc() || ptr != end || num_threads == 0) {
+        fmt::print(stderr, "Invalid number of threads: {}\n", arg);
+        exit(1);
+      }
+      opts.num_threads = num_threads;
+    } else if (name == "list") {
+      opts.list = true;
+    } else {
+      fmt::print(stderr, "Unknown option: {}\n", arg);
+      exit(1);
+    }
+  }
+  if (pos == 0 && !opts.list) {
+    fmt::print(stderr,
+               "Usage: dtoa-convert [--method=NAME] [--float] "
+               "[--separator=SEP] [--threads=N] [--list] INPUT [OUTPUT]\n");
+    exit(1);
+  }
+  return opts;
+}
+
+// Appends the text of `values`, each followed by `separator`, to `out` with
+// `write_one(value, buffer)` which returns a pointer past the output. The
+// buffer is grown as needed since methods in the fixed notation may write
+// hundreds of characters per value.
+template <typename T, typename F>
+void convert_values(std::span<const T> values, F write_one, char separator,
+                    std::vector<char>& out) {
+  if (out.size() < values.size() * batch_value_size + dtoa_buffer_size)
+    out.resize(values.size() * batch_value_size + dtoa_buffer_size);
+  size_t size = 0;
+  for (T value : values) {
+    if (out.size() - size <= size_t(dtoa_buffer_size))
+      out.resize(out.size() * 2);
+    size = size_t(write_one(value, out.data() + size) - out.data());
+    out[size++] = separator;
+  }
+  out.resize(size);
+}
+
+// Converts `values` into length-prefixed strings with `batch` and appends
+// them to `out`, each followed by `separator`.
+void convert_batch(std::span<const double> values, batch_dtoa_fun batch,
+                   char separator, std::vector<char>& scratch,
+                   std::vector<char>& out) {
+  scratch.resize(values.size() * batch_value_size);
+  const char* end = batch(values, scratch.data());
+  out.resize(values.size() * batch_value_size);
+  char* p = out.data();
+  for (const char* s = scratch.data(); s != end;) {
+    size_t size = static_cast<unsigned char>(*s++);
+    memcpy(p, s, size);
+    p += size;
+    *p++ = separator;
+    s += size;
+  }
+  out.resize(size_t(p - out.data()));
+}
+
+// Writes all buffers in `iov` to `fd`, resuming after partial writes.
+auto write_all(int fd, std::vector<iovec>& iov) -> bool {
+  size_t i = 0;
+  while (i < iov.size()) {
+    int count = int(std::min(iov.size() - i, size_t(IOV_MAX)));
+    ssize_t written = writev(fd, iov.data() + i, count);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    for (size_t n = size_t(written); n != 0;) {
+      size_t consumed = std::min(n, iov[i].iov_len);
+      iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + consumed;
+      iov[i].iov_len -= consumed;
+      n -= consumed;
+      if (iov[i].iov_len == 0) ++i;
+    }
+    while (i < iov.size() && iov[i].iov_len == 0) ++i;
+  }
+  return true;
+}
+
+struct convert_result {
+  size_t output_size = 0;
+  double convert_seconds = 0;
+};
+
+// Converts `values` in rounds of chunks on `num_threads` threads with
+// `convert_chunk(values, out)` and writes the text of each round to `fd`.
+template <typename T, typename F>
+auto convert(std::span<const T> values, unsigned num_threads, int fd,
+             F convert_chunk) -> convert_result {
+  size_t num_chunks = num_threads * chunks_per_thread;
+  std::vector<std::vector<char>> buffers(num_chunks);
+  std::vector<iovec> iov;
+  convert_result result;
+  for (size_t begin = 0; begin < values.size();
+       begin += num_chunks * chunk_size) {
+    auto start = std::chrono::steady_clock::now();
+    size_t round_chunks = std::min(
+        num_chunks, (values.size() - begin + chunk_size - 1) / chunk_size);
+    std::atomic<size_t> next_chunk = 0;
+    auto run = [&] {
+      for (;;) {
+        size_t i = next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (i >= round_chunks) break;
+        size_t first = begin + i * chunk_size;
+        size_t last = std::min(first + chunk_size, values.size());
+        convert_chunk(values.subspan(first, last - first), buffers[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < std::min<size_t>(num_threads, round_chunks); ++t)
+      threads.emplace_back(run);
+    run();
+    for (std::thread& t : threads) t.join();
+    result.convert_seconds += std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+    iov.clear();
+    for (size_t i = 0; i < round_chunks; ++i) {
+      iov.push_back({buffers[i].data(), buffers[i].size()});
+      result.output_size += buffers[i].size();
+    }
+    if (!write_all(fd, iov)) {
+      fmt::print(stderr, "Write failed: {}\n", strerror(errno));
+      exit(1);
+    }
+  }
+  return result;
+}
+
+// Converts `values` in rounds with the parallel method `parallel`, which
+// writes newlines, and writes the text of each round to `fd`.
+auto convert_parallel(std::span<const double> values, unsigned num_threads,
+                      int fd, parallel_dtoa_fun parallel) -> convert_result {
+  size_t round_size = num_threads * chunks_per_thread * chunk_size;
+  std::vector<char> buffer(round_size * batch_value_size);
+  convert_result result;
+  for (size_t begin = 0; begin < values.size(); begin += round_size) {
+    auto start = std::chrono::steady_clock::now();
+    std::span<const double> round =
+        values.subspan(begin, std::min(round_size, values.size() - begin));
+    char* end = parallel(round, buffer.data(), int(num_threads));
+    result.convert_seconds += std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+    std::vector<iovec> iov = {{buffer.data(), size_t(end - buffer.data())}};
+    result.output_size += iov[0].iov_len;
+    if (!write_all(fd, iov)) {
+      fmt::print(stderr, "Write failed: {}\n", strerror(errno));
+      exit(1);
+    }
+  }
+  return result;
+}
+
+void list_methods() {
+  for (const std::string& name : method_names()) {
+    named_methods m = find_methods(name);
+    fmt::print("{:28}", name);
+    if (m.parallel) fmt::print(" parallel");
+    if (m.batch) fmt::print(" batch");
+    if (m.dtoa || m.dtoa_end) fmt::print(" double");
+    if (m.ftoa) fmt::print(" float");
+    fmt::print("\n");
+  }
+}
+
+}  // namespace
+
+// Converts a file of native-endian doubles or floats to text with a
+// registered method, using its parallel or batch variant if there is one,
+// and prints the throughput to stderr.
+auto main(int argc, char** argv) -> int {
+  options opts = parse_options(argc, argv);
+  if (opts.list) {
+    list_methods();
+    return 0;
+  }
+  named_methods m = find_methods(opts.method);
+
+  mapped_file input;
+  if (!input.open(opts.input.c_str())) {
+    fmt::print(stderr, "Failed to open {}: {}\n", opts.input, strerror(errno));
+    return 1;
+  }
+  int fd = 1;
+  if (!opts.output.empty()) {
+    fd = open(opts.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      fmt::print(stderr, "Failed to open {}: {}\n", opts.output,
+                 strerror(errno));
+      return 1;
+    }
+  }
+
+  size_t value_size = opts.floats ? sizeof(float) : sizeof(double);
+  if (input.size() % value_size != 0) {
+    fmt::print(stderr, "warning: ignoring {} trailing bytes\n",
+               input.size() % value_size);
+  }
+  size_t num_values = input.size() / value_size;
+  char separator = opts.separator;
+  auto start = std::chrono::steady_clock::now();
+  convert_result result;
+  const char* path = "double";
+  if (opts.floats) {
+    if (!m.ftoa) {
+      fmt::print(stderr, "No float method {}\n", opts.method);
+      return 1;
+    }
+    path = "float";
+    std::span<const float> values(static_cast<const float*>(input.data()),
+                                  num_values);
+    auto write_one = [ftoa = m.ftoa](float value, char* out) {
+      ftoa(value, out);
+      return out + strlen(out);
+    };
+    result = convert(values, opts.num_threads, fd,
+                     [&](std::span<const float> chunk, std::vector<char>& out) {
+                       convert_values(chunk, write_one, separator, out);
+                     });
+  } else {
+    std::span<const double> values(static_cast<const double*>(input.data()),
+                                   num_values);
+    if (m.parallel && separator == '\n') {
+      path = "parallel";
+      result = convert_parallel(values, opts.num_threads, fd, m.parallel);
+    } else if (m.batch) {
+      path = "batch";
+      result = convert(
+          values, opts.num_threads, fd,
+          [&](std::span<const double> chunk, std::vector<char>& out) {
+            thread_local std::vector<char> scratch;
+            convert_batch(chunk, m.batch, separator, scratch, out);
+          });
+    } else if (m.dtoa_end) {
+      auto write_one = [dtoa = m.dtoa_end](double value, char* out) {
+        return dtoa(value, out);
+      };
+      result = convert(
+          values, opts.num_threads, fd,
+          [&](std::span<const double> chunk, std::vector<char>& out) {
+            convert_values(chunk, write_one, separator, out);
+          });
+    } else if (m.dtoa) {
+      auto write_one = [dtoa = m.dtoa](double value, char* out) {
+        dtoa(value, out);
+        return out + strlen(out);
+      };
+      result = convert(
+          values, opts.num_threads, fd,
+          [&](std::span<const double> chunk, std::vector<char>& out) {
+            convert_values(chunk, write_one, separator, out);
+          });
+    } else {
+      fmt::print(stderr, "No method {}, see --list\n", opts.method);
+      return 1;
+    }
+  }
+  if (fd != 1) close(fd);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  fmt::print(stderr,
+             "Converted {} values with {} ({}, {} threads) into {:.1f}MB\n",
+             num_values, opts.method, path, opts.num_threads,
+             double(result.output_size) / 1e6);
+  fmt::print(stderr,
+             "{:.3f}s, {:.3f}GB/s of text, {:.2f}ns per value; conversion "
+             "alone {:.3f}s, {:.3f}GB/s\n",
+             seconds, double(result.output_size) / seconds / 1e9,
+             seconds * 1e9 / double(num_values), result.convert_seconds,
+             double(result.output_size) / result.convert_seconds / 1e9);
+  return 0;
+}
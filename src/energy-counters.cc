@@ -0,0 +1,106 @@
+// Energy counters.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "energy-counters.h"
+
+#include <stdlib.h>  // strtoull
+
+#include <string>
+
+#ifdef __linux__
+#  include <fcntl.h>   // open
+#  include <unistd.h>  // pread
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+auto read_uj(int fd) -> uint64_t {
+  char buf[32] = {};
+  if (pread(fd, buf, sizeof(buf) - 1, 0) <= 0) return 0;
+  return strtoull(buf, nullptr, 10);
+}
+
+// Returns the contents of a small sysfs file without the trailing newline.
+auto read_line(const std::string& path) -> std::string {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return {};
+  char buf[64] = {};
+  ssize_t n = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  std::string result(buf, n > 0 ? size_t(n) : 0);
+  while (!result.empty() && result.back() == '\n') result.pop_back();
+  return result;
+}
+
+}  // namespace
+
+energy_counters::energy_counters() {
+  // Package domains are intel-rapl:N and their subdomains intel-rapl:N:M, one
+  // of which is named core. Other subdomains, e.g. uncore and dram, are not
+  // used.
+  const char* root = "/sys/class/powercap/intel-rapl:";
+  constexpr int max_packages = 8;
+  for (int package = 0; package < max_packages; ++package) {
+    for (int sub = -1; sub < max_packages; ++sub) {
+      std::string dir = root + std::to_string(package);
+      if (sub >= 0) dir += ":" + std::to_string(sub);
+      std::string name = read_line(dir + "/name");
+      if (name.empty()) {
+        if (sub < 0) return;
+        break;
+      }
+      energy_domain domain = energy_package;
+      if (sub >= 0) {
+        if (name != "core") continue;
+        domain = energy_core;
+      }
+      if (num_counters_ == int(sizeof(counters_) / sizeof(*counters_))) return;
+      int fd = open((dir + "/energy_uj").c_str(), O_RDONLY);
+      if (fd < 0) continue;
+      if (read_uj(fd) == 0) {  // Not readable without root on recent kernels.
+        close(fd);
+        continue;
+      }
+      std::string range = read_line(dir + "/max_energy_range_uj");
+      uint64_t max_uj = strtoull(range.c_str(), nullptr, 10);
+      counters_[num_counters_++] = {fd, domain, max_uj};
+      available_[domain] = true;
+    }
+  }
+}
+
+energy_counters::~energy_counters() {
+  for (int i = 0; i < num_counters_; ++i) close(counters_[i].fd);
+}
+
+void energy_counters::start() {
+  for (int i = 0; i < num_counters_; ++i)
+    start_uj_[i] = read_uj(counters_[i].fd);
+}
+
+auto energy_counters::stop() -> energy_counts {
+  energy_counts result;
+  for (int i = 0; i < num_counters_; ++i) {
+    const counter& c = counters_[i];
+    uint64_t end = read_uj(c.fd);
+    // The counter wraps around at max_uj.
+    uint64_t uj = end >= start_uj_[i] ? end - start_uj_[i]
+                                      : end + c.max_uj + 1 - start_uj_[i];
+    result.joules[c.domain] += double(uj) * 1e-6;
+  }
+  return result;
+}
+
+#else
+
+// macOS reports energy through powermetrics and the private IOReport
+// framework, both of which need root or entitlements, so it is unsupported.
+energy_counters::energy_counters() {}
+energy_counters::~energy_counters() {}
+void energy_counters::start() {}
+auto energy_counters::stop() -> energy_counts { return {}; }
+
+#endif
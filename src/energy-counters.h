@@ -0,0 +1,55 @@
+// Energy counters.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef ENERGY_COUNTERS_H_
+#define ENERGY_COUNTERS_H_
+
+#include <stdint.h>  // uint64_t
+
+enum energy_domain { energy_package, energy_core, num_energy_domains };
+
+constexpr const char* energy_domain_names[num_energy_domains] = {"package",
+                                                                 "core"};
+
+struct energy_counts {
+  double joules[num_energy_domains] = {};
+};
+
+// The RAPL energy counters of all CPU packages and of their cores, read from
+// the powercap interface on Linux which covers Intel and recent AMD CPUs.
+// Reading them may require root. The counters are updated about every
+// millisecond and include everything running on the package, so the measured
+// code should run for much longer on an otherwise idle system.
+class energy_counters {
+ private:
+  // Files of the counters and the ranges at which they wrap around.
+  struct counter {
+    int fd;
+    energy_domain domain;
+    uint64_t max_uj;
+  };
+  counter counters_[16];
+  int num_counters_ = 0;
+  bool available_[num_energy_domains] = {};
+  uint64_t start_uj_[16] = {};
+
+ public:
+  energy_counters();
+  ~energy_counters();
+
+  energy_counters(const energy_counters&) = delete;
+  void operator=(const energy_counters&) = delete;
+
+  // Returns true if any domain is available.
+  auto available() const -> bool { return num_counters_ != 0; }
+
+  auto available(energy_domain d) const -> bool { return available_[d]; }
+
+  void start();
+
+  // Returns the energy used since the last call to start().
+  auto stop() -> energy_counts;
+};
+
+#endif  // ENERGY_COUNTERS_H_
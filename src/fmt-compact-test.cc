@@ -0,0 +1,19 @@
+// {fmt} test with the compact Dragonbox cache, i.e. what fmt uses when
+// optimizing for size. It should be compared with fmt which is built the same
+// way but with the full cache.
+#define FMT_HEADER_ONLY 1
+#define FMT_USE_FULL_CACHE_DRAGONBOX 0
+// Use a separate namespace so that the linker doesn't pick the full cache
+// versions of the functions from the compiled library (src/fmt/src/format.cc).
+#define FMT_BEGIN_NAMESPACE \
+  namespace fmt {           \
+  inline namespace v12_compact {
+#define FMT_END_NAMESPACE \
+  }                       \
+  }
+#include "benchmark.h"
+#include "fmt/compile.h"
+
+static register_method _("fmt-compact", [](double value, char* buffer) {
+  return fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+});
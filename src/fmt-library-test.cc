@@ -0,0 +1,27 @@
+// {fmt} tests using the compiled library and runtime format strings, i.e. the
+// way fmt is normally used, as opposed to fmt which uses compile-time format
+// strings and the header-only mode.
+#include <string.h>  // memcpy
+
+#include <iterator>  // std::back_inserter
+
+#include "benchmark.h"
+#include "fmt/format.h"
+
+static register_method _("fmt-runtime", [](double value, char* buffer) {
+  return fmt::format_to(buffer, "{}", value);
+});
+
+static register_method format_to_n(
+    "fmt-format-to-n", [](double value, char* buffer) {
+      // The longest shortest representation of a double has 24 characters.
+      return fmt::format_to_n(buffer, 24, "{}", value).out;
+    });
+
+static register_method memory_buffer(
+    "fmt-memory-buffer", [](double value, char* buffer) {
+      auto buf = fmt::memory_buffer();
+      fmt::format_to(std::back_inserter(buf), "{}", value);
+      memcpy(buffer, buf.data(), buf.size());
+      return buffer + buf.size();
+    });
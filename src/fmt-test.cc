@@ -1,8 +1,101 @@
 #define FMT_HEADER_ONLY 1
+#include <string.h>  // memcpy
+
+#include <string>
+
 #include "benchmark.h"
 #include "fmt/compile.h"
+#include "fmt/xchar.h"
+#include "string-arena.h"
 
 static register_method _("fmt", [](double value, char* buffer) {
-  buffer = fmt::format_to(buffer, FMT_COMPILE("{}"), value);
-  *buffer = '\0';
+  return fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+});
+
+// fmt::format returning a std::string like most application code calls it.
+// It allocates if the output doesn't fit in the small string buffer, e.g. 15
+// characters in libstdc++.
+static register_method format(
+    "fmt-format",
+    [](double value, char* buffer) {
+      std::string s = fmt::format(FMT_COMPILE("{}"), value);
+      memcpy(buffer, s.data(), s.size());
+      return buffer + s.size();
+    },
+    {.allocates = true});
+
+// The same with a std::pmr::string allocated from a per-thread arena. The
+// output is formatted on the stack first like fmt::format does, so that the
+// string is allocated once with the right size.
+static register_method format_pmr(
+    "fmt-format-pmr", [](double value, char* buffer) {
+      char out[dtoa_buffer_size];
+      char* end = fmt::format_to(out, FMT_COMPILE("{}"), value);
+      std::pmr::string s(out, end, get_string_arena().resource());
+      memcpy(buffer, s.data(), s.size());
+      return buffer + s.size();
+    });
+
+static register_hex_method hex("fmt", [](double value, char* buffer) {
+  *fmt::format_to(buffer, FMT_COMPILE("{:a}"), value) = '\0';
+});
+
+static register_batch_method batch(
+    "fmt", [](std::span<const double> values, char* out) {
+      for (double value : values) {
+        char* end = fmt::format_to(out + 1, FMT_COMPILE("{}"), value);
+        *out = char(end - out - 1);
+        out = end;
+      }
+      return out;
+    });
+
+static register_float_method float32(
+    "fmt", [](float value, char* buffer) {
+      buffer = fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+      *buffer = '\0';
+    });
+
+static register_precision_method fixed(
+    "fmt-%f", fixed_precision_format::fixed,
+    [](double value, int precision, char* buffer) {
+      *fmt::format_to(buffer, FMT_COMPILE("{:.{}f}"), value, precision) = '\0';
+    });
+
+static register_precision_method exponent(
+    "fmt-%e", fixed_precision_format::exponent,
+    [](double value, int precision, char* buffer) {
+      *fmt::format_to(buffer, FMT_COMPILE("{:.{}e}"), value, precision) = '\0';
+    });
+
+static register_itoa_method itoa(
+    "fmt",
+    [](int32_t value, char* buffer) {
+      return fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+    },
+    [](int64_t value, char* buffer) {
+      return fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+    });
+
+static register_bounded_method bounded(
+    "fmt", [](double value, char* buffer, size_t n) {
+      return fmt::format_to_n(buffer, n, FMT_COMPILE("{}"), value).size;
+    });
+
+static register_wide_method wide("fmt", [](double value, char16_t* buffer) {
+  return fmt::format_to(buffer, FMT_COMPILE(u"{}"), value);
 });
+
+static register_wide_method wide_copy(
+    "fmt-widen", [](double value, char16_t* buffer) {
+      char narrow[dtoa_buffer_size];
+      char* end = fmt::format_to(narrow, FMT_COMPILE("{}"), value);
+      return widen(narrow, end, buffer);
+    });
+
+static register_fixed_column_method fixed_column(
+    "fmt-%.2f", [](std::span<const double> values, char* out) {
+      for (double value : values)
+        out = fmt::format_to(out, FMT_COMPILE("{:.2f}\n"), value);
+      return out;
+    });
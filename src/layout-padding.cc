@@ -0,0 +1,10 @@
+// Padding in the code section of builds with a randomized code layout.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+// LAYOUT_PADDING bytes that shift the code of the objects linked after this
+// one. It is never executed.
+#define LAYOUT_STRINGIFY(x) #x
+#define LAYOUT_SKIP(size) ".text\n.skip " LAYOUT_STRINGIFY(size) "\n"
+
+asm(LAYOUT_SKIP(LAYOUT_PADDING));
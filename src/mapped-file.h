@@ -0,0 +1,82 @@
+// A read-only memory-mapped file.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <stddef.h>  // size_t
+#include <stdio.h>   // FILE
+#include <stdlib.h>  // malloc
+
+#ifndef _WIN32
+#  include <fcntl.h>     // open
+#  include <sys/mman.h>  // mmap
+#  include <sys/stat.h>  // fstat
+#  include <unistd.h>    // close
+#endif
+
+// Maps a file into memory for reading. Without mmap, e.g. on Windows, the file
+// is read into a heap buffer instead.
+class mapped_file {
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  mapped_file() = default;
+  ~mapped_file() { close(); }
+
+  mapped_file(const mapped_file&) = delete;
+  void operator=(const mapped_file&) = delete;
+
+  // Maps the file at `path` and returns true on success. On failure returns
+  // false with errno set.
+  auto open(const char* path) -> bool {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+    size_ = size_t(st.st_size);
+    if (size_ != 0) {
+      data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data_ == MAP_FAILED) data_ = nullptr;
+    }
+    ::close(fd);
+    if (size_ != 0 && !data_) return false;
+    if (data_) madvise(data_, size_, MADV_SEQUENTIAL);
+    return true;
+#else
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    size_ = size_t(ftell(f));
+    fseek(f, 0, SEEK_SET);
+    data_ = malloc(size_ != 0 ? size_ : 1);
+    bool ok = data_ && fread(data_, 1, size_, f) == size_;
+    fclose(f);
+    if (!ok) close();
+    return ok;
+#endif
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (data_) munmap(data_, size_);
+#else
+    free(data_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  auto data() const -> const void* { return data_; }
+  auto size() const -> size_t { return size_; }
+};
+
+#endif  // MAPPED_FILE_H_
@@ -0,0 +1,272 @@
+// The methods registered with the register_* functions of benchmark.h,
+// shared by dtoa-benchmark and dtoa-convert.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "method-registry.h"
+
+#include <algorithm>  // std::sort
+
+// The vectors are constant-initialized, so methods can be registered by
+// static constructors of any translation unit.
+std::vector<method> methods;
+std::vector<method_source> method_sources;
+std::vector<range_method> range_methods;
+std::vector<fallback_method> fallback_methods;
+std::vector<path_method> path_methods;
+std::vector<footprint_method> footprint_methods;
+std::vector<inline_method> inline_methods;
+std::vector<prefetch_method> prefetch_methods;
+std::vector<batch_method> batch_methods;
+std::vector<parallel_method> parallel_methods;
+std::vector<hex_method> hex_methods;
+std::vector<float_method> float_methods;
+std::vector<float16_method> float16_methods;
+#if LDBL_MANT_DIG == 64
+std::vector<long_double_method> long_double_methods;
+#endif
+#ifdef __SIZEOF_FLOAT128__
+std::vector<float128_method> float128_methods;
+#endif
+std::vector<columnar_method> columnar_methods;
+std::vector<fixed_column_method> fixed_column_methods;
+std::vector<parse_method> parse_methods;
+std::vector<column_parse_method> column_parse_methods;
+std::vector<digits_method> digits_methods;
+std::vector<itoa_method> itoa_methods;
+std::vector<decimal_method> decimal_methods;
+std::vector<float_decimal_method> float_decimal_methods;
+std::vector<format_method> format_methods;
+std::vector<decimal64_method> decimal64_methods;
+std::vector<precision_method> precision_methods;
+std::vector<bounded_method> bounded_methods;
+std::vector<wide_method> wide_methods;
+
+namespace {
+
+void add_source(const char* name, std::source_location location) {
+  method_sources.push_back(method_source{name, location.file_name()});
+}
+
+}  // namespace
+
+register_method::register_method(const char* name, dtoa_fun dtoa,
+                                 method_info info,
+                                 std::source_location location) {
+  add_source(name, location);
+  methods.push_back(method{name, dtoa, nullptr, info});
+}
+
+register_method::register_method(const char* name, dtoa_end_fun dtoa,
+                                 method_info info,
+                                 std::source_location location) {
+  add_source(name, location);
+  methods.push_back(method{name, nullptr, dtoa, info});
+}
+
+register_range_method::register_range_method(const char* name,
+                                             dtoa_end_fun dtoa, double min,
+                                             double max,
+                                             std::source_location location) {
+  add_source(name, location);
+  range_methods.push_back(range_method{name, dtoa, min, max});
+}
+
+register_inline_method::register_inline_method(const char* name,
+                                               inline_loop_fun loop,
+                                               std::source_location location) {
+  add_source(name, location);
+  inline_methods.push_back(inline_method{name, loop});
+}
+
+register_fallback_counter::register_fallback_counter(
+    const char* name, fallback_counter count, std::source_location location) {
+  add_source(name, location);
+  fallback_methods.push_back(fallback_method{name, count});
+}
+
+register_path_counter::register_path_counter(const char* name, dtoa_fun dtoa,
+                                             path_counter count,
+                                             std::source_location location) {
+  add_source(name, location);
+  path_methods.push_back(path_method{name, dtoa, count});
+}
+
+register_footprint::register_footprint(
+    const char* name, std::initializer_list<const char*> symbols,
+    std::source_location location) {
+  add_source(name, location);
+  footprint_methods.push_back(
+      footprint_method{name, {symbols.begin(), symbols.end()}});
+}
+
+register_prefetch::register_prefetch(const char* name,
+                                     table_prefetcher prefetch,
+                                     std::source_location location) {
+  add_source(name, location);
+  prefetch_methods.push_back(prefetch_method{name, prefetch});
+}
+
+register_hex_method::register_hex_method(const char* name, dtoa_fun dtoa,
+                                         std::source_location location) {
+  add_source(name, location);
+  hex_methods.push_back(hex_method{name, dtoa});
+}
+
+register_float_method::register_float_method(const char* name, ftoa_fun ftoa,
+                                             method_info info,
+                                             std::source_location location) {
+  add_source(name, location);
+  float_methods.push_back(float_method{name, ftoa, info});
+}
+
+register_float16_method::register_float16_method(
+    const char* name, float16_format format, f16toa_fun f16toa,
+    std::source_location location) {
+  add_source(name, location);
+  float16_methods.push_back(float16_method{name, format, f16toa});
+}
+
+#if LDBL_MANT_DIG == 64
+register_long_double_method::register_long_double_method(
+    const char* name, ldtoa_fun ldtoa, std::source_location location) {
+  add_source(name, location);
+  long_double_methods.push_back(long_double_method{name, ldtoa});
+}
+#endif
+
+#ifdef __SIZEOF_FLOAT128__
+register_float128_method::register_float128_method(
+    const char* name, f128toa_fun f128toa, std::source_location location) {
+  add_source(name, location);
+  float128_methods.push_back(float128_method{name, f128toa});
+}
+#endif
+
+register_digits_method::register_digits_method(const char* name,
+                                               digits_fun write_digits,
+                                               std::source_location location) {
+  add_source(name, location);
+  digits_methods.push_back(digits_method{name, write_digits});
+}
+
+register_itoa_method::register_itoa_method(const char* name, itoa32_fun itoa32,
+                                           itoa64_fun itoa64,
+                                           std::source_location location) {
+  add_source(name, location);
+  itoa_methods.push_back(itoa_method{name, itoa32, itoa64});
+}
+
+register_decimal_method::register_decimal_method(
+    const char* name, decimal_fun to_decimal, std::source_location location) {
+  add_source(name, location);
+  decimal_methods.push_back(decimal_method{name, to_decimal});
+}
+
+register_float_decimal_method::register_float_decimal_method(
+    const char* name, float_decimal_fun to_decimal,
+    std::source_location location) {
+  add_source(name, location);
+  float_decimal_methods.push_back(float_decimal_method{name, to_decimal});
+}
+
+register_format_method::register_format_method(const char* name,
+                                               format_fun format,
+                                               std::source_location location) {
+  add_source(name, location);
+  format_methods.push_back(format_method{name, format});
+}
+
+register_decimal64_method::register_decimal64_method(
+    const char* name, decimal64_fun format, std::source_location location) {
+  add_source(name, location);
+  decimal64_methods.push_back(decimal64_method{name, format});
+}
+
+register_precision_method::register_precision_method(
+    const char* name, fixed_precision_format format, precision_fun format_fun,
+    int max_precision, std::source_location location) {
+  add_source(name, location);
+  precision_methods.push_back(
+      precision_method{name, format, format_fun, max_precision});
+}
+
+register_bounded_method::register_bounded_method(
+    const char* name, bounded_fun write, std::source_location location) {
+  add_source(name, location);
+  bounded_methods.push_back(bounded_method{name, write});
+}
+
+register_columnar_method::register_columnar_method(
+    const char* name, columnar_fun convert, std::source_location location) {
+  add_source(name, location);
+  columnar_methods.push_back(columnar_method{name, convert});
+}
+
+register_fixed_column_method::register_fixed_column_method(
+    const char* name, fixed_column_fun write, std::source_location location) {
+  add_source(name, location);
+  fixed_column_methods.push_back(fixed_column_method{name, write});
+}
+
+register_parse_method::register_parse_method(const char* name, parse_fun parse,
+                                             std::source_location location) {
+  add_source(name, location);
+  parse_methods.push_back(parse_method{name, parse});
+}
+
+register_column_parse_method::register_column_parse_method(
+    const char* name, column_parse_fun parse, std::source_location location) {
+  add_source(name, location);
+  column_parse_methods.push_back(column_parse_method{name, parse});
+}
+
+register_wide_method::register_wide_method(const char* name,
+                                           wide_dtoa_fun dtoa,
+                                           std::source_location location) {
+  add_source(name, location);
+  wide_methods.push_back(wide_method{name, dtoa});
+}
+
+register_batch_method::register_batch_method(const char* name,
+                                             batch_dtoa_fun dtoa,
+                                             method_info info,
+                                             std::source_location location) {
+  add_source(name, location);
+  batch_methods.push_back(batch_method{name, dtoa, info});
+}
+
+register_parallel_method::register_parallel_method(
+    const char* name, parallel_dtoa_fun dtoa, method_info info,
+    std::source_location location) {
+  add_source(name, location);
+  parallel_methods.push_back(parallel_method{name, dtoa, info});
+}
+
+auto find_methods(std::string_view name) -> named_methods {
+  named_methods result;
+  for (const method& m : methods) {
+    if (m.name != name) continue;
+    result.dtoa = m.dtoa;
+    result.dtoa_end = m.dtoa_end;
+  }
+  for (const batch_method& m : batch_methods) {
+    if (m.name == name) result.batch = m.dtoa;
+  }
+  for (const parallel_method& m : parallel_methods) {
+    if (m.name == name) result.parallel = m.dtoa;
+  }
+  for (const float_method& m : float_methods) {
+    if (m.name == name) result.ftoa = m.dtoa;
+  }
+  return result;
+}
+
+auto method_names() -> std::vector<std::string> {
+  std::vector<std::string> names;
+  for (const method& m : methods) names.push_back(m.name);
+  for (const float_method& m : float_methods) names.push_back(m.name);
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  return names;
+}
@@ -0,0 +1,243 @@
+// The methods registered with the register_* functions of benchmark.h,
+// shared by dtoa-benchmark and dtoa-convert.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef METHOD_REGISTRY_H_
+#define METHOD_REGISTRY_H_
+
+#include <float.h>  // LDBL_MANT_DIG
+
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+struct method {
+  std::string name;
+  // Exactly one of dtoa and dtoa_end is set.
+  dtoa_fun dtoa;
+  dtoa_end_fun dtoa_end;
+  method_info info;
+
+  // Whether the output is both shortest and correct.
+  auto is_exact() const -> bool { return info.shortest && info.correct; }
+
+  // Calls `f` with the conversion function so that timed loops are
+  // instantiated for each signature without a branch per call.
+  template <typename F>
+  auto visit(F f) const {
+    return dtoa_end ? f(dtoa_end) : f(dtoa);
+  }
+};
+
+extern std::vector<method> methods;
+
+// The file that registers a method, hashed with the files it depends on into
+// the key of the cached results of the method. A method may be registered
+// in several files, e.g. with a fallback counter, while methods of plugins
+// have no sources and are never cached.
+struct method_source {
+  std::string name;
+  std::string file;
+};
+
+extern std::vector<method_source> method_sources;
+
+struct range_method {
+  std::string name;
+  dtoa_end_fun dtoa;
+  double min;
+  double max;
+};
+
+extern std::vector<range_method> range_methods;
+
+struct fallback_method {
+  std::string name;
+  fallback_counter count;
+};
+
+extern std::vector<fallback_method> fallback_methods;
+
+struct path_method {
+  std::string name;
+  dtoa_fun dtoa;
+  path_counter count;
+};
+
+extern std::vector<path_method> path_methods;
+
+struct footprint_method {
+  std::string name;
+  std::vector<std::string> symbols;
+};
+
+extern std::vector<footprint_method> footprint_methods;
+
+struct inline_method {
+  std::string name;
+  inline_loop_fun loop;
+};
+
+extern std::vector<inline_method> inline_methods;
+
+struct prefetch_method {
+  std::string name;
+  table_prefetcher prefetch;
+};
+
+extern std::vector<prefetch_method> prefetch_methods;
+
+struct batch_method {
+  std::string name;
+  batch_dtoa_fun dtoa;
+  method_info info;
+};
+
+extern std::vector<batch_method> batch_methods;
+
+struct parallel_method {
+  std::string name;
+  parallel_dtoa_fun dtoa;
+  method_info info;
+};
+
+extern std::vector<parallel_method> parallel_methods;
+
+struct hex_method {
+  std::string name;
+  dtoa_fun dtoa;
+};
+
+extern std::vector<hex_method> hex_methods;
+
+struct float_method {
+  std::string name;
+  ftoa_fun dtoa;
+  method_info info;
+};
+
+extern std::vector<float_method> float_methods;
+
+struct float16_method {
+  std::string name;
+  float16_format format;
+  f16toa_fun dtoa;
+};
+
+extern std::vector<float16_method> float16_methods;
+
+#if LDBL_MANT_DIG == 64
+struct long_double_method {
+  std::string name;
+  ldtoa_fun dtoa;
+};
+
+extern std::vector<long_double_method> long_double_methods;
+#endif
+
+#ifdef __SIZEOF_FLOAT128__
+struct float128_method {
+  std::string name;
+  f128toa_fun dtoa;
+};
+
+extern std::vector<float128_method> float128_methods;
+#endif
+
+struct columnar_method {
+  std::string name;
+  columnar_fun convert;
+};
+
+extern std::vector<columnar_method> columnar_methods;
+
+struct fixed_column_method {
+  std::string name;
+  fixed_column_fun write;
+};
+
+extern std::vector<fixed_column_method> fixed_column_methods;
+
+struct parse_method {
+  std::string name;
+  parse_fun parse;
+};
+
+extern std::vector<parse_method> parse_methods;
+
+struct column_parse_method {
+  std::string name;
+  column_parse_fun parse;
+};
+
+extern std::vector<column_parse_method> column_parse_methods;
+
+struct digits_method {
+  std::string name;
+  digits_fun write_digits;
+};
+
+extern std::vector<digits_method> digits_methods;
+
+struct itoa_method {
+  std::string name;
+  itoa32_fun itoa32;
+  itoa64_fun itoa64;
+};
+
+extern std::vector<itoa_method> itoa_methods;
+
+struct decimal_method {
+  std::string name;
+  decimal_fun to_decimal;
+};
+
+extern std::vector<decimal_method> decimal_methods;
+
+struct float_decimal_method {
+  std::string name;
+  float_decimal_fun to_decimal;
+};
+
+extern std::vector<float_decimal_method> float_decimal_methods;
+
+struct format_method {
+  std::string name;
+  format_fun format;
+};
+
+extern std::vector<format_method> format_methods;
+
+struct decimal64_method {
+  std::string name;
+  decimal64_fun format;
+};
+
+extern std::vector<decimal64_method> decimal64_methods;
+
+struct precision_method {
+  std::string name;
+  fixed_precision_format format;
+  precision_fun format_fun;
+  int max_precision;
+};
+
+extern std::vector<precision_method> precision_methods;
+
+struct bounded_method {
+  std::string name;
+  bounded_fun write;
+};
+
+extern std::vector<bounded_method> bounded_methods;
+
+struct wide_method {
+  std::string name;
+  wide_dtoa_fun dtoa;
+};
+
+extern std::vector<wide_method> wide_methods;
+
+#endif  // METHOD_REGISTRY_H_
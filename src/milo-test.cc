@@ -1,4 +1,37 @@
+#include <string.h>  // strcpy
+
+#include <atomic>
+
 #include "benchmark.h"
+#include "double-conversion/bignum-dtoa.h"
 #include "milo/dtoa_milo.h"
 
-static register_method _("milo", dtoa_milo);
+static std::atomic<uint64_t> num_fallbacks;
+
+// Grisu3 with a fallback to double-conversion's bignum-dtoa when it cannot
+// prove that the result is the shortest and closest. Plain Grisu2 (dtoa_milo)
+// is not registered since it guarantees neither.
+static register_method _("milo-grisu3", [](double value, char* buffer) {
+  if (value == 0) {
+    strcpy(buffer, "0.0");
+    return;
+  }
+  if (value < 0) {
+    *buffer++ = '-';
+    value = -value;
+  }
+  int length = 0, K = 0;
+  if (!Grisu3(value, buffer, &length, &K)) {
+    using namespace double_conversion;
+    num_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    int point = 0;
+    BignumDtoa(value, BIGNUM_DTOA_SHORTEST, 0, Vector<char>(buffer, 18),
+               &length, &point);
+    K = point - length;
+  }
+  Prettify(buffer, length, K);
+});
+
+static register_fallback_counter fallbacks("milo-grisu3", []() -> uint64_t {
+  return num_fallbacks.exchange(0, std::memory_order_relaxed);
+});
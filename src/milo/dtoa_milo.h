@@ -130,7 +130,9 @@ struct DiyFp {
 
 	void NormalizedBoundaries(DiyFp* minus, DiyFp* plus) const {
 		DiyFp pl = DiyFp((f << 1) + 1, e - 1).NormalizeBoundary();
-		DiyFp mi = (f == kDpHiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+		// The lower boundary is closer for powers of 2 except the smallest normal
+		// number whose predecessor is subnormal with the same spacing.
+		DiyFp mi = (f == kDpHiddenBit && e != kDpMinExponent + 1) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
 		mi.f <<= mi.e - pl.e;
 		mi.e = pl.e;
 		*plus = pl;
@@ -318,6 +320,82 @@ inline void Grisu2(double value, char* buffer, int* length, int* K) {
 	DigitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
 }
 
+// Grisu3 rounding and rejection test from double-conversion's fast-dtoa.cc.
+// Returns false if the digits cannot be proven to be the closest shortest
+// representation.
+inline bool RoundWeed(char* buffer, int len, uint64_t distance_too_high_w, uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa, uint64_t unit) {
+	const uint64_t small_distance = distance_too_high_w - unit;
+	const uint64_t big_distance = distance_too_high_w + unit;
+	while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+		   (rest + ten_kappa < small_distance ||
+			small_distance - rest >= rest + ten_kappa - small_distance)) {
+		buffer[len - 1]--;
+		rest += ten_kappa;
+	}
+	if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+		(rest + ten_kappa < big_distance ||
+		 big_distance - rest > rest + ten_kappa - big_distance))
+		return false;
+	return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// Generates the digits of the unsafe interval (Wm - 1 ulp, Wp + 1 ulp) like
+// DigitGen and weeds out results that may lie outside of the rounding
+// interval.
+inline bool DigitGen3(const DiyFp& Wm, const DiyFp& W, const DiyFp& Wp, char* buffer, int* len, int* K) {
+	static const uint32_t kPow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+	uint64_t unit = 1;
+	const DiyFp too_low(Wm.f - unit, Wm.e);
+	const DiyFp too_high(Wp.f + unit, Wp.e);
+	uint64_t unsafe_interval = too_high.f - too_low.f;
+	const DiyFp one(uint64_t(1) << -W.e, W.e);
+	uint32_t p1 = static_cast<uint32_t>(too_high.f >> -one.e);
+	uint64_t p2 = too_high.f & (one.f - 1);
+	int kappa = static_cast<int>(CountDecimalDigit32(p1));
+	*len = 0;
+
+	// p1 is nonzero since W is normalized so the first digit is nonzero.
+	while (kappa > 0) {
+		const uint32_t divisor = kPow10[kappa - 1];
+		buffer[(*len)++] = '0' + static_cast<char>(p1 / divisor);
+		p1 %= divisor;
+		kappa--;
+		const uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+		if (rest < unsafe_interval) {
+			*K += kappa;
+			return RoundWeed(buffer, *len, too_high.f - W.f, unsafe_interval, rest, static_cast<uint64_t>(divisor) << -one.e, unit);
+		}
+	}
+
+	// kappa = 0
+	for (;;) {
+		p2 *= 10;
+		unit *= 10;
+		unsafe_interval *= 10;
+		buffer[(*len)++] = '0' + static_cast<char>(p2 >> -one.e);
+		p2 &= one.f - 1;
+		kappa--;
+		if (p2 < unsafe_interval) {
+			*K += kappa;
+			return RoundWeed(buffer, *len, (too_high.f - W.f) * unit, unsafe_interval, p2, one.f, unit);
+		}
+	}
+}
+
+// Returns false if Grisu3 cannot prove that the result is the shortest and
+// closest, in which case the caller should fall back to an exact algorithm.
+inline bool Grisu3(double value, char* buffer, int* length, int* K) {
+	const DiyFp v(value);
+	DiyFp w_m, w_p;
+	v.NormalizedBoundaries(&w_m, &w_p);
+
+	const DiyFp c_mk = GetCachedPower(w_p.e, K);
+	const DiyFp W = v.Normalize() * c_mk;
+	const DiyFp Wp = w_p * c_mk;
+	const DiyFp Wm = w_m * c_mk;
+	return DigitGen3(Wm, W, Wp, buffer, length, K);
+}
+
 inline const char* GetDigitsLut() {
 	static const char cDigitsLut[200] = {
 		'0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0', '7', '0', '8', '0', '9',
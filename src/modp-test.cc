@@ -1,10 +1,28 @@
-// {fmt} test with the compact Dragonbox cache (the default).
-
 #include <cstdio>
 
 #include "benchmark.h"
 #include "modp_numtoa/modp_numtoa.h"
 
-static register_method _("modp", [](double value, char* buffer) {
-  modp_dtoa2(value, buffer, 18);
-});
+// modp_dtoa2 computes digits in floating point so the last ones are
+// inexact.
+static register_method _(
+    "modp",
+    [](double value, char* buffer) { modp_dtoa2(value, buffer, 18); },
+    {.shortest = false, .correct = false});
+
+// modp_dtoa only supports precisions up to 9.
+static register_precision_method fixed(
+    "modp-%f", fixed_precision_format::fixed,
+    [](double value, int precision, char* buffer) {
+      modp_dtoa(value, buffer, precision);
+    },
+    9);
+
+static register_itoa_method itoa(
+    "modp",
+    [](int32_t value, char* buffer) {
+      return buffer + modp_itoa10(value, buffer);
+    },
+    [](int64_t value, char* buffer) {
+      return buffer + modp_litoa10(value, buffer);
+    });
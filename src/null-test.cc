@@ -1,3 +1,5 @@
 #include "benchmark.h"
 
-static register_method _("null", [](double, char*) {});
+static register_method _(
+    "null", [](double, char* buffer) { return buffer; },
+    {.shortest = false, .correct = false});
@@ -4,9 +4,32 @@
 
 #include "benchmark.h"
 
-static register_method _("ostringstream", [](double value, char* buffer) {
-  std::ostringstream oss;
-  oss << std::setprecision(17) << value;
-  std::string s = oss.str();
-  memcpy(buffer, s.data(), s.size());
-});
+// %.17g-like output which round-trips but isn't the shortest.
+constexpr method_info info = {.shortest = false, .allocates = true};
+
+static register_method _(
+    "ostringstream",
+    [](double value, char* buffer) {
+      std::ostringstream oss;
+      oss << std::setprecision(17) << value;
+      std::string s = oss.str();
+      memcpy(buffer, s.data(), s.size());
+      return buffer + s.size();
+    },
+    info);
+
+// Reuses a stream like production code that formats many values does.
+static register_method reused(
+    "ostringstream-reused", [](double value, char* buffer) {
+      static thread_local std::ostringstream oss = []() {
+        std::ostringstream result;
+        result << std::setprecision(17);
+        return result;
+      }();
+      oss.str("");
+      oss << value;
+      std::string s = oss.str();
+      memcpy(buffer, s.data(), s.size());
+      return buffer + s.size();
+    },
+    info);
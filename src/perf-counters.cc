@@ -0,0 +1,375 @@
+// Hardware performance counters.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "perf-counters.h"
+
+#include <stdio.h>   // fopen
+#include <stdlib.h>  // strtoull
+#include <string.h>  // memset
+
+#include <algorithm>  // std::sort
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#elif defined(__APPLE__)
+#  include <dlfcn.h>
+
+#  include <type_traits>  // std::remove_reference_t
+#endif
+
+#if defined(__linux__)
+
+namespace {
+
+struct event_config {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t cache_read_miss(int cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+constexpr event_config event_configs[num_perf_events] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1I)},
+};
+
+auto open_event(event_config e, int group_fd) -> int {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = e.type;
+  attr.config = e.config;
+  attr.disabled = group_fd == -1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return int(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+perf_counters::perf_counters() {
+  for (int i = 0; i < num_perf_events; ++i) {
+    int leader = num_open_ != 0 ? fds_[0] : -1;
+    int fd = open_event(event_configs[i], leader);
+    if (fd < 0) continue;
+    fds_[num_open_] = fd;
+    order_[num_open_++] = i;
+    available_[i] = true;
+  }
+}
+
+perf_counters::~perf_counters() {
+  for (int i = 0; i < num_open_; ++i) close(fds_[i]);
+}
+
+void perf_counters::start() {
+  if (num_open_ == 0) return;
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+auto perf_counters::stop() -> perf_counts {
+  perf_counts result;
+  if (num_open_ == 0) return result;
+  ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // The group read format is {nr, time_enabled, time_running, values[nr]}.
+  uint64_t data[3 + num_perf_events] = {};
+  if (read(fds_[0], data, sizeof(data)) <= 0) return result;
+  uint64_t time_enabled = data[1], time_running = data[2];
+  if (time_running == 0) return result;
+  // Scale the counts if the group was multiplexed with other events.
+  double scale = double(time_enabled) / double(time_running);
+  for (uint64_t i = 0; i < data[0] && i < uint64_t(num_open_); ++i)
+    result.values[order_[i]] = uint64_t(double(data[3 + i]) * scale);
+  return result;
+}
+
+#elif defined(__APPLE__)
+
+// kperf is a private framework so its functions are looked up at runtime.
+// Apple Silicon has two fixed counters: cycles and instructions.
+namespace {
+
+constexpr uint32_t kpc_class_fixed_mask = 1;
+
+struct kperf_api {
+  int (*force_all_ctrs_set)(int value) = nullptr;
+  int (*set_counting)(uint32_t classes) = nullptr;
+  int (*set_thread_counting)(uint32_t classes) = nullptr;
+  int (*get_thread_counters)(uint32_t tid, uint32_t buf_count,
+                             uint64_t* buf) = nullptr;
+  bool loaded = false;
+
+  kperf_api() {
+    void* lib = dlopen(
+        "/System/Library/PrivateFrameworks/kperf.framework/kperf", RTLD_LAZY);
+    if (!lib) return;
+    auto get = [&](auto& fun, const char* name) {
+      fun = reinterpret_cast<std::remove_reference_t<decltype(fun)>>(
+          dlsym(lib, name));
+      return fun != nullptr;
+    };
+    loaded = get(force_all_ctrs_set, "kpc_force_all_ctrs_set") &&
+             get(set_counting, "kpc_set_counting") &&
+             get(set_thread_counting, "kpc_set_thread_counting") &&
+             get(get_thread_counters, "kpc_get_thread_counters");
+  }
+};
+
+auto get_kperf() -> const kperf_api& {
+  static const kperf_api api;
+  return api;
+}
+
+auto read_fixed_counters(perf_counts& counts) -> bool {
+  // The buffer must be large enough for all counters even if only fixed ones
+  // are counted.
+  uint64_t buf[32] = {};
+  if (get_kperf().get_thread_counters(0, 32, buf) != 0) return false;
+  counts.values[perf_cycles] = buf[0];
+  counts.values[perf_instructions] = buf[1];
+  return true;
+}
+
+}  // namespace
+
+perf_counters::perf_counters() {
+  const kperf_api& api = get_kperf();
+  // These fail without root privileges.
+  if (!api.loaded || api.force_all_ctrs_set(1) != 0 ||
+      api.set_counting(kpc_class_fixed_mask) != 0 ||
+      api.set_thread_counting(kpc_class_fixed_mask) != 0) {
+    return;
+  }
+  if (!read_fixed_counters(start_counts_)) return;
+  num_open_ = 2;
+  available_[perf_cycles] = available_[perf_instructions] = true;
+}
+
+perf_counters::~perf_counters() {
+  if (num_open_ != 0) get_kperf().force_all_ctrs_set(0);
+}
+
+void perf_counters::start() {
+  if (num_open_ != 0) read_fixed_counters(start_counts_);
+}
+
+auto perf_counters::stop() -> perf_counts {
+  perf_counts result;
+  if (num_open_ == 0 || !read_fixed_counters(result)) return {};
+  for (int e : {perf_cycles, perf_instructions})
+    result.values[e] -= start_counts_.values[e];
+  return result;
+}
+
+#else
+
+perf_counters::perf_counters() {}
+perf_counters::~perf_counters() {}
+void perf_counters::start() {}
+auto perf_counters::stop() -> perf_counts { return {}; }
+
+#endif
+
+#if defined(__linux__)
+
+namespace {
+
+// Sets of events for the top-down breakdown. The first event is the group
+// leader.
+enum topdown_scheme {
+  // Intel's topdown metrics which the kernel reports as slot counts.
+  intel_metrics,
+  // The slot events of older Intel CPUs.
+  intel_slots,
+  // Arm's STALL_SLOT events where slots are cycles times the issue width.
+  arm_stall_slots,
+  num_topdown_schemes
+};
+
+struct topdown_scheme_events {
+  const char* events[6];
+  int num_events;
+};
+
+constexpr topdown_scheme_events topdown_schemes[num_topdown_schemes] = {
+    {{"slots", "topdown-fe-bound", "topdown-bad-spec", "topdown-be-bound",
+      "topdown-retiring"},
+     5},
+    {{"topdown-total-slots", "topdown-fetch-bubbles", "topdown-slots-issued",
+      "topdown-slots-retired", "topdown-recovery-bubbles"},
+     5},
+    {{"cpu_cycles", "stall_slot_frontend", "stall_slot_backend", "stall_slot",
+      "op_spec", "op_retired"},
+     6},
+};
+
+auto read_file(const std::string& path) -> std::string {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return {};
+  char buf[256] = {};
+  size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  std::string result(buf, n);
+  while (!result.empty() && result.back() == '\n') result.pop_back();
+  return result;
+}
+
+// Resolves the event `name` of the PMU in the sysfs directory `pmu` to its
+// perf_event_open type and config. The event is described by terms like
+// event=0x00,umask=0x80 and each term is placed into the config bits given
+// by its format, e.g. config:8-15.
+auto find_sysfs_event(const std::string& pmu, const char* name,
+                      event_config& e) -> bool {
+  std::string terms = read_file(pmu + "/events/" + name);
+  std::string type = read_file(pmu + "/type");
+  if (terms.empty() || type.empty()) return false;
+  e = {uint32_t(strtoul(type.c_str(), nullptr, 10)), 0};
+  for (size_t pos = 0; pos < terms.size();) {
+    size_t end = std::min(terms.find(',', pos), terms.size());
+    std::string term = terms.substr(pos, end - pos);
+    pos = end + 1;
+    size_t eq = term.find('=');
+    uint64_t value =
+        eq != std::string::npos ? strtoull(term.c_str() + eq + 1, nullptr, 0)
+                                : 1;
+    // The format is config:LOW[-HIGH][,LOW[-HIGH]...] with the value's bits
+    // filling the ranges from the lowest.
+    std::string format = read_file(pmu + "/format/" + term.substr(0, eq));
+    if (!format.starts_with("config:")) return false;
+    const char* p = format.c_str() + 7;
+    while (*p) {
+      char* next = nullptr;
+      unsigned low = unsigned(strtoul(p, &next, 10)), high = low;
+      if (*next == '-') high = unsigned(strtoul(next + 1, &next, 10));
+      for (unsigned bit = low; bit <= high && bit < 64; ++bit, value >>= 1)
+        e.config |= (value & 1) << bit;
+      p = *next == ',' ? next + 1 : next;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+topdown_counters::topdown_counters() {
+  // Intel's core PMU is cpu or, on hybrid CPUs, cpu_core. Arm PMUs are named
+  // after the core, e.g. armv8_pmuv3_0, so all are searched.
+  std::vector<std::string> pmus;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           "/sys/bus/event_source/devices", ec)) {
+    pmus.push_back(entry.path().string());
+  }
+  std::sort(pmus.begin(), pmus.end());
+  for (int scheme = 0; scheme < num_topdown_schemes && scheme_ < 0; ++scheme) {
+    const topdown_scheme_events& s = topdown_schemes[scheme];
+    for (const std::string& pmu : pmus) {
+      event_config configs[max_events];
+      bool found = true;
+      for (int i = 0; i < s.num_events && found; ++i)
+        found = find_sysfs_event(pmu, s.events[i], configs[i]);
+      if (!found) continue;
+      if (scheme == arm_stall_slots) {
+        slots_per_cycle_ = atof(read_file(pmu + "/caps/slots").c_str());
+        if (slots_per_cycle_ == 0) continue;
+      }
+      for (int i = 0; i < s.num_events; ++i) {
+        int fd = open_event(configs[i], num_open_ != 0 ? fds_[0] : -1);
+        if (fd < 0) {
+          for (int j = 0; j < num_open_; ++j) close(fds_[j]);
+          num_open_ = 0;
+          break;
+        }
+        fds_[num_open_++] = fd;
+      }
+      if (num_open_ != 0) {
+        scheme_ = scheme;
+        break;
+      }
+    }
+  }
+}
+
+topdown_counters::~topdown_counters() {
+  for (int i = 0; i < num_open_; ++i) close(fds_[i]);
+}
+
+void topdown_counters::start() {
+  if (num_open_ == 0) return;
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+auto topdown_counters::stop() -> topdown_fractions {
+  topdown_fractions result;
+  if (num_open_ == 0) return result;
+  ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  // The group read format is {nr, time_enabled, time_running, values[nr]}.
+  // The fractions don't depend on multiplexing so the times are ignored.
+  uint64_t data[3 + max_events] = {};
+  if (read(fds_[0], data, sizeof(data)) <= 0) return result;
+  const uint64_t* v = data + 3;
+  double* r = result.values;
+  switch (scheme_) {
+    case intel_metrics:
+    case intel_slots: {
+      double slots = double(v[0]);
+      if (slots == 0) return result;
+      r[topdown_frontend_bound] = double(v[1]) / slots;
+      if (scheme_ == intel_metrics) {
+        r[topdown_bad_speculation] = double(v[2]) / slots;
+        r[topdown_retiring] = double(v[4]) / slots;
+      } else {
+        // Issued slots that didn't retire and slots lost recovering from
+        // mispredictions.
+        r[topdown_bad_speculation] = (double(v[2]) - double(v[3]) +
+                                      double(v[4])) / slots;
+        r[topdown_retiring] = double(v[3]) / slots;
+      }
+      break;
+    }
+    case arm_stall_slots: {
+      double slots = double(v[0]) * slots_per_cycle_;
+      if (slots == 0 || v[4] == 0) return result;
+      r[topdown_frontend_bound] = double(v[1]) / slots;
+      // Slots that weren't stalled issued operations, a part of which were
+      // speculative and didn't retire.
+      double issued = 1 - double(v[3]) / slots;
+      r[topdown_retiring] = issued * double(v[5]) / double(v[4]);
+      r[topdown_bad_speculation] = issued - r[topdown_retiring];
+      break;
+    }
+  }
+  // The backend is what remains, which also absorbs rounding.
+  r[topdown_backend_bound] = std::max(
+      1 - r[topdown_frontend_bound] - r[topdown_bad_speculation] -
+          r[topdown_retiring],
+      0.0);
+  return result;
+}
+
+#else
+
+topdown_counters::topdown_counters() {}
+topdown_counters::~topdown_counters() {}
+void topdown_counters::start() {}
+auto topdown_counters::stop() -> topdown_fractions { return {}; }
+
+#endif
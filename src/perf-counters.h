@@ -0,0 +1,108 @@
+// Hardware performance counters.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <stdint.h>  // uint64_t
+
+enum perf_event {
+  perf_cycles,
+  perf_instructions,
+  perf_branch_misses,
+  perf_l1d_misses,
+  perf_l1i_misses,
+  num_perf_events
+};
+
+constexpr const char* perf_event_names[num_perf_events] = {
+    "cycles", "instructions", "branch-misses", "l1d-misses", "l1i-misses"};
+
+struct perf_counts {
+  uint64_t values[num_perf_events] = {};
+};
+
+// A group of hardware counters for the calling thread: perf_event_open on
+// Linux and kperf on macOS. kperf requires root and only the fixed cycle and
+// instruction counters are used there. Events that the CPU, kernel or
+// permissions don't support are reported as unavailable.
+class perf_counters {
+ private:
+  int fds_[num_perf_events];
+  // Indices of events in the order they are read from the group leader.
+  int order_[num_perf_events];
+  int num_open_ = 0;
+  bool available_[num_perf_events] = {};
+  // Counter values at start() where counters cannot be reset (kperf).
+  perf_counts start_counts_;
+
+ public:
+  perf_counters();
+  ~perf_counters();
+
+  perf_counters(const perf_counters&) = delete;
+  void operator=(const perf_counters&) = delete;
+
+  // Returns true if any event is available.
+  auto available() const -> bool { return num_open_ != 0; }
+
+  auto available(perf_event e) const -> bool { return available_[e]; }
+
+  // Resets and starts counting.
+  void start();
+
+  // Stops counting and returns the counts since the last call to start().
+  auto stop() -> perf_counts;
+};
+
+// Level-1 top-down categories of pipeline slots: slots where the frontend
+// delivered no operation, where operations were issued but later cancelled,
+// where the backend couldn't accept an operation and where operations retired.
+enum topdown_category {
+  topdown_frontend_bound,
+  topdown_bad_speculation,
+  topdown_backend_bound,
+  topdown_retiring,
+  num_topdown_categories
+};
+
+constexpr const char* topdown_category_names[num_topdown_categories] = {
+    "frontend-bound", "bad-speculation", "backend-bound", "retiring"};
+
+// Fractions of pipeline slots per category that add up to 1.
+struct topdown_fractions {
+  double values[num_topdown_categories] = {};
+};
+
+// Counters for the top-down breakdown of the calling thread, from the events
+// the Linux kernel exposes in sysfs: the topdown metrics of Intel CPUs since
+// Ice Lake, the older topdown-* slot events of Intel CPUs since Sandy Bridge
+// and the STALL_SLOT events of Armv8.4 PMUs. Only available on Linux.
+class topdown_counters {
+ private:
+  static constexpr int max_events = 6;
+
+  int fds_[max_events];
+  int num_open_ = 0;
+  int scheme_ = -1;
+  // The issue width of Arm cores, from the PMU's slots capability.
+  double slots_per_cycle_ = 0;
+
+ public:
+  topdown_counters();
+  ~topdown_counters();
+
+  topdown_counters(const topdown_counters&) = delete;
+  void operator=(const topdown_counters&) = delete;
+
+  auto available() const -> bool { return num_open_ != 0; }
+
+  // Resets and starts counting.
+  void start();
+
+  // Stops counting and returns the breakdown since the last call to start().
+  auto stop() -> topdown_fractions;
+};
+
+#endif  // PERF_COUNTERS_H_
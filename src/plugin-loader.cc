@@ -0,0 +1,78 @@
+// Loading of plugins with conversion methods.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "plugin-loader.h"
+
+#ifdef _WIN32
+#  include <windows.h>  // LoadLibraryA
+#else
+#  include <dlfcn.h>  // dlopen
+#endif
+
+#include <algorithm>  // std::sort
+#include <filesystem>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace {
+
+#ifdef _WIN32
+constexpr const char* library_extension = ".dll";
+#elif defined(__APPLE__)
+constexpr const char* library_extension = ".dylib";
+#else
+constexpr const char* library_extension = ".so";
+#endif
+
+auto load_plugin(const std::string& path, const plugin_registry& registry)
+    -> bool {
+#ifdef _WIN32
+  HMODULE library = LoadLibraryA(path.c_str());
+  if (!library) {
+    fmt::print(stderr, "Cannot load plugin {}: error {}\n", path,
+               GetLastError());
+    return false;
+  }
+  auto entry = reinterpret_cast<plugin_entry>(
+      GetProcAddress(library, DTOA_BENCHMARK_PLUGIN_ENTRY));
+#else
+  // RTLD_LOCAL keeps the symbols of different plugins, e.g. two forks of the
+  // same library, apart.
+  void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!library) {
+    fmt::print(stderr, "Cannot load plugin {}: {}\n", path, dlerror());
+    return false;
+  }
+  auto entry = reinterpret_cast<plugin_entry>(
+      dlsym(library, DTOA_BENCHMARK_PLUGIN_ENTRY));
+#endif
+  if (!entry) {
+    fmt::print(stderr, "Plugin {} doesn't export {}\n", path,
+               DTOA_BENCHMARK_PLUGIN_ENTRY);
+    return false;
+  }
+  fmt::print("Loading plugin {}\n", path);
+  entry(registry);
+  return true;
+}
+
+}  // namespace
+
+auto load_plugins(const std::string& path, const plugin_registry& registry)
+    -> bool {
+  std::error_code ec;
+  if (!std::filesystem::is_directory(path, ec))
+    return load_plugin(path, registry);
+  // Load in a stable order so that runs are reproducible.
+  std::vector<std::string> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+    if (entry.path().extension() == library_extension)
+      paths.push_back(entry.path().string());
+  }
+  std::sort(paths.begin(), paths.end());
+  bool ok = true;
+  for (const std::string& p : paths) ok = load_plugin(p, registry) && ok;
+  return ok;
+}
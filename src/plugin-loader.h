@@ -0,0 +1,18 @@
+// Loading of plugins with conversion methods.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef PLUGIN_LOADER_H_
+#define PLUGIN_LOADER_H_
+
+#include <string>
+
+#include "plugin.h"
+
+// Loads the plugin at `path`, or every shared library in `path` if it is a
+// directory, and calls its entry point with `registry`. Libraries stay loaded
+// until exit. Returns false and prints an error if a plugin cannot be loaded.
+auto load_plugins(const std::string& path, const plugin_registry& registry)
+    -> bool;
+
+#endif  // PLUGIN_LOADER_H_
@@ -0,0 +1,41 @@
+// The interface of plugins, shared libraries with conversion methods that are
+// loaded at runtime.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef PLUGIN_H_
+#define PLUGIN_H_
+
+#include "benchmark.h"
+
+// Bump when plugin_registry or method_info change. Plugins should add nothing
+// if the registry has a different version.
+constexpr int plugin_interface_version = 1;
+
+// Functions a plugin calls to add its methods. Names are copied. Added methods
+// are verified and timed like the built-in ones.
+struct plugin_registry {
+  int version;
+  void (*add_method)(const char* name, dtoa_fun dtoa,
+                     const method_info& info);
+  void (*add_end_method)(const char* name, dtoa_end_fun dtoa,
+                         const method_info& info);
+};
+
+// The name of the function a plugin exports, e.g.
+//
+//   extern "C" DTOA_BENCHMARK_EXPORT void dtoa_benchmark_register(
+//       const plugin_registry& registry) {
+//     registry.add_method("mydtoa", mydtoa, {});
+//   }
+#define DTOA_BENCHMARK_PLUGIN_ENTRY "dtoa_benchmark_register"
+
+using plugin_entry = void (*)(const plugin_registry& registry);
+
+#ifdef _WIN32
+#  define DTOA_BENCHMARK_EXPORT __declspec(dllexport)
+#else
+#  define DTOA_BENCHMARK_EXPORT __attribute__((visibility("default")))
+#endif
+
+#endif  // PLUGIN_H_
@@ -0,0 +1,17 @@
+// An example plugin that adds std::to_chars under another name. Build it with
+// `make example-plugin` and run `dtoa-benchmark --plugin=example-plugin.so`.
+
+#include <charconv>
+
+#include "plugin.h"
+
+extern "C" DTOA_BENCHMARK_EXPORT void dtoa_benchmark_register(
+    const plugin_registry& registry) {
+  if (registry.version != plugin_interface_version) return;
+  registry.add_end_method(
+      "to_chars-plugin",
+      [](double value, char* buffer) {
+        return std::to_chars(buffer, buffer + 24, value).ptr;
+      },
+      {});
+}
@@ -4,8 +4,9 @@
 // Copyright (c) 2024, Victor Zverovich
 // License: https://github.com/fmtlib/fmt/blob/master/LICENSE
 
+#include <math.h>    // frexp, signbit
 #include <stdint.h>  // uint32_t
-#include <string.h>  // memcpy
+#include <string.h>  // memcpy, strcpy
 
 #include <charconv>  // std::to_chars
 #include <limits>    // std::numeric_limits
@@ -102,6 +103,11 @@ struct decimal {
 };
 
 void dtoa(char* buf, double val, int precision) {
+  // decimal requires a nonzero value.
+  if (val == 0) {
+    strcpy(buf, signbit(val) ? "-0e+0" : "0e+0");
+    return;
+  }
   decimal d(val);
 
   int bigit_index = *d.bigits > 0 ? 0 : 1;
@@ -157,6 +163,7 @@ void dtoa(char* buf, double val, int precision) {
   *std::to_chars(buf + count, buf + count + 4, exp).ptr = '\0';
 }
 
-static register_method _("puff", [](double value, char* buffer) {
-  dtoa(buffer, value, 17);
-});
+// Always writes 17 significant digits.
+static register_method _(
+    "puff", [](double value, char* buffer) { dtoa(buffer, value, 17); },
+    {.shortest = false, .notation = output_notation::scientific});
@@ -0,0 +1,203 @@
+// Cached results of methods whose sources haven't changed since an earlier
+// run.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "result-cache.h"
+
+#include <stdio.h>  // fopen, snprintf
+
+#include <algorithm>  // std::sort
+#include <filesystem>
+#include <iterator>  // std::distance
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto read_file(const std::string& path, std::string& content) -> bool {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  content.clear();
+  char buffer[4096];
+  size_t n = 0;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) != 0)
+    content.append(buffer, n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+auto write_file(const std::string& path, const std::string& content)
+    -> bool {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(content.data(), 1, content.size(), f) == content.size();
+  return fclose(f) == 0 && ok;
+}
+
+// Returns the path of the header included by `line` if it has the form
+// #include "path" and an empty string otherwise.
+auto parse_include(std::string_view line) -> std::string_view {
+  size_t pos = line.find_first_not_of(" \t");
+  if (pos == std::string_view::npos || line[pos] != '#') return {};
+  pos = line.find_first_not_of(" \t", pos + 1);
+  if (pos == std::string_view::npos || line.substr(pos, 7) != "include")
+    return {};
+  pos = line.find_first_not_of(" \t", pos + 7);
+  if (pos == std::string_view::npos || line[pos] != '"') return {};
+  size_t end = line.find('"', pos + 1);
+  if (end == std::string_view::npos) return {};
+  return line.substr(pos + 1, end - pos - 1);
+}
+
+// Returns `key` as 16 hex digits which is used as a file name.
+auto hex_key(uint64_t key) -> std::string {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(key));
+  return buffer;
+}
+
+}  // namespace
+
+auto hash_bytes(std::string_view data, uint64_t hash) -> uint64_t {
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+void source_hasher::add_includes(const std::string& file,
+                                 std::vector<std::string>& files) {
+  if (std::find(files.begin(), files.end(), file) != files.end()) return;
+  files.push_back(file);
+  std::string content;
+  if (!read_file(file, content)) return;
+  std::vector<std::string> dirs = {fs::path(file).parent_path().string()};
+  dirs.insert(dirs.end(), include_dirs_.begin(), include_dirs_.end());
+  std::string_view rest = content;
+  while (!rest.empty()) {
+    size_t end = rest.find('\n');
+    std::string_view line = rest.substr(0, end);
+    rest = end == std::string_view::npos ? "" : rest.substr(end + 1);
+    std::string_view include = parse_include(line);
+    if (include.empty()) continue;
+    // Headers that aren't found, e.g. generated ones, are skipped.
+    std::error_code ec;
+    for (const std::string& dir : dirs) {
+      fs::path path = fs::path(dir) / include;
+      if (!fs::is_regular_file(path, ec)) continue;
+      add_includes(fs::weakly_canonical(path, ec).string(), files);
+      break;
+    }
+  }
+}
+
+auto source_hasher::find_sources(const std::string& file)
+    -> std::vector<std::string> {
+  std::vector<std::string> files;
+  std::error_code ec;
+  add_includes(fs::weakly_canonical(file, ec).string(), files);
+  fs::path root = fs::weakly_canonical(root_, ec);
+  std::vector<std::string> libraries;
+  for (const std::string& f : files) {
+    fs::path relative = fs::path(f).lexically_relative(root);
+    if (relative.empty() || *relative.begin() == ".." ||
+        std::distance(relative.begin(), relative.end()) < 2) {
+      continue;
+    }
+    libraries.push_back((root / *relative.begin()).string());
+  }
+  std::sort(libraries.begin(), libraries.end());
+  libraries.erase(std::unique(libraries.begin(), libraries.end()),
+                  libraries.end());
+  for (const std::string& library : libraries) {
+    for (const auto& entry : fs::recursive_directory_iterator(library, ec)) {
+      if (entry.is_regular_file(ec)) files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+auto source_hasher::hash(const std::vector<std::string>& files,
+                         uint64_t hash) -> uint64_t {
+  std::error_code ec;
+  fs::path root = fs::weakly_canonical(root_, ec);
+  for (const std::string& file : files) {
+    auto it = file_hashes_.find(file);
+    if (it == file_hashes_.end()) {
+      // A missing file hashes like an empty one so that the key still
+      // changes when it is added.
+      std::string content;
+      read_file(file, content);
+      it = file_hashes_.emplace(file, hash_bytes(content)).first;
+    }
+    hash = hash_bytes(fs::path(file).lexically_relative(root).string(), hash);
+    hash = hash_bytes(hex_key(it->second), hash);
+  }
+  return hash;
+}
+
+auto read_rows(const char* path) -> rows_by_function {
+  rows_by_function rows;
+  std::string content;
+  if (!read_file(path, content)) return rows;
+  std::string_view rest = content;
+  bool header = true;
+  while (!rest.empty()) {
+    size_t end = rest.find('\n');
+    std::string_view line = rest.substr(0, end);
+    rest = end == std::string_view::npos ? "" : rest.substr(end + 1);
+    if (header || line.empty()) {
+      header = false;
+      continue;
+    }
+    // Function is the second column.
+    size_t start = line.find(',');
+    if (start == std::string_view::npos) continue;
+    size_t stop = line.find(',', start + 1);
+    std::string function(line.substr(start + 1, stop - start - 1));
+    std::string& group = rows[function];
+    group += line;
+    group += '\n';
+  }
+  return rows;
+}
+
+auto result_cache::method_dir(const std::string& name) const -> std::string {
+  // Method names are used as directory names so characters that may not be
+  // valid in a path, e.g. '/', are replaced.
+  std::string dir_name = name;
+  for (char& c : dir_name) {
+    bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+    if (!valid) c = '_';
+  }
+  return (fs::path(dir_) / dir_name).string();
+}
+
+auto result_cache::load(const std::string& name, uint64_t key,
+                        std::string& rows, std::string& samples) const
+    -> bool {
+  std::string base = method_dir(name) + "/" + hex_key(key);
+  return read_file(base + ".csv", rows) &&
+         read_file(base + ".samples.csv", samples);
+}
+
+auto result_cache::store(const std::string& name, uint64_t key,
+                         const std::string& rows,
+                         const std::string& samples) const -> bool {
+  std::string dir = method_dir(name);
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir, ec);
+  if (ec) return false;
+  std::string base = dir + "/" + hex_key(key);
+  return write_file(base + ".samples.csv", samples) &&
+         write_file(base + ".csv", rows);
+}
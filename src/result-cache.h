@@ -0,0 +1,81 @@
+// Cached results of methods whose sources haven't changed since an earlier
+// run.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef RESULT_CACHE_H_
+#define RESULT_CACHE_H_
+
+#include <stdint.h>  // uint64_t
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>  // std::move
+#include <vector>
+
+// Returns the FNV-1a hash of `data` continuing from `hash`.
+auto hash_bytes(std::string_view data,
+                uint64_t hash = 0xcbf29ce484222325) -> uint64_t;
+
+// Hashes the sources a method is built from. Files are read and hashed once
+// no matter how many methods depend on them.
+class source_hasher {
+ private:
+  std::string root_;
+  std::vector<std::string> include_dirs_;
+  std::map<std::string, uint64_t> file_hashes_;
+
+  // Adds `file` and the local headers it includes to `files` recursively.
+  void add_includes(const std::string& file, std::vector<std::string>& files);
+
+ public:
+  // `root` is the source directory and `include_dirs` are the directories
+  // searched for includes in addition to the directory of the includer.
+  source_hasher(std::string root, std::vector<std::string> include_dirs)
+      : root_(std::move(root)), include_dirs_(std::move(include_dirs)) {}
+
+  // Returns the files `file` depends on: the file itself, the headers it
+  // includes with #include "..." recursively and all files of the libraries
+  // of those headers, i.e. of the subdirectories of the root that contain
+  // them, since a header-only method in a test file is compiled from the
+  // library's sources. The result is sorted.
+  auto find_sources(const std::string& file) -> std::vector<std::string>;
+
+  // Returns the hash of the paths relative to the root and the contents of
+  // `files` continuing from `hash`.
+  auto hash(const std::vector<std::string>& files, uint64_t hash)
+      -> uint64_t;
+};
+
+// Rows of result files grouped by the Function column, each group in the
+// original order and with line endings, e.g.
+//   {"zmij", "randomdigit,zmij,1,20.5\nrandomdigit,zmij,2,20.7\n"}.
+using rows_by_function = std::map<std::string, std::string>;
+
+// Reads the rows of a results or samples file without the header.
+auto read_rows(const char* path) -> rows_by_function;
+
+// Stores the result and sample rows of methods in `dir`, one subdirectory
+// per method with a pair of files named after the key. A method keeps only
+// the files of its latest key.
+class result_cache {
+ private:
+  std::string dir_;
+
+  auto method_dir(const std::string& name) const -> std::string;
+
+ public:
+  explicit result_cache(std::string dir) : dir_(std::move(dir)) {}
+
+  // Loads the rows of method `name` stored with `key` and returns true on
+  // success.
+  auto load(const std::string& name, uint64_t key, std::string& rows,
+            std::string& samples) const -> bool;
+
+  // Stores the rows of method `name` with `key` and returns true on success.
+  auto store(const std::string& name, uint64_t key, const std::string& rows,
+             const std::string& samples) const -> bool;
+};
+
+#endif  // RESULT_CACHE_H_
@@ -1,7 +1,155 @@
+#include <stdlib.h>  // free
+#include <string.h>
+
 #include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#ifdef __SIZEOF_INT128__
+#  include "ryu/ryu_generic_128.h"
+#endif
 
 #include "benchmark.h"
+#include "string-arena.h"
+
+static register_method _(
+    "ryu",
+    [](double value, char* buffer) {
+      return buffer + d2s_buffered_n(value, buffer);
+    },
+    {.notation = output_notation::scientific, .table_size = d2s_table_size()});
+
+// Ryu with RYU_OPTIMIZE_SIZE which stores every 26th power of 5 and computes
+// the rest, trading speed for a smaller table.
+static register_method small(
+    "ryu-small",
+    [](double value, char* buffer) {
+      return buffer + d2s_small_buffered_n(value, buffer);
+    },
+    {.notation = output_notation::scientific,
+     .table_size = d2s_small_table_size()});
+
+// Ryu without __int128 and with the code paths of 32-bit platforms, which
+// show how it performs where 64x64->128-bit multiplication is emulated.
+static register_method ops64(
+    "ryu-64-bit-ops",
+    [](double value, char* buffer) {
+      return buffer + d2s_64_bit_ops_buffered_n(value, buffer);
+    },
+    {.notation = output_notation::scientific, .table_size = d2s_table_size()});
+
+static register_method bit32(
+    "ryu-32-bit",
+    [](double value, char* buffer) {
+      return buffer + d2s_32_bit_buffered_n(value, buffer);
+    },
+    {.notation = output_notation::scientific, .table_size = d2s_table_size()});
+
+#ifdef RYU_OPTIMIZE_SIZE
+// dtoa-benchmark-size builds the default d2s.c with the small tables too.
+static register_footprint footprint(
+    "ryu",
+    {"d2s_buffered_n", "DOUBLE_POW5_INV_SPLIT2", "DOUBLE_POW5_SPLIT2",
+     "POW5_INV_OFFSETS", "POW5_OFFSETS", "DOUBLE_POW5_TABLE", "DIGIT_TABLE"});
+#else
+static register_footprint footprint(
+    "ryu", {"d2s_buffered_n", "DOUBLE_POW5_INV_SPLIT", "DOUBLE_POW5_SPLIT",
+            "DIGIT_TABLE"});
+#endif
+
+// d2s returns a malloc'd string which the caller frees.
+static register_method malloced(
+    "ryu-d2s",
+    [](double value, char* buffer) {
+      char* s = d2s(value);
+      size_t n = strlen(s);
+      memcpy(buffer, s, n);
+      free(s);
+      return buffer + n;
+    },
+    {.notation = output_notation::scientific,
+     .allocates = true,
+     .table_size = d2s_table_size()});
+
+// The same with the string allocated from a per-thread arena and written by
+// d2s_buffered_n since d2s takes no allocator.
+static register_method arena(
+    "ryu-d2s-arena",
+    [](double value, char* buffer) {
+      char* s = get_string_arena().allocate(25);
+      int n = d2s_buffered_n(value, s);
+      memcpy(buffer, s, size_t(n));
+      return buffer + n;
+    },
+    {.notation = output_notation::scientific, .table_size = d2s_table_size()});
+
+static register_footprint footprint_small(
+    "ryu-small",
+    {"d2s_small_buffered_n", "DOUBLE_POW5_INV_SPLIT2", "DOUBLE_POW5_SPLIT2",
+     "POW5_INV_OFFSETS", "POW5_OFFSETS", "DOUBLE_POW5_TABLE", "DIGIT_TABLE"});
 
-static register_method _("ryu", [](double value, char* buffer) {
-  d2s_buffered(value, buffer);
+static register_prefetch prefetch("ryu", d2s_prefetch_tables);
+static register_prefetch prefetch_small("ryu-small", d2s_small_prefetch_tables);
+
+static register_batch_method batch(
+    "ryu", [](std::span<const double> values, char* out) {
+      for (double value : values) {
+        int n = d2s_buffered_n(value, out + 1);
+        *out = char(n);
+        out += n + 1;
+      }
+      return out;
+    },
+    {.notation = output_notation::scientific});
+
+static register_float_method float32(
+    "ryu", [](float value, char* buffer) { f2s_buffered(value, buffer); },
+    {.notation = output_notation::scientific});
+
+static register_parse_method parse(
+    "ryu", [](const char* begin, const char* end) {
+      double result = 0;
+      s2d_n(begin, int(end - begin), &result);
+      return result;
+    });
+
+static register_decimal_method decimal("ryu", [](double value) -> decimal_fp {
+  uint64_t mantissa = 0;
+  int32_t exponent = 0;
+  d2d_decimal(value, &mantissa, &exponent);
+  return {mantissa, exponent};
 });
+
+static register_format_method format(
+    "ryu", [](decimal_fp dec, char* buffer) {
+      buffer[d2s_decimal_n(dec.sig, dec.exp, buffer)] = '\0';
+    });
+
+static register_precision_method fixed(
+    "ryu-%f", fixed_precision_format::fixed,
+    [](double value, int precision, char* buffer) {
+      d2fixed_buffered(value, uint32_t(precision), buffer);
+    });
+
+static register_precision_method exponent(
+    "ryu-%e", fixed_precision_format::exponent,
+    [](double value, int precision, char* buffer) {
+      d2exp_buffered(value, uint32_t(precision), buffer);
+    });
+
+// generic_128.c needs __int128.
+#if LDBL_MANT_DIG == 64 && defined(__SIZEOF_INT128__)
+static register_long_double_method long_double(
+    "ryu", [](long double value, char* buffer) {
+      buffer[generic_to_chars(long_double_to_fd128(value), buffer)] = '\0';
+    });
+#endif
+
+#if defined(__SIZEOF_FLOAT128__) && defined(__SIZEOF_INT128__)
+static register_float128_method float128(
+    "ryu", [](__float128 value, char* buffer) {
+      __uint128_t bits = 0;
+      memcpy(&bits, &value, sizeof(value));
+      floating_decimal_128 dec =
+          generic_binary_to_decimal(bits, 112, 15, false);
+      buffer[generic_to_chars(dec, buffer)] = '\0';
+    });
+#endif
@@ -495,6 +495,59 @@ int d2s_buffered_n(double f, char* result) {
   return to_chars(v, ieeeSign, result);
 }
 
+void d2d_decimal(double f, uint64_t* mantissa, int32_t* exponent) {
+  const uint64_t bits = double_to_bits(f);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  floating_decimal_64 v;
+  if (!d2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
+    v = d2d(ieeeMantissa, ieeeExponent);
+  }
+  *mantissa = v.mantissa;
+  *exponent = v.exponent;
+}
+
+int d2s_decimal_n(uint64_t mantissa, int32_t exponent, char* result) {
+  floating_decimal_64 v;
+  v.mantissa = mantissa;
+  v.exponent = exponent;
+  return to_chars(v, false, result);
+}
+
+size_t d2s_table_size(void) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  return sizeof(DOUBLE_POW5_INV_SPLIT2) + sizeof(POW5_INV_OFFSETS) +
+    sizeof(DOUBLE_POW5_SPLIT2) + sizeof(POW5_OFFSETS) + sizeof(DOUBLE_POW5_TABLE) +
+    sizeof(DIGIT_TABLE);
+#else
+  return sizeof(DOUBLE_POW5_INV_SPLIT) + sizeof(DOUBLE_POW5_SPLIT) + sizeof(DIGIT_TABLE);
+#endif
+}
+
+static void prefetch_table(const void* table, size_t size) {
+  for (size_t i = 0; i < size; i += 64) {
+#if defined(__GNUC__)
+    __builtin_prefetch((const char*) table + i);
+#else
+    (void) *(const volatile char*) ((const char*) table + i);
+#endif
+  }
+}
+
+void d2s_prefetch_tables(void) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  prefetch_table(DOUBLE_POW5_INV_SPLIT2, sizeof(DOUBLE_POW5_INV_SPLIT2));
+  prefetch_table(POW5_INV_OFFSETS, sizeof(POW5_INV_OFFSETS));
+  prefetch_table(DOUBLE_POW5_SPLIT2, sizeof(DOUBLE_POW5_SPLIT2));
+  prefetch_table(POW5_OFFSETS, sizeof(POW5_OFFSETS));
+  prefetch_table(DOUBLE_POW5_TABLE, sizeof(DOUBLE_POW5_TABLE));
+#else
+  prefetch_table(DOUBLE_POW5_INV_SPLIT, sizeof(DOUBLE_POW5_INV_SPLIT));
+  prefetch_table(DOUBLE_POW5_SPLIT, sizeof(DOUBLE_POW5_SPLIT));
+#endif
+  prefetch_table(DIGIT_TABLE, sizeof(DIGIT_TABLE));
+}
+
 void d2s_buffered(double f, char* result) {
   const int index = d2s_buffered_n(f, result);
 
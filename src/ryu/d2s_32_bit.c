@@ -0,0 +1,22 @@
+// d2s with RYU_ONLY_64_BIT_OPS and RYU_32_BIT_PLATFORM under different names
+// so that it can be linked together with the default build of d2s.c. It uses
+// the code paths of 32-bit platforms which also compute 64-bit divisions by
+// constants with 32-bit multiplications since 32-bit compilers call library
+// functions for them. Not part of upstream Ryu.
+
+#ifndef RYU_ONLY_64_BIT_OPS
+#define RYU_ONLY_64_BIT_OPS
+#endif
+#ifndef RYU_32_BIT_PLATFORM
+#define RYU_32_BIT_PLATFORM
+#endif
+
+#define d2s_buffered_n d2s_32_bit_buffered_n
+#define d2s_buffered d2s_32_bit_buffered
+#define d2s d2s_32_bit
+#define d2d_decimal d2d_32_bit_decimal
+#define d2s_decimal_n d2s_32_bit_decimal_n
+#define d2s_table_size d2s_32_bit_table_size
+#define d2s_prefetch_tables d2s_32_bit_prefetch_tables
+
+#include "ryu/d2s.c"
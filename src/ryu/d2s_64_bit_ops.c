@@ -0,0 +1,18 @@
+// d2s with RYU_ONLY_64_BIT_OPS under different names so that it can be linked
+// together with the default build of d2s.c. It uses the portable emulation of
+// 64x64->128-bit multiplication instead of __int128 like platforms without
+// it, e.g. MSVC targeting 32-bit x86 or ARM. Not part of upstream Ryu.
+
+#ifndef RYU_ONLY_64_BIT_OPS
+#define RYU_ONLY_64_BIT_OPS
+#endif
+
+#define d2s_buffered_n d2s_64_bit_ops_buffered_n
+#define d2s_buffered d2s_64_bit_ops_buffered
+#define d2s d2s_64_bit_ops
+#define d2d_decimal d2d_64_bit_ops_decimal
+#define d2s_decimal_n d2s_64_bit_ops_decimal_n
+#define d2s_table_size d2s_64_bit_ops_table_size
+#define d2s_prefetch_tables d2s_64_bit_ops_prefetch_tables
+
+#include "ryu/d2s.c"
@@ -0,0 +1,17 @@
+// d2s with the small lookup tables (RYU_OPTIMIZE_SIZE) under different names
+// so that it can be linked together with the default build of d2s.c. Not part
+// of upstream Ryu.
+
+#ifndef RYU_OPTIMIZE_SIZE
+#define RYU_OPTIMIZE_SIZE
+#endif
+
+#define d2s_buffered_n d2s_small_buffered_n
+#define d2s_buffered d2s_small_buffered
+#define d2s d2s_small
+#define d2d_decimal d2d_small_decimal
+#define d2s_decimal_n d2s_small_decimal_n
+#define d2s_table_size d2s_small_table_size
+#define d2s_prefetch_tables d2s_small_prefetch_tables
+
+#include "ryu/d2s.c"
@@ -22,11 +22,38 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include <stddef.h>
 
 int d2s_buffered_n(double f, char* result);
 void d2s_buffered(double f, char* result);
 char* d2s(double f);
 
+// The two stages of d2s_buffered_n exposed separately for benchmarking (not
+// part of upstream Ryu). d2d_decimal converts the absolute value of a finite
+// nonzero f; the mantissa may have trailing zeros for small integers.
+// d2s_decimal_n writes a positive mantissa without trailing zeros.
+void d2d_decimal(double f, uint64_t* mantissa, int32_t* exponent);
+int d2s_decimal_n(uint64_t mantissa, int32_t exponent, char* result);
+
+// The size in bytes of the lookup tables used by d2s (not part of upstream
+// Ryu).
+size_t d2s_table_size(void);
+
+// Prefetches the lookup tables used by d2s into the caches (not part of
+// upstream Ryu).
+void d2s_prefetch_tables(void);
+
+// d2s built with RYU_OPTIMIZE_SIZE in d2s_small.c (not part of upstream Ryu).
+int d2s_small_buffered_n(double f, char* result);
+void d2s_small_buffered(double f, char* result);
+size_t d2s_small_table_size(void);
+void d2s_small_prefetch_tables(void);
+
+// d2s without __int128 in d2s_64_bit_ops.c and with the 32-bit platform code
+// paths in d2s_32_bit.c (not part of upstream Ryu).
+int d2s_64_bit_ops_buffered_n(double f, char* result);
+int d2s_32_bit_buffered_n(double f, char* result);
+
 int f2s_buffered_n(float f, char* result);
 void f2s_buffered(float f, char* result);
 char* f2s(float f);
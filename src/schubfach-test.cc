@@ -4,6 +4,35 @@
 
 #include "benchmark.h"
 
-static register_method _("schubfach", [](double x, char* buffer) noexcept {
-  schubfach::dtoa(x, buffer);
-});
+static register_method _(
+    "schubfach",
+    [](double x, char* buffer) noexcept { schubfach::dtoa(x, buffer); },
+    {.notation = output_notation::scientific});
+
+static register_footprint footprint(
+    "schubfach", {"schubfach::dtoa", "schubfach::to_decimal",
+                  "schubfach::write",
+                  "(anonymous namespace)::pow10_significands"});
+
+static register_decimal_method decimal("schubfach",
+                                       [](double x) noexcept -> decimal_fp {
+                                         auto [sig, exp] =
+                                             schubfach::to_decimal(x);
+                                         return {sig, exp};
+                                       });
+
+static register_format_method format(
+    "schubfach", [](decimal_fp dec, char* buffer) noexcept {
+      schubfach::write(buffer, {dec.sig, dec.exp});
+    });
+
+static register_float_method float32(
+    "schubfach",
+    [](float x, char* buffer) noexcept { schubfach::dtoa(x, buffer); },
+    {.notation = output_notation::scientific});
+
+static register_float_decimal_method float_decimal(
+    "schubfach", [](float x) noexcept -> decimal_fp {
+      auto [sig, exp] = schubfach::to_decimal(x);
+      return {sig, exp};
+    });
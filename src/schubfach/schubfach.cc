@@ -9,8 +9,9 @@
 #include <stdint.h>  // uint64_t
 #include <string.h>  // memcpy
 
-#include <bit>     // std::bit_cast
-#include <limits>  // std::numeric_limits
+#include <bit>          // std::bit_cast
+#include <limits>       // std::numeric_limits
+#include <type_traits>  // std::conditional_t
 
 namespace {
 
@@ -738,8 +739,11 @@ const uint64_t pow10[] = {
     100'000'000'000'000'000,
 };
 
+}  // namespace
+
 // Writes the decimal FP number dec_sig * 10**dec_exp to buffer.
-void write(char* buffer, uint64_t dec_sig, int dec_exp) noexcept {
+void schubfach::write(char* buffer, dec_fp dec) noexcept {
+  auto [dec_sig, dec_exp] = dec;
   int len = floor_log10_pow2(std::numeric_limits<uint64_t>::digits -
                              std::countl_zero(dec_sig));
   if (dec_sig >= pow10[len]) ++len;
@@ -773,42 +777,38 @@ void write(char* buffer, uint64_t dec_sig, int dec_exp) noexcept {
   *buffer = '\0';
 }
 
-}  // namespace
-
-void schubfach::dtoa(double value, char* buffer) noexcept {
-  uint64_t bits = std::bit_cast<uint64_t>(value);
-  *buffer = '-';
-  buffer += bits >> 63;
+namespace {
 
-  constexpr int num_sig_bits = std::numeric_limits<double>::digits - 1;
-  constexpr int exp_mask = 0x7ff;
+// Converts a finite nonzero float or double. The significands of both fit
+// into the 64-bit arithmetic and the decimal exponents of float are a subrange
+// of the ones of double so the same table is used.
+template <typename Float>
+auto to_decimal_impl(Float value) noexcept -> schubfach::dec_fp {
+  using uint = std::conditional_t<sizeof(Float) == 4, uint32_t, uint64_t>;
+  uint bits = std::bit_cast<uint>(value);
+  constexpr int num_sig_bits = std::numeric_limits<Float>::digits - 1;
+  constexpr int num_exp_bits = sizeof(Float) * 8 - num_sig_bits - 1;
+  constexpr int exp_mask = (1 << num_exp_bits) - 1;
+  constexpr int exp_bias = exp_mask >> 1;
   int bin_exp = int(bits >> num_sig_bits) & exp_mask;
 
   constexpr uint64_t implicit_bit = uint64_t(1) << num_sig_bits;
   uint64_t bin_sig = bits & (implicit_bit - 1);  // binary significand
 
   bool regular = bin_sig != 0;
-  if (((bin_exp + 1) & exp_mask) <= 1) [[unlikely]] {
-    if (bin_exp != 0) {
-      memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
-      return;
-    }
-    if (bin_sig == 0) {
-      memcpy(buffer, "0", 2);
-      return;
-    }
+  if (bin_exp == 0) [[unlikely]] {
     // Handle subnormals.
     bin_sig ^= implicit_bit;
     ++bin_exp;
     regular = true;
   }
   bin_sig ^= implicit_bit;
-  bin_exp -= num_sig_bits + 1023;  // Remove the exponent bias.
+  bin_exp -= num_sig_bits + exp_bias;  // Remove the exponent bias.
 
   // Handle small integers.
   if ((bin_exp < 0) & (bin_exp >= -num_sig_bits)) {
     uint64_t f = bin_sig >> -bin_exp;
-    if (f << -bin_exp == bin_sig) return write(buffer, f, 0);
+    if (f << -bin_exp == bin_sig) return {f, 0};
   }
 
   // Shift the significand so that boundaries are integer.
@@ -862,7 +862,7 @@ void schubfach::dtoa(double value, char* buffer) noexcept {
     bool under_in = lower + bin_sig_lsb <= (dec_sig_under2 << 2);
     bool over_in = (dec_sig_over2 << 2) + bin_sig_lsb <= upper;
     if (under_in != over_in)
-      return write(buffer, under_in ? dec_sig_under2 : dec_sig_over2, dec_exp);
+      return {under_in ? dec_sig_under2 : dec_sig_over2, dec_exp};
   }
 
   uint64_t dec_sig_over = dec_sig_under + 1;
@@ -870,11 +870,63 @@ void schubfach::dtoa(double value, char* buffer) noexcept {
   bool over_in = (dec_sig_over << 2) + bin_sig_lsb <= upper;
   if (under_in != over_in) {
     // Only one of dec_sig_under or dec_sig_over are in the rounding interval.
-    return write(buffer, under_in ? dec_sig_under : dec_sig_over, dec_exp);
+    return {under_in ? dec_sig_under : dec_sig_over, dec_exp};
   }
 
   // Both dec_sig_under and dec_sig_over are in the interval - pick the closest.
   int cmp = scaled_sig - ((dec_sig_under + dec_sig_over) << 1);
   bool under_closer = cmp < 0 || cmp == 0 && (dec_sig_under & 1) == 0;
-  return write(buffer, under_closer ? dec_sig_under : dec_sig_over, dec_exp);
+  return {under_closer ? dec_sig_under : dec_sig_over, dec_exp};
+}
+
+}  // namespace
+
+auto schubfach::to_decimal(double value) noexcept -> dec_fp {
+  return to_decimal_impl(value);
+}
+
+auto schubfach::to_decimal(float value) noexcept -> dec_fp {
+  return to_decimal_impl(value);
+}
+
+void schubfach::dtoa(double value, char* buffer) noexcept {
+  uint64_t bits = std::bit_cast<uint64_t>(value);
+  *buffer = '-';
+  buffer += bits >> 63;
+
+  constexpr int exp_mask = 0x7ff;
+  int bin_exp = int(bits >> 52) & exp_mask;
+  uint64_t bin_sig = bits & ((uint64_t(1) << 52) - 1);
+  if (((bin_exp + 1) & exp_mask) <= 1) [[unlikely]] {
+    if (bin_exp != 0) {
+      memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
+      return;
+    }
+    if (bin_sig == 0) {
+      memcpy(buffer, "0", 2);
+      return;
+    }
+  }
+  write(buffer, to_decimal(value));
+}
+
+void schubfach::dtoa(float value, char* buffer) noexcept {
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  *buffer = '-';
+  buffer += bits >> 31;
+
+  constexpr int exp_mask = 0xff;
+  int bin_exp = int(bits >> 23) & exp_mask;
+  uint32_t bin_sig = bits & ((uint32_t(1) << 23) - 1);
+  if (((bin_exp + 1) & exp_mask) <= 1) [[unlikely]] {
+    if (bin_exp != 0) {
+      memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
+      return;
+    }
+    if (bin_sig == 0) {
+      memcpy(buffer, "0", 2);
+      return;
+    }
+  }
+  write(buffer, to_decimal(value));
 }
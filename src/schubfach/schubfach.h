@@ -3,12 +3,32 @@
 // Copyright (c) 2025 - present, Victor Zverovich
 // Distributed under the MIT license (see LICENSE).
 
+#include <stdint.h>  // uint64_t
+
 namespace schubfach {
 
 constexpr int buffer_size = 25;
 
+/// A decimal floating-point number sig * 10**exp.
+struct dec_fp {
+  uint64_t sig;
+  int exp;
+};
+
+/// Converts the absolute value of a finite nonzero `value` into the shortest
+/// correctly rounded decimal representation. The significand may have
+/// trailing zeros.
+auto to_decimal(double value) noexcept -> dec_fp;
+auto to_decimal(float value) noexcept -> dec_fp;
+
+/// Writes `dec` with a nonzero significand of up to 17 digits in the format of
+/// dtoa to `buffer`. `buffer` should point to a buffer of size `buffer_size` or
+/// larger.
+void write(char* buffer, dec_fp dec) noexcept;
+
 /// Writes the shortest correctly rounded decimal representation of `value` to
 /// `buffer`. `buffer` should point to a buffer of size `buffer_size` or larger.
 void dtoa(double value, char* buffer) noexcept;
+void dtoa(float value, char* buffer) noexcept;
 
 }  // namespace schubfach
@@ -1,7 +1,78 @@
+#include <locale.h>  // uselocale
+
 #include <cstdio>
 
+#if defined(__APPLE__)
+#  include <xlocale.h>
+#endif
+
 #include "benchmark.h"
 
-static register_method _("sprintf", [](double value, char* buffer) {
-  sprintf(buffer, "%.17g", value);
+// %.17g round-trips but isn't the shortest, e.g. 0.10000000000000001.
+constexpr method_info info = {.shortest = false};
+
+static register_method _(
+    "sprintf",
+    [](double value, char* buffer) {
+      return buffer + sprintf(buffer, "%.17g", value);
+    },
+    info);
+
+static register_method bounded(
+    "snprintf",
+    [](double value, char* buffer) {
+      return buffer + snprintf(buffer, dtoa_buffer_size, "%.17g", value);
+    },
+    info);
+
+#ifndef _WIN32
+// Switches to the C locale for the call to make the output independent of the
+// global locale.
+static register_method c_locale(
+    "snprintf-c-locale", [](double value, char* buffer) {
+      static const locale_t c = newlocale(LC_ALL_MASK, "C", locale_t());
+      locale_t old = uselocale(c);
+      int n = snprintf(buffer, dtoa_buffer_size, "%.17g", value);
+      uselocale(old);
+      return buffer + n;
+    },
+    info);
+#endif
+
+static register_hex_method hex("sprintf", [](double value, char* buffer) {
+  sprintf(buffer, "%a", value);
 });
+
+static register_precision_method fixed(
+    "sprintf-%f", fixed_precision_format::fixed,
+    [](double value, int precision, char* buffer) {
+      sprintf(buffer, "%.*f", precision, value);
+    });
+
+static register_precision_method exponent(
+    "sprintf-%e", fixed_precision_format::exponent,
+    [](double value, int precision, char* buffer) {
+      sprintf(buffer, "%.*e", precision, value);
+    });
+
+#if LDBL_MANT_DIG == 64
+// 21 significant digits are needed to round-trip.
+static register_long_double_method long_double(
+    "sprintf", [](long double value, char* buffer) {
+      sprintf(buffer, "%.21Lg", value);
+    });
+#endif
+
+static register_itoa_method itoa(
+    "sprintf",
+    [](int32_t value, char* buffer) {
+      return buffer + sprintf(buffer, "%d", value);
+    },
+    [](int64_t value, char* buffer) {
+      return buffer + sprintf(buffer, "%lld", static_cast<long long>(value));
+    });
+
+static register_bounded_method truncating(
+    "snprintf", [](double value, char* buffer, size_t n) {
+      return size_t(snprintf(buffer, n, "%.17g", value));
+    });
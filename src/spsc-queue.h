@@ -0,0 +1,44 @@
+// A bounded single-producer single-consumer queue.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stddef.h>  // size_t
+
+#include <atomic>
+
+// A lock-free ring buffer of `Size` elements where one thread pushes and
+// another pops. The indices are on separate cache lines to avoid false
+// sharing between the two threads.
+template <typename T, size_t Size>
+class spsc_queue {
+ private:
+  static_assert((Size & (Size - 1)) == 0, "size must be a power of two");
+
+  alignas(64) std::atomic<size_t> head_ = 0;  // The next element to pop.
+  alignas(64) std::atomic<size_t> tail_ = 0;  // The next element to push.
+  alignas(64) T data_[Size];
+
+ public:
+  // Returns false if the queue is full.
+  auto try_push(const T& value) -> bool {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Size) return false;
+    data_[tail % Size] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false if the queue is empty.
+  auto try_pop(T& value) -> bool {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    value = data_[head % Size];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+#endif  // SPSC_QUEUE_H_
@@ -0,0 +1,58 @@
+// Arenas for strings returned by conversions.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef STRING_ARENA_H_
+#define STRING_ARENA_H_
+
+#include <stddef.h>  // size_t
+
+#include <memory>  // std::unique_ptr
+#include <memory_resource>
+#include <string>
+
+// A monotonic buffer resource over a fixed buffer from which string-returning
+// conversions allocate instead of the heap, e.g. as the allocator of a
+// std::pmr::string. It is released every `reset_interval` strings like a
+// request-scoped arena in a server, so a string must not be used after
+// `reset_interval` more are allocated. Allocations only go to the heap if the
+// strings between two releases don't fit in the buffer.
+class string_arena {
+ public:
+  static constexpr size_t reset_interval = 4096;
+
+ private:
+  // Enough for the longest double, 24 characters and a NUL, per string.
+  static constexpr size_t buffer_size = reset_interval * 32;
+
+  std::unique_ptr<char[]> buffer_;
+  std::pmr::monotonic_buffer_resource resource_;
+  size_t count_ = 0;
+
+ public:
+  string_arena()
+      : buffer_(new char[buffer_size]), resource_(buffer_.get(), buffer_size) {}
+
+  // Returns the resource to allocate the next string from.
+  auto resource() -> std::pmr::memory_resource* {
+    if (++count_ == reset_interval) {
+      resource_.release();
+      count_ = 0;
+    }
+    return &resource_;
+  }
+
+  // Returns `size` bytes for the next string, e.g. for a C API that writes
+  // into a caller-provided buffer instead of returning a malloc'd one.
+  auto allocate(size_t size) -> char* {
+    return static_cast<char*>(resource()->allocate(size, 1));
+  }
+};
+
+// Returns the arena of the calling thread.
+inline auto get_string_arena() -> string_arena& {
+  thread_local string_arena arena;
+  return arena;
+}
+
+#endif  // STRING_ARENA_H_
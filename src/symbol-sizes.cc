@@ -0,0 +1,86 @@
+// Static footprint of code and tables from the symbol sizes of the benchmark.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#include "symbol-sizes.h"
+
+#include <stdio.h>   // fopen
+#include <stdlib.h>  // strtoull
+#include <string.h>  // strchr
+
+#include <set>
+
+namespace {
+
+auto is_identifier_char(char c) -> bool {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+// Returns true if `pattern` occurs in `name` not preceded or followed by an
+// identifier character.
+auto contains_identifier(const std::string& name, const std::string& pattern)
+    -> bool {
+  for (size_t pos = name.find(pattern); pos != std::string::npos;
+       pos = name.find(pattern, pos + 1)) {
+    size_t end = pos + pattern.size();
+    if ((pos == 0 || !is_identifier_char(name[pos - 1])) &&
+        (end == name.size() || !is_identifier_char(name[end]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+auto symbol_sizes::load(const char* path) -> bool {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  // Lines have the form "<address> <size> <type> <name>". Symbols without a
+  // size, e.g. section markers, only have an address.
+  char line[4096];
+  while (fgets(line, sizeof(line), f)) {
+    char* p = strchr(line, ' ');
+    if (!p) continue;
+    char* end = nullptr;
+    size_t size = strtoull(p + 1, &end, 16);
+    if (end == p + 1 || end[0] != ' ' || end[1] == '\0' || end[2] != ' ')
+      continue;
+    std::string name = end + 3;
+    if (!name.empty() && name.back() == '\n') name.pop_back();
+    switch (end[1]) {
+      case 't':
+      case 'T':
+      case 'w':
+      case 'W':
+        symbols_.push_back({name, size, true});
+        break;
+      case 'r':
+      case 'R':
+      case 'd':
+      case 'D':
+      case 'u':  // unique global, e.g. a static data member of a template
+      case 'v':
+      case 'V':
+        symbols_.push_back({name, size, false});
+        break;
+    }
+  }
+  fclose(f);
+  return !symbols_.empty();
+}
+
+auto symbol_sizes::measure(const std::vector<std::string>& patterns) const
+    -> footprint {
+  footprint result;
+  std::set<std::string> seen;
+  for (const symbol& s : symbols_) {
+    bool matches = false;
+    for (const std::string& pattern : patterns)
+      matches = matches || contains_identifier(s.name, pattern);
+    if (!matches || !seen.insert(s.name).second) continue;
+    (s.is_code ? result.code_size : result.table_size) += s.size;
+  }
+  return result;
+}
@@ -0,0 +1,41 @@
+// Static footprint of code and tables from the symbol sizes of the benchmark.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef SYMBOL_SIZES_H_
+#define SYMBOL_SIZES_H_
+
+#include <stddef.h>  // size_t
+
+#include <string>
+#include <vector>
+
+struct footprint {
+  size_t code_size = 0;   // text
+  size_t table_size = 0;  // read-only and initialized data
+};
+
+// The sizes of the defined symbols of the benchmark executable as listed by
+// `nm --print-size --demangle --defined-only` at build time.
+class symbol_sizes {
+ private:
+  struct symbol {
+    std::string name;
+    size_t size;
+    bool is_code;
+  };
+  std::vector<symbol> symbols_;
+
+ public:
+  // Loads the nm output from `path` and returns true on success.
+  auto load(const char* path) -> bool;
+
+  // Returns the total sizes of symbols whose demangled names contain any of
+  // `patterns` as a whole identifier, e.g. "d2s" matches "d2s" but not
+  // "d2s_small". Each name is counted once even if several translation units
+  // define it, e.g. a table in an anonymous namespace, since a build with a
+  // single method would contain only one copy.
+  auto measure(const std::vector<std::string>& patterns) const -> footprint;
+};
+
+#endif  // SYMBOL_SIZES_H_
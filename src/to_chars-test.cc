@@ -1,7 +1,128 @@
+#include <string.h>  // memcpy
+
 #include <charconv>
 
 #include "benchmark.h"
 
 static register_method _("to_chars", [](double value, char* buffer) {
-  *std::to_chars(buffer, buffer + 24, value).ptr = '\0';
+  return std::to_chars(buffer, buffer + 24, value).ptr;
+});
+
+static register_method general("to_chars-general", [](double value,
+                                                      char* buffer) {
+  return std::to_chars(buffer, buffer + 24, value, std::chars_format::general)
+      .ptr;
 });
+
+static register_method fixed(
+    "to_chars-fixed",
+    [](double value, char* buffer) {
+      return std::to_chars(buffer, buffer + dtoa_buffer_size, value,
+                           std::chars_format::fixed)
+          .ptr;
+    },
+    {.notation = output_notation::fixed});
+
+static register_method scientific(
+    "to_chars-scientific",
+    [](double value, char* buffer) {
+      return std::to_chars(buffer, buffer + 24, value,
+                           std::chars_format::scientific)
+          .ptr;
+    },
+    {.notation = output_notation::scientific});
+
+// Uses the precision overload of to_chars.
+template <std::chars_format format>
+void to_chars_precision(double value, int precision, char* buffer) {
+  *std::to_chars(buffer, buffer + dtoa_buffer_size - 1, value, format,
+                 precision)
+       .ptr = '\0';
+}
+
+static register_precision_method fixed_precision(
+    "to_chars-%f", fixed_precision_format::fixed,
+    to_chars_precision<std::chars_format::fixed>);
+
+static register_precision_method exponent_precision(
+    "to_chars-%e", fixed_precision_format::exponent,
+    to_chars_precision<std::chars_format::scientific>);
+
+static register_precision_method general_precision(
+    "to_chars-%g", fixed_precision_format::general,
+    to_chars_precision<std::chars_format::general>);
+
+static register_hex_method hex("to_chars", [](double value, char* buffer) {
+  *std::to_chars(buffer, buffer + 32, value, std::chars_format::hex).ptr =
+      '\0';
+});
+
+static register_float_method float32(
+    "to_chars", [](float value, char* buffer) {
+      *std::to_chars(buffer, buffer + 16, value).ptr = '\0';
+    });
+
+static register_parse_method parse(
+    "from_chars", [](const char* begin, const char* end) {
+      double result = 0;
+      std::from_chars(begin, end, result);
+      return result;
+    });
+
+#if LDBL_MANT_DIG == 64
+static register_long_double_method long_double(
+    "to_chars", [](long double value, char* buffer) {
+      *std::to_chars(buffer, buffer + 64, value).ptr = '\0';
+    });
+#endif
+
+static register_itoa_method itoa(
+    "to_chars",
+    [](int32_t value, char* buffer) {
+      return std::to_chars(buffer, buffer + 11, value).ptr;
+    },
+    [](int64_t value, char* buffer) {
+      return std::to_chars(buffer, buffer + 20, value).ptr;
+    });
+
+// to_chars fails instead of truncating so the output is copied from a
+// temporary buffer if it doesn't fit.
+static register_bounded_method bounded(
+    "to_chars", [](double value, char* buffer, size_t n) {
+      auto [end, ec] = std::to_chars(buffer, buffer + n, value);
+      if (ec == std::errc()) return size_t(end - buffer);
+      char temp[24];
+      size_t size = size_t(std::to_chars(temp, temp + 24, value).ptr - temp);
+      memcpy(buffer, temp, n);
+      return size;
+    });
+
+// std::to_chars only writes char so UTF-16 output requires widening.
+static register_wide_method wide(
+    "to_chars-widen", [](double value, char16_t* buffer) {
+      char narrow[24];
+      char* end = std::to_chars(narrow, narrow + sizeof(narrow), value).ptr;
+      return widen(narrow, end, buffer);
+    });
+
+static register_fixed_column_method fixed_column(
+    "to_chars-fixed", [](std::span<const double> values, char* out) {
+      for (double value : values) {
+        out = std::to_chars(out, out + fixed_column_value_size - 1, value,
+                            std::chars_format::fixed)
+                  .ptr;
+        *out++ = '\n';
+      }
+      return out;
+    });
+
+static register_fixed_column_method fixed_column2(
+    "to_chars-%.2f", [](std::span<const double> values, char* out) {
+      for (double value : values) {
+        out = std::to_chars(out, out + fixed_column_value_size - 1, value,
+                            std::chars_format::fixed, 2)
+                  .ptr;
+        *out++ = '\n';
+      }
+      return out;
+    });
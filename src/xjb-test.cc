@@ -1,5 +1,20 @@
 #include "benchmark.h"
 #include "xjb/xjb64.h"
 
-static register_method _("xjb64",
-                         [](double x, char* buffer) { xjb64(x, buffer); });
+// xjb64 writes a NUL but returns a pointer to it.
+static register_method _("xjb64", xjb64);
+
+// Includes the tables which are static locals of xjb64.
+static register_footprint footprint("xjb64", {"xjb64"});
+
+static register_decimal_method decimal("xjb64", [](double x) -> decimal_fp {
+  xjb::dec_fp dec = xjb::to_decimal(x);
+  return {dec.sig, dec.exp};
+});
+
+// xjb has no float writer, only the float overload of to_decimal.
+static register_float_decimal_method float_decimal(
+    "xjb64", [](float x) -> decimal_fp {
+      xjb::dec_fp dec = xjb::to_decimal(x);
+      return {dec.sig, dec.exp};
+    });
@@ -1 +1,32 @@
+#ifndef XJB64_H
+#define XJB64_H
+
+#include <stdint.h>
+
+namespace xjb {
+
+// The buffer size required by xjb64 including the sign and the terminating
+// NUL. xjb64 stores whole 8 and 16-byte words so it may write past the end of
+// the string.
+constexpr int buffer_size = 34;
+
+// A decimal floating-point number sig * 10**exp.
+struct dec_fp {
+    uint64_t sig;
+    int exp;
+};
+
+// Converts the absolute value of a finite nonzero value into the shortest
+// correctly rounded decimal representation. The significand may have one
+// trailing zero.
+dec_fp to_decimal(double v);
+dec_fp to_decimal(float v);
+
+}  // namespace xjb
+
+// Writes the shortest representation of v followed by a NUL to buf and
+// returns a pointer to the NUL. buf should point to a buffer of size
+// xjb::buffer_size or larger.
 char* xjb64(double v,char* buf);
+
+#endif  // XJB64_H
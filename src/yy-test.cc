@@ -1,7 +1,19 @@
 #include "benchmark.h"
 
 extern "C" char* yy_double_to_string(double val, char* buf);
+extern "C" double yy_string_to_double(const char* str, char** endptr);
 
 static register_method _("yy", [](double value, char* buffer) {
-  *yy_double_to_string(value, buffer) = 0;
+  return yy_double_to_string(value, buffer);
 });
+
+static register_footprint footprint("yy", {"yy_double_to_string",
+                                           "pow10_sig_table"});
+
+// yy_string_to_double requires a NUL-terminated string. `endptr` must not be
+// null because it is dereferenced when parsing "inf".
+static register_parse_method parse(
+    "yy", [](const char* begin, const char*) {
+      char* end = nullptr;
+      return yy_string_to_double(begin, &end);
+    });
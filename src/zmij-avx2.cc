@@ -0,0 +1,37 @@
+// zmij for AVX2 with BMI2 and FMA, see zmij-isa.h.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifdef ZMIJ_ISA_VARIANTS
+#  ifndef __AVX2__
+#    error "zmij-avx2.cc must be compiled with -mavx2"
+#  endif
+
+#  define ZMIJ_HEADER_ONLY
+#  define ZMIJ_HEADER_NAMESPACE header_only_avx2
+#  include "zmij/zmij.h"
+#  include "zmij-isa.h"
+
+namespace {
+
+auto supported() -> bool {
+  __builtin_cpu_init();  // May be called before constructors.
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") &&
+         __builtin_cpu_supports("fma");
+}
+
+auto write_scientific(double value, char* buffer) noexcept -> char* {
+  return buffer + zmij::write<zmij::dialect<2, true, false>>(
+                      buffer, zmij::double_buffer_size, value);
+}
+
+void to_decimal_soa(const double* values, long long* sigs, int16_t* exps,
+                    size_t n) noexcept {
+  zmij::to_decimal(values, sigs, exps, n);
+}
+
+}  // namespace
+
+extern const zmij_isa zmij_avx2 = {"avx2", supported, write_scientific,
+                                   to_decimal_soa};
+#endif  // ZMIJ_ISA_VARIANTS
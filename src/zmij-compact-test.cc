@@ -0,0 +1,16 @@
+#define ZMIJ_HEADER_ONLY
+#define ZMIJ_COMPACT_POW10 1
+#include "zmij/zmij.h"
+
+#include "benchmark.h"
+
+// zmij with the compressed table of powers of 10. It should be compared with
+// zmij-header-only which is built the same way but with the full table.
+static register_method _(
+    "zmij-compact",
+    [](double x, char* buffer) noexcept {
+      return buffer + zmij::write<zmij::dialect<2, true, false>>(
+                          buffer, zmij::double_buffer_size, x);
+    },
+    {.notation = output_notation::scientific,
+     .table_size = zmij::detail::pow10_table_size()});
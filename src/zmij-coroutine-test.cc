@@ -0,0 +1,107 @@
+// An experimental coroutine API that yields chunks of formatted values, built
+// on zmij and benchmarked as batch methods against the synchronous zmij loop
+// to measure the cost of the coroutine frame and of suspending per chunk.
+
+#include <algorithm>  // std::min
+#include <coroutine>
+#include <exception>  // std::terminate
+#include <utility>    // std::exchange
+
+#include "benchmark.h"
+#include "zmij/zmij.h"
+
+namespace {
+
+// A minimal synchronous generator like C++23's std::generator which isn't
+// available in all supported standard libraries.
+template <typename T>
+class generator {
+ public:
+  struct promise_type {
+    T value;
+
+    auto get_return_object() -> generator {
+      return generator(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+    auto final_suspend() noexcept -> std::suspend_always { return {}; }
+    auto yield_value(T v) noexcept -> std::suspend_always {
+      value = v;
+      return {};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  struct sentinel {};
+
+  class iterator {
+   private:
+    std::coroutine_handle<promise_type> handle_;
+
+   public:
+    explicit iterator(std::coroutine_handle<promise_type> h) : handle_(h) {}
+
+    auto operator*() const -> const T& { return handle_.promise().value; }
+    auto operator++() -> iterator& {
+      handle_.resume();
+      return *this;
+    }
+    auto operator==(sentinel) const -> bool { return handle_.done(); }
+  };
+
+  generator(generator&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  ~generator() {
+    if (handle_) handle_.destroy();
+  }
+
+  auto begin() -> iterator {
+    handle_.resume();
+    return iterator(handle_);
+  }
+  auto end() -> sentinel { return {}; }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit generator(std::coroutine_handle<promise_type> h) : handle_(h) {}
+};
+
+// Formats `values` as length-prefixed strings starting at `out`, suspending
+// after every `chunk_size` values with the span of the chunk written.
+auto format_chunks(std::span<const double> values, char* out,
+                   size_t chunk_size) -> generator<std::span<char>> {
+  for (size_t i = 0; i < values.size(); i += chunk_size) {
+    char* begin = out;
+    size_t end = std::min(i + chunk_size, values.size());
+    for (size_t j = i; j < end; ++j) {
+      size_t n = zmij::write(out + 1, zmij::double_buffer_size, values[j]);
+      *out = char(n);
+      out += n + 1;
+    }
+    co_yield std::span<char>(begin, out);
+  }
+}
+
+template <size_t ChunkSize>
+auto format_with_coroutine(std::span<const double> values, char* out)
+    -> char* {
+  for (std::span<char> chunk : format_chunks(values, out, ChunkSize))
+    out = chunk.data() + chunk.size();
+  return out;
+}
+
+}  // namespace
+
+// zmij::write uses the scientific notation, e.g. 1e-01.
+constexpr auto scientific =
+    method_info{.notation = output_notation::scientific};
+
+static register_batch_method chunk1("zmij-coroutine-1",
+                                    format_with_coroutine<1>, scientific);
+static register_batch_method chunk16("zmij-coroutine-16",
+                                     format_with_coroutine<16>, scientific);
+static register_batch_method chunk256("zmij-coroutine-256",
+                                      format_with_coroutine<256>, scientific);
@@ -0,0 +1,86 @@
+// zmij variants for newer x86-64 instruction sets and runtime dispatch between
+// them, for comparison with the baseline zmij build.
+
+#include <span>
+#include <string>
+
+#include "benchmark.h"
+#include "zmij-isa.h"
+#include "zmij/zmij.h"
+
+#ifdef ZMIJ_ISA_VARIANTS
+namespace {
+
+// Variants in order of preference.
+const zmij_isa* const variants[] = {&zmij_avx512, &zmij_avx2};
+
+auto write_baseline(double value, char* buffer) noexcept -> char* {
+  return buffer + zmij::write<zmij::dialect<2, true, false>>(
+                      buffer, zmij::double_buffer_size, value);
+}
+
+void to_decimal_baseline(const double* values, long long* sigs, int16_t* exps,
+                         size_t n) noexcept {
+  zmij::to_decimal(values, sigs, exps, n);
+}
+
+// The baseline x86-64 build of zmij.
+const zmij_isa baseline = {"baseline", [] { return true; }, write_baseline,
+                           to_decimal_baseline};
+
+// Returns the best variant supported by the CPU.
+auto resolve() -> const zmij_isa* {
+  for (const zmij_isa* isa : variants) {
+    if (isa->supported()) return isa;
+  }
+  return &baseline;
+}
+
+// Resolved once at startup and called through a pointer like an ifunc.
+const zmij_isa* dispatched = resolve();
+
+// Converts the values into separate significand and exponent arrays like
+// zmij-soa.
+auto write_soa(const zmij_isa& isa, std::span<const double> values, char* out)
+    -> size_t {
+  auto sigs = reinterpret_cast<long long*>(out);
+  auto exps = reinterpret_cast<int16_t*>(sigs + values.size());
+  isa.to_decimal(values.data(), sigs, exps, values.size());
+  return values.size() * (sizeof(long long) + sizeof(int16_t));
+}
+
+template <const zmij_isa& Isa>
+auto write_soa(std::span<const double> values, char* out) -> size_t {
+  return write_soa(Isa, values, out);
+}
+
+// Variants are only registered if the CPU supports them because they can't
+// be verified, let alone benchmarked, otherwise.
+template <const zmij_isa& Isa> void register_isa() {
+  if (!Isa.supported()) return;
+  register_method((std::string("zmij-") + Isa.name).c_str(), Isa.write,
+                  {.notation = output_notation::scientific,
+                   .table_size = zmij::detail::pow10_table_size()});
+  register_columnar_method((std::string("zmij-soa-") + Isa.name).c_str(),
+                           write_soa<Isa>);
+}
+
+const bool registered =
+    (register_isa<zmij_avx2>(), register_isa<zmij_avx512>(), true);
+
+}  // namespace
+
+static register_method dispatch(
+    "zmij-dispatch",
+    [](double x, char* buffer) noexcept {
+      return dispatched->write(x, buffer);
+    },
+    {.notation = output_notation::scientific,
+     .table_size = zmij::detail::pow10_table_size()});
+
+static register_columnar_method soa_dispatch(
+    "zmij-soa-dispatch",
+    [](std::span<const double> values, char* out) {
+      return write_soa(*dispatched, values, out);
+    });
+#endif  // ZMIJ_ISA_VARIANTS
@@ -0,0 +1,62 @@
+#define ZMIJ_HEADER_ONLY
+#include "zmij/zmij.h"
+
+#include <array>
+#include <string_view>
+
+#include "benchmark.h"
+
+namespace {
+
+// Converts `value` at compile time.
+constexpr auto write_constant(double value)
+    -> std::array<char, zmij::double_buffer_size> {
+  std::array<char, zmij::double_buffer_size> buffer = {};
+  zmij::write(buffer.data(), buffer.size(), value);
+  return buffer;
+}
+
+static_assert(std::string_view(write_constant(6.62607015e-34).data()) ==
+              "6.62607015e-34");
+constexpr zmij::dec_fp planck = zmij::to_decimal(6.62607015e-34);
+static_assert(planck.sig == 66260701500000000 && planck.exp == -50);
+
+}  // namespace
+
+// The same as zmij but using the header-only build, which shouldn't be slower.
+static register_method _(
+    "zmij-header-only",
+    [](double x, char* buffer) noexcept {
+      return buffer + zmij::write<zmij::dialect<2, true, false>>(
+                          buffer, zmij::double_buffer_size, x);
+    },
+    {.notation = output_notation::scientific,
+     .table_size = zmij::detail::pow10_table_size()});
+
+// Only the header-only build can be inlined into the benchmark loop.
+DTOA_BENCHMARK_INLINE(inline_write, "zmij-header-only",
+                      [](double x, char* buffer) noexcept {
+                        zmij::write<zmij::dialect<2, true, false>>(
+                            buffer, zmij::double_buffer_size, x);
+                      });
+
+// Writers specialized for value ranges which are only instantiated by the
+// header-only build. [1e-6, 1e9] matches e.g. prices and the wider range the
+// uniform-exponent dataset.
+static register_range_method range(
+    "zmij-range",
+    [](double x, char* buffer) noexcept {
+      return buffer +
+             zmij::write<zmij::range<-6, 9>, zmij::dialect<2, true, false>>(
+                 buffer, zmij::double_buffer_size, x);
+    },
+    1e-6, 1e9);
+
+static register_range_method wide_range(
+    "zmij-range-20",
+    [](double x, char* buffer) noexcept {
+      return buffer +
+             zmij::write<zmij::range<-20, 20>, zmij::dialect<2, true, false>>(
+                 buffer, zmij::double_buffer_size, x);
+    },
+    1e-20, 1e20);
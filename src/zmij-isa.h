@@ -0,0 +1,30 @@
+// zmij built for newer x86-64 instruction sets.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license.
+
+#ifndef ZMIJ_ISA_H_
+#define ZMIJ_ISA_H_
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // int16_t
+
+// A header-only build of zmij compiled with the flags of an instruction set in
+// its own translation unit, e.g. zmij-avx2.cc with -mavx2, so that the best
+// one for the CPU can be picked at startup. Only primitive types are used
+// because the builds have distinct types and the translation units don't
+// include the benchmark headers whose inline functions could otherwise be
+// merged with ones that use the instruction set.
+struct zmij_isa {
+  const char* name;
+  // Returns true if the CPU supports the instruction set.
+  bool (*supported)();
+  char* (*write)(double value, char* buffer) noexcept;
+  void (*to_decimal)(const double* values, long long* sigs, int16_t* exps,
+                     size_t n) noexcept;
+};
+
+// Defined if ZMIJ_ISA_VARIANTS is set by the build on x86-64.
+extern const zmij_isa zmij_avx2;
+extern const zmij_isa zmij_avx512;
+
+#endif  // ZMIJ_ISA_H_
@@ -0,0 +1,17 @@
+#define ZMIJ_HEADER_ONLY
+#define ZMIJ_USE_INT128 0
+#define ZMIJ_HEADER_NAMESPACE header_only_no_int128
+#include "zmij/zmij.h"
+
+#include "benchmark.h"
+
+// zmij with the portable emulation of 64x64->128-bit multiplication used on
+// platforms without __int128, e.g. 32-bit ARM. It should be compared with
+// zmij-header-only which is built the same way but with __int128.
+static register_method _(
+    "zmij-no-int128",
+    [](double x, char* buffer) noexcept {
+      return buffer + zmij::write<zmij::dialect<2, true, false>>(
+                          buffer, zmij::double_buffer_size, x);
+    },
+    {.notation = output_notation::scientific});
@@ -0,0 +1,26 @@
+#define ZMIJ_HEADER_ONLY
+#define ZMIJ_STATS 1
+#include "zmij/zmij.h"
+
+#include "benchmark.h"
+
+// zmij instrumented to count the code paths of conversions in the general
+// notation which also takes the integral fast path.
+static register_path_counter _(
+    "zmij",
+    [](double x, char* buffer) noexcept {
+      zmij::write(buffer, zmij::general_buffer_size, x,
+                  zmij::notation::general);
+    },
+    []() -> std::span<const path_count> {
+      static path_count counts[6];
+      zmij::stats& s = zmij::get_stats();
+      counts[0] = {"integral", s.integral};
+      counts[1] = {"fast", s.fast};
+      counts[2] = {"half-ulp-tie", s.half_ulp_tie};
+      counts[3] = {"near-boundary", s.near_boundary};
+      counts[4] = {"irregular", s.irregular};
+      counts[5] = {"subnormal", s.subnormal};
+      s = {};
+      return counts;
+    });
@@ -1,7 +1,258 @@
 #include "zmij/zmij.h"
+#include "zmij/parallel.h"
 
 #include "benchmark.h"
 
-static register_method _("zmij", [](double x, char* buffer) noexcept {
-  zmij::write(buffer, zmij::double_buffer_size, x);
+// The default output without the NUL which the benchmark doesn't need.
+using no_nul_dialect = zmij::dialect<2, true, false>;
+
+// zmij::write uses the scientific notation, e.g. 1e-01.
+constexpr auto scientific =
+    method_info{.notation = output_notation::scientific};
+
+static register_method _(
+    "zmij",
+    [](double x, char* buffer) noexcept {
+      return buffer +
+             zmij::write<no_nul_dialect>(buffer, zmij::double_buffer_size, x);
+    },
+    {.notation = output_notation::scientific,
+     .table_size = zmij::detail::pow10_table_size()});
+
+static register_footprint footprint(
+    "zmij", {"zmij::to_decimal(double)", "zmij::detail::write_decimal",
+             "zmij::detail::write_significand17",
+             "(anonymous namespace)::pow10_significands",
+             "(anonymous namespace)::exp_shifts"});
+
+static register_prefetch prefetch("zmij", zmij::prefetch_tables);
+
+// The default dialect which writes a NUL.
+static register_method nul_terminated(
+    "zmij-nul-terminated",
+    [](double x, char* buffer) noexcept {
+      zmij::write(buffer, zmij::double_buffer_size, x);
+    },
+    scientific);
+
+static register_method general("zmij-general", [](double x,
+                                                  char* buffer) noexcept {
+  return buffer + zmij::write(buffer, zmij::general_buffer_size, x,
+                              zmij::notation::general);
 });
+
+// Output dialects compile to separate writers and should be as fast as the
+// default.
+static register_method json(
+    "zmij-json",
+    [](double x, char* buffer) noexcept {
+      return buffer + zmij::write<zmij::json_dialect>(
+                          buffer, zmij::double_buffer_size, x);
+    },
+    scientific);
+
+static register_method python(
+    "zmij-python",
+    [](double x, char* buffer) noexcept {
+      return buffer + zmij::write<zmij::python_dialect>(
+                          buffer, zmij::double_buffer_size, x);
+    },
+    scientific);
+
+// Same as sprintf's %.17g.
+static register_method precision(
+    "zmij-%.17g",
+    [](double x, char* buffer) noexcept {
+      return buffer +
+             zmij::write_general(buffer, zmij::precision_buffer_size, x, 17);
+    },
+    {.shortest = false});
+
+static register_batch_method batch(
+    "zmij", [](std::span<const double> values, char* out) noexcept {
+      for (double x : values) {
+        size_t n = zmij::write(out + 1, zmij::double_buffer_size, x);
+        *out = char(n);
+        out += n + 1;
+      }
+      return out;
+    },
+    scientific);
+
+static register_parallel_method parallel(
+    "zmij",
+    [](std::span<const double> values, char* out, int num_threads) {
+      return zmij::write_parallel(out, values.data(), values.size(), '\n',
+                                  unsigned(num_threads));
+    },
+    scientific);
+
+static register_float_method float32(
+    "zmij",
+    [](float x, char* buffer) noexcept {
+      zmij::write(buffer, zmij::float_buffer_size, x);
+    },
+    scientific);
+
+// Columnar output as an array of dec_fp and as separate significand and
+// exponent arrays, both with a loop over the scalar to_decimal and with the
+// array overloads.
+static register_columnar_method aos_scalar(
+    "zmij-aos-scalar",
+    [](std::span<const double> values, char* out) noexcept {
+      auto decs = reinterpret_cast<zmij::dec_fp*>(out);
+      for (size_t i = 0; i < values.size(); ++i)
+        decs[i] = zmij::to_decimal(values[i]);
+      return values.size() * sizeof(zmij::dec_fp);
+    });
+
+static register_columnar_method aos(
+    "zmij-aos", [](std::span<const double> values, char* out) noexcept {
+      auto decs = reinterpret_cast<zmij::dec_fp*>(out);
+      zmij::to_decimal(values.data(), decs, values.size());
+      return values.size() * sizeof(zmij::dec_fp);
+    });
+
+static register_columnar_method soa_scalar(
+    "zmij-soa-scalar",
+    [](std::span<const double> values, char* out) noexcept {
+      auto sigs = reinterpret_cast<long long*>(out);
+      auto exps = reinterpret_cast<int16_t*>(sigs + values.size());
+      for (size_t i = 0; i < values.size(); ++i) {
+        zmij::dec_fp dec = zmij::to_decimal(values[i]);
+        sigs[i] = dec.sig;
+        exps[i] = int16_t(dec.exp);
+      }
+      return values.size() * (sizeof(long long) + sizeof(int16_t));
+    });
+
+static register_columnar_method soa(
+    "zmij-soa", [](std::span<const double> values, char* out) noexcept {
+      auto sigs = reinterpret_cast<long long*>(out);
+      auto exps = reinterpret_cast<int16_t*>(sigs + values.size());
+      zmij::to_decimal(values.data(), sigs, exps, values.size());
+      return values.size() * (sizeof(long long) + sizeof(int16_t));
+    });
+
+static register_float16_method float16(
+    "zmij", float16_format::binary16, [](uint16_t bits, char* buffer) noexcept {
+      zmij::write(buffer, zmij::float16_buffer_size, zmij::float16{bits});
+    });
+
+static register_float16_method bfloat16(
+    "zmij", float16_format::bfloat16, [](uint16_t bits, char* buffer) noexcept {
+      zmij::write(buffer, zmij::float16_buffer_size, zmij::bfloat16{bits});
+    });
+
+#if ZMIJ_HAS_FLOAT128
+static register_float128_method float128(
+    "zmij", [](__float128 x, char* buffer) noexcept {
+      zmij::write(buffer, zmij::float128_buffer_size, x);
+    });
+#endif
+
+static register_parse_method parse(
+    "zmij", [](const char* begin, const char* end) noexcept {
+      double result = 0;
+      zmij::from_chars(begin, end, result);
+      return result;
+    });
+
+static register_column_parse_method column_parse(
+    "zmij-column", [](std::string_view input, double* out) noexcept {
+      return zmij::parse_column(input.data(), input.data() + input.size(),
+                                '\n', out);
+    });
+
+static register_digits_method digits(
+    "zmij", [](uint64_t sig, char* buffer) noexcept {
+      char* end = zmij::detail::write_significand17(buffer, sig, true);
+      end[end == buffer] = '\0';
+    });
+
+static register_digits_method digits_portable(
+    "zmij-portable", [](uint64_t sig, char* buffer) noexcept {
+      char* end = zmij::detail::write_significand17(buffer, sig, true, true);
+      end[end == buffer] = '\0';
+    });
+
+static register_decimal_method decimal(
+    "zmij", [](double x) noexcept -> decimal_fp {
+      zmij::dec_fp dec = zmij::to_decimal(x);
+      return {uint64_t(dec.sig < 0 ? -dec.sig : dec.sig), dec.exp};
+    });
+
+static register_format_method format(
+    "zmij", [](decimal_fp dec, char* buffer) noexcept {
+      *zmij::detail::write_decimal(buffer, (long long)dec.sig, dec.exp) = '\0';
+    });
+
+static register_decimal64_method decimal64(
+    "zmij", [](uint64_t bits, char* buffer) noexcept {
+      buffer[zmij::write(buffer, zmij::double_buffer_size,
+                         zmij::decimal64{bits})] = '\0';
+    });
+
+// The BCD digit writer of the floating-point conversions applied to integers.
+static register_itoa_method itoa(
+    "zmij",
+    [](int32_t value, char* buffer) noexcept {
+      return zmij::write_integer(buffer, value);
+    },
+    [](int64_t value, char* buffer) noexcept {
+      return zmij::write_integer(buffer, value);
+    });
+
+static register_bounded_method bounded(
+    "zmij", [](double x, char* buffer, size_t n) noexcept {
+      return zmij::write(buffer, n, x);
+    });
+
+// The previous bounded write which always went through a temporary buffer.
+static register_bounded_method bounded_copy(
+    "zmij-copy", [](double x, char* buffer, size_t n) noexcept {
+      if (n >= zmij::double_buffer_size)
+        return size_t(zmij::detail::write(x, buffer) - buffer);
+      char temp[zmij::double_buffer_size] = {};
+      size_t size = size_t(zmij::detail::write(x, temp) - temp);
+      memcpy(buffer, temp, n);
+      return size;
+    });
+
+// UTF-16 output written directly and by widening the narrow output.
+static register_wide_method wide(
+    "zmij", [](double x, char16_t* buffer) noexcept {
+      return buffer + zmij::write(buffer, zmij::double_buffer_size, x);
+    });
+
+static register_wide_method wide_copy(
+    "zmij-widen", [](double x, char16_t* buffer) noexcept {
+      char narrow[zmij::double_buffer_size];
+      size_t size = zmij::write<no_nul_dialect>(narrow, sizeof(narrow), x);
+      return widen(narrow, narrow + size, buffer);
+    });
+
+// Prices share a decimal exponent so the decimal point can be placed once per
+// column. zmij-column detects the number of digits after the point and
+// zmij-column-2 is given it.
+static register_fixed_column_method column(
+    "zmij-column", [](std::span<const double> values, char* out) noexcept {
+      int scale = zmij::column_scale(values.data(), values.size());
+      return zmij::write_column(out, values.data(), values.size(), scale,
+                                '\n');
+    });
+
+static register_fixed_column_method column2(
+    "zmij-column-2", [](std::span<const double> values, char* out) noexcept {
+      return zmij::write_column(out, values.data(), values.size(), 2, '\n');
+    });
+
+// The shortest fixed notation of each value on its own.
+static register_fixed_column_method fixed_column(
+    "zmij-fixed", [](std::span<const double> values, char* out) noexcept {
+      for (double value : values) {
+        out = zmij::detail::write(value, out, zmij::notation::fixed);
+        *out++ = '\n';
+      }
+      return out;
+    });
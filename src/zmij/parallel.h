@@ -0,0 +1,98 @@
+// Parallel conversion of large arrays of doubles.
+// Copyright (c) 2025 - present, Victor Zverovich
+// Distributed under the MIT license (see LICENSE) or alternatively
+// the Boost Software License, Version 1.0.
+
+#ifndef ZMIJ_PARALLEL_H_
+#define ZMIJ_PARALLEL_H_
+
+#include <string.h>  // memcpy
+
+#include <algorithm>  // std::min
+#include <atomic>
+#include <memory>  // std::unique_ptr
+#include <thread>
+#include <vector>
+
+#include "zmij.h"
+
+namespace zmij {
+#ifdef ZMIJ_HEADER_ONLY
+inline namespace ZMIJ_HEADER_NAMESPACE {
+#endif
+
+enum {
+  // The number of values write_parallel converts as a unit. The output of a
+  // chunk, up to 400KB, stays in the cache until it is copied to the result.
+  parallel_chunk_size = 16384,
+};
+
+/// Writes the shortest correctly rounded decimal representations of `n`
+/// values, each followed by `separator`, to `out` using `num_threads` threads
+/// or one per logical CPU if it is 0, and returns a pointer past the end. The
+/// output is the same as that of a single-threaded loop over write. `out`
+/// should point to a buffer of size `n * double_buffer_size` or larger.
+///
+/// Threads claim chunks of parallel_chunk_size values in order from a shared
+/// counter, so faster threads take more of them, and convert each into a
+/// buffer of their own. The offset of a chunk in `out` is the end of the
+/// previous one, so a thread waits only for the conversion of that chunk,
+/// which was claimed just before, publishes the end of its chunk and copies
+/// it. Threads are started per call which pays off from about a million
+/// values.
+inline auto write_parallel(char* out, const double* values, size_t n,
+                           char separator, unsigned num_threads = 0) -> char* {
+  size_t num_chunks = (n + parallel_chunk_size - 1) / parallel_chunk_size;
+  if (num_threads == 0)
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  num_threads = unsigned(std::min<size_t>(num_threads, num_chunks));
+
+  // ends[i] is the offset of the end of chunk i - 1 in `out` once known.
+  constexpr size_t unknown = ~size_t(0);
+  std::unique_ptr<std::atomic<size_t>[]> ends(
+      new std::atomic<size_t>[num_chunks + 1]);
+  ends[0].store(0, std::memory_order_relaxed);
+  for (size_t i = 1; i <= num_chunks; ++i)
+    ends[i].store(unknown, std::memory_order_relaxed);
+  std::atomic<size_t> next_chunk = 0;
+
+  auto run = [&] {
+    std::unique_ptr<char[]> buffer(
+        new char[size_t(parallel_chunk_size) * double_buffer_size]);
+    for (;;) {
+      size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= num_chunks) break;
+      size_t begin = chunk * parallel_chunk_size;
+      size_t end = std::min(begin + parallel_chunk_size, n);
+      char* p = buffer.get();
+      for (size_t i = begin; i < end; ++i) {
+        // The terminating null, if any, is overwritten by the separator.
+        p += write(p, double_buffer_size, values[i]);
+        *p++ = separator;
+      }
+      size_t size = size_t(p - buffer.get());
+      size_t offset = 0;
+      while ((offset = ends[chunk].load(std::memory_order_acquire)) == unknown)
+        std::this_thread::yield();
+      ends[chunk + 1].store(offset + size, std::memory_order_release);
+      memcpy(out + offset, buffer.get(), size);
+    }
+  };
+  if (num_threads > 1) {
+    // The calling thread is one of the workers.
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < num_threads; ++i) threads.emplace_back(run);
+    run();
+    for (std::thread& t : threads) t.join();
+  } else {
+    run();
+  }
+  return out + ends[num_chunks].load(std::memory_order_relaxed);
+}
+
+#ifdef ZMIJ_HEADER_ONLY
+}  // namespace ZMIJ_HEADER_NAMESPACE
+#endif
+}  // namespace zmij
+
+#endif  // ZMIJ_PARALLEL_H_
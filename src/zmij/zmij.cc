@@ -12,21 +12,68 @@ struct dec_fp {
   long long sig;
   int exp;
 };
+enum class notation { scientific, fixed, general };
+enum { non_finite_exp = int(~0u >> 1), non_finite_exp16 = 0x7fff };
+enum { max_precision = 350 };
+struct float16 {
+  unsigned short bits;
+};
+struct bfloat16 {
+  unsigned short bits;
+};
+struct decimal64 {
+  unsigned long long bits;
+};
+struct from_chars_result {
+  const char* ptr;
+  bool ok;
+};
+template <int MinExpDigits = 2, bool ExpPlus = true, bool NulTerminated = true>
+struct dialect {
+  static constexpr int min_exp_digits = MinExpDigits;
+  static constexpr bool exp_plus = ExpPlus;
+  static constexpr bool nul_terminated = NulTerminated;
+};
+using default_dialect = dialect<>;
+using json_dialect = dialect<1, true, false>;
+using python_dialect = dialect<2, true, false>;
 }  // namespace zmij
 #endif
 
+#ifndef ZMIJ_HEADER_CONSTEXPR
+#  define ZMIJ_HEADER_CONSTEXPR
+#  define ZMIJ_HEADER_INLINE
+#endif
+#ifndef ZMIJ_HAS_FLOAT128
+#  define ZMIJ_HAS_FLOAT128 0
+#endif
+
 #include <assert.h>  // assert
+#include <float.h>   // FLT_EVAL_METHOD
 #include <stddef.h>  // size_t
 #include <stdint.h>  // uint64_t
 #include <string.h>  // memcpy
 
-#include <limits>       // std::numeric_limits
+#if __has_include(<bit>)
+#  include <bit>  // std::bit_cast, std::endian
+#endif
+#include <algorithm>    // std::min
+#include <cmath>        // std::signbit
+#include <limits>      // std::numeric_limits
 #include <type_traits>  // std::conditional_t
 
 #ifndef ZMIJ_USE_SIMD
 #  define ZMIJ_USE_SIMD 1
 #endif
 
+#ifndef ZMIJ_COMPACT_POW10
+#  define ZMIJ_COMPACT_POW10 0
+#endif
+
+#ifndef ZMIJ_STATS
+#  define ZMIJ_STATS 0
+#endif
+
 #ifdef _MSC_VER
 #  define ZMIJ_MSC_VER _MSC_VER
 #  include <intrin.h>  // __lzcnt64/_umul128/__umulh
@@ -63,6 +110,22 @@ struct dec_fp {
 #  define ZMIJ_USE_SSE4_1 0
 #endif
 
+#ifdef ZMIJ_USE_AVX2
+// Use the provided definition
+#elif defined(__AVX2__)
+#  define ZMIJ_USE_AVX2 ZMIJ_USE_SIMD
+#else
+#  define ZMIJ_USE_AVX2 0
+#endif
+
+#ifdef ZMIJ_USE_AVX512
+// Use the provided definition
+#elif defined(__AVX512F__)
+#  define ZMIJ_USE_AVX512 ZMIJ_USE_SIMD
+#else
+#  define ZMIJ_USE_AVX512 0
+#endif
+
 #if ZMIJ_USE_NEON
 #  include <arm_neon.h>
 #endif
@@ -72,6 +135,10 @@ struct dec_fp {
       "User asked for SSE4.1 but SSE is not available or explicitly not requested."
 #endif
 
+#if (ZMIJ_USE_AVX2 || ZMIJ_USE_AVX512) && !ZMIJ_USE_SSE
+#  error "User asked for AVX2 or AVX-512 but SSE is not available."
+#endif
+
 #if ZMIJ_USE_SSE
 #  include <immintrin.h>
 #endif
@@ -130,17 +197,30 @@ auto is_constant_evaluated() -> bool { return false; }
 #  define ZMIJ_CONSTEXPR
 #endif
 
-inline auto is_big_endian() noexcept -> bool {
+// Counts a conversion that took the code path `path` if ZMIJ_STATS is 1.
+#if ZMIJ_STATS
+#  define ZMIJ_COUNT(path) \
+    (is_constant_evaluated() ? void() : void(++zmij::get_stats().path))
+#else
+#  define ZMIJ_COUNT(path) void()
+#endif
+
+ZMIJ_CONSTEXPR inline auto is_big_endian() noexcept -> bool {
+#ifdef __cpp_lib_endian
+  return std::endian::native == std::endian::big;
+#else
   int n = 1;
   return *reinterpret_cast<char*>(&n) != 1;
+#endif
 }
 
-inline auto bswap64(uint64_t x) noexcept -> uint64_t {
+ZMIJ_CONSTEXPR inline auto bswap64(uint64_t x) noexcept -> uint64_t {
 #if ZMIJ_HAS_BUILTIN(__builtin_bswap64)
   return __builtin_bswap64(x);
-#elif ZMIJ_MSC_VER
-  return _byteswap_uint64(x);
 #else
+#  if ZMIJ_MSC_VER
+  if (!is_constant_evaluated()) return _byteswap_uint64(x);
+#  endif
   return ((x & 0xff00000000000000) >> 56) | ((x & 0x00ff000000000000) >> 40) |
          ((x & 0x0000ff0000000000) >> 24) | ((x & 0x000000ff00000000) >> +8) |
          ((x & 0x00000000ff000000) << +8) | ((x & 0x0000000000ff0000) << 24) |
@@ -148,24 +228,29 @@ inline auto bswap64(uint64_t x) noexcept -> uint64_t {
 #endif
 }
 
-inline auto clz(uint64_t x) noexcept -> int {
+ZMIJ_CONSTEXPR inline auto clz(uint64_t x) noexcept -> int {
   assert(x != 0);
 #if ZMIJ_HAS_BUILTIN(__builtin_clzll)
   return __builtin_clzll(x);
-#elif defined(__AVX2__) && defined(_M_AMD64)
-  // Use lzcnt only on AVX2-capable CPUs that have this BMI instruction.
-  return __lzcnt64(x);
-#elif defined(_M_AMD64) || defined(_M_ARM64)
-  unsigned long idx;
-  _BitScanReverse64(&idx, x);  // Fallback to the BSR instruction.
-  return 63 - idx;
-#elif ZMIJ_MSC_VER
-  // Fallback to the 32-bit BSR instruction.
-  unsigned long idx;
-  if (_BitScanReverse(&idx, uint32_t(x >> 32))) return 31 - idx;
-  _BitScanReverse(&idx, uint32_t(x));
-  return 63 - idx;
 #else
+#  if defined(__AVX2__) && defined(_M_AMD64)
+  // Use lzcnt only on AVX2-capable CPUs that have this BMI instruction.
+  if (!is_constant_evaluated()) return __lzcnt64(x);
+#  elif defined(_M_AMD64) || defined(_M_ARM64)
+  if (!is_constant_evaluated()) {
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);  // Fallback to the BSR instruction.
+    return 63 - idx;
+  }
+#  elif ZMIJ_MSC_VER
+  if (!is_constant_evaluated()) {
+    // Fallback to the 32-bit BSR instruction.
+    unsigned long idx;
+    if (_BitScanReverse(&idx, uint32_t(x >> 32))) return 31 - idx;
+    _BitScanReverse(&idx, uint32_t(x));
+    return 63 - idx;
+  }
+#  endif
   int n = 64;
   for (; x > 0; x >>= 1) --n;
   return n;
@@ -256,8 +341,8 @@ constexpr auto umul128_hi64(uint64_t x, uint64_t y) noexcept -> uint64_t {
   return uint64_t(umul128(x, y) >> 64);
 }
 
-inline auto umul192_hi128(uint64_t x_hi, uint64_t x_lo, uint64_t y) noexcept
-    -> uint128 {
+ZMIJ_CONSTEXPR inline auto umul192_hi128(uint64_t x_hi, uint64_t x_lo,
+                                         uint64_t y) noexcept -> uint128 {
   uint128_t p = umul128(x_hi, y);
   uint64_t lo = uint64_t(p) + uint64_t(umul128(x_lo, y) >> 64);
   return {uint64_t(p >> 64) + (lo < uint64_t(p)), lo};
@@ -265,13 +350,13 @@ inline auto umul192_hi128(uint64_t x_hi, uint64_t x_lo, uint64_t y) noexcept
 
 // Computes high 64 bits of multiplication of x and y, discards the least
 // significant bit and rounds to odd, where x = uint128_t(x_hi << 64) | x_lo.
-auto umulhi_inexact_to_odd(uint64_t x_hi, uint64_t x_lo, uint64_t y) noexcept
-    -> uint64_t {
+ZMIJ_CONSTEXPR auto umulhi_inexact_to_odd(uint64_t x_hi, uint64_t x_lo,
+                                      uint64_t y) noexcept -> uint64_t {
   uint128 p = umul192_hi128(x_hi, x_lo, y);
   return p.hi | ((p.lo >> 1) != 0);
 }
-auto umulhi_inexact_to_odd(uint64_t x_hi, uint64_t, uint32_t y) noexcept
-    -> uint32_t {
+ZMIJ_CONSTEXPR auto umulhi_inexact_to_odd(uint64_t x_hi, uint64_t,
+                                      uint32_t y) noexcept -> uint32_t {
   uint64_t p = uint64_t(umul128(x_hi, y) >> 32);
   return uint32_t(p >> 32) | ((uint32_t(p) >> 1) != 0);
 }
@@ -288,23 +373,73 @@ template <typename Float> struct float_traits : std::numeric_limits<Float> {
   using sig_type = std::conditional_t<num_bits == 64, uint64_t, uint32_t>;
   static constexpr sig_type implicit_bit = sig_type(1) << num_sig_bits;
 
-  static auto to_bits(Float value) noexcept -> sig_type {
+  static ZMIJ_CONSTEXPR auto to_bits(Float value) noexcept -> sig_type {
+#ifdef __cpp_lib_bit_cast
+    return std::bit_cast<sig_type>(value);
+#else
     uint64_t bits;
     memcpy(&bits, &value, sizeof(value));
     return bits;
+#endif
+  }
+
+  static constexpr auto is_negative(sig_type bits) noexcept -> bool {
+    return bits >> (num_bits - 1);
+  }
+  static constexpr auto get_sig(sig_type bits) noexcept -> sig_type {
+    return bits & (implicit_bit - 1);
+  }
+  static constexpr auto get_exp(sig_type bits) noexcept -> int64_t {
+    return int64_t(bits >> num_sig_bits) & exp_mask;
+  }
+};
+
+// Traits of a 16-bit format with `sig_bits` explicit significand bits that is
+// passed as bits. The significand is widened to 32 bits to reuse the float
+// conversion.
+template <int sig_bits, int min_exp10, int max_exp10> struct float16_traits {
+  static constexpr int num_bits = 16;
+  static constexpr int num_sig_bits = sig_bits;
+  static constexpr int num_exp_bits = num_bits - num_sig_bits - 1;
+  static constexpr int exp_mask = (1 << num_exp_bits) - 1;
+  static constexpr int exp_bias = (1 << (num_exp_bits - 1)) - 1;
+  static constexpr int min_exponent10 = min_exp10;
+  static constexpr int max_exponent10 = max_exp10;
+  static constexpr int max_digits10 = 2 + (num_sig_bits + 1) * 30103 / 100000;
+
+  using sig_type = uint32_t;
+  static constexpr sig_type implicit_bit = sig_type(1) << num_sig_bits;
+
+  template <typename Float>
+  static constexpr auto to_bits(Float value) noexcept -> sig_type {
+    return value.bits;
   }
 
-  static auto is_negative(sig_type bits) noexcept -> bool {
+  static constexpr auto is_negative(sig_type bits) noexcept -> bool {
     return bits >> (num_bits - 1);
   }
-  static auto get_sig(sig_type bits) noexcept -> sig_type {
+  static constexpr auto get_sig(sig_type bits) noexcept -> sig_type {
     return bits & (implicit_bit - 1);
   }
-  static auto get_exp(sig_type bits) noexcept -> int64_t {
+  static constexpr auto get_exp(sig_type bits) noexcept -> int64_t {
     return int64_t(bits >> num_sig_bits) & exp_mask;
   }
 };
 
+template <>
+struct float_traits<zmij::float16> : float16_traits<10, -4, 4> {};
+template <>
+struct float_traits<zmij::bfloat16> : float16_traits<7, -37, 38> {};
+
+// Values in a range are doubles with the exponent bounds of the range so that
+// e.g. the three-digit exponent path is pruned.
+template <int MinExp10, int MaxExp10, bool NonNegative>
+struct float_traits<zmij::range<MinExp10, MaxExp10, NonNegative>>
+    : float_traits<double> {
+  static constexpr int min_exponent10 = MinExp10;
+  static constexpr int max_exponent10 = MaxExp10;
+};
+
 // 128-bit significands of powers of 10 rounded down.
 // Generated using 192-bit arithmetic method by Dougall Johnson.
 struct pow10_significands_table {
@@ -315,10 +450,10 @@ struct pow10_significands_table {
 #endif
 
   static constexpr int num_pow10 = 617;
+  static constexpr int dec_exp_min = -292;
   uint64_t data[num_pow10 * 2] = {};
 
   ZMIJ_CONSTEXPR auto operator[](int dec_exp) const noexcept -> uint128 {
-    constexpr int dec_exp_min = -292;
     if (!split_tables) {
       int index = (dec_exp - dec_exp_min) * 2;
       return {data[index], data[index + 1]};
@@ -332,6 +467,15 @@ struct pow10_significands_table {
     return {hi[-dec_exp], lo[-dec_exp]};
   }
 
+  // Returns the same entry as operator[] but can be called in constant
+  // evaluation before C++20, e.g. to build smaller tables.
+  constexpr auto at(int dec_exp) const noexcept -> uint128 {
+    int i = dec_exp - dec_exp_min;
+    if (split_tables)
+      return {data[num_pow10 - i - 1], data[num_pow10 * 2 - i - 1]};
+    return {data[i * 2], data[i * 2 + 1]};
+  }
+
   constexpr pow10_significands_table() noexcept {
     struct uint192 {
       uint64_t w0, w1, w2;  // w0 = least significant, w2 = most significant
@@ -368,6 +512,106 @@ struct pow10_significands_table {
 };
 constexpr pow10_significands_table pow10_significands;
 
+// A compressed version of pow10_significands that stores every 27th entry and
+// recovers the rest by multiplying by a power of 5, similarly to Dragonbox's
+// compact cache. The result of the multiplication is up to 2 less than the
+// table entry so the difference is stored as a 2-bit correction to give
+// exactly the same values.
+struct compact_pow10_significands_table {
+  static constexpr int compression_ratio = 27;  // 5**26 fits in 64 bits.
+  static constexpr int num_pow10 = pow10_significands_table::num_pow10;
+  static constexpr int num_bases =
+      (num_pow10 + compression_ratio - 1) / compression_ratio;
+  static constexpr int dec_exp_min = -292;
+
+  uint64_t bases[num_bases * 2] = {};
+  uint64_t pow5[compression_ratio] = {};
+  uint64_t corrections[(num_pow10 * 2 + 63) / 64] = {};
+
+  // Returns floor(log2(10**dec_exp)).
+  static constexpr auto floor_log2_pow10(int dec_exp) noexcept -> int {
+    return dec_exp * 217'707 >> 16;
+  }
+
+  // Returns the significand without the correction.
+  ZMIJ_CONSTEXPR auto recover(int dec_exp) const noexcept -> uint128 {
+    unsigned index = unsigned(dec_exp - dec_exp_min);
+    unsigned base_index = index / compression_ratio;
+    int offset = int(index - base_index * compression_ratio);
+    uint64_t hi = bases[base_index * 2], lo = bases[base_index * 2 + 1];
+    if (offset == 0) return {hi, lo};
+
+    // Multiply the base significand by 5**offset and normalize the 192-bit
+    // product. The shift is in the range [2, 61].
+    int shift = floor_log2_pow10(dec_exp) -
+                floor_log2_pow10(dec_exp - offset) - offset;
+    uint128_t p_lo = umul128(lo, pow5[offset]);
+    uint128_t p_hi = umul128(hi, pow5[offset]);
+    uint64_t w0 = uint64_t(p_lo);
+    uint64_t w1 = uint64_t(p_lo >> 64) + uint64_t(p_hi);
+    uint64_t w2 = uint64_t(p_hi >> 64) + (w1 < uint64_t(p_hi));
+    return {(w2 << (64 - shift)) | (w1 >> shift),
+            (w1 << (64 - shift)) | (w0 >> shift)};
+  }
+
+  ZMIJ_CONSTEXPR auto operator[](int dec_exp) const noexcept -> uint128 {
+    unsigned index = unsigned(dec_exp - dec_exp_min);
+    uint128 result = recover(dec_exp);
+    uint64_t correction = (corrections[index / 32] >> (index % 32 * 2)) & 3;
+    result.lo += correction;
+    result.hi += result.lo < correction;
+    return result;
+  }
+
+  constexpr compact_pow10_significands_table() noexcept {
+    for (int i = 0; i < num_bases; ++i) {
+      uint128 base = pow10_significands[dec_exp_min + i * compression_ratio];
+      bases[i * 2] = base.hi;
+      bases[i * 2 + 1] = base.lo;
+    }
+    pow5[0] = 1;
+    for (int i = 1; i < compression_ratio; ++i) pow5[i] = pow5[i - 1] * 5;
+    for (int i = 0; i < num_pow10; ++i) {
+      uint64_t correction = pow10_significands[dec_exp_min + i].lo -
+                            recover(dec_exp_min + i).lo;
+      corrections[i / 32] |= correction << (i % 32 * 2);
+    }
+  }
+
+  // Returns true if all entries match pow10_significands.
+  constexpr auto verify() const noexcept -> bool {
+    for (int i = 0; i < num_pow10; ++i) {
+      uint128 expected = pow10_significands[dec_exp_min + i];
+      uint128 actual = (*this)[dec_exp_min + i];
+      if (actual.hi != expected.hi || actual.lo != expected.lo) return false;
+    }
+    return true;
+  }
+};
+
+#if ZMIJ_COMPACT_POW10
+constexpr compact_pow10_significands_table compact_pow10_significands;
+static_assert(compact_pow10_significands.verify(),
+              "compact pow10 table mismatch");
+#endif
+
+// Returns the 128-bit significand of 10**dec_exp rounded down.
+ZMIJ_CONSTEXPR ZMIJ_INLINE auto get_pow10_significand(int dec_exp) noexcept
+    -> uint128 {
+#if ZMIJ_COMPACT_POW10
+  return compact_pow10_significands[dec_exp];
+#else
+  return pow10_significands[dec_exp];
+#endif
+}
+
+// The powers of 10 used by to_decimal by default.
+struct pow10_source {
+  static ZMIJ_CONSTEXPR ZMIJ_INLINE auto get(int dec_exp) noexcept -> uint128 {
+    return get_pow10_significand(dec_exp);
+  }
+};
+
 // Computes the decimal exponent as floor(log10(2**bin_exp)) if regular or
 // floor(log10(3/4 * 2**bin_exp)) otherwise, without branching.
 constexpr auto compute_dec_exp(int bin_exp, bool regular) noexcept -> int {
@@ -380,6 +624,48 @@ constexpr auto compute_dec_exp(int bin_exp, bool regular) noexcept -> int {
   return (bin_exp * log10_2_sig - !regular * log10_3_over_4_sig) >> log10_2_exp;
 }
 
+// The entries of pow10_significands that to_decimal uses for values in Range,
+// e.g. 19 instead of 617 for range<-6, 8>, so that a writer specialized for
+// the range has a smaller cache footprint.
+template <typename Range> struct range_pow10_significands_table {
+  // Bounds of bin_exp in to_decimal for values in
+  // [10**min_exp10, 10**(max_exp10 + 1)). floor(log2(10**e)) is overestimated
+  // by at most one.
+  static constexpr int min_bin_exp = (Range::min_exp10 * 217'707 >> 16) - 53;
+  static constexpr int max_bin_exp =
+      ((Range::max_exp10 + 1) * 217'707 >> 16) - 52;
+  // The fast path computes the decimal exponent differently so the bounds are
+  // widened by one within the bounds of pow10_significands.
+  static constexpr int min_dec_exp =
+      std::max(-compute_dec_exp(max_bin_exp, true) - 1,
+               pow10_significands_table::dec_exp_min);
+  static constexpr int max_dec_exp =
+      std::min(-compute_dec_exp(min_bin_exp, false) + 1,
+               pow10_significands_table::dec_exp_min +
+                   pow10_significands_table::num_pow10 - 1);
+  static constexpr int num_pow10 = max_dec_exp - min_dec_exp + 1;
+  uint128 data[num_pow10] = {};
+
+  constexpr range_pow10_significands_table() noexcept {
+    for (int i = 0; i < num_pow10; ++i)
+      data[i] = pow10_significands.at(min_dec_exp + i);
+  }
+
+  ZMIJ_CONSTEXPR auto operator[](int dec_exp) const noexcept -> uint128 {
+    assert(dec_exp >= min_dec_exp && dec_exp <= max_dec_exp);
+    return data[dec_exp - min_dec_exp];
+  }
+};
+template <typename Range>
+constexpr range_pow10_significands_table<Range> range_pow10_significands;
+
+// The powers of 10 used by to_decimal for values in Range.
+template <typename Range> struct range_pow10_source {
+  static ZMIJ_CONSTEXPR ZMIJ_INLINE auto get(int dec_exp) noexcept -> uint128 {
+    return range_pow10_significands<Range>[dec_exp];
+  }
+};
+
 constexpr ZMIJ_INLINE auto do_compute_exp_shift(int bin_exp,
                                                 int dec_exp) noexcept
     -> unsigned char {
@@ -429,7 +715,7 @@ constexpr ZMIJ_INLINE auto compute_exp_shift(int bin_exp, int dec_exp) noexcept
   return do_compute_exp_shift(bin_exp, dec_exp);
 }
 
-inline auto count_trailing_nonzeros(uint64_t x) noexcept -> int {
+ZMIJ_CONSTEXPR inline auto count_trailing_nonzeros(uint64_t x) noexcept -> int {
   // We count the number of bytes until there are only zeros left.
   // The code is equivalent to
   //   return 8 - clz(x) / 8
@@ -446,18 +732,20 @@ inline auto count_trailing_nonzeros(uint64_t x) noexcept -> int {
   return (70 - clz((x << 1) | 1)) / 8;
 }
 
+// Align data since unaligned access may be slower when crossing a
+// hardware-specific boundary. It is at namespace scope because static
+// variables are not allowed in constexpr functions.
+alignas(2) constexpr char digits2_data[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
 // Converts value in the range [0, 100) to a string. GCC generates a bit better
 // code when value is pointer-size (https://www.godbolt.org/z/5fEPMT1cc).
-inline auto digits2(size_t value) noexcept -> const char* {
-  // Align data since unaligned access may be slower when crossing a
-  // hardware-specific boundary.
-  alignas(2) static const char data[] =
-      "0001020304050607080910111213141516171819"
-      "2021222324252627282930313233343536373839"
-      "4041424344454647484950515253545556575859"
-      "6061626364656667686970717273747576777879"
-      "8081828384858687888990919293949596979899";
-  return &data[value * 2];
+constexpr auto digits2(size_t value) noexcept -> const char* {
+  return &digits2_data[value * 2];
 }
 
 constexpr int div10k_exp = 40;
@@ -472,7 +760,7 @@ constexpr uint32_t neg10 = (1 << 8) - 10;
 
 constexpr uint64_t zeros = 0x0101010101010101u * '0';
 
-auto to_bcd8(uint64_t abcdefgh) noexcept -> uint64_t {
+ZMIJ_CONSTEXPR auto to_bcd8(uint64_t abcdefgh) noexcept -> uint64_t {
   // An optimization from Xiang JunBo.
   // Three steps BCD. Base 10000 -> base 100 -> base 10.
   // div and mod are evaluated simultaneously as, e.g.
@@ -491,20 +779,64 @@ auto to_bcd8(uint64_t abcdefgh) noexcept -> uint64_t {
   return is_big_endian() ? a_b_c_d_e_f_g_h : bswap64(a_b_c_d_e_f_g_h);
 }
 
-inline auto write_if(char* buffer, uint32_t digit, bool condition) noexcept
+constexpr auto write_if(char* buffer, uint32_t digit, bool condition) noexcept
     -> char* {
   *buffer = char('0' + digit);
   return buffer + condition;
 }
 
-inline void write8(char* buffer, uint64_t value) noexcept {
-  memcpy(buffer, &value, 8);
+// Copies `n` bytes from `src` to `dst`. Unlike memcpy it can be used in
+// constant evaluation.
+ZMIJ_CONSTEXPR inline void copy(char* dst, const char* src, size_t n) noexcept {
+  if (is_constant_evaluated()) {
+    for (size_t i = 0; i < n; ++i) dst[i] = src[i];
+    return;
+  }
+  memcpy(dst, src, n);
 }
 
-// Writes a significand consisting of up to 17 decimal digits (16-17 for
-// normals) and removes trailing zeros.
-auto write_significand17(char* buffer, uint64_t value,
-                         bool has17digits) noexcept -> char* {
+// Stores `value` to `buffer` in the native byte order. Unlike memcpy it can be
+// used in constant evaluation.
+template <typename UInt>
+ZMIJ_CONSTEXPR inline void store(char* buffer, UInt value) noexcept {
+  if (is_constant_evaluated()) {
+    for (size_t i = 0; i < sizeof(UInt); ++i) {
+      size_t shift = (is_big_endian() ? sizeof(UInt) - 1 - i : i) * 8;
+      buffer[i] = char(value >> shift);
+    }
+    return;
+  }
+  memcpy(buffer, &value, sizeof(UInt));
+}
+
+ZMIJ_CONSTEXPR inline void write8(char* buffer, uint64_t value) noexcept {
+  store(buffer, value);
+}
+
+// A portable version of write_significand17 using 64-bit SWAR.
+ZMIJ_CONSTEXPR auto write_significand17_portable(char* buffer, uint64_t value,
+                                  bool has17digits) noexcept -> char* {
+  char* start = buffer;
+  // Each digit is denoted by a letter so value is abbccddeeffgghhii.
+  uint32_t abbccddee = uint32_t(value / 100'000'000);
+  uint32_t ffgghhii = uint32_t(value % 100'000'000);
+  buffer = write_if(buffer, abbccddee / 100'000'000, has17digits);
+  uint64_t bcd = to_bcd8(abbccddee % 100'000'000);
+  write8(buffer, bcd | zeros);
+  if (ffgghhii == 0) {
+    buffer += count_trailing_nonzeros(bcd);
+    return buffer - int(buffer - start == 1);
+  }
+  bcd = to_bcd8(ffgghhii);
+  write8(buffer + 8, bcd | zeros);
+  return buffer + 8 + count_trailing_nonzeros(bcd);
+}
+
+#if ZMIJ_USE_NEON || ZMIJ_USE_SSE
+// A SIMD version of write_significand17.
+auto write_significand17_simd(char* buffer, uint64_t value,
+                              bool has17digits) noexcept -> char* {
+#endif
 #if ZMIJ_USE_NEON
   // An optimized version for NEON by Dougall Johnson.
   constexpr int32_t neg10k = -10000 + 0x10000;
@@ -635,40 +967,149 @@ auto write_significand17(char* buffer, uint64_t value,
 
   _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), digits);
   return buffer + len - int(len + (a != 0) == 1);
-#else  // !ZMIJ_USE_NEON && !ZMIJ_USE_SSE
+#endif  // ZMIJ_USE_SSE
+#if ZMIJ_USE_NEON || ZMIJ_USE_SSE
+}
+#endif
+
+// Writes a significand consisting of up to 17 decimal digits (16-17 for
+// normals) and removes trailing zeros. Constant evaluation uses the portable
+// version since intrinsics are not constexpr.
+ZMIJ_CONSTEXPR auto write_significand17(char* buffer, uint64_t value,
+                                        bool has17digits) noexcept -> char* {
+#if ZMIJ_USE_NEON || ZMIJ_USE_SSE
+  if (!is_constant_evaluated())
+    return write_significand17_simd(buffer, value, has17digits);
+#endif
+  return write_significand17_portable(buffer, value, has17digits);
+}
+
+// Writes a significand consisting of up to 9 decimal digits (7-9 for normals)
+// and removes trailing zeros.
+ZMIJ_CONSTEXPR auto write_significand9(char* buffer, uint32_t value,
+                                      bool has9digits) noexcept -> char* {
   char* start = buffer;
-  // Each digit is denoted by a letter so value is abbccddeeffgghhii.
+  buffer = write_if(buffer, value / 100'000'000, has9digits);
+  uint64_t bcd = to_bcd8(value % 100'000'000);
+  write8(buffer, bcd | zeros);
+  buffer += count_trailing_nonzeros(bcd);
+  return buffer - int(buffer - start == 1);
+}
+
+// Stores the 8 ASCII digits `digits`, in the memory order of write8, to
+// `buffer` widened to UTF-16 or UTF-32 code units of type Char.
+template <typename Char>
+ZMIJ_INLINE void write8_wide(Char* buffer, uint64_t digits) noexcept {
+  static_assert(sizeof(Char) == 2 || sizeof(Char) == 4, "unsupported Char");
+  unsigned char bytes[8];
+  memcpy(bytes, &digits, sizeof(digits));
+#if ZMIJ_USE_SSE
+  __m128i narrow = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes));
+  __m128i zero = _mm_setzero_si128();
+  __m128i wide = _mm_unpacklo_epi8(narrow, zero);
+  auto out = reinterpret_cast<__m128i*>(buffer);
+  if (sizeof(Char) == 2) {
+    _mm_storeu_si128(out, wide);
+  } else {
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(wide, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(wide, zero));
+  }
+#elif ZMIJ_USE_NEON
+  uint16x8_t wide = vmovl_u8(vld1_u8(bytes));
+  if (sizeof(Char) == 2) {
+    memcpy(buffer, &wide, sizeof(wide));
+  } else {
+    uint32x4_t lo = vmovl_u16(vget_low_u16(wide));
+    uint32x4_t hi = vmovl_u16(vget_high_u16(wide));
+    memcpy(buffer, &lo, sizeof(lo));
+    memcpy(buffer + 4, &hi, sizeof(hi));
+  }
+#else
+  for (int i = 0; i < 8; ++i) buffer[i] = Char(bytes[i]);
+#endif
+}
+
+// Same as write_significand17_portable but writes code units of type Char.
+// The digits are produced with SWAR in two groups of 8 which are widened with
+// SIMD instead of writing narrow digits and widening the whole output.
+template <typename Char>
+ZMIJ_INLINE auto write_significand17_wide(Char* buffer, uint64_t value,
+                                          bool has17digits) noexcept -> Char* {
+  Char* start = buffer;
   uint32_t abbccddee = uint32_t(value / 100'000'000);
   uint32_t ffgghhii = uint32_t(value % 100'000'000);
-  buffer = write_if(buffer, abbccddee / 100'000'000, has17digits);
+  *buffer = Char('0' + abbccddee / 100'000'000);
+  buffer += has17digits;
   uint64_t bcd = to_bcd8(abbccddee % 100'000'000);
-  write8(buffer, bcd | zeros);
+  write8_wide(buffer, bcd | zeros);
   if (ffgghhii == 0) {
     buffer += count_trailing_nonzeros(bcd);
     return buffer - int(buffer - start == 1);
   }
   bcd = to_bcd8(ffgghhii);
-  write8(buffer + 8, bcd | zeros);
+  write8_wide(buffer + 8, bcd | zeros);
   return buffer + 8 + count_trailing_nonzeros(bcd);
-#endif
 }
 
-// Writes a significand consisting of up to 9 decimal digits (7-9 for normals)
-// and removes trailing zeros.
-auto write_significand9(char* buffer, uint32_t value, bool has9digits) noexcept
+// Shifts the digits of the BCD `bcd` from to_bcd8 `n` positions towards the
+// start of the buffer.
+ZMIJ_CONSTEXPR inline auto shift_digits(uint64_t bcd, int n) noexcept
+    -> uint64_t {
+  return is_big_endian() ? bcd << (n * 8) : bcd >> (n * 8);
+}
+
+// Returns the number of leading zero digits of the nonzero BCD `bcd`.
+ZMIJ_CONSTEXPR inline auto count_leading_zero_digits(uint64_t bcd) noexcept
+    -> int {
+  return clz(is_big_endian() ? bcd : bswap64(bcd)) / 8;
+}
+
+// Writes an integer in [1, 1e16) without leading zeros and returns a pointer
+// past the last digit. Up to 16 bytes are written.
+ZMIJ_CONSTEXPR auto write_integer16(char* buffer, uint64_t value) noexcept
     -> char* {
-  char* start = buffer;
-  buffer = write_if(buffer, value / 100'000'000, has9digits);
-  uint64_t bcd = to_bcd8(value % 100'000'000);
-  write8(buffer, bcd | zeros);
-  buffer += count_trailing_nonzeros(bcd);
-  return buffer - int(buffer - start == 1);
+  uint64_t hi = value / 100'000'000;
+  uint64_t lo_bcd = to_bcd8(value % 100'000'000);
+  if (hi == 0) {
+    int n = count_leading_zero_digits(lo_bcd);
+    write8(buffer, shift_digits(lo_bcd | zeros, n));
+    return buffer + 8 - n;
+  }
+  uint64_t hi_bcd = to_bcd8(hi);
+  int n = count_leading_zero_digits(hi_bcd);
+  write8(buffer, shift_digits(hi_bcd | zeros, n));
+  buffer += 8 - n;
+  write8(buffer, lo_bcd | zeros);
+  return buffer + 8;
+}
+
+// Writes an integer without leading zeros and returns a pointer past the last
+// digit. Up to 20 bytes are written.
+ZMIJ_CONSTEXPR auto write_integer20(char* buffer, uint64_t value) noexcept
+    -> char* {
+  constexpr uint64_t e16 = 10'000'000'000'000'000;
+  if (value < e16) {
+    if (value != 0) return write_integer16(buffer, value);
+    *buffer = '0';
+    return buffer + 1;
+  }
+  // The high part has at most 4 digits since 2**64 < 1.9e19.
+  uint64_t hi_bcd = to_bcd8(value / e16);
+  uint64_t lo = value % e16;
+  int n = count_leading_zero_digits(hi_bcd);
+  write8(buffer, shift_digits(hi_bcd | zeros, n));
+  buffer += 8 - n;
+  write8(buffer, to_bcd8(lo / 100'000'000) | zeros);
+  write8(buffer + 8, to_bcd8(lo % 100'000'000) | zeros);
+  return buffer + 16;
 }
 
 template <int num_bits>
-auto normalize(zmij::dec_fp dec, bool subnormal) noexcept -> zmij::dec_fp {
+constexpr auto normalize(zmij::dec_fp dec, bool subnormal) noexcept
+    -> zmij::dec_fp {
   if (!subnormal) [[ZMIJ_LIKELY]]
     return dec;
+  ZMIJ_COUNT(subnormal);
   while (dec.sig < (num_bits == 64 ? uint64_t(1e16) : uint64_t(1e8))) {
     dec.sig *= 10;
     --dec.exp;
@@ -677,10 +1118,13 @@ auto normalize(zmij::dec_fp dec, bool subnormal) noexcept -> zmij::dec_fp {
 }
 
 // Converts a binary FP number bin_sig * 2**bin_exp to the shortest decimal
-// representation, where bin_exp = raw_exp - num_sig_bits - exp_bias.
-template <typename Float, typename UInt>
-ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
-                            bool subnormal) noexcept -> zmij::dec_fp {
+// representation, where bin_exp = raw_exp - num_sig_bits - exp_bias, using the
+// powers of 10 from Pow10.
+template <typename Float, typename Pow10 = pow10_source, typename UInt>
+ZMIJ_CONSTEXPR ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp,
+                                           bool regular,
+                                           bool subnormal) noexcept
+    -> zmij::dec_fp {
   using traits = float_traits<Float>;
   int64_t bin_exp = raw_exp - traits::num_sig_bits - traits::exp_bias;
   constexpr int num_bits = std::numeric_limits<UInt>::digits;
@@ -690,7 +1134,7 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
                                    : compute_dec_exp(bin_exp, true);
     unsigned char exp_shift =
         compute_exp_shift<num_bits, true>(bin_exp, dec_exp);
-    uint128 pow10 = pow10_significands[-dec_exp];
+    uint128 pow10 = Pow10::get(-dec_exp);
 
     UInt integral = 0;        // integral part of bin_sig * pow10
     uint64_t fractional = 0;  // fractional part of bin_sig * pow10
@@ -706,8 +1150,10 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
     constexpr uint64_t half_ulp = uint64_t(1) << 63;
 
     // Exact half-ulp tie when rounding to nearest integer.
-    if (fractional == half_ulp) [[ZMIJ_UNLIKELY]]
+    if (fractional == half_ulp) [[ZMIJ_UNLIKELY]] {
+      ZMIJ_COUNT(half_ulp_tie);
       break;
+    }
 
     uint64_t digit;
     if (ZMIJ_USE_INT128) {
@@ -716,7 +1162,7 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
       constexpr uint64_t div10_sig = (1ull << 63) / 5 + 1;
       digit = integral - umul128_hi64(integral, div10_sig) * 10;
       // or it narrows to 32-bit and doesn't use madd/msub
-      ZMIJ_ASM(("" : "+r"(digit)));
+      if (!is_constant_evaluated()) ZMIJ_ASM(("" : "+r"(digit)));
     } else {
       digit = integral % 10;
     }
@@ -762,6 +1208,7 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
         // Case where upper == ten is insufficient: 1.342178e+08f.
         ten - upper <= 1u)  // upper == ten || upper == ten - 1
         [[ZMIJ_UNLIKELY]] {
+      ZMIJ_COUNT(near_boundary);
       break;
     }
 
@@ -769,13 +1216,15 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
     int64_t shorter = int64_t(integral - digit + round_up * 10);
     int64_t longer = int64_t(integral + (fractional >= half_ulp));
     bool use_shorter = (scaled_sig_mod10 <= scaled_half_ulp) + round_up != 0;
+    ZMIJ_COUNT(fast);
     return {use_shorter ? shorter : longer, dec_exp};
   }
+  if (!regular) ZMIJ_COUNT(irregular);
   bin_exp += subnormal;
 
   int dec_exp = compute_dec_exp(bin_exp, regular);
   unsigned char exp_shift = compute_exp_shift<num_bits>(bin_exp, dec_exp);
-  uint128 pow10 = pow10_significands[-dec_exp];
+  uint128 pow10 = Pow10::get(-dec_exp);
 
   // Fallback to Schubfach to guarantee correctness in boundary cases.
   // This requires switching to strict overestimates of powers of 10.
@@ -814,104 +1263,2108 @@ ZMIJ_INLINE auto to_decimal(UInt bin_sig, int64_t raw_exp, bool regular,
   return normalize<num_bits>({int64_t(dec_sig), dec_exp}, subnormal);
 }
 
-}  // namespace
 
-namespace zmij {
+// Powers of 10 that fit in uint64_t.
+constexpr uint64_t pow10_u64[] = {1,
+                                  10,
+                                  100,
+                                  1000,
+                                  10000,
+                                  100000,
+                                  1000000,
+                                  10000000,
+                                  100000000,
+                                  1000000000,
+                                  10000000000,
+                                  100000000000,
+                                  1000000000000,
+                                  10000000000000,
+                                  100000000000000,
+                                  1000000000000000,
+                                  10000000000000000,
+                                  100000000000000000,
+                                  1000000000000000000,
+                                  10000000000000000000u};
+
+inline auto count_digits(uint64_t x) noexcept -> int {
+  int n = 1;
+  while (n < 20 && x >= pow10_u64[n]) ++n;
+  return n;
+}
 
-inline auto to_decimal(double value) noexcept -> dec_fp {
-  using traits = float_traits<double>;
-  auto bits = traits::to_bits(value);
-  auto bin_exp = traits::get_exp(bits);  // binary exponent
-  auto bin_sig = traits::get_sig(bits);  // binary significand
-  bool special = ((bin_exp + 1) & traits::exp_mask) <= 1;
-  bool regular = (bin_sig != 0) | special;
-  if (special) [[ZMIJ_UNLIKELY]] {
-    if (bin_exp != 0) return {0, int(~0u >> 1)};
-    if (bin_sig == 0) return {0, 0};
-    bin_sig |= traits::implicit_bit;
+// Writes the decimal digits of x to buffer and returns a pointer past them.
+inline auto write_uint(char* buffer, uint64_t x) noexcept -> char* {
+  char* end = buffer + count_digits(x);
+  char* p = end;
+  while (x >= 100) {
+    p -= 2;
+    memcpy(p, digits2(x % 100), 2);
+    x /= 100;
   }
-  bin_sig ^= traits::implicit_bit;
-  auto dec = ::to_decimal<double>(bin_sig, bin_exp, regular, special);
-  return {traits::is_negative(bits) ? -dec.sig : dec.sig, dec.exp};
+  if (x >= 10) {
+    p -= 2;
+    memcpy(p, digits2(x), 2);
+  } else {
+    *--p = char('0' + x);
+  }
+  return end;
 }
 
-namespace detail {
+// An unsigned big integer with a fixed capacity in 32-bit limbs.
+template <int capacity> class basic_bigint {
+ private:
+  uint32_t limbs_[capacity];
+  int size_ = 0;
 
-// It is slightly faster to return a pointer to the end than the size.
-template <typename Float>
-auto write(Float value, char* buffer) noexcept -> char* {
-  using traits = float_traits<Float>;
-  auto bits = traits::to_bits(value);
-  // It is beneficial to extract exponent and significand early.
-  auto bin_exp = traits::get_exp(bits);  // binary exponent
-  auto bin_sig = traits::get_sig(bits);  // binary significand
+ public:
+  explicit basic_bigint(uint64_t value) noexcept {
+    for (; value != 0; value >>= 32) limbs_[size_++] = uint32_t(value);
+  }
 
-  *buffer = '-';
-  buffer += traits::is_negative(bits);
+  // Only the used limbs are copied since the capacity can be large.
+  basic_bigint(const basic_bigint& other) noexcept : size_(other.size_) {
+    memcpy(limbs_, other.limbs_, sizeof(uint32_t) * size_t(size_));
+  }
+  void operator=(const basic_bigint&) = delete;
+
+  void add(const basic_bigint& other) noexcept {
+    uint64_t carry = 0;
+    int size = size_ > other.size_ ? size_ : other.size_;
+    for (int i = 0; i < size; ++i) {
+      uint64_t sum = carry + (i < size_ ? limbs_[i] : 0) +
+                     (i < other.size_ ? other.limbs_[i] : 0);
+      limbs_[i] = uint32_t(sum);
+      carry = sum >> 32;
+    }
+    size_ = size;
+    if (carry != 0) {
+      assert(size_ < capacity);
+      limbs_[size_++] = uint32_t(carry);
+    }
+  }
 
-  bool regular = bin_sig != 0;
-  bool subnormal = bin_exp == 0;
-  if (bin_exp == 0 || bin_exp == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
-    if (bin_exp != 0) {
-      memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
-      return buffer + 3;
+  void multiply(uint32_t x) noexcept {
+    uint64_t carry = 0;
+    for (int i = 0; i < size_; ++i) {
+      uint64_t p = uint64_t(limbs_[i]) * x + carry;
+      limbs_[i] = uint32_t(p);
+      carry = p >> 32;
     }
-    if (bin_sig == 0) {
-      memcpy(buffer, "0", 2);
-      return buffer + 1;
+    if (carry != 0) {
+      assert(size_ < capacity);
+      limbs_[size_++] = uint32_t(carry);
     }
-    bin_sig |= traits::implicit_bit;
   }
-  bin_sig ^= traits::implicit_bit;
 
-  // Here be 🐉s.
-  auto dec = ::to_decimal<Float>(bin_sig, bin_exp, regular, subnormal);
-  int dec_exp = dec.exp;
+  void multiply_pow10(int n) noexcept {
+    for (; n >= 9; n -= 9) multiply(uint32_t(pow10_u64[9]));
+    if (n > 0) multiply(uint32_t(pow10_u64[n]));
+  }
 
-  // Write significand.
-  char* start = buffer;
-  if (traits::num_bits == 64) {
-    bool has17digits = dec.sig >= uint64_t(1e16);
-    dec_exp += traits::max_digits10 - 2 + has17digits;
-    buffer = write_significand17(buffer + 1, dec.sig, has17digits);
-  } else {
-    if (dec.sig < uint32_t(1e7)) [[ZMIJ_UNLIKELY]] {
-      dec.sig *= 10;
-      --dec_exp;
+  void multiply_pow5(int n) noexcept {
+    // Multiply by the largest powers of 5 that fit in a multiplier.
+#if ZMIJ_HAS_FLOAT128
+    constexpr int max_exp = 27;
+#else
+    constexpr int max_exp = 13;
+#endif
+    auto pow5 = [](int exp) constexpr {
+      uint64_t result = 1;
+      for (int i = 0; i < exp; ++i) result *= 5;
+      return result;
+    };
+    constexpr uint64_t max_pow5 = pow5(max_exp);
+    for (; n > 0; n -= max_exp) {
+      uint64_t x = n >= max_exp ? max_pow5 : pow5(n);
+#if ZMIJ_HAS_FLOAT128
+      multiply64(x);
+#else
+      multiply(uint32_t(x));
+#endif
     }
-    bool has9digits = dec.sig >= uint32_t(1e8);
-    dec_exp += traits::max_digits10 - 2 + has9digits;
-    buffer = write_significand9(buffer + 1, dec.sig, has9digits);
   }
-  start[0] = start[1];
-  start[1] = '.';
 
-  // Write exponent.
-  uint16_t e_sign = dec_exp >= 0 ? ('+' << 8 | 'e') : ('-' << 8 | 'e');
-  if (is_big_endian()) e_sign = e_sign << 8 | e_sign >> 8;
-  memcpy(buffer, &e_sign, 2);
-  buffer += 2;
-  dec_exp = dec_exp >= 0 ? dec_exp : -dec_exp;
-  if (traits::min_exponent10 >= -99 && traits::max_exponent10 <= 99) {
-    memcpy(buffer, digits2(dec_exp), 2);
-    buffer[2] = '\0';
-    return buffer + 2;
+  void shift_left(int n) noexcept {
+    if (size_ == 0) return;
+    int limb_shift = n / 32, bit_shift = n % 32;
+    assert(size_ + limb_shift < capacity);
+    limbs_[size_] = 0;
+    for (int i = size_; i >= 0; --i) {
+      uint64_t x = uint64_t(limbs_[i]) << bit_shift;
+      if (i > 0) x |= uint64_t(limbs_[i - 1]) << bit_shift >> 32;
+      limbs_[i + limb_shift] = i + limb_shift < capacity ? uint32_t(x) : 0;
+    }
+    for (int i = 0; i < limb_shift; ++i) limbs_[i] = 0;
+    size_ += limb_shift + 1;
+    while (size_ > 0 && limbs_[size_ - 1] == 0) --size_;
   }
 
-  // digit = dec_exp / 100
-  uint32_t digit = use_umul128_hi64
-                       ? umul128_hi64(dec_exp, 0x290000000000000)
-                       : (uint32_t(dec_exp) * div100_sig) >> div100_exp;
-  uint32_t digit_with_nuls = '0' + digit;
-  if (is_big_endian()) digit_with_nuls <<= 24;
-  memcpy(buffer, &digit_with_nuls, 4);
-  buffer += dec_exp >= 100;
-  memcpy(buffer, digits2(dec_exp - digit * 100), 2);
-  return buffer + 2;
-}
+#if ZMIJ_HAS_FLOAT128
+  void multiply64(uint64_t x) noexcept {
+    if (x == 0) {
+      size_ = 0;
+      return;
+    }
+    // Process pairs of limbs to halve the number of multiplications.
+    uint64_t carry = 0;
+    int i = 0;
+    for (; i + 1 < size_; i += 2) {
+      uint64_t pair = limbs_[i] | uint64_t(limbs_[i + 1]) << 32;
+      unsigned __int128 p = (unsigned __int128)pair * x + carry;
+      limbs_[i] = uint32_t(p);
+      limbs_[i + 1] = uint32_t(uint64_t(p) >> 32);
+      carry = uint64_t(p >> 64);
+    }
+    if (i < size_) {
+      unsigned __int128 p = (unsigned __int128)limbs_[i] * x + carry;
+      limbs_[i] = uint32_t(p);
+      carry = uint64_t(p >> 32);
+    }
+    for (; carry != 0; carry >>= 32) {
+      assert(size_ < capacity);
+      limbs_[size_++] = uint32_t(carry);
+    }
+  }
+
+  // Returns the shift that gives at least two limbs with the most significant
+  // bit of the top one set as required by divide.
+  auto normalizing_shift() const noexcept -> int {
+    return clz(limbs_[size_ - 1]) - 32 + (size_ == 1 ? 32 : 0);
+  }
+
+  // Divides *this by a normalized `divisor` leaving the remainder in *this and
+  // returns the quotient which must be less than 2**128 (Knuth's algorithm D).
+  auto divide(const basic_bigint& divisor) noexcept -> unsigned __int128 {
+    int n = divisor.size_;
+    if (size_ < n) return 0;
+    uint64_t divisor_top =
+        uint64_t(divisor.limbs_[n - 1]) << 32 | divisor.limbs_[n - 2];
+    unsigned __int128 quotient = 0;
+    assert(size_ < capacity);
+    limbs_[size_] = 0;
+    for (int j = size_ - n; j >= 0; --j) {
+      // Estimate the quotient digit from the top limbs. It can be too large by
+      // at most 2 which is corrected by adding back.
+      unsigned __int128 top = (unsigned __int128)limbs_[j + n] << 64 |
+                              uint64_t(limbs_[j + n - 1]) << 32 |
+                              limbs_[j + n - 2];
+      unsigned __int128 estimate = top / divisor_top;
+      uint32_t digit = estimate > ~0u ? ~0u : uint32_t(estimate);
+      uint64_t carry = 0;
+      int64_t borrow = 0;
+      for (int i = 0; i < n; ++i) {
+        uint64_t p = uint64_t(digit) * divisor.limbs_[i] + carry;
+        carry = p >> 32;
+        int64_t d = int64_t(limbs_[i + j]) - int64_t(uint32_t(p)) - borrow;
+        limbs_[i + j] = uint32_t(d);
+        borrow = d < 0;
+      }
+      int64_t high = int64_t(limbs_[j + n]) - int64_t(carry) - borrow;
+      while (high < 0) {
+        --digit;
+        carry = 0;
+        for (int i = 0; i < n; ++i) {
+          uint64_t sum = uint64_t(limbs_[i + j]) + divisor.limbs_[i] + carry;
+          limbs_[i + j] = uint32_t(sum);
+          carry = sum >> 32;
+        }
+        high += int64_t(carry);
+      }
+      limbs_[j + n] = uint32_t(high);
+      quotient = quotient << 32 | digit;
+    }
+    size_ = n;
+    while (size_ > 0 && limbs_[size_ - 1] == 0) --size_;
+    return quotient;
+  }
+
+  auto is_zero() const noexcept -> bool { return size_ == 0; }
+#endif  // ZMIJ_HAS_FLOAT128
+
+  // Subtracts `other` which must not be greater than *this.
+  void subtract(const basic_bigint& other) noexcept {
+    int64_t borrow = 0;
+    for (int i = 0; i < size_; ++i) {
+      int64_t d = int64_t(limbs_[i]) - borrow -
+                  (i < other.size_ ? int64_t(other.limbs_[i]) : 0);
+      borrow = d < 0;
+      limbs_[i] = uint32_t(d);
+    }
+    while (size_ > 0 && limbs_[size_ - 1] == 0) --size_;
+  }
+
+  friend auto compare(const basic_bigint& lhs,
+                      const basic_bigint& rhs) noexcept -> int {
+    if (lhs.size_ != rhs.size_) return lhs.size_ < rhs.size_ ? -1 : 1;
+    for (int i = lhs.size_ - 1; i >= 0; --i) {
+      if (lhs.limbs_[i] != rhs.limbs_[i])
+        return lhs.limbs_[i] < rhs.limbs_[i] ? -1 : 1;
+    }
+    return 0;
+  }
+};
+
+// The number of limbs of big integers in the exact fallback of
+// fixed-precision conversion. round_exact scales a significand of at most 54
+// bits, or of 1024 bits with no fractional part, by 10**-pos and generates
+// digits against a denominator of the same magnitude. -pos is at most
+// 324 + max_precision for a subnormal in the exponential format and
+// max_precision in the fixed format, so with the doubling and the extra digit
+// of the digit loop all values are below 2**58 * 10**(324 + max_precision),
+// about 2300 bits. shift_left needs one spare limb.
+constexpr int bigint_capacity = 80;
+static_assert((58 + (324 + zmij::max_precision) * 3322 / 1000 + 1) / 32 + 2 <=
+                  bigint_capacity,
+              "bigint_capacity is too small for max_precision");
+
+using bigint = basic_bigint<bigint_capacity>;
+
+// Decimal digits [data, data + size) multiplied by 10**exp, i.e. exp is the
+// position of the last digit. size is 0 if the value rounds to zero.
+struct rounded_decimal {
+  int size;
+  int exp;
+};
+
+// Rounds bin_sig * 2**bin_exp correctly with ties to even at the decimal
+// position get_pos(e), where e is the position of the first significant digit,
+// using big integers. Writes the digits to `digits`.
+template <typename F>
+auto round_exact(uint64_t bin_sig, int bin_exp, F get_pos,
+                 char* digits) noexcept -> rounded_decimal {
+  bigint num(bin_sig), den(1);
+  if (bin_exp >= 0)
+    num.shift_left(bin_exp);
+  else
+    den.shift_left(-bin_exp);
+
+  // 10**e <= value < 10**(e + 1) where e is either the estimate or one more.
+  int e = compute_dec_exp(bin_exp + 63 - clz(bin_sig), true);
+  {
+    bigint n = num, d = den;
+    if (e + 1 >= 0)
+      d.multiply_pow10(e + 1);
+    else
+      n.multiply_pow10(-e - 1);
+    if (compare(n, d) >= 0) ++e;
+  }
+
+  // value / 10**pos = num / den
+  int pos = get_pos(e);
+  if (pos >= 0)
+    den.multiply_pow10(pos);
+  else
+    num.multiply_pow10(-pos);
+
+  int num_digits = e - pos + 1;
+  if (num_digits <= 0) {
+    // value < 10**pos: round to either 0 or 10**pos.
+    num.shift_left(1);
+    if (compare(num, den) <= 0) return {0, pos};
+    digits[0] = '1';
+    return {1, pos};
+  }
+
+  // Generate digits of num / (den * 10**(num_digits - 1)) which is in [1, 10).
+  den.multiply_pow10(num_digits - 1);
+  for (int i = 0; i < num_digits; ++i) {
+    if (i != 0) num.multiply(10);
+    char digit = '0';
+    while (compare(num, den) >= 0) {
+      num.subtract(den);
+      ++digit;
+    }
+    digits[i] = digit;
+  }
+  num.shift_left(1);
+  int cmp = compare(num, den);
+  if (cmp < 0 || (cmp == 0 && (digits[num_digits - 1] - '0') % 2 == 0))
+    return {num_digits, pos};
+  int i = num_digits - 1;
+  for (; i >= 0 && digits[i] == '9'; --i) digits[i] = '0';
+  if (i >= 0) {
+    ++digits[i];
+    return {num_digits, pos};
+  }
+  digits[0] = '1';
+  digits[num_digits] = '0';
+  return {num_digits + 1, pos};
+}
+
+// Rounds a positive finite value at the decimal position get_pos(e), where e
+// is the position of the first significant digit. Uses the 128-bit powers of
+// 10 from to_decimal when the result has at most 18 digits and the remainder
+// is not too close to a half, and big integers otherwise.
+template <typename F>
+auto round_decimal(uint64_t bits, F get_pos, char* digits) noexcept
+    -> rounded_decimal {
+  using traits = float_traits<double>;
+  int raw_exp = int(traits::get_exp(bits));
+  uint64_t bin_sig = traits::get_sig(bits);
+  if (raw_exp != 0)
+    bin_sig |= traits::implicit_bit;
+  else
+    ++raw_exp;
+  int bin_exp = raw_exp - traits::num_sig_bits - traits::exp_bias;
+
+  // integral.fractional = bin_sig * 2**bin_exp / 10**dec_exp.
+  int dec_exp = compute_dec_exp(bin_exp, true);
+  unsigned char exp_shift = do_compute_exp_shift(bin_exp, dec_exp);
+  uint128 pow10 = get_pow10_significand(-dec_exp);
+  uint128 p = umul192_hi128(pow10.hi, pow10.lo, bin_sig << exp_shift);
+  uint64_t integral = p.hi, fractional = p.lo;
+  if (integral == 0) return round_exact(bin_sig, bin_exp, get_pos, digits);
+  int pos = get_pos(dec_exp + count_digits(integral) - 1);
+
+  // The number of integral digits to drop.
+  int shift = pos - dec_exp;
+  if (shift >= 18) return {0, pos};  // The value is < 0.1 * 10**pos.
+  if (shift == -1) {
+    uint128_t p10 = umul128(fractional, 10);
+    integral = integral * 10 + uint64_t(p10 >> 64);
+    fractional = uint64_t(p10);
+    shift = 0;
+  }
+  if (shift < 0) return round_exact(bin_sig, bin_exp, get_pos, digits);
+
+  // Compare the remainder (rem + fractional / 2**64) / 10**shift with 1/2 as
+  // 2 * (rem * 2**64 + fractional) with 10**shift * 2**64. The product is an
+  // underestimate by a few units of the fractional part so fall back if the
+  // remainder is too close to a half.
+  uint64_t divisor = pow10_u64[shift];
+  uint64_t quotient = integral / divisor, rem = integral % divisor;
+  uint64_t rem2 = (rem << 1) | (fractional >> 63), frac2 = fractional << 1;
+  constexpr uint64_t margin = 256;
+  if ((rem2 == divisor && frac2 <= margin) ||
+      (rem2 == divisor - 1 && frac2 >= ~uint64_t(0) - margin)) {
+    return round_exact(bin_sig, bin_exp, get_pos, digits);
+  }
+  quotient += rem2 >= divisor;
+  if (quotient == 0) return {0, pos};
+  return {int(write_uint(digits, quotient) - digits), pos};
+}
+
+enum class precision_format { fixed, exp, general };
+
+// The maximum number of significant digits of a double is 309 and the maximum
+// precision is max_precision.
+constexpr int max_rounded_digits = 309 + zmij::max_precision + 2;
+
+// Writes `value` with `precision` like printf's %f, %e and %g.
+auto write_precision(double value, char* buffer, int precision,
+                     precision_format fmt) noexcept -> char* {
+  using traits = float_traits<double>;
+  assert(precision >= 0 && precision <= zmij::max_precision);
+  auto bits = traits::to_bits(value);
+  *buffer = '-';
+  buffer += traits::is_negative(bits);
+  if (traits::get_exp(bits) == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
+    // printf writes "inf" and "nan" regardless of the precision.
+    memcpy(buffer, traits::get_sig(bits) == 0 ? "inf" : "nan", 4);
+    return buffer + 3;
+  }
+  if (fmt == precision_format::general && precision == 0) precision = 1;
+  // The number of digits after the decimal point in the exponential format.
+  int exp_precision =
+      fmt == precision_format::general ? precision - 1 : precision;
+
+  char digits[max_rounded_digits];
+  rounded_decimal dec = {0, 0};
+  bool zero = (bits & ~(uint64_t(1) << 63)) == 0;
+  if (zero) {
+    if (fmt == precision_format::fixed) dec.exp = -precision;
+  } else if (fmt == precision_format::fixed) {
+    dec = round_decimal(
+        bits, [=](int) { return -precision; }, digits);
+  } else {
+    dec = round_decimal(
+        bits, [=](int e) { return e - exp_precision; }, digits);
+    // Rounding up may add a digit, e.g. 9.99 -> 10.0, which is always 0.
+    if (dec.size == exp_precision + 2) {
+      --dec.size;
+      ++dec.exp;
+    }
+  }
+
+  // The position of the first significant digit.
+  int first = zero ? 0 : dec.exp + dec.size - 1;
+  bool use_fixed = fmt == precision_format::fixed ||
+                   (fmt == precision_format::general && first < precision &&
+                    first >= -4);
+  bool strip_zeros = fmt == precision_format::general;
+  if (strip_zeros) {
+    while (dec.size > 0 && digits[dec.size - 1] == '0') {
+      --dec.size;
+      ++dec.exp;
+    }
+  }
+
+  if (use_fixed) {
+    // The number of digits after the decimal point.
+    int num_fraction_digits = fmt == precision_format::fixed ? precision
+                              : dec.exp < 0                  ? -dec.exp
+                                                             : 0;
+    if (dec.size == 0) {
+      *buffer++ = '0';
+    } else if (dec.exp >= 0) {
+      memcpy(buffer, digits, size_t(dec.size));
+      memset(buffer + dec.size, '0', size_t(dec.exp));
+      buffer += dec.size + dec.exp;
+    } else if (dec.size + dec.exp > 0) {
+      int num_integral_digits = dec.size + dec.exp;
+      memcpy(buffer, digits, size_t(num_integral_digits));
+      buffer += num_integral_digits;
+    } else {
+      *buffer++ = '0';
+    }
+    if (num_fraction_digits != 0) {
+      *buffer++ = '.';
+      // Leading zeros of the fractional part.
+      int num_zeros = dec.size == 0 ? num_fraction_digits
+                                    : std::max(-(dec.size + dec.exp), 0);
+      memset(buffer, '0', size_t(num_zeros));
+      buffer += num_zeros;
+      int num_digits = num_fraction_digits - num_zeros;
+      memcpy(buffer, digits + dec.size - num_digits, size_t(num_digits));
+      buffer += num_digits;
+    }
+    *buffer = '\0';
+    return buffer;
+  }
+
+  if (zero) {
+    digits[0] = '0';
+    dec.size = 1;
+  }
+  *buffer++ = digits[0];
+  int num_fraction_digits = strip_zeros ? dec.size - 1 : exp_precision;
+  if (num_fraction_digits != 0) {
+    *buffer++ = '.';
+    memcpy(buffer, digits + 1, size_t(dec.size - 1));
+    memset(buffer + dec.size - 1, '0',
+           size_t(num_fraction_digits - (dec.size - 1)));
+    buffer += num_fraction_digits;
+  }
+  *buffer++ = 'e';
+  *buffer++ = first >= 0 ? '+' : '-';
+  unsigned abs_exp = unsigned(first >= 0 ? first : -first);
+  if (abs_exp >= 100) {
+    *buffer++ = char('0' + abs_exp / 100);
+    abs_exp %= 100;
+  }
+  memcpy(buffer, digits2(abs_exp), 2);
+  buffer += 2;
+  *buffer = '\0';
+  return buffer;
+}
+
+#if ZMIJ_HAS_FLOAT128
+// A big integer for binary128 which has values up to about 2**16384 * 10**37
+// and 2**16496.
+using bigint128 = basic_bigint<530>;
+
+// Not uint128_t which is emulated if ZMIJ_USE_INT128 is 0 while binary128
+// support requires __int128 anyway.
+using native_uint128 = unsigned __int128;
+
+// Writes the 37 or fewer digits of `value` and returns a pointer past the end.
+auto write_uint128(char* buffer, native_uint128 value) noexcept -> char* {
+  constexpr uint64_t pow10_18 = 1'000'000'000'000'000'000;
+  char digits[40];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  for (int i = 0; i < 3 && (value != 0 || p == end); ++i) {
+    uint64_t part = uint64_t(value % pow10_18);
+    value /= pow10_18;
+    for (int j = 0; j < 18 && (part != 0 || value != 0 || p == end); ++j) {
+      *--p = char('0' + part % 10);
+      part /= 10;
+    }
+  }
+  memcpy(buffer, p, size_t(end - p));
+  return buffer + (end - p);
+}
+
+// Writes the shortest correctly rounded representation of a binary128 value.
+// The 113-bit significand doesn't fit the 128-bit powers of 10 so the value
+// and its rounding interval are scaled by a power of 10 exactly using big
+// integers to have 37 integral digits. The shortest decimal in the interval
+// is then found with 128-bit arithmetic on the integral parts, with the
+// remainders resolving the boundaries and ties. Correct but much slower than
+// double.
+auto write_float128(__float128 value, char* buffer) noexcept -> char* {
+  constexpr int num_sig_bits = 112, exp_mask = 0x7fff, exp_bias = 16383;
+  constexpr native_uint128 implicit_bit = native_uint128(1) << num_sig_bits;
+  native_uint128 bits;
+  memcpy(&bits, &value, sizeof(value));
+  *buffer = '-';
+  buffer += int(bits >> 127);
+
+  int raw_exp = int(bits >> num_sig_bits) & exp_mask;
+  native_uint128 bin_sig = bits & (implicit_bit - 1);
+  if (raw_exp == exp_mask) {
+    memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
+    return buffer + 3;
+  }
+  if (raw_exp == 0 && bin_sig == 0) {
+    memcpy(buffer, "0", 2);
+    return buffer + 1;
+  }
+  // The lower boundary is closer at a power of 2 except at the smallest
+  // normal exponent.
+  bool lower_closer = bin_sig == 0 && raw_exp > 1;
+  if (raw_exp != 0)
+    bin_sig |= implicit_bit;
+  else
+    raw_exp = 1;
+  int bin_exp = raw_exp - exp_bias - num_sig_bits;
+  bool even = (bin_sig & 1) == 0;
+
+  // dec_exp = floor(log10(2**floor(log2(value)))) so that
+  // value * 10**(36 - dec_exp) is in [10**36, 2 * 10**37).
+  uint64_t sig_hi = uint64_t(bin_sig >> 64);
+  int bin_exp_max = sig_hi != 0 ? bin_exp + 127 - clz(sig_hi)
+                                : bin_exp + 63 - clz(uint64_t(bin_sig));
+  int dec_exp = int((int64_t(bin_exp_max) * 169'464'822'037'455) >> 49);
+  int pow10 = 36 - dec_exp;
+
+  // In units of 2**(bin_exp - 2) the value is 4 * bin_sig and the rounding
+  // interval extends by 2 above and by 2 or 1 below. Scale the units by
+  // 10**pow10 with `scale` / `s`.
+  bigint128 scale(1), s(1);
+  int pow2 = pow10 + bin_exp - 2;
+  if (pow10 >= 0)
+    scale.multiply_pow5(pow10);
+  else
+    s.multiply_pow5(-pow10);
+  if (pow2 >= 0)
+    scale.shift_left(pow2);
+  else
+    s.shift_left(-pow2);
+  bigint128 r = scale;
+  r.multiply64(sig_hi);
+  r.shift_left(64);
+  bigint128 r_lo = scale;
+  r_lo.multiply64(uint64_t(bin_sig));
+  r.add(r_lo);
+  r.shift_left(2);
+  bigint128 upper = r, lower = r, quarter = scale;
+  scale.shift_left(1);
+  upper.add(scale);
+  lower.subtract(lower_closer ? quarter : scale);
+
+  int norm_shift = s.normalizing_shift();
+  s.shift_left(norm_shift);
+  r.shift_left(norm_shift);
+  upper.shift_left(norm_shift);
+  lower.shift_left(norm_shift);
+  native_uint128 sig = r.divide(s);
+  native_uint128 upper_sig = upper.divide(s);
+  native_uint128 lower_sig = lower.divide(s);
+  // Adjust the integral parts to the decimals within the rounding interval
+  // which includes the boundaries if the binary significand is even.
+  if (upper.is_zero() && !even) --upper_sig;
+  if (!lower.is_zero() || !even) ++lower_sig;
+
+  // Find the largest power of 10 with a multiple in the interval.
+  native_uint128 unit = 1;
+  while (upper_sig / (unit * 10) * (unit * 10) >= lower_sig) {
+    unit *= 10;
+    --pow10;
+  }
+  native_uint128 lo = sig / unit * unit, hi = lo + unit;
+  bool pick_hi = lo < lower_sig;
+  if (!pick_hi && hi <= upper_sig) {
+    // Compare the distances to value = sig + r / s: 2 * (value - lo) - unit.
+    auto twice_diff = __int128(2 * (sig - lo)) - __int128(unit);
+    int cmp = 0;
+    if (twice_diff >= 0) {
+      cmp = twice_diff > 0 || !r.is_zero();
+    } else if (twice_diff < -1) {
+      cmp = -1;
+    } else {
+      r.shift_left(1);
+      cmp = compare(r, s);
+    }
+    pick_hi = cmp > 0 || (cmp == 0 && (lo / unit) % 2 != 0);
+  }
+  native_uint128 dec_sig = (pick_hi ? hi : lo) / unit;
+
+  char* start = buffer;
+  buffer = write_uint128(buffer + 1, dec_sig);
+  dec_exp = int(buffer - start) - 2 - pow10;
+  start[0] = start[1];
+  if (buffer - start > 2)
+    start[1] = '.';
+  else
+    buffer = start + 1;
+
+  *buffer++ = 'e';
+  *buffer++ = dec_exp >= 0 ? '+' : '-';
+  unsigned abs_exp = unsigned(dec_exp >= 0 ? dec_exp : -dec_exp);
+  if (abs_exp < 10) *buffer++ = '0';
+  buffer = write_uint(buffer, abs_exp);
+  *buffer = '\0';
+  return buffer;
+}
+#endif  // ZMIJ_HAS_FLOAT128
+
+constexpr uint64_t inf_bits = 0x7ff0'0000'0000'0000;
+constexpr int min_table_exp = -292;  // The smallest power of 10 in the table.
+
+// Returns a lower bound of the 128-bit significand of 10**dec_exp for dec_exp
+// below the table computed from two table entries. It is less than the exact
+// significand by at most 11.
+auto pow10_significand_below_table(int dec_exp) noexcept -> uint128 {
+  constexpr int offset = 50;
+  uint128 a = get_pow10_significand(dec_exp + offset);
+  uint128 b = get_pow10_significand(-offset);
+  // The top 128 bits of a * b without the product of the lower halves.
+  uint128_t p11 = umul128(a.hi, b.hi);
+  uint128_t p10 = umul128(a.hi, b.lo), p01 = umul128(a.lo, b.hi);
+  bool carry = uint64_t(p10) + uint64_t(p01) < uint64_t(p10);
+  uint128 result = uint128{uint64_t(p11 >> 64), uint64_t(p11)} +
+                   uint128{0, uint64_t(p10 >> 64)} +
+                   uint128{0, uint64_t(p01 >> 64)} + uint128{0, carry};
+  if ((result.hi >> 63) == 0)
+    result = {result.hi << 1 | result.lo >> 63, result.lo << 1};
+  return result;
+}
+
+// Rounds the top 128 bits hi:lo of the product of a normalized 64-bit
+// significand and a normalized significand of 10**q to nearest and returns the
+// bits of the double. `bin_exp` is floor(log2(10**q)) + 63 - lz where lz is
+// the normalization shift of the first significand. The exact product is
+// assumed to be slightly above hi:lo unless `exact` is true.
+auto round_product(uint64_t hi, uint64_t lo, int bin_exp,
+                   bool exact) noexcept -> uint64_t {
+  // The leading bit of hi is at 62 + upperbit.
+  int upperbit = int(hi >> 63);
+  int biased_exp = bin_exp + upperbit + 1023;
+  int shift = upperbit + 10;  // The number of bits below the significand.
+  if (biased_exp <= 0) {
+    // Subnormal: shift out more bits with the exponent of the smallest normal.
+    shift += 1 - biased_exp;
+    biased_exp = 1;
+  }
+  if (shift > 64) return 0;  // Below half of the smallest subnormal.
+  uint64_t sig = shift < 64 ? hi >> shift : 0;
+  uint64_t rem = shift < 64 ? hi & ((uint64_t(1) << shift) - 1) : hi;
+  uint64_t half = uint64_t(1) << (shift - 1);
+  bool round_up =
+      rem > half || (rem == half && (lo != 0 || !exact || (sig & 1) != 0));
+  // Significands with the implicit bit carry into the exponent.
+  uint64_t bits = (uint64_t(biased_exp - 1) << 52) + sig + round_up;
+  return bits < inf_bits ? bits : inf_bits;
+}
+
+// Computes w * 10**q rounded to nearest with the Eisel-Lemire algorithm using
+// the same table of powers of 10 as to_decimal. Returns false if the result is
+// ambiguous, i.e. too close to a halfway point between doubles given the
+// truncation of the table, with `bits` set to an approximation within one
+// unit in the last place.
+auto eisel_lemire(uint64_t w, int q, uint64_t& bits) noexcept -> bool {
+  if (w == 0 || q < -342) {
+    bits = 0;
+    return true;
+  }
+  if (q > 308) {
+    bits = inf_bits;
+    return true;
+  }
+
+  int lz = clz(w);
+  w <<= lz;
+  int bin_exp = ((q * 217'706) >> 16) + 63 - lz;
+  if (q < min_table_exp) [[ZMIJ_UNLIKELY]] {
+    // 10**q is approximated from two table entries so accept the result only
+    // if both ends of the error interval round the same way. The error is at
+    // most 11 * w / 2**64 plus one unit for the truncation of the product.
+    uint128 pow10 = pow10_significand_below_table(q);
+    uint128_t p = umul128(w, pow10.lo);
+    uint128 product = uint128{uint64_t(umul128(w, pow10.hi) >> 64),
+                              uint64_t(umul128(w, pow10.hi))} +
+                      uint128{0, uint64_t(p >> 64)};
+    bits = round_product(product.hi, product.lo, bin_exp, false);
+    uint128 upper = product + uint128{0, 16};
+    return upper.hi >= product.hi &&
+           round_product(upper.hi, upper.lo, bin_exp, false) == bits;
+  }
+
+  uint128 pow10 = get_pow10_significand(q);
+  uint128_t p = umul128(w, pow10.hi);
+  uint64_t hi = uint64_t(p >> 64), lo = uint64_t(p);
+  // 10**q is exact in the table for q in [0, 55].
+  bool exact_pow10 = q >= 0 && q <= 55, exact = exact_pow10;
+  if ((hi & 0x1ff) == 0x1ff || exact_pow10) {
+    // The lower bits can affect rounding so add the second product.
+    p = umul128(w, pow10.lo);
+    uint64_t p_hi = uint64_t(p >> 64);
+    lo += p_hi;
+    hi += lo < p_hi;
+    exact = exact_pow10 && uint64_t(p) == 0;
+  }
+  bits = round_product(hi, lo, bin_exp, exact);
+  // The exact product can only be above hi:lo by one unit of lo if the second
+  // product was computed.
+  if (lo != ~uint64_t(0)) return true;
+  return hi != ~uint64_t(0) && round_product(hi + 1, 0, bin_exp, false) == bits;
+}
+
+// A big integer for the exact fallback of parsing. The capacity covers
+// 10**801 * 2**1076 and 2**54 * 5**1124 with some room to spare.
+using parse_bigint = basic_bigint<110>;
+
+// Returns the correctly rounded bits of the decimal significand [first, last),
+// which may contain a decimal point, multiplied by 10**exp. `bits` is an
+// initial approximation within a few units in the last place that is adjusted
+// by comparing the input with halfway points between doubles exactly.
+auto parse_exact(const char* first, const char* last, int exp,
+                 uint64_t bits) noexcept -> uint64_t {
+  // Digits beyond max_digits only matter as a sticky digit.
+  constexpr int max_digits = 800;
+  parse_bigint digits(0);
+  int num_digits = 0, chunk_size = 0;
+  uint32_t chunk = 0;
+  bool after_point = false, sticky = false;
+  for (const char* p = first; p != last; ++p) {
+    if (*p == '.') {
+      after_point = true;
+      continue;
+    }
+    if (num_digits == 0 && *p == '0') {
+      exp -= after_point;
+      continue;
+    }
+    if (num_digits == max_digits) {
+      exp += !after_point;
+      sticky |= *p != '0';
+      continue;
+    }
+    chunk = chunk * 10 + uint32_t(*p - '0');
+    ++num_digits;
+    exp -= after_point;
+    if (++chunk_size == 9) {
+      digits.multiply(uint32_t(pow10_u64[9]));
+      digits.add(parse_bigint(chunk));
+      chunk = 0;
+      chunk_size = 0;
+    }
+  }
+  digits.multiply(uint32_t(pow10_u64[chunk_size]));
+  digits.add(parse_bigint(chunk));
+  if (sticky) {
+    digits.multiply(10);
+    digits.add(parse_bigint(1));
+    --exp;
+  }
+
+  // Compare digits * 5**exp with halfway points times 5**-exp after dividing
+  // both by 2**exp. The powers of 5 are computed once for all comparisons.
+  parse_bigint pow5(1);
+  if (exp >= 0)
+    digits.multiply_pow5(exp);
+  else
+    pow5.multiply_pow5(-exp);
+
+  // Compares digits * 10**exp with the halfway point between b and b + 1.
+  auto compare_halfway = [&](uint64_t b) {
+    int bin_exp = int(b >> 52);
+    uint64_t bin_sig = b & ((uint64_t(1) << 52) - 1);
+    if (bin_exp != 0)
+      bin_sig |= uint64_t(1) << 52;
+    else
+      bin_exp = 1;
+    // halfway = (2 * bin_sig + 1) * 2**pow2
+    int pow2 = bin_exp - 1075 - 1;
+    uint64_t halfway_sig = 2 * bin_sig + 1;
+    parse_bigint lhs = digits, rhs = pow5, rhs_hi = pow5;
+    rhs.multiply(uint32_t(halfway_sig));
+    rhs_hi.multiply(uint32_t(halfway_sig >> 32));
+    rhs_hi.shift_left(32);
+    rhs.add(rhs_hi);
+    if (pow2 >= exp)
+      rhs.shift_left(pow2 - exp);
+    else
+      lhs.shift_left(exp - pow2);
+    return compare(lhs, rhs);
+  };
+  // Round half to even.
+  while (bits < inf_bits) {
+    int cmp = compare_halfway(bits);
+    if (cmp < 0 || (cmp == 0 && (bits & 1) == 0)) break;
+    ++bits;
+  }
+  while (bits != 0) {
+    int cmp = compare_halfway(bits - 1);
+    if (cmp > 0 || (cmp == 0 && (bits & 1) == 0)) break;
+    --bits;
+  }
+  return bits;
+}
+
+constexpr auto is_digit(char c) noexcept -> bool {
+  return unsigned(c - '0') < 10;
+}
+
+// Reads 8 characters as a little-endian 64-bit integer.
+inline auto read8(const char* p) noexcept -> uint64_t {
+  uint64_t x;
+  memcpy(&x, p, sizeof(x));
+  return is_big_endian() ? bswap64(x) : x;
+}
+
+// Checks if all 8 characters read by read8 are digits.
+constexpr auto is_eight_digits(uint64_t x) noexcept -> bool {
+  constexpr uint64_t mask = 0xf0f0'f0f0'f0f0'f0f0;
+  return ((x & mask) | (((x + 0x0606'0606'0606'0606) & mask) >> 4)) ==
+         0x3333'3333'3333'3333;
+}
+
+// Converts 8 digits read by read8 into an integer with SWAR.
+constexpr auto parse_eight_digits(uint64_t x) noexcept -> uint64_t {
+  constexpr uint64_t mask = 0x0000'00ff'0000'00ff;
+  constexpr uint64_t mul1 = 0x000f'4240'0000'0064;  // 100 + (1000000 << 32)
+  constexpr uint64_t mul2 = 0x0000'2710'0000'0001;  // 1 + (10000 << 32)
+  x -= 0x3030'3030'3030'3030;
+  x = x * 10 + (x >> 8);  // Pairs of digits.
+  return (((x & mask) * mul1) + (((x >> 16) & mask) * mul2)) >> 32;
+}
+
+// Accumulates digits from [p, last) into sig and returns a pointer past them.
+// sig wraps around for more than 19 digits.
+inline auto accumulate_digits(const char* p, const char* last,
+                              uint64_t& sig) noexcept -> const char* {
+  for (; last - p >= 8; p += 8) {
+    uint64_t chunk = read8(p);
+    if (!is_eight_digits(chunk)) break;
+    sig = sig * 100'000'000 + parse_eight_digits(chunk);
+  }
+  for (; p != last && is_digit(*p); ++p) sig = sig * 10 + uint64_t(*p - '0');
+  return p;
+}
+
+// Powers of 10 that are exactly representable as doubles.
+constexpr double pow10_doubles[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Checks if [p, last) starts with the lowercase `s` ignoring case.
+auto starts_with(const char* p, const char* last, const char* s) noexcept
+    -> bool {
+  for (; *s; ++p, ++s) {
+    if (p == last || (*p | 0x20) != *s) return false;
+  }
+  return true;
+}
+
+#if (ZMIJ_USE_AVX2 || ZMIJ_USE_AVX512) && !ZMIJ_COMPACT_POW10
+// Operations on vectors of 64-bit lanes used by the batch to_decimal kernel.
+// Masks are vectors on AVX2 and mask registers on AVX-512.
+#  if ZMIJ_USE_AVX512
+struct simd {
+  using vec = __m512i;
+  using mask = __mmask8;
+  static constexpr int num_lanes = 8;
+
+  static auto load(const double* p) noexcept -> vec {
+    return _mm512_loadu_si512(p);
+  }
+  static void store(uint64_t* p, vec x) noexcept { _mm512_storeu_si512(p, x); }
+  static auto set1(uint64_t x) noexcept -> vec {
+    return _mm512_set1_epi64(int64_t(x));
+  }
+  static auto add(vec x, vec y) noexcept -> vec {
+    return _mm512_add_epi64(x, y);
+  }
+  static auto sub(vec x, vec y) noexcept -> vec {
+    return _mm512_sub_epi64(x, y);
+  }
+  static auto and_(vec x, vec y) noexcept -> vec {
+    return _mm512_and_si512(x, y);
+  }
+  static auto or_(vec x, vec y) noexcept -> vec {
+    return _mm512_or_si512(x, y);
+  }
+  template <int n> static auto srli(vec x) noexcept -> vec {
+    return _mm512_srli_epi64(x, n);
+  }
+  template <int n> static auto slli(vec x) noexcept -> vec {
+    return _mm512_slli_epi64(x, n);
+  }
+  static auto srlv(vec x, vec n) noexcept -> vec {
+    return _mm512_srlv_epi64(x, n);
+  }
+  static auto sllv(vec x, vec n) noexcept -> vec {
+    return _mm512_sllv_epi64(x, n);
+  }
+  // Multiplies the low 32 bits of each lane into 64-bit products.
+  static auto mul32(vec x, vec y) noexcept -> vec {
+    return _mm512_mul_epu32(x, y);
+  }
+  static auto gather(const uint64_t* base, vec index) noexcept -> vec {
+    return _mm512_i64gather_epi64(index, base, 8);
+  }
+
+  static auto eq(vec x, vec y) noexcept -> mask {
+    return _mm512_cmpeq_epi64_mask(x, y);
+  }
+  // Unsigned x < y.
+  static auto lt(vec x, vec y) noexcept -> mask {
+    return _mm512_cmplt_epu64_mask(x, y);
+  }
+  static auto mask_or(mask x, mask y) noexcept -> mask { return x | y; }
+  static auto mask_andnot(mask x, mask y) noexcept -> mask { return ~x & y; }
+  // Returns y in lanes where `m` is set and x elsewhere.
+  static auto blend(mask m, vec x, vec y) noexcept -> vec {
+    return _mm512_mask_blend_epi64(m, x, y);
+  }
+  static auto to_bits(mask m) noexcept -> unsigned { return m; }
+};
+#  else
+struct simd {
+  using vec = __m256i;
+  using mask = __m256i;
+  static constexpr int num_lanes = 4;
+
+  static auto load(const double* p) noexcept -> vec {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void store(uint64_t* p, vec x) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+  }
+  static auto set1(uint64_t x) noexcept -> vec {
+    return _mm256_set1_epi64x(int64_t(x));
+  }
+  static auto add(vec x, vec y) noexcept -> vec {
+    return _mm256_add_epi64(x, y);
+  }
+  static auto sub(vec x, vec y) noexcept -> vec {
+    return _mm256_sub_epi64(x, y);
+  }
+  static auto and_(vec x, vec y) noexcept -> vec {
+    return _mm256_and_si256(x, y);
+  }
+  static auto or_(vec x, vec y) noexcept -> vec {
+    return _mm256_or_si256(x, y);
+  }
+  template <int n> static auto srli(vec x) noexcept -> vec {
+    return _mm256_srli_epi64(x, n);
+  }
+  template <int n> static auto slli(vec x) noexcept -> vec {
+    return _mm256_slli_epi64(x, n);
+  }
+  static auto srlv(vec x, vec n) noexcept -> vec {
+    return _mm256_srlv_epi64(x, n);
+  }
+  static auto sllv(vec x, vec n) noexcept -> vec {
+    return _mm256_sllv_epi64(x, n);
+  }
+  // Multiplies the low 32 bits of each lane into 64-bit products.
+  static auto mul32(vec x, vec y) noexcept -> vec {
+    return _mm256_mul_epu32(x, y);
+  }
+  static auto gather(const uint64_t* base, vec index) noexcept -> vec {
+    return _mm256_i64gather_epi64(reinterpret_cast<const long long*>(base),
+                                  index, 8);
+  }
+
+  static auto eq(vec x, vec y) noexcept -> mask {
+    return _mm256_cmpeq_epi64(x, y);
+  }
+  // Unsigned x < y. AVX2 only has a signed comparison so flip the sign bits.
+  static auto lt(vec x, vec y) noexcept -> mask {
+    vec sign = set1(uint64_t(1) << 63);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign),
+                              _mm256_xor_si256(x, sign));
+  }
+  static auto mask_or(mask x, mask y) noexcept -> mask { return or_(x, y); }
+  static auto mask_andnot(mask x, mask y) noexcept -> mask {
+    return _mm256_andnot_si256(x, y);
+  }
+  // Returns y in lanes where `m` is set and x elsewhere.
+  static auto blend(mask m, vec x, vec y) noexcept -> vec {
+    return _mm256_blendv_epi8(x, y, m);
+  }
+  static auto to_bits(mask m) noexcept -> unsigned {
+    return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+  }
+};
+#  endif
+
+// Computes the high 64 bits of 64x64-bit products in each lane using 32-bit
+// partial products, the same way as the portable umul128.
+ZMIJ_INLINE void umul128_lanes(simd::vec x, simd::vec y, simd::vec& hi,
+                               simd::vec& lo) noexcept {
+  using v = simd;
+  v::vec mask32 = v::set1(0xffffffff);
+  v::vec a = v::srli<32>(x), c = v::srli<32>(y);
+  v::vec ac = v::mul32(a, c);
+  v::vec bc = v::mul32(x, c);
+  v::vec ad = v::mul32(a, y);
+  v::vec bd = v::mul32(x, y);
+  v::vec cs = v::add(v::add(v::srli<32>(bd), v::and_(ad, mask32)),
+                     v::and_(bc, mask32));  // cross sum
+  hi = v::add(v::add(ac, v::srli<32>(ad)),
+              v::add(v::srli<32>(bc), v::srli<32>(cs)));
+  lo = v::or_(v::slli<32>(cs), v::and_(bd, mask32));
+}
+
+// Converts simd::num_lanes values using the regular path of to_decimal in
+// all lanes and returns a bit mask of lanes that need the scalar path:
+// special and subnormal values, powers of two and the boundary cases where
+// the scalar code falls back to Schubfach.
+ZMIJ_INLINE auto to_decimal_lanes(const double* values, uint64_t* sigs,
+                                  uint64_t* dec_exps) noexcept -> unsigned {
+  using v = simd;
+  using traits = float_traits<double>;
+  v::vec zero = v::set1(0);
+  v::vec bits = v::load(values);
+  v::vec raw_exp = v::and_(v::srli<traits::num_sig_bits>(bits),
+                           v::set1(traits::exp_mask));
+  v::vec bin_sig = v::and_(bits, v::set1(traits::implicit_bit - 1));
+  v::mask special = v::mask_or(v::eq(raw_exp, zero),
+                               v::eq(raw_exp, v::set1(traits::exp_mask)));
+  v::mask fallback = v::mask_or(special, v::eq(bin_sig, zero));
+  bin_sig = v::or_(bin_sig, v::set1(traits::implicit_bit));
+
+  // compute_dec_exp and do_compute_exp_shift on biased values to avoid
+  // signed 64-bit shifts which AVX2 doesn't have. The biases are multiples of
+  // the shifted-out powers of two so the floors are unaffected.
+  constexpr int offset = traits::num_sig_bits + traits::exp_bias;
+  constexpr uint64_t log10_2_sig = 315'653, log10_2_exp = 20;
+  constexpr uint64_t log2_pow10_sig = 217'707, log2_pow10_exp = 16;
+  v::vec biased_bin_exp = v::add(raw_exp, v::set1((1 << log10_2_exp) - offset));
+  // dec_exp + log10_2_sig
+  v::vec biased_dec_exp = v::srli<log10_2_exp>(
+      v::mul32(biased_bin_exp, v::set1(log10_2_sig)));
+  // -dec_exp + 2**log2_pow10_exp
+  v::vec neg_dec_exp = v::sub(
+      v::set1((1 << log2_pow10_exp) + log10_2_sig), biased_dec_exp);
+  // pow10_bin_exp + log2_pow10_sig
+  v::vec pow10_bin_exp = v::srli<log2_pow10_exp>(
+      v::mul32(neg_dec_exp, v::set1(log2_pow10_sig)));
+  v::vec exp_shift = v::sub(v::add(raw_exp, pow10_bin_exp),
+                            v::set1(offset + log2_pow10_sig - 1));
+
+  // pow10_significands[-dec_exp] with dec_exp_min = -292.
+  static_assert(!pow10_significands_table::split_tables, "");
+  v::vec index = v::slli<1>(
+      v::sub(neg_dec_exp, v::set1((1 << log2_pow10_exp) - 292)));
+  v::vec pow10_hi = v::gather(pow10_significands.data, index);
+  v::vec pow10_lo = v::gather(pow10_significands.data + 1, index);
+
+  // umul192_hi128(pow10.hi, pow10.lo, bin_sig << exp_shift)
+  v::vec scaled_sig = v::sllv(bin_sig, exp_shift);
+  v::vec p_hi, p_lo, unused, lo_hi;
+  umul128_lanes(pow10_hi, scaled_sig, p_hi, p_lo);
+  umul128_lanes(pow10_lo, scaled_sig, lo_hi, unused);
+  v::vec fractional = v::add(p_lo, lo_hi);
+  v::vec integral = v::sub(p_hi, v::blend(v::lt(fractional, p_lo), zero,
+                                          v::set1(~uint64_t(0))));
+  constexpr uint64_t half_ulp = uint64_t(1) << 63;
+  fallback = v::mask_or(fallback, v::eq(fractional, v::set1(half_ulp)));
+
+  // digit = integral % 10, see to_decimal.
+  v::vec quotient, unused_lo;
+  umul128_lanes(integral, v::set1((1ull << 63) / 5 + 1), quotient, unused_lo);
+  v::vec digit = v::sub(
+      integral, v::add(v::slli<3>(quotient), v::slli<1>(quotient)));
+
+  constexpr int num_integral_bits = 4;
+  constexpr uint64_t ten = uint64_t(10) << (64 - num_integral_bits);
+  v::vec scaled_sig_mod10 =
+      v::or_(v::slli<64 - num_integral_bits>(digit),
+             v::srli<num_integral_bits>(fractional));
+  v::vec scaled_half_ulp = v::srlv(
+      pow10_hi, v::sub(v::set1(num_integral_bits + 1), exp_shift));
+  v::vec upper = v::add(scaled_sig_mod10, scaled_half_ulp);
+  fallback = v::mask_or(
+      v::mask_or(fallback, v::eq(scaled_sig_mod10, scaled_half_ulp)),
+      v::lt(v::sub(v::set1(ten), upper), v::set1(2)));
+
+  v::mask round_up = v::lt(v::set1(ten - 1), upper);
+  v::vec shorter =
+      v::add(v::sub(integral, digit), v::blend(round_up, zero, v::set1(10)));
+  v::vec longer = v::add(integral, v::srli<63>(fractional));
+  v::mask use_longer =
+      v::mask_andnot(round_up, v::lt(scaled_half_ulp, scaled_sig_mod10));
+  v::store(sigs, v::blend(use_longer, shorter, longer));
+  v::store(dec_exps, biased_dec_exp);
+  return v::to_bits(fallback);
+}
+#endif  // ZMIJ_USE_AVX2 || ZMIJ_USE_AVX512
+}  // namespace
+
+namespace zmij {
+#ifdef ZMIJ_HEADER_ONLY
+inline namespace ZMIJ_HEADER_NAMESPACE {
+#endif
+
+ZMIJ_HEADER_INLINE ZMIJ_HEADER_CONSTEXPR auto to_decimal(double value) noexcept
+    -> dec_fp {
+  using traits = float_traits<double>;
+  auto bits = traits::to_bits(value);
+  auto bin_exp = traits::get_exp(bits);  // binary exponent
+  auto bin_sig = traits::get_sig(bits);  // binary significand
+  bool special = ((bin_exp + 1) & traits::exp_mask) <= 1;
+  bool regular = (bin_sig != 0) | special;
+  if (special) [[ZMIJ_UNLIKELY]] {
+    if (bin_exp != 0) return {0, int(~0u >> 1)};
+    if (bin_sig == 0) return {0, 0};
+    bin_sig |= traits::implicit_bit;
+  }
+  bin_sig ^= traits::implicit_bit;
+  auto dec = ::to_decimal<double>(bin_sig, bin_exp, regular, special);
+  return {traits::is_negative(bits) ? -dec.sig : dec.sig, dec.exp};
+}
+
+namespace {
+// Converts `n` values calling `store(i, dec)` with the result for each.
+template <typename Store>
+ZMIJ_INLINE void to_decimal_each(const double* values, size_t n,
+                                 Store store) noexcept {
+  size_t i = 0;
+#if (ZMIJ_USE_AVX2 || ZMIJ_USE_AVX512) && !ZMIJ_COMPACT_POW10
+  constexpr int num_lanes = simd::num_lanes;
+  constexpr uint64_t dec_exp_bias = 315'653;
+  for (; i + num_lanes <= n; i += num_lanes) {
+    uint64_t sigs[num_lanes], dec_exps[num_lanes];
+    unsigned fallback = to_decimal_lanes(values + i, sigs, dec_exps);
+    for (int j = 0; j < num_lanes; ++j) {
+      if (fallback & (1u << j)) [[ZMIJ_UNLIKELY]] {
+        store(i + j, to_decimal(values[i + j]));
+        continue;
+      }
+      long long sig = (long long)sigs[j];
+      bool negative = std::signbit(values[i + j]);
+      store(i + j,
+            dec_fp{negative ? -sig : sig, int(dec_exps[j] - dec_exp_bias)});
+    }
+  }
+#endif
+  for (; i < n; ++i) store(i, to_decimal(values[i]));
+}
+}  // namespace
+
+ZMIJ_HEADER_INLINE void to_decimal(const double* values, dec_fp* out,
+                                   size_t n) noexcept {
+  to_decimal_each(values, n, [=](size_t i, dec_fp dec) { out[i] = dec; });
+}
+
+ZMIJ_HEADER_INLINE void to_decimal(const double* values, long long* sigs,
+                                   int16_t* exps, size_t n) noexcept {
+  to_decimal_each(values, n, [=](size_t i, dec_fp dec) {
+    sigs[i] = dec.sig;
+    exps[i] = int16_t(dec.exp != non_finite_exp ? dec.exp : non_finite_exp16);
+  });
+}
+
+namespace detail {
+
+template <typename Dialect, typename Float, typename Dec>
+ZMIJ_HEADER_CONSTEXPR ZMIJ_INLINE auto write_scientific(char* buffer,
+                                                        Dec dec) noexcept
+    -> char*;
+
+template <typename Dialect, typename Float>
+ZMIJ_HEADER_CONSTEXPR ZMIJ_INLINE auto write_exponent(char* buffer,
+                                                      int dec_exp) noexcept
+    -> char*;
+
+// It is slightly faster to return a pointer to the end than the size.
+template <typename Dialect, typename Float>
+ZMIJ_HEADER_CONSTEXPR ZMIJ_INLINE auto write_dialect(Float value,
+                                                     char* buffer) noexcept
+    -> char* {
+  using traits = float_traits<Float>;
+  auto bits = traits::to_bits(value);
+  // It is beneficial to extract exponent and significand early.
+  auto bin_exp = traits::get_exp(bits);  // binary exponent
+  auto bin_sig = traits::get_sig(bits);  // binary significand
+
+  *buffer = '-';
+  buffer += traits::is_negative(bits);
+
+  bool regular = bin_sig != 0;
+  bool subnormal = bin_exp == 0;
+  if (bin_exp == 0 || bin_exp == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
+    if (bin_exp != 0) {
+      copy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
+      return buffer + 3;
+    }
+    if (bin_sig == 0) {
+      copy(buffer, "0", 2);
+      return buffer + 1;
+    }
+    bin_sig |= traits::implicit_bit;
+  }
+  bin_sig ^= traits::implicit_bit;
+
+  // Here be 🐉s.
+  auto dec = ::to_decimal<Float>(bin_sig, bin_exp, regular, subnormal);
+  return write_scientific<Dialect, Float>(buffer, dec);
+}
+
+// Writes the decimal significand and exponent `dec` produced by to_decimal
+// for Float in the scientific notation.
+template <typename Dialect, typename Float, typename Dec>
+ZMIJ_HEADER_CONSTEXPR ZMIJ_INLINE auto write_scientific(char* buffer,
+                                                        Dec dec) noexcept
+    -> char* {
+  using traits = float_traits<Float>;
+  int dec_exp = dec.exp;
+
+  // Write significand.
+  char* start = buffer;
+  if (traits::num_bits == 64) {
+    bool has17digits = dec.sig >= uint64_t(1e16);
+    dec_exp += traits::max_digits10 - 2 + has17digits;
+    buffer = ::write_significand17(buffer + 1, dec.sig, has17digits);
+  } else {
+    if (traits::num_bits == 16) {
+      // Scale the 3-5 digits of a 16-bit format to the 8-9 digits of float.
+      while (dec.sig < uint32_t(1e7)) {
+        dec.sig *= 10;
+        --dec_exp;
+      }
+    } else if (dec.sig < uint32_t(1e7)) [[ZMIJ_UNLIKELY]] {
+      dec.sig *= 10;
+      --dec_exp;
+    }
+    bool has9digits = dec.sig >= uint32_t(1e8);
+    constexpr int max_digits10 = std::numeric_limits<float>::max_digits10;
+    dec_exp += max_digits10 - 2 + has9digits;
+    buffer = write_significand9(buffer + 1, dec.sig, has9digits);
+  }
+  start[0] = start[1];
+  start[1] = '.';
+  return write_exponent<Dialect, Float>(buffer, dec_exp);
+}
+
+// Writes the exponent part of the scientific notation, e.g. "e+05", and a NUL
+// if the dialect requires one. Up to 6 bytes are written.
+template <typename Dialect, typename Float>
+ZMIJ_HEADER_CONSTEXPR ZMIJ_INLINE auto write_exponent(char* buffer,
+                                                      int dec_exp) noexcept
+    -> char* {
+  using traits = float_traits<Float>;
+  if (Dialect::exp_plus) {
+    uint16_t e_sign = dec_exp >= 0 ? ('+' << 8 | 'e') : ('-' << 8 | 'e');
+    if (is_big_endian()) e_sign = e_sign << 8 | e_sign >> 8;
+    store(buffer, e_sign);
+    buffer += 2;
+  } else {
+    buffer[0] = 'e';
+    buffer[1] = '-';
+    buffer += 1 + (dec_exp < 0);
+  }
+  dec_exp = dec_exp >= 0 ? dec_exp : -dec_exp;
+  if (Dialect::min_exp_digits == 1 && dec_exp < 10) {
+    buffer[0] = char('0' + dec_exp);
+    if (Dialect::nul_terminated) buffer[1] = '\0';
+    return buffer + 1;
+  }
+  if (traits::min_exponent10 >= -99 && traits::max_exponent10 <= 99) {
+    copy(buffer, digits2(dec_exp), 2);
+    if (Dialect::nul_terminated) buffer[2] = '\0';
+    return buffer + 2;
+  }
+
+  // digit = dec_exp / 100
+  uint32_t digit = use_umul128_hi64
+                       ? umul128_hi64(dec_exp, 0x290000000000000)
+                       : (uint32_t(dec_exp) * div100_sig) >> div100_exp;
+  uint32_t digit_with_nuls = '0' + digit;
+  if (is_big_endian()) digit_with_nuls <<= 24;
+  store(buffer, digit_with_nuls);
+  buffer += dec_exp >= 100;
+  copy(buffer, digits2(dec_exp - digit * 100), 2);
+  return buffer + 2;
+}
+
+template <typename Float>
+ZMIJ_HEADER_CONSTEXPR auto write(Float value, char* buffer) noexcept -> char* {
+  return write_dialect<default_dialect>(value, buffer);
+}
+
+ZMIJ_HEADER_INLINE auto write_decimal(char* buffer, long long sig,
+                                      int exp) noexcept -> char* {
+  *buffer = '-';
+  buffer += sig < 0;
+  uint64_t abs_sig = sig < 0 ? 0 - uint64_t(sig) : uint64_t(sig);
+  // Scale to the 17 digits of the internal to_decimal results.
+  int scale = 17 - count_digits(abs_sig);
+  struct {
+    uint64_t sig;
+    int exp;
+  } dec = {abs_sig * pow10_u64[scale], exp - scale};
+  return write_scientific<default_dialect, double>(buffer, dec);
+}
+
+ZMIJ_HEADER_INLINE auto write_decimal64(decimal64 value,
+                                        char* buffer) noexcept -> char* {
+  uint64_t bits = value.bits;
+  *buffer = '-';
+  buffer += bits >> 63;
+
+  // If the two bits after the sign are 11, the exponent is shifted by 2 bits
+  // and the coefficient is 0b100 followed by the low 51 bits.
+  uint64_t sig = 0;
+  int exp = 0;
+  if ((bits >> 61 & 3) != 3) [[ZMIJ_LIKELY]] {
+    exp = int(bits >> 53 & 0x3ff);
+    sig = bits & ((uint64_t(1) << 53) - 1);
+  } else {
+    if ((bits >> 59 & 3) == 3) {
+      copy(buffer, bits & (uint64_t(1) << 58) ? "nan" : "inf", 4);
+      return buffer + 3;
+    }
+    exp = int(bits >> 51 & 0x3ff);
+    sig = (bits & ((uint64_t(1) << 51) - 1)) | (uint64_t(1) << 53);
+  }
+  // Coefficients above 10**16 - 1 are noncanonical and treated as zero.
+  constexpr uint64_t max_sig = uint64_t(1e16) - 1;
+  if (sig == 0 || sig > max_sig) [[ZMIJ_UNLIKELY]] {
+    copy(buffer, "0", 2);
+    return buffer + 1;
+  }
+  constexpr int exp_bias = 398;
+  exp -= exp_bias;
+
+  // Scale the coefficient to 16 digits like a 16-digit double significand.
+  // The digit count is derived from the bit length instead of a loop.
+  int num_digits = ((64 - clz(sig)) * 1233) >> 12;
+  num_digits += sig >= pow10_u64[num_digits];
+  int scale = 16 - num_digits;
+  struct {
+    uint64_t sig;
+    int exp;
+  } dec = {sig * pow10_u64[scale], exp - scale};
+  return write_scientific<default_dialect, double>(buffer, dec);
+}
 
+ZMIJ_HEADER_INLINE ZMIJ_HEADER_CONSTEXPR auto write_bounded(
+    double value, char* out, size_t n) noexcept -> size_t {
+  using traits = float_traits<double>;
+  auto bits = traits::to_bits(value);
+  auto bin_exp = traits::get_exp(bits);
+  auto bin_sig = traits::get_sig(bits);
+  bool negative = traits::is_negative(bits);
+  if (bin_exp == 0 || bin_exp == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
+    char buffer[double_buffer_size] = {};
+    size_t size = write(value, buffer) - buffer;
+    copy(out, buffer, n);
+    return size;
+  }
+
+  bool regular = bin_sig != 0;
+  bin_sig ^= traits::implicit_bit;
+  auto dec = ::to_decimal<double>(bin_sig, bin_exp, regular, false);
+
+  // The significand fits since n >= min_direct_size.
+  char* start = out + negative;
+  *out = '-';
+  bool has17digits = dec.sig >= uint64_t(1e16);
+  int dec_exp = dec.exp + traits::max_digits10 - 2 + has17digits;
+  char* end = ::write_significand17(start + 1, dec.sig, has17digits);
+  start[0] = start[1];
+  start[1] = '.';
+  size_t size = size_t(end - out);
+  constexpr size_t max_exponent_size = 6;
+  if (n - size >= max_exponent_size)
+    return write_exponent<default_dialect, double>(end, dec_exp) - out;
+
+  // Only the exponent, at most 5 characters and a NUL, may be truncated.
+  char exp[max_exponent_size] = {};
+  size_t exp_size =
+      size_t(write_exponent<default_dialect, double>(exp, dec_exp) - exp);
+  copy(end, exp, n - size);
+  return size + exp_size;
+}
+
+template <typename Range, typename Dialect>
+ZMIJ_HEADER_CONSTEXPR auto write_range(double value, char* buffer) noexcept
+    -> char* {
+  using traits = float_traits<double>;
+  auto bits = traits::to_bits(value);
+  auto bin_exp = traits::get_exp(bits);
+  auto bin_sig = traits::get_sig(bits);
+
+  bool negative = traits::is_negative(bits);
+  assert(!(Range::non_negative && negative));
+  if (!Range::non_negative) {
+    *buffer = '-';
+    buffer += negative;
+  }
+
+  // Zeros, subnormals and non-finite values are outside of any range.
+  assert(bin_exp != 0 && bin_exp != traits::exp_mask);
+  bool regular = bin_sig != 0;
+  bin_sig ^= traits::implicit_bit;
+  auto dec = ::to_decimal<double, range_pow10_source<Range>>(bin_sig, bin_exp,
+                                                             regular, false);
+  // The exponent in the scientific notation.
+  bool has17digits = uint64_t(dec.sig) >= uint64_t(1e16);
+  int exp10 = dec.exp + traits::max_digits10 - 2 + has17digits;
+  assert(exp10 >= Range::min_exp10 && exp10 <= Range::max_exp10);
+  (void)exp10;
+  return write_scientific<Dialect, Range>(buffer, dec);
+}
+
+// Same as write for double but writes code units of type Char without a
+// terminating null. Up to 24 code units are written.
+template <typename Char>
+ZMIJ_INLINE auto write_wide(double value, Char* buffer) noexcept -> Char* {
+  using traits = float_traits<double>;
+  auto bits = traits::to_bits(value);
+  auto bin_exp = traits::get_exp(bits);
+  auto bin_sig = traits::get_sig(bits);
+
+  *buffer = Char('-');
+  buffer += traits::is_negative(bits);
+
+  bool regular = bin_sig != 0;
+  bool subnormal = bin_exp == 0;
+  if (bin_exp == 0 || bin_exp == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
+    if (bin_exp == 0 && bin_sig == 0) {
+      *buffer = Char('0');
+      return buffer + 1;
+    }
+    if (bin_exp != 0) {
+      const char* s = bin_sig == 0 ? "inf" : "nan";
+      for (int i = 0; i < 3; ++i) buffer[i] = Char(s[i]);
+      return buffer + 3;
+    }
+    bin_sig |= traits::implicit_bit;
+  }
+  bin_sig ^= traits::implicit_bit;
+
+  auto dec = ::to_decimal<double>(bin_sig, bin_exp, regular, subnormal);
+  bool has17digits = dec.sig >= uint64_t(1e16);
+  int dec_exp = dec.exp + traits::max_digits10 - 2 + has17digits;
+  Char* start = buffer;
+  buffer = ::write_significand17_wide(buffer + 1, dec.sig, has17digits);
+  start[0] = start[1];
+  start[1] = Char('.');
+
+  // Same as write_exponent for the default dialect.
+  buffer[0] = Char('e');
+  buffer[1] = Char(dec_exp >= 0 ? '+' : '-');
+  buffer += 2;
+  dec_exp = dec_exp >= 0 ? dec_exp : -dec_exp;
+  *buffer = Char('0' + dec_exp / 100);
+  buffer += dec_exp >= 100;
+  const char* d = digits2(size_t(dec_exp % 100));
+  buffer[0] = Char(d[0]);
+  buffer[1] = Char(d[1]);
+  return buffer + 2;
+}
+
+template <typename Char>
+ZMIJ_INLINE auto write_wide(Char* out, size_t n, double value) noexcept
+    -> size_t {
+  if (n >= double_buffer_size) return size_t(write_wide(value, out) - out);
+  Char buffer[double_buffer_size];
+  size_t size = size_t(write_wide(value, buffer) - buffer);
+  for (size_t i = 0; i < n && i < size; ++i) out[i] = buffer[i];
+  return size;
+}
+
+#ifndef ZMIJ_HEADER_ONLY
 template auto write(double value, char* buffer) noexcept -> char*;
 template auto write(float value, char* buffer) noexcept -> char*;
+template auto write(float16 value, char* buffer) noexcept -> char*;
+template auto write(bfloat16 value, char* buffer) noexcept -> char*;
+
+// Other dialects are only available in the header-only mode.
+template auto write_dialect<json_dialect>(double value, char* buffer) noexcept
+    -> char*;
+template auto write_dialect<json_dialect>(float value, char* buffer) noexcept
+    -> char*;
+template auto write_dialect<python_dialect>(double value, char* buffer) noexcept
+    -> char*;
+template auto write_dialect<python_dialect>(float value, char* buffer) noexcept
+    -> char*;
+#endif
+
+#if ZMIJ_HAS_FLOAT128
+template <>
+ZMIJ_HEADER_INLINE auto write(__float128 value, char* buffer) noexcept
+    -> char* {
+  return write_float128(value, buffer);
+}
+#endif
+
+template <typename Float>
+auto write(Float value, char* buffer, notation fmt) noexcept -> char* {
+  using traits = float_traits<Float>;
+  auto bits = traits::to_bits(value);
+  auto bin_exp = traits::get_exp(bits);  // binary exponent
+  auto bin_sig = traits::get_sig(bits);  // binary significand
+
+  *buffer = '-';
+  buffer += traits::is_negative(bits);
+
+  if (traits::num_bits == 64) {
+    // Integers in [1, 2**53) are exact and their neighbors are at most 1
+    // apart, so the shortest representation is the integer itself which is
+    // written directly in both notations. `shift` is the number of fractional
+    // bits of the significand.
+    int64_t shift = traits::exp_bias + traits::num_sig_bits - bin_exp;
+    uint64_t sig = uint64_t(bin_sig | traits::implicit_bit);
+    if (uint64_t(shift) <= uint64_t(traits::num_sig_bits) &&
+        (sig << (63 - shift) << 1) == 0) {
+      ZMIJ_COUNT(integral);
+      buffer = write_integer16(buffer, sig >> shift);
+      *buffer = '\0';
+      return buffer;
+    }
+  }
+
+  bool regular = bin_sig != 0;
+  bool subnormal = bin_exp == 0;
+  if (bin_exp == 0 || bin_exp == traits::exp_mask) [[ZMIJ_UNLIKELY]] {
+    if (bin_exp != 0) {
+      memcpy(buffer, bin_sig == 0 ? "inf" : "nan", 4);
+      return buffer + 3;
+    }
+    if (bin_sig == 0) {
+      memcpy(buffer, "0", 2);
+      return buffer + 1;
+    }
+    bin_sig |= traits::implicit_bit;
+  }
+  bin_sig ^= traits::implicit_bit;
+
+  auto dec = ::to_decimal<Float>(bin_sig, bin_exp, regular, subnormal);
+  int dec_exp = dec.exp;
+
+  // Write the significand digits at buffer + 1 like in the scientific
+  // notation. dec_exp becomes the exponent of the first digit.
+  char* digits = buffer + 1;
+  char* end = nullptr;
+  if (traits::num_bits == 64) {
+    bool has17digits = dec.sig >= uint64_t(1e16);
+    dec_exp += traits::max_digits10 - 2 + has17digits;
+    end = write_significand17(digits, dec.sig, has17digits);
+  } else {
+    if (dec.sig < uint32_t(1e7)) [[ZMIJ_UNLIKELY]] {
+      dec.sig *= 10;
+      --dec_exp;
+    }
+    bool has9digits = dec.sig >= uint32_t(1e8);
+    dec_exp += traits::max_digits10 - 2 + has9digits;
+    end = write_significand9(digits, dec.sig, has9digits);
+  }
+  // A single digit is reported as an empty range to drop the decimal point.
+  int num_digits = end != digits ? int(end - digits) : 1;
+
+  if (fmt == notation::general && (dec_exp < -6 || dec_exp >= 21)) {
+    buffer[0] = digits[0];
+    if (num_digits > 1) {
+      buffer[1] = '.';
+      buffer = digits + num_digits;
+    } else {
+      buffer = digits;
+    }
+    *buffer++ = 'e';
+    *buffer++ = dec_exp >= 0 ? '+' : '-';
+    unsigned abs_exp = unsigned(dec_exp >= 0 ? dec_exp : -dec_exp);
+    if (abs_exp >= 100) {
+      *buffer++ = char('0' + abs_exp / 100);
+      abs_exp %= 100;
+      memcpy(buffer, digits2(abs_exp), 2);
+      buffer += 2;
+    } else if (abs_exp >= 10) {
+      memcpy(buffer, digits2(abs_exp), 2);
+      buffer += 2;
+    } else {
+      *buffer++ = char('0' + abs_exp);
+    }
+    *buffer = '\0';
+    return buffer;
+  }
+
+  if (dec_exp >= num_digits - 1) {
+    // An integer: ddd000.
+    memmove(buffer, digits, size_t(num_digits));
+    int num_zeros = dec_exp + 1 - num_digits;
+    memset(buffer + num_digits, '0', size_t(num_zeros));
+    buffer += num_digits + num_zeros;
+  } else if (dec_exp >= 0) {
+    // ddd.ddd: move the integral digits one position to the left.
+    memmove(buffer, digits, size_t(dec_exp + 1));
+    buffer[dec_exp + 1] = '.';
+    buffer = digits + num_digits;
+  } else {
+    // 0.000ddd
+    int num_zeros = -dec_exp - 1;
+    memmove(buffer + 2 + num_zeros, digits, size_t(num_digits));
+    memcpy(buffer, "0.", 2);
+    memset(buffer + 2, '0', size_t(num_zeros));
+    buffer += 2 + num_zeros + num_digits;
+  }
+  *buffer = '\0';
+  return buffer;
+}
+
+#ifndef ZMIJ_HEADER_ONLY
+template auto write(double value, char* buffer, notation fmt) noexcept
+    -> char*;
+template auto write(float value, char* buffer, notation fmt) noexcept
+    -> char*;
+#endif
 
 }  // namespace detail
+
+ZMIJ_HEADER_INLINE auto from_chars(const char* first, const char* last,
+                                   double& value) noexcept
+    -> from_chars_result {
+  const char* p = first;
+  bool negative = p != last && *p == '-';
+  p += negative;
+  uint64_t bits = 0;
+  if (p == last || (!is_digit(*p) && *p != '.')) {
+    if (starts_with(p, last, "inf")) {
+      p += starts_with(p, last, "infinity") ? 8 : 3;
+      bits = inf_bits;
+    } else if (starts_with(p, last, "nan")) {
+      p += 3;
+      // Skip an optional (n-char-sequence).
+      const char* end = p;
+      if (end != last && *end == '(') {
+        for (++end; end != last && (is_digit(*end) || *end == '_' ||
+                                    unsigned((*end | 0x20) - 'a') < 26);
+             ++end) {
+        }
+        if (end != last && *end == ')') p = end + 1;
+      }
+      bits = inf_bits | (uint64_t(1) << 51);
+    } else {
+      return {first, false};
+    }
+    bits |= uint64_t(negative) << 63;
+    memcpy(&value, &bits, sizeof(value));
+    return {p, true};
+  }
+
+  // Parse the significand into sig with value = sig * 10**q.
+  const char* sig_begin = p;
+  uint64_t sig = 0;
+  p = accumulate_digits(p, last, sig);
+  ptrdiff_t num_digits = p - sig_begin;
+  int q = 0;
+  if (p != last && *p == '.') {
+    const char* frac_begin = ++p;
+    p = accumulate_digits(p, last, sig);
+    num_digits += p - frac_begin;
+    q = -int(p - frac_begin);
+  }
+  if (num_digits == 0) return {first, false};
+  const char* sig_end = p;
+
+  int exp = 0;
+  if (p != last && (*p | 0x20) == 'e') {
+    const char* e = p + 1;
+    bool exp_negative = e != last && *e == '-';
+    if (e != last && (*e == '-' || *e == '+')) ++e;
+    if (e != last && is_digit(*e)) {
+      for (; e != last && is_digit(*e); ++e) {
+        if (exp < 100'000) exp = exp * 10 + (*e - '0');
+      }
+      if (exp_negative) exp = -exp;
+      p = e;
+    }
+  }
+
+  bool truncated = false;
+  if (num_digits > 19) [[ZMIJ_UNLIKELY]] {
+    // Keep up to 19 significant digits and check if nonzero ones are dropped.
+    sig = 0;
+    q = 0;
+    int num_sig_digits = 0;
+    bool after_point = false;
+    for (const char* d = sig_begin; d != sig_end; ++d) {
+      if (*d == '.') {
+        after_point = true;
+      } else if (sig == 0 && *d == '0') {
+        q -= after_point;
+      } else if (num_sig_digits < 19) {
+        sig = sig * 10 + uint64_t(*d - '0');
+        ++num_sig_digits;
+        q -= after_point;
+      } else {
+        q += !after_point;
+        truncated |= *d != '0';
+      }
+    }
+  }
+  q += exp;
+
+#if FLT_EVAL_METHOD == 0
+  // Clinger's fast path: both sig and 10**|q| are exact doubles so a single
+  // correctly rounded operation gives the result.
+  if (!truncated && sig <= (uint64_t(1) << 53) && q >= -22 && q <= 22) {
+    value = q < 0 ? double(sig) / pow10_doubles[-q]
+                  : double(sig) * pow10_doubles[q];
+    if (negative) value = -value;
+    return {p, true};
+  }
+#endif
+
+  // Truncated digits put the value between sig and sig + 1 units.
+  bool ok = eisel_lemire(sig, q, bits);
+  if (ok && truncated) {
+    uint64_t upper_bits = 0;
+    ok = eisel_lemire(sig + 1, q, upper_bits) && upper_bits == bits;
+  }
+  if (!ok) [[ZMIJ_UNLIKELY]]
+    bits = parse_exact(sig_begin, sig_end, exp, bits);
+  bits |= uint64_t(negative) << 63;
+  memcpy(&value, &bits, sizeof(value));
+  return {p, true};
+}
+
+namespace {
+
+// Parses the field [p, end) with from_chars and returns true if it is a
+// number that spans the whole field.
+inline auto parse_field(const char* p, const char* end, double& value) noexcept
+    -> bool {
+  from_chars_result result = from_chars(p, end, value);
+  return result.ok && result.ptr == end;
+}
+
+#if ZMIJ_USE_SSE && FLT_EVAL_METHOD == 0
+// Returns the number of trailing zero bits of a nonzero `x`.
+inline auto ctz(uint64_t x) noexcept -> int {
+  assert(x != 0);
+#  if ZMIJ_HAS_BUILTIN(__builtin_ctzll)
+  return __builtin_ctzll(x);
+#  elif defined(_M_AMD64)
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return int(idx);
+#  else
+  int n = 0;
+  for (; (x & 1) == 0; x >>= 1) ++n;
+  return n;
+#  endif
+}
+
+// Converts 16 digits with values 0-9 in the bytes of `digits`, the most
+// significant first, into an integer with SSE2 multiply-adds: pairs of digits,
+// then groups of 4 and 8 digits are combined in 16-bit lanes.
+ZMIJ_INLINE auto parse16_digits(__m128i digits) noexcept -> uint64_t {
+  __m128i zero = _mm_setzero_si128();
+  __m128i mul10 = _mm_set1_epi32(10 | (1 << 16));
+  __m128i hi = _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), mul10);
+  __m128i lo = _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), mul10);
+  __m128i x = _mm_packs_epi32(hi, lo);  // 8 groups of 2 digits
+  x = _mm_madd_epi16(x, _mm_set1_epi32(100 | (1 << 16)));
+  x = _mm_packs_epi32(x, x);  // 4 groups of 4 digits
+  x = _mm_madd_epi16(x, _mm_set1_epi32(10000 | (1 << 16)));
+  uint32_t high8 = uint32_t(_mm_cvtsi128_si32(x));
+  uint32_t low8 = uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(x, 4)));
+  return uint64_t(high8) * 100'000'000 + low8;
+}
+
+// Returns a mask of the last `n` bytes of a vector, 0 <= n <= 16.
+ZMIJ_INLINE auto tail_mask(int n) noexcept -> __m128i {
+  alignas(32) static const unsigned char masks[32] = {
+      0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+      0,    0,    0,    0,    0,    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + n));
+}
+
+// Parses a number of the form -?d*.?d*(e[+-]?d{1,3})? with at most 19
+// significand digits, of which at most 16 after the point, at p. The 32 bytes
+// at p and the 16 bytes before it must be readable. Returns a pointer past the
+// number or null for other numbers and for values that need big integer
+// arithmetic which are left to from_chars.
+ZMIJ_INLINE auto parse_simple(const char* p, double& value) noexcept
+    -> const char* {
+  bool negative = *p == '-';
+  p += negative;
+  __m128i zeros = _mm_set1_epi8('0');
+  __m128i nines = _mm_set1_epi8(9);
+  auto digit_mask = [&](const char* q) {
+    __m128i digits = _mm_sub_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(q)), zeros);
+    return uint64_t(uint32_t(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(digits, nines), digits))));
+  };
+  // Bits past the vectors are set so that a run of digits that doesn't end
+  // in them has a length of 32 and is rejected.
+  uint64_t non_digits = ~(digit_mask(p) | digit_mask(p + 16) << 16);
+  int int_size = ctz(non_digits);
+  int sig_size = int_size;
+  int frac_size = 0;
+  if (int_size < 31 && p[int_size] == '.') {
+    frac_size = ctz(non_digits >> (int_size + 1));
+    sig_size = int_size + 1 + frac_size;
+  }
+  int num_digits = int_size + frac_size;
+  if (num_digits == 0 || num_digits > 19 || frac_size > 16) return nullptr;
+
+  // Load the last 16 digits so that they are adjacent and end at the last
+  // byte: the integral ones from before the point and the fractional ones
+  // from before the end of the significand. Up to 3 leading digits are added
+  // separately.
+  const char* sig_end = p + sig_size;
+  auto load_before = [&](const char* q) {
+    return _mm_sub_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(q - 16)), zeros);
+  };
+  int num_leading = num_digits > 16 ? num_digits - 16 : 0;
+  __m128i frac_mask = tail_mask(frac_size);
+  __m128i int_mask =
+      _mm_andnot_si128(frac_mask, tail_mask(num_digits - num_leading));
+  __m128i digits =
+      _mm_or_si128(_mm_and_si128(load_before(p + num_digits), int_mask),
+                   _mm_and_si128(load_before(sig_end), frac_mask));
+  uint64_t sig = parse16_digits(digits);
+  // The numbers of leading and exponent digits vary between numbers so they
+  // are accumulated with conditional moves rather than loops that would be
+  // mispredicted.
+  uint64_t leading = 0;
+  for (int i = 0; i < 3; ++i) {
+    uint64_t next = leading * 10 + uint64_t(p[i] - '0');
+    leading = i < num_leading ? next : leading;
+  }
+  sig += leading * 10'000'000'000'000'000;
+
+  int q = -frac_size;
+  const char* end = sig_end;
+  if ((*end | 0x20) == 'e') {
+    bool exp_negative = end[1] == '-';
+    int exp_start = sig_size + 1 + (end[1] == '-' || end[1] == '+');
+    int exp_size = ctz(non_digits >> exp_start);
+    if (exp_size == 0 || exp_size > 3) return nullptr;
+    const char* exp_digits = p + exp_start;
+    int exp = 0;
+    for (int i = 0; i < 3; ++i) {
+      int next = exp * 10 + (exp_digits[i] - '0');
+      exp = i < exp_size ? next : exp;
+    }
+    q += exp_negative ? -exp : exp;
+    end = exp_digits + exp_size;
+  }
+  if (sig <= (uint64_t(1) << 53) && q >= -22 && q <= 22) {
+    value = q < 0 ? double(sig) / pow10_doubles[-q]
+                  : double(sig) * pow10_doubles[q];
+  } else {
+    uint64_t bits = 0;
+    if (!eisel_lemire(sig, q, bits)) return nullptr;
+    memcpy(&value, &bits, sizeof(value));
+  }
+  if (negative) value = -value;
+  return end;
+}
+#endif  // ZMIJ_USE_SSE && FLT_EVAL_METHOD == 0
+
+}  // namespace
+
+ZMIJ_HEADER_INLINE auto parse_column(const char* first, const char* last,
+                                     char separator, double* out) noexcept
+    -> size_t {
+  double* start = out;
+  const char* p = first;
+#if ZMIJ_USE_SSE && FLT_EVAL_METHOD == 0
+  // Numbers are parsed in place and the separators are checked after them,
+  // so there is no separate scan for the field boundaries. Fields that don't
+  // take the fast path are found with memchr and parsed with from_chars.
+  // Fields that start less than 16 bytes into the input or less than 32
+  // bytes before its end are parsed with from_chars only since the vector
+  // loads would read outside of it.
+  while (p - first < 16 && p != last) {
+    auto end = static_cast<const char*>(memchr(p, separator, size_t(last - p)));
+    if (!end || !parse_field(p, end, *out)) return size_t(out - start);
+    ++out;
+    p = end + 1;
+  }
+  while (last - p >= 32) {
+    const char* end = parse_simple(p, *out);
+    if (!end || *end != separator) [[ZMIJ_UNLIKELY]] {
+      end = static_cast<const char*>(memchr(p, separator, size_t(last - p)));
+      if (!end || !parse_field(p, end, *out)) return size_t(out - start);
+    }
+    ++out;
+    p = end + 1;
+  }
+#endif
+  while (p != last) {
+    auto end = static_cast<const char*>(memchr(p, separator, size_t(last - p)));
+    if (!end || !parse_field(p, end, *out)) break;
+    ++out;
+    p = end + 1;
+  }
+  return size_t(out - start);
+}
+
+ZMIJ_HEADER_INLINE void prefetch_tables() noexcept {
+#if ZMIJ_COMPACT_POW10
+  const void* pow10 = &compact_pow10_significands;
+#else
+  const void* pow10 = &pow10_significands;
+#endif
+  auto prefetch = [](const void* data, size_t size) {
+    for (size_t i = 0; i < size; i += 64) {
+#if ZMIJ_HAS_BUILTIN(__builtin_prefetch)
+      __builtin_prefetch(static_cast<const char*>(data) + i);
+#else
+      // A load which, unlike a prefetch, waits for the line.
+      (void)*static_cast<const volatile char*>(
+          static_cast<const void*>(static_cast<const char*>(data) + i));
+#endif
+    }
+  };
+  prefetch(pow10, detail::pow10_table_size());
+  prefetch(digits2_data, sizeof(digits2_data));
+}
+
+ZMIJ_HEADER_INLINE auto write_integer(char* buffer, uint64_t value) noexcept
+    -> char* {
+  return write_integer20(buffer, value);
+}
+
+ZMIJ_HEADER_INLINE auto write_integer(char* buffer, int64_t value) noexcept
+    -> char* {
+  *buffer = '-';
+  // Negate in unsigned arithmetic so that the minimum value doesn't overflow.
+  uint64_t abs_value = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+  return write_integer20(buffer + (value < 0), abs_value);
+}
+
+ZMIJ_HEADER_INLINE auto write(char16_t* out, size_t n, double value) noexcept
+    -> size_t {
+  return detail::write_wide(out, n, value);
+}
+
+ZMIJ_HEADER_INLINE auto write(char32_t* out, size_t n, double value) noexcept
+    -> size_t {
+  return detail::write_wide(out, n, value);
+}
+
+ZMIJ_HEADER_INLINE auto write(wchar_t* out, size_t n, double value) noexcept
+    -> size_t {
+  return detail::write_wide(out, n, value);
+}
+
+namespace {
+struct fixed_point {
+  uint64_t digits;  // |value| * 10**scale
+  bool exact;
+};
+
+// Converts `value` to an integer number of units of 10**-scale, where `pow10`
+// is 10**scale. The result is exact if the shortest representation of `value`
+// has at most `scale` digits after the decimal point and the scaled value is
+// below 2**53. Rounding the scaled value recovers the digits of such a
+// representation, and the division back is correctly rounded, so comparing
+// with `value` decides exactness without computing the shortest digits.
+ZMIJ_INLINE auto to_fixed_point(double value, double pow10) noexcept
+    -> fixed_point {
+  double scaled = value < 0 ? -value * pow10 : value * pow10;
+  if (!(scaled < 0x1p53)) return {0, false};  // Also NaN.
+  uint64_t digits = uint64_t(scaled + 0.5);
+  double result = double(digits) / pow10;
+  return {digits, (value < 0 ? -result : result) == value};
+}
+
+template <int Scale>
+auto write_column_scaled(char* out, const double* values, size_t n,
+                         char separator) noexcept -> char* {
+  constexpr uint64_t pow10 = pow10_u64[Scale];
+  for (size_t i = 0; i < n; ++i) {
+    double value = values[i];
+    fixed_point fp = to_fixed_point(value, double(pow10));
+    if (fp.exact) [[ZMIJ_LIKELY]] {
+      *out = '-';
+      out += std::signbit(value);
+      out = write_integer20(out, fp.digits / pow10);
+      if (Scale != 0) {
+        *out = '.';
+        uint64_t bcd = to_bcd8(fp.digits % pow10);
+        write8(out + 1, shift_digits(bcd | zeros, (8 - Scale) % 8));
+        out += 1 + Scale;
+      }
+    } else {
+      out = detail::write(value, out);
+    }
+    *out++ = separator;
+  }
+  return out;
+}
+}  // namespace
+
+ZMIJ_HEADER_INLINE auto column_scale(const double* values, size_t n) noexcept
+    -> int {
+  int scale = 0;
+  for (size_t i = 0; i < n; ++i) {
+    for (int s = scale; s <= max_column_scale; ++s) {
+      if (!to_fixed_point(values[i], double(pow10_u64[s])).exact) continue;
+      scale = s;
+      break;
+    }
+  }
+  return scale;
+}
+
+ZMIJ_HEADER_INLINE auto write_column(char* out, const double* values,
+                                     size_t n, int scale,
+                                     char separator) noexcept -> char* {
+  // Dispatch once per column so that the scaling uses constant divisors.
+  switch (scale) {
+    case 0: return write_column_scaled<0>(out, values, n, separator);
+    case 1: return write_column_scaled<1>(out, values, n, separator);
+    case 2: return write_column_scaled<2>(out, values, n, separator);
+    case 3: return write_column_scaled<3>(out, values, n, separator);
+    case 4: return write_column_scaled<4>(out, values, n, separator);
+    case 5: return write_column_scaled<5>(out, values, n, separator);
+    case 6: return write_column_scaled<6>(out, values, n, separator);
+    case 7: return write_column_scaled<7>(out, values, n, separator);
+  }
+  return write_column_scaled<max_column_scale>(out, values, n, separator);
+}
+
+namespace detail {
+
+ZMIJ_HEADER_INLINE auto write_fixed(double value, char* buffer,
+                                    int precision) noexcept -> char* {
+  return write_precision(value, buffer, precision, precision_format::fixed);
+}
+
+ZMIJ_HEADER_INLINE auto write_exp(double value, char* buffer,
+                                  int precision) noexcept -> char* {
+  return write_precision(value, buffer, precision, precision_format::exp);
+}
+
+ZMIJ_HEADER_INLINE auto write_general(double value, char* buffer,
+                                      int precision) noexcept -> char* {
+  return write_precision(value, buffer, precision, precision_format::general);
+}
+
+ZMIJ_HEADER_INLINE auto pow10_table_size() noexcept -> size_t {
+#if ZMIJ_COMPACT_POW10
+  return sizeof(compact_pow10_significands);
+#else
+  return sizeof(pow10_significands);
+#endif
+}
+
+ZMIJ_HEADER_INLINE auto write_significand17(char* buffer, uint64_t value,
+                                            bool has17digits,
+                                            bool portable) noexcept -> char* {
+  return portable ? ::write_significand17_portable(buffer, value, has17digits)
+                  : ::write_significand17(buffer, value, has17digits);
+}
+
+}  // namespace detail
+#ifdef ZMIJ_HEADER_ONLY
+}  // namespace ZMIJ_HEADER_NAMESPACE
+#endif
 }  // namespace zmij
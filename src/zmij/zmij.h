@@ -7,12 +7,232 @@
 #define ZMIJ_H_
 
 #include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
 #include <string.h>  // memcpy
 
+// If ZMIJ_HEADER_ONLY is defined, the implementation is included into this
+// header and to_decimal and write are constexpr (C++20) so that conversions of
+// constants can be folded at compile time. Non-constant arguments use the same
+// optimized code as the compiled library.
+#ifdef ZMIJ_HEADER_ONLY
+#  include <type_traits>  // std::is_constant_evaluated
+#  define ZMIJ_HEADER_INLINE inline
+#  ifdef __cpp_lib_is_constant_evaluated
+#    define ZMIJ_HEADER_CONSTEXPR constexpr
+#  else
+#    define ZMIJ_HEADER_CONSTEXPR
+#  endif
+#else
+#  define ZMIJ_HEADER_INLINE
+#  define ZMIJ_HEADER_CONSTEXPR
+#endif
+
+// If ZMIJ_COMPACT_POW10 is 1, a compressed table of powers of 10 is used
+// instead of the full 128-bit one (~10KB) at the cost of an extra
+// multiplication per conversion, reducing the cache footprint.
+#ifndef ZMIJ_COMPACT_POW10
+#  define ZMIJ_COMPACT_POW10 0
+#endif
+
+// If ZMIJ_STATS is 1, conversions count the code paths they take, e.g. how
+// often the fast path falls back to Schubfach, in per-thread counters returned
+// by get_stats. It must have the same value when compiling zmij.cc and
+// compiles to nothing by default.
+#ifndef ZMIJ_STATS
+#  define ZMIJ_STATS 0
+#endif
+
+// An inline namespace that keeps header-only definitions distinct from ones in
+// a compiled zmij.cc and from ones with a different table or instrumentation.
+// It can be defined to include several builds, e.g. for different instruction
+// sets, in one program.
+#ifdef ZMIJ_HEADER_NAMESPACE
+// Use the provided definition.
+#elif defined(ZMIJ_HEADER_ONLY)
+#  if ZMIJ_STATS
+#    define ZMIJ_HEADER_NAMESPACE header_only_stats
+#  elif ZMIJ_COMPACT_POW10
+#    define ZMIJ_HEADER_NAMESPACE header_only_compact
+#  else
+#    define ZMIJ_HEADER_NAMESPACE header_only
+#  endif
+#endif
+
+// Whether binary128 (__float128) is supported.
+#ifndef ZMIJ_HAS_FLOAT128
+#  if defined(__SIZEOF_FLOAT128__) && defined(__SIZEOF_INT128__)
+#    define ZMIJ_HAS_FLOAT128 1
+#  else
+#    define ZMIJ_HAS_FLOAT128 0
+#  endif
+#endif
+
 namespace zmij {
+#ifdef ZMIJ_HEADER_ONLY
+inline namespace ZMIJ_HEADER_NAMESPACE {
+#endif
+
+/// Notations for the shortest decimal representation.
+enum class notation {
+  scientific,  // d.ddde+XX
+  fixed,       // ddd.ddd without an exponent
+  // Fixed if 1e-6 <= |value| < 1e21 and scientific with an exponent without
+  // leading zeros otherwise, like ECMAScript's Number.prototype.toString
+  // except that negative zero is written as "-0".
+  general,
+};
+
+/// An IEEE 754 binary16 (half-precision) value given by its bit pattern since
+/// there is no portable type for it.
+struct float16 {
+  uint16_t bits;
+};
+
+/// A bfloat16 value, the upper 16 bits of a binary32, given by its bit
+/// pattern.
+struct bfloat16 {
+  uint16_t bits;
+};
+
+/// An IEEE 754 decimal64 value in the binary integer decimal (BID) encoding,
+/// e.g. a price, given by its bit pattern.
+struct decimal64 {
+  uint64_t bits;
+};
+
+/// An output dialect of the shortest scientific notation: the minimum number
+/// of exponent digits (1 or 2), whether nonnegative exponents have a '+' and
+/// whether the output is NUL-terminated. Each dialect compiles to a separate
+/// writer without runtime checks. Without a terminator the characters past the
+/// returned size are unspecified.
+template <int MinExpDigits = 2, bool ExpPlus = true, bool NulTerminated = true>
+struct dialect {
+  static_assert(MinExpDigits == 1 || MinExpDigits == 2,
+                "unsupported number of exponent digits");
+  static constexpr int min_exp_digits = MinExpDigits;
+  static constexpr bool exp_plus = ExpPlus;
+  static constexpr bool nul_terminated = NulTerminated;
+};
+
+using default_dialect = dialect<>;             // 1e+00, 1.5e-07
+using json_dialect = dialect<1, true, false>;  // 1e+0, 1.5e-7 like JavaScript
+// Python's repr and Go's strconv.FormatFloat in the 'e' format.
+using python_dialect = dialect<2, true, false>;  // 1e+00, 1.5e-07
+using go_dialect = python_dialect;
+
+/// Compile-time assumptions about the values passed to write<Range>: they are
+/// finite with exponents in [MinExp10, MaxExp10] in the scientific notation,
+/// i.e. 10**MinExp10 <= |value| < 10**(MaxExp10 + 1), and nonnegative if
+/// NonNegative is true. For example, range<-6, 8> covers [1e-6, 1e9). The
+/// writer for a range drops the checks for zeros, subnormals, non-finite values
+/// and, if possible, the sign and three-digit exponents, and only stores the
+/// powers of 10 that the range needs.
+template <int MinExp10, int MaxExp10, bool NonNegative = true> struct range {
+  static_assert(-307 <= MinExp10 && MinExp10 <= MaxExp10 && MaxExp10 <= 308,
+                "a range must only include normal doubles");
+  static constexpr int min_exp10 = MinExp10;
+  static constexpr int max_exp10 = MaxExp10;
+  static constexpr bool non_negative = NonNegative;
+};
+
+#if ZMIJ_STATS
+/// Numbers of conversions by the code path they took. Fallbacks are to
+/// Schubfach in to_decimal.
+struct stats {
+  // Integers written directly in the fixed and general notations.
+  uint64_t integral;
+  uint64_t fast;           // Shortest found by the fast path of to_decimal.
+  uint64_t half_ulp_tie;   // Fallback on an exact half-ulp tie.
+  uint64_t near_boundary;  // Fallback near a rounding interval boundary.
+  // Fallback for a power of 2 with an asymmetric rounding interval.
+  uint64_t irregular;
+  uint64_t subnormal;  // Fallback and normalization of a subnormal.
+};
+
+/// Returns the counters of the calling thread.
+inline auto get_stats() noexcept -> stats& {
+  thread_local stats s = {};
+  return s;
+}
+#endif
+
 namespace detail {
 template <typename Float>
-auto write(Float value, char* buffer) noexcept -> char*;
+ZMIJ_HEADER_CONSTEXPR auto write(Float value, char* buffer) noexcept -> char*;
+
+// Same as write for float and double but in the output dialect `Dialect`.
+template <typename Dialect, typename Float>
+ZMIJ_HEADER_CONSTEXPR auto write_dialect(Float value, char* buffer) noexcept
+    -> char*;
+
+#if ZMIJ_HAS_FLOAT128
+template <>
+ZMIJ_HEADER_INLINE auto write(__float128 value, char* buffer) noexcept
+    -> char*;
+#endif
+
+// Writes `value` in the fixed or general notation.
+template <typename Float>
+auto write(Float value, char* buffer, notation fmt) noexcept -> char*;
+
+ZMIJ_HEADER_INLINE auto write_fixed(double value, char* buffer,
+                                    int precision) noexcept -> char*;
+ZMIJ_HEADER_INLINE auto write_exp(double value, char* buffer,
+                                  int precision) noexcept -> char*;
+ZMIJ_HEADER_INLINE auto write_general(double value, char* buffer,
+                                      int precision) noexcept -> char*;
+
+// Writes the digits of a decimal significand with up to 17 digits (16-17 for
+// normals) without trailing zeros and returns a pointer past the last one or
+// `buffer` if there is only one digit so that the decimal point can be
+// dropped. Exposed to benchmark digit emission separately from to_decimal. If
+// `portable` is true the SWAR version is used instead of NEON or SSE.
+ZMIJ_HEADER_INLINE auto write_significand17(char* buffer, uint64_t value,
+                                            bool has17digits,
+                                            bool portable = false) noexcept
+    -> char*;
+
+// Writes sig * 10**exp with a nonzero significand of up to 17 digits, e.g. the
+// result of to_decimal, like write and returns a pointer past the end. Exposed
+// to benchmark formatting separately from to_decimal.
+ZMIJ_HEADER_INLINE auto write_decimal(char* buffer, long long sig,
+                                      int exp) noexcept -> char*;
+
+// Writes a decimal64 `value` like write writes a double with the same
+// decimal value and returns a pointer past the end.
+ZMIJ_HEADER_INLINE auto write_decimal64(decimal64 value, char* buffer) noexcept
+    -> char*;
+
+// The smallest buffer size for which write_bounded writes in place. The
+// significand is written with a store of 16 digits after the first one which
+// may end 18 bytes past the sign, followed by up to 6 bytes of the exponent,
+// so the output of any positive value fits. In shorter buffers whether the
+// output fits varies between values and the mispredicted checks cost more
+// than writing to a temporary buffer and copying.
+constexpr size_t min_direct_size = 18 + 6;
+
+// Writes `value` like write to a buffer of size `n` in
+// [min_direct_size, double_buffer_size) and returns the size of the full
+// output. The output is written in place unless it doesn't fit, in which case
+// only the exponent is truncated.
+ZMIJ_HEADER_INLINE ZMIJ_HEADER_CONSTEXPR auto write_bounded(
+    double value, char* out, size_t n) noexcept -> size_t;
+
+// Returns the size in bytes of the table of powers of 10.
+ZMIJ_HEADER_INLINE auto pow10_table_size() noexcept -> size_t;
+
+// Copies the first `n` bytes of `in` to `out` like memcpy but also in constant
+// evaluation.
+ZMIJ_HEADER_CONSTEXPR inline void copy_n(char* out, const char* in,
+                                         size_t n) noexcept {
+#if defined(ZMIJ_HEADER_ONLY) && defined(__cpp_lib_is_constant_evaluated)
+  if (std::is_constant_evaluated()) {
+    for (size_t i = 0; i < n; ++i) out[i] = in[i];
+    return;
+  }
+#endif
+  memcpy(out, in, n);
+}
 }  // namespace detail
 
 enum {
@@ -29,33 +249,309 @@ struct dec_fp {
 /// Converts `value` into the shortest correctly rounded decimal representation.
 /// Usage:
 ///   auto [sig, exp] = to_decimal(6.62607015e-34);
-auto to_decimal(double value) noexcept -> dec_fp;
+ZMIJ_HEADER_INLINE ZMIJ_HEADER_CONSTEXPR auto to_decimal(double value) noexcept
+    -> dec_fp;
+
+/// Converts `n` values into the shortest correctly rounded decimal
+/// representations in `out`. With AVX2 or AVX-512 and the full table of powers
+/// of 10 multiple values are processed at a time and values that need the
+/// Schubfach fallback use the scalar path.
+ZMIJ_HEADER_INLINE void to_decimal(const double* values, dec_fp* out,
+                                   size_t n) noexcept;
+
+enum {
+  // The exponent of non-finite values in the columnar to_decimal.
+  non_finite_exp16 = 0x7fff,
+};
+
+/// Converts `n` values into the shortest correctly rounded decimal
+/// representations stored as separate arrays of significands and exponents,
+/// e.g. for columnar encoders. This writes 10 bytes per value instead of the
+/// 16 of dec_fp. If exps[i] is non_finite_exp16 then values[i] is a NaN or an
+/// infinity.
+ZMIJ_HEADER_INLINE void to_decimal(const double* values, long long* sigs,
+                                   int16_t* exps, size_t n) noexcept;
+
+/// Prefetches the tables used by conversions, e.g. the powers of 10, into the
+/// caches without waiting for them. Call it ahead of a latency-sensitive
+/// conversion, e.g. when a request arrives, if conversions are infrequent
+/// enough for the tables to be evicted in between.
+ZMIJ_HEADER_INLINE void prefetch_tables() noexcept;
+
+struct from_chars_result {
+  const char* ptr;
+  bool ok;
+};
+
+/// Parses a decimal floating-point number in [first, last) into `value`
+/// rounded to nearest. Accepts an optional '-' followed by digits with an
+/// optional decimal point and exponent or by "inf", "infinity" or "nan"
+/// ignoring case. Out-of-range values become infinities or zeros. On success
+/// returns a pointer past the parsed characters, otherwise `first`. Uses the
+/// same table of powers of 10 as to_decimal and falls back to big integer
+/// arithmetic only for near-halfway or long inputs.
+ZMIJ_HEADER_INLINE auto from_chars(const char* first, const char* last,
+                                   double& value) noexcept
+    -> from_chars_result;
+
+/// Parses a column of numbers in [first, last), each followed by `separator`,
+/// e.g. "1.5\n-2e-05\n", into `out` and returns the number of values parsed.
+/// Numbers with up to 19 significand digits and 3 exponent digits are parsed
+/// in place with SIMD multiply-adds and the separator is checked after them,
+/// so there is no separate scan for field boundaries. Other fields and values
+/// that need big integer arithmetic are parsed with from_chars. Stops at the
+/// first field that isn't a number or a trailing one without a separator.
+/// `out` should have room for a value per separator.
+ZMIJ_HEADER_INLINE auto parse_column(const char* first, const char* last,
+                                     char separator, double* out) noexcept
+    -> size_t;
 
 enum {
   double_buffer_size = 25,
   float_buffer_size = 17,
+  // At most "-6.104e-05" for binary16 and "-1.175e-38" for bfloat16.
+  float16_buffer_size = 16,
+  // A sign, 36 digits, a decimal point, "e+4932" and a NUL.
+  float128_buffer_size = 48,
+  // The general notation is at most "-0.000000" followed by 17 digits or
+  // 21 integral digits. Some room is reserved for unaligned stores.
+  general_buffer_size = 40,
+  // The fixed notation of the smallest subnormals has over 320 zeros.
+  fixed_buffer_size = 350,
+  // The maximum precision supported by write_fixed, write_exp and
+  // write_general.
+  max_precision = 350,
+  // A buffer size sufficient for write_fixed, write_exp and write_general with
+  // any precision up to max_precision: a sign, 309 integral digits, a decimal
+  // point, max_precision fractional digits and a terminating NUL.
+  precision_buffer_size = 1 + 309 + 1 + max_precision + 1,
+  // A sign and the 20 digits of the largest 64-bit integer.
+  integer_buffer_size = 21,
+  // The maximum number of digits after the decimal point of write_column.
+  max_column_scale = 8,
+  // The number of bytes per value that write_column may write including the
+  // separator and room for unaligned stores.
+  column_value_size = 32,
 };
 
+/// Writes the decimal representation of `value` to `buffer` using the same BCD
+/// digit writer as the floating-point conversions and returns a pointer past
+/// the end. `buffer` should have at least integer_buffer_size bytes. No
+/// terminating NUL is written.
+ZMIJ_HEADER_INLINE auto write_integer(char* buffer, uint64_t value) noexcept
+    -> char*;
+ZMIJ_HEADER_INLINE auto write_integer(char* buffer, int64_t value) noexcept
+    -> char*;
+
+/// Returns the smallest number of digits after the decimal point, up to
+/// max_column_scale, with which the shortest representations of the `n`
+/// values can be written in the fixed notation, e.g. 2 for prices. Values
+/// that need more digits are ignored since write_column falls back to write
+/// for them anyway.
+ZMIJ_HEADER_INLINE auto column_scale(const double* values, size_t n) noexcept
+    -> int;
+
+/// Writes `n` values that share a decimal exponent, e.g. a column of prices,
+/// each followed by `separator` to `out` and returns a pointer past the end.
+/// Values are written in the fixed notation with `scale` digits after the
+/// decimal point, e.g. "12.50" for a scale of 2, if their shortest
+/// representation has at most that many and they are below 2**53 units of
+/// 10**-scale, and like write otherwise. `scale` above max_column_scale is
+/// treated as max_column_scale. `out` should point to a buffer of size
+/// `n * column_value_size` or larger.
+ZMIJ_HEADER_INLINE auto write_column(char* out, const double* values,
+                                     size_t n, int scale,
+                                     char separator) noexcept -> char*;
+
+/// Writes the shortest correctly rounded decimal representation of `value` to
+/// `out` as UTF-16 or UTF-32 code units, e.g. for Windows APIs or Java and
+/// JavaScript strings, without converting to char first. `out` should point
+/// to a buffer of `n` code units or larger. No terminating null is written.
+ZMIJ_HEADER_INLINE auto write(char16_t* out, size_t n, double value) noexcept
+    -> size_t;
+ZMIJ_HEADER_INLINE auto write(char32_t* out, size_t n, double value) noexcept
+    -> size_t;
+ZMIJ_HEADER_INLINE auto write(wchar_t* out, size_t n, double value) noexcept
+    -> size_t;
+
+// 32-bit overloads so that calls with int or unsigned are not ambiguous.
+inline auto write_integer(char* buffer, uint32_t value) noexcept -> char* {
+  return write_integer(buffer, uint64_t(value));
+}
+inline auto write_integer(char* buffer, int32_t value) noexcept -> char* {
+  return write_integer(buffer, int64_t(value));
+}
+
 /// Writes the shortest correctly rounded decimal representation of `value` to
 /// `out`. `out` should point to a buffer of size `n` or larger.
-inline auto write(char* out, size_t n, double value) noexcept -> size_t {
+ZMIJ_HEADER_CONSTEXPR inline auto write(char* out, size_t n,
+                                        double value) noexcept -> size_t {
   if (n >= double_buffer_size) return detail::write(value, out) - out;
-  char buffer[double_buffer_size];
+  if (n >= detail::min_direct_size) return detail::write_bounded(value, out, n);
+  char buffer[double_buffer_size] = {};
   size_t result = detail::write(value, buffer) - buffer;
-  memcpy(out, buffer, n);
+  detail::copy_n(out, buffer, n);
   return result;
 }
 
 /// Writes the shortest correctly rounded decimal representation of `value` to
 /// `out`. `out` should point to a buffer of size `n` or larger.
-inline auto write(char* out, size_t n, float value) noexcept -> size_t {
+ZMIJ_HEADER_CONSTEXPR inline auto write(char* out, size_t n,
+                                        float value) noexcept -> size_t {
   if (n >= float_buffer_size) return detail::write(value, out) - out;
-  char buffer[float_buffer_size];
+  char buffer[float_buffer_size] = {};
+  size_t result = detail::write(value, buffer) - buffer;
+  detail::copy_n(out, buffer, n);
+  return result;
+}
+
+/// Writes the shortest correctly rounded decimal representation of `value` to
+/// `out` in the output dialect `Dialect`, e.g. zmij::write<json_dialect>(...).
+/// `out` should point to a buffer of size `n` or larger.
+template <typename Dialect, typename Float>
+ZMIJ_HEADER_CONSTEXPR inline auto write(char* out, size_t n,
+                                        Float value) noexcept -> size_t {
+  constexpr size_t size = sizeof(Float) == sizeof(double) ? double_buffer_size
+                                                          : float_buffer_size;
+  if (n >= size) return detail::write_dialect<Dialect>(value, out) - out;
+  char buffer[size] = {};
+  size_t result = detail::write_dialect<Dialect>(value, buffer) - buffer;
+  detail::copy_n(out, buffer, n);
+  return result;
+}
+
+#ifdef ZMIJ_HEADER_ONLY
+namespace detail {
+template <typename Range, typename Dialect>
+ZMIJ_HEADER_CONSTEXPR auto write_range(double value, char* buffer) noexcept
+    -> char*;
+}  // namespace detail
+
+/// Writes the shortest correctly rounded decimal representation of `value`,
+/// which must satisfy the assumptions of `Range`, to `out` in the output
+/// dialect `Dialect`, e.g. zmij::write<zmij::range<-6, 8>>(...). `out` should
+/// point to a buffer of size `n` or larger. The assumptions are checked with
+/// assert and violating them in release builds is undefined behavior. Only
+/// available in the header-only build since a writer is instantiated for each
+/// range.
+template <typename Range, typename Dialect = default_dialect>
+ZMIJ_HEADER_CONSTEXPR inline auto write(char* out, size_t n,
+                                        double value) noexcept
+    -> decltype(size_t(Range::min_exp10)) {
+  if (n >= double_buffer_size)
+    return detail::write_range<Range, Dialect>(value, out) - out;
+  char buffer[double_buffer_size] = {};
+  size_t result = detail::write_range<Range, Dialect>(value, buffer) - buffer;
+  detail::copy_n(out, buffer, n);
+  return result;
+}
+#endif
+
+/// Writes the shortest correctly rounded decimal representation of `value` to
+/// `out`. `out` should point to a buffer of size `n` or larger.
+inline auto write(char* out, size_t n, float16 value) noexcept -> size_t {
+  if (n >= float16_buffer_size) return detail::write(value, out) - out;
+  char buffer[float16_buffer_size];
   size_t result = detail::write(value, buffer) - buffer;
   memcpy(out, buffer, n);
   return result;
 }
 
+/// Writes the shortest correctly rounded decimal representation of `value` to
+/// `out`. `out` should point to a buffer of size `n` or larger.
+inline auto write(char* out, size_t n, bfloat16 value) noexcept -> size_t {
+  if (n >= float16_buffer_size) return detail::write(value, out) - out;
+  char buffer[float16_buffer_size];
+  size_t result = detail::write(value, buffer) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+/// Writes a decimal64 `value` in the scientific notation like a double, e.g.
+/// "1.25e+02", to `out`. There is no binary-to-decimal conversion, only digit
+/// emission. Trailing zeros of the coefficient, e.g. of 12500e-2, are not
+/// written. `out` should point to a buffer of size `n` or larger.
+inline auto write(char* out, size_t n, decimal64 value) noexcept -> size_t {
+  if (n >= double_buffer_size) return detail::write_decimal64(value, out) - out;
+  char buffer[double_buffer_size];
+  size_t result = detail::write_decimal64(value, buffer) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+#if ZMIJ_HAS_FLOAT128
+/// Writes the shortest correctly rounded decimal representation of a binary128
+/// `value` to `out`. `out` should point to a buffer of size `n` or larger.
+/// This uses exact big-integer arithmetic and is much slower than double.
+inline auto write(char* out, size_t n, __float128 value) noexcept -> size_t {
+  if (n >= float128_buffer_size) return detail::write(value, out) - out;
+  char buffer[float128_buffer_size];
+  size_t result = detail::write(value, buffer) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+#endif
+
+/// Writes the shortest correctly rounded decimal representation of `value` in
+/// the notation `fmt` to `out`. `out` should point to a buffer of size `n` or
+/// larger.
+template <typename Float>
+auto write(char* out, size_t n, Float value, notation fmt) noexcept -> size_t {
+  if (fmt == notation::scientific) return write(out, n, value);
+  size_t size =
+      fmt == notation::fixed ? fixed_buffer_size : general_buffer_size;
+  if (n >= size) return detail::write(value, out, fmt) - out;
+  char buffer[fixed_buffer_size];
+  size_t result = detail::write(value, buffer, fmt) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+/// Writes `value` correctly rounded to `precision` digits after the decimal
+/// point like printf("%.*f", precision, value) in the C locale. `out` should
+/// point to a buffer of size `n` or larger. `precision` must be in the range
+/// [0, max_precision].
+inline auto write_fixed(char* out, size_t n, double value,
+                        int precision) noexcept -> size_t {
+  if (n >= precision_buffer_size)
+    return detail::write_fixed(value, out, precision) - out;
+  char buffer[precision_buffer_size];
+  size_t result = detail::write_fixed(value, buffer, precision) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+/// Writes `value` correctly rounded to `precision` digits after the decimal
+/// point in the exponential format like printf("%.*e", precision, value).
+inline auto write_exp(char* out, size_t n, double value,
+                      int precision) noexcept -> size_t {
+  if (n >= precision_buffer_size)
+    return detail::write_exp(value, out, precision) - out;
+  char buffer[precision_buffer_size];
+  size_t result = detail::write_exp(value, buffer, precision) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+/// Writes `value` correctly rounded to `precision` significant digits like
+/// printf("%.*g", precision, value).
+inline auto write_general(char* out, size_t n, double value,
+                          int precision) noexcept -> size_t {
+  if (n >= precision_buffer_size)
+    return detail::write_general(value, out, precision) - out;
+  char buffer[precision_buffer_size];
+  size_t result = detail::write_general(value, buffer, precision) - buffer;
+  memcpy(out, buffer, n);
+  return result;
+}
+
+#ifdef ZMIJ_HEADER_ONLY
+}  // namespace ZMIJ_HEADER_NAMESPACE
+#endif
 }  // namespace zmij
 
+#ifdef ZMIJ_HEADER_ONLY
+#  include "zmij.cc"
+#endif
+
 #endif  // ZMIJ_H_